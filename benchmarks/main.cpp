@@ -0,0 +1,558 @@
+/**
+ * Benchmark of the CPU-side costs of using generated kernels: construction,
+ * bind group creation, encoding and submitting dispatches, and readback round
+ * trips. Results are written as JSON, so that regressions in the dispatch path
+ * can be detected by comparing runs.
+ *
+ * Since it measures the CPU side, it is meaningful on machines without a GPU:
+ * use '--backend null' (Dawn's null backend, where the GPU does nothing) or
+ * '--fallback-adapter' (a software Vulkan adapter such as SwiftShader).
+ */
+
+// NB: This WEBGPU_CPP_IMPLEMENTATION must be defined in **exactly one** source
+// file, and before including webgpu C++ header (see https://github.com/eliemichel/WebGPU-Cpp)
+#define WEBGPU_CPP_IMPLEMENTATION
+
+#include "generated/BenchmarkTouchKernel.h"
+#include "generated/BenchmarkWideKernel.h"
+// Header generated from examples/02_multiple_entrypoints/shaders/buffer-math.slang
+#include "generated/BufferMathKernel.h"
+
+#include <slang-webgpu/common/result.h>
+#include <slang-webgpu/common/logger.h>
+#include <slang-webgpu/runtime/readback-service.h>
+
+// NB: raii::Foo is the equivalent of Foo except its release()/addRef() methods
+// are automatically called
+#include <webgpu/webgpu-raii.hpp>
+
+#include <CLI11.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <map>
+#include <optional>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+using namespace wgpu;
+
+/**
+ * Durations of the samples of a single benchmark, where each sample runs
+ * 'itemsPerSample' times the measured operation.
+ */
+struct Measurement {
+	std::string name;
+	std::vector<std::pair<std::string, uint64_t>> parameters;
+	uint64_t itemsPerSample = 1;
+	std::vector<double> samplesNs;
+};
+
+struct BenchmarkOptions {
+	uint32_t iterations = 50;
+	std::string filter;
+};
+
+class BenchmarkRunner {
+public:
+	BenchmarkRunner(const BenchmarkOptions& options)
+		: m_options(options)
+	{}
+
+	/**
+	 * Run 'sample' for the configured number of iterations (after a warmup
+	 * run), unless 'name' does not match the filter. 'sample' returns the
+	 * duration to record in nanoseconds, so that it can exclude its setup.
+	 */
+	Result<Void, Error> run(
+		const std::string& name,
+		std::vector<std::pair<std::string, uint64_t>> parameters,
+		uint64_t itemsPerSample,
+		const std::function<Result<double, Error>()>& sample,
+		std::optional<uint32_t> iterations = std::nullopt
+	) {
+		if (!m_options.filter.empty() && name.find(m_options.filter) == std::string::npos) {
+			return {};
+		}
+
+		Measurement measurement;
+		measurement.name = name;
+		measurement.parameters = std::move(parameters);
+		measurement.itemsPerSample = itemsPerSample;
+
+		uint32_t count = iterations.value_or(m_options.iterations);
+		// Statistics are undefined without samples
+		TRY_ASSERT(count > 0, "Benchmark '" << name << "' needs at least one iteration");
+		if (count > 1) {
+			// Warmup
+			TRY(sample());
+		}
+		for (uint32_t i = 0; i < count; ++i) {
+			double durationNs;
+			TRY_ASSIGN(durationNs, sample());
+			measurement.samplesNs.push_back(durationNs);
+		}
+
+		logMeasurement(measurement);
+		m_measurements.push_back(std::move(measurement));
+		return {};
+	}
+
+	const std::vector<Measurement>& measurements() const { return m_measurements; }
+
+private:
+	static void logMeasurement(const Measurement& measurement) {
+		std::vector<double> samples = measurement.samplesNs;
+		std::sort(samples.begin(), samples.end());
+		double median = samples[samples.size() / 2] / measurement.itemsPerSample;
+		std::ostringstream parameters;
+		for (const auto& [key, value] : measurement.parameters) {
+			parameters << " " << key << "=" << value;
+		}
+		LOG(INFO) << measurement.name << parameters.str() << ": " << median / 1000.0 << " us per item (median of " << samples.size() << " sample(s))";
+	}
+
+private:
+	BenchmarkOptions m_options;
+	std::vector<Measurement> m_measurements;
+};
+
+/**
+ * Time a single call to 'f', in nanoseconds.
+ */
+template <typename F>
+double timeNs(F&& f) {
+	auto start = std::chrono::steady_clock::now();
+	f();
+	auto end = std::chrono::steady_clock::now();
+	return (double)std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
+}
+
+////////////////////////////////////////////
+// Device
+
+static std::optional<BackendType> parseBackend(const std::string& name) {
+	static const std::map<std::string, BackendType> backends = {
+		{ "default", BackendType::Undefined },
+		{ "null", BackendType::Null },
+		{ "vulkan", BackendType::Vulkan },
+		{ "metal", BackendType::Metal },
+		{ "d3d12", BackendType::D3D12 },
+		{ "d3d11", BackendType::D3D11 },
+		{ "opengl", BackendType::OpenGL },
+		{ "opengles", BackendType::OpenGLES },
+	};
+	auto it = backends.find(name);
+	if (it == backends.end()) return std::nullopt;
+	return it->second;
+}
+
+/**
+ * Create a device on a given backend, possibly a software one. The description
+ * of the adapter is reported in the JSON output.
+ */
+Result<raii::Device, Error> createBenchmarkDevice(
+	BackendType backend,
+	bool fallbackAdapter,
+	std::map<std::string, std::string>& context
+) {
+	// Timed waits let ReadbackService block on futures rather than polling
+	InstanceDescriptor instanceDesc = Default;
+	instanceDesc.features.timedWaitAnyEnable = true;
+	raii::Instance instance = createInstance(instanceDesc);
+
+	RequestAdapterOptions options = Default;
+	options.backendType = backend;
+	options.forceFallbackAdapter = fallbackAdapter;
+	raii::Adapter adapter = instance->requestAdapter(options);
+	TRY_ASSERT(*adapter, "Could not get a WebGPU adapter for this backend (is it enabled in the Dawn build?)");
+
+	DeviceDescriptor descriptor = Default;
+	descriptor.uncapturedErrorCallbackInfo2.callback = [](
+		[[maybe_unused]] WGPUDevice const* device,
+		WGPUErrorType type,
+		WGPUStringView message,
+		[[maybe_unused]] void* userdata1,
+		[[maybe_unused]] void* userdata2
+	) {
+		if (message.data)
+			LOG(ERROR) << "[WebGPU] Uncaptured error: " << StringView(message) << " (type: " << type << ")";
+		else
+			LOG(ERROR) << "[WebGPU] Uncaptured error: (reason: " << type << ")";
+	};
+	raii::Device device = adapter->requestDevice(descriptor);
+	TRY_ASSERT(*device, "Could not get a WebGPU device");
+
+	AdapterInfo info;
+	device->getAdapterInfo(&info);
+	auto toString = [](WGPUStringView value) {
+		std::ostringstream ss;
+		ss << StringView(value);
+		return ss.str();
+	};
+	context["device"] = toString(info.device);
+	context["vendor"] = toString(info.vendor);
+	context["architecture"] = toString(info.architecture);
+	context["backend"] = std::to_string((int)info.backendType);
+	context["adapter_type"] = std::to_string((int)info.adapterType);
+	LOG(INFO)
+		<< "Using device: " << context["device"]
+		<< " (vendor: " << context["vendor"]
+		<< ", architecture: " << context["architecture"] << ")";
+	info.freeMembers();
+	return device;
+}
+
+static raii::Buffer createStorageBuffer(Device device, uint64_t size, const char* label) {
+	BufferDescriptor bufferDesc = Default;
+	bufferDesc.label = StringView(label);
+	bufferDesc.size = size;
+	bufferDesc.usage = BufferUsage::Storage | BufferUsage::CopySrc | BufferUsage::CopyDst;
+	return device.createBuffer(bufferDesc);
+}
+
+////////////////////////////////////////////
+// Benchmarks
+
+static const std::vector<uint64_t> s_bufferSizes = { 256, 64 * 1024, 16 * 1024 * 1024 };
+static const std::vector<uint64_t> s_dispatchCounts = { 1, 16, 256, 4096 };
+
+/**
+ * Cost of creating a kernel, upon first creation (shader compilation) and
+ * when its GPU objects are already shared through the device registry.
+ */
+Result<Void, Error> benchmarkKernelConstruction(BenchmarkRunner& runner, Device device) {
+	TRY(runner.run("kernel_construction/cold", {}, 1, [&]() -> Result<double, Error> {
+		bool valid = false;
+		double durationNs = timeNs([&]() {
+			generated::BufferMathKernel kernel(device);
+			valid = kernel;
+		});
+		TRY_ASSERT(valid, "Kernel could not load!");
+		return durationNs;
+	}, 1));
+
+	TRY(runner.run("kernel_construction/cached", {}, 1, [&]() -> Result<double, Error> {
+		return timeNs([&]() {
+			generated::BufferMathKernel kernel(device);
+		});
+	}));
+	return {};
+}
+
+/**
+ * Cost of createBindGroup() for kernels with few and many bindings, and with
+ * buffer views (which are validated on the CPU).
+ */
+Result<Void, Error> benchmarkCreateBindGroup(BenchmarkRunner& runner, Device device) {
+	constexpr uint64_t bindGroupsPerSample = 64;
+	generated::BenchmarkTouchKernel touchKernel(device);
+	generated::BenchmarkWideKernel wideKernel(device);
+	generated::BufferMathKernel mathKernel(device);
+	TRY_ASSERT(touchKernel && wideKernel && mathKernel, "Kernel could not load!");
+
+	for (uint64_t size : s_bufferSizes) {
+		std::vector<raii::Buffer> buffers;
+		for (int i = 0; i < 8; ++i) {
+			buffers.push_back(createStorageBuffer(device, size, "bind group input"));
+		}
+
+		TRY(runner.run("create_bind_group/touch", { { "buffer_size", size } }, bindGroupsPerSample, [&]() -> Result<double, Error> {
+			std::vector<raii::BindGroup> bindGroups(bindGroupsPerSample);
+			return timeNs([&]() {
+				for (raii::BindGroup& bindGroup : bindGroups) {
+					*bindGroup = touchKernel.createBindGroup(*buffers[0]);
+				}
+			});
+		}));
+
+		TRY(runner.run("create_bind_group/wide", { { "buffer_size", size } }, bindGroupsPerSample, [&]() -> Result<double, Error> {
+			std::vector<raii::BindGroup> bindGroups(bindGroupsPerSample);
+			return timeNs([&]() {
+				for (raii::BindGroup& bindGroup : bindGroups) {
+					*bindGroup = wideKernel.createBindGroup(
+						*buffers[0], *buffers[1], *buffers[2], *buffers[3],
+						*buffers[4], *buffers[5], *buffers[6], *buffers[7]
+					);
+				}
+			});
+		}));
+
+		TRY(runner.run("create_bind_group/buffer_math_views", { { "buffer_size", size } }, bindGroupsPerSample, [&]() -> Result<double, Error> {
+			std::vector<raii::BindGroup> bindGroups(bindGroupsPerSample);
+			bool valid = true;
+			double durationNs = timeNs([&]() {
+				for (raii::BindGroup& bindGroup : bindGroups) {
+					auto maybeBindGroup = mathKernel.createBindGroup(
+						BufferView(*buffers[0], 0, size),
+						BufferView(*buffers[1], 0, size),
+						BufferView(*buffers[2], 0, size)
+					);
+					valid = valid && !isError(maybeBindGroup);
+					if (valid) *bindGroup = std::get<BindGroup>(maybeBindGroup);
+				}
+			});
+			TRY_ASSERT(valid, "Could not create bind group from views");
+			return durationNs;
+		}));
+	}
+	return {};
+}
+
+/**
+ * Cost of encoding N dispatches: in a single compute pass, through a
+ * Recorder, and with one compute pass per dispatch.
+ */
+Result<Void, Error> benchmarkEncodeDispatches(BenchmarkRunner& runner, Device device) {
+	generated::BufferMathKernel kernel(device);
+	TRY_ASSERT(kernel, "Kernel could not load!");
+	raii::Buffer buffer0 = createStorageBuffer(device, 256, "buffer0");
+	raii::Buffer buffer1 = createStorageBuffer(device, 256, "buffer1");
+	raii::Buffer result = createStorageBuffer(device, 256, "result");
+	raii::BindGroup bindGroup = kernel.createBindGroup(*buffer0, *buffer1, *result);
+
+	for (uint64_t dispatchCount : s_dispatchCounts) {
+		TRY(runner.run("encode_dispatches/single_pass", { { "dispatch_count", dispatchCount } }, dispatchCount, [&]() -> Result<double, Error> {
+			return timeNs([&]() {
+				raii::CommandEncoder encoder = device.createCommandEncoder();
+				raii::ComputePassEncoder computePass = encoder->beginComputePass();
+				for (uint64_t i = 0; i < dispatchCount; ++i) {
+					kernel.dispatchComputeMainAdd(*computePass, ThreadCount{ 64 }, *bindGroup);
+				}
+				computePass->end();
+				raii::CommandBuffer commands = encoder->finish();
+			});
+		}));
+
+		TRY(runner.run("encode_dispatches/recorder", { { "dispatch_count", dispatchCount } }, dispatchCount, [&]() -> Result<double, Error> {
+			return timeNs([&]() {
+				generated::BufferMathKernel::Recorder recorder = kernel.createRecorder();
+				for (uint64_t i = 0; i < dispatchCount; ++i) {
+					kernel.dispatchComputeMainAdd(recorder, ThreadCount{ 64 }, *bindGroup);
+				}
+				raii::CommandBuffer commands = recorder.finish();
+			});
+		}));
+
+		TRY(runner.run("encode_dispatches/pass_per_dispatch", { { "dispatch_count", dispatchCount } }, dispatchCount, [&]() -> Result<double, Error> {
+			return timeNs([&]() {
+				raii::CommandEncoder encoder = device.createCommandEncoder();
+				for (uint64_t i = 0; i < dispatchCount; ++i) {
+					kernel.dispatchComputeMainAdd(*encoder, ThreadCount{ 64 }, *bindGroup);
+				}
+				raii::CommandBuffer commands = encoder->finish();
+			});
+		}));
+	}
+	return {};
+}
+
+/**
+ * Cost of submitting command buffers that contain N dispatches, measured
+ * without their encoding.
+ */
+Result<Void, Error> benchmarkSubmit(BenchmarkRunner& runner, Device device) {
+	generated::BenchmarkTouchKernel kernel(device);
+	TRY_ASSERT(kernel, "Kernel could not load!");
+	raii::Buffer buffer = createStorageBuffer(device, 256, "data");
+	raii::BindGroup bindGroup = kernel.createBindGroup(*buffer);
+	raii::Queue queue = device.getQueue();
+	ReadbackService readbacks(device, "benchmark");
+
+	for (uint64_t dispatchCount : s_dispatchCounts) {
+		TRY(runner.run("submit", { { "dispatch_count", dispatchCount } }, 1, [&]() -> Result<double, Error> {
+			raii::CommandEncoder encoder = device.createCommandEncoder();
+			raii::ComputePassEncoder computePass = encoder->beginComputePass();
+			for (uint64_t i = 0; i < dispatchCount; ++i) {
+				kernel.dispatch(*computePass, ThreadCount{ 64 }, *bindGroup);
+			}
+			computePass->end();
+			raii::CommandBuffer commands = encoder->finish();
+			return timeNs([&]() {
+				queue->submit(*commands);
+			});
+		}));
+
+		// Do not let work pile up on the queue from one batch to the next
+		ReadbackService::Readback readback;
+		TRY_ASSIGN(readback, readbacks.read(*buffer));
+		TRY(readbacks.wait(readback));
+	}
+	return {};
+}
+
+/**
+ * Latency of a dispatch followed by the readback of its buffer, from
+ * recording to the data being available on the CPU.
+ */
+Result<Void, Error> benchmarkReadbackRoundTrip(BenchmarkRunner& runner, Device device) {
+	generated::BenchmarkTouchKernel kernel(device);
+	TRY_ASSERT(kernel, "Kernel could not load!");
+	raii::Queue queue = device.getQueue();
+	ReadbackService readbacks(device, "benchmark");
+
+	for (uint64_t size : s_bufferSizes) {
+		raii::Buffer buffer = createStorageBuffer(device, size, "data");
+		raii::BindGroup bindGroup = kernel.createBindGroup(*buffer);
+		uint32_t threadCount = (uint32_t)(size / sizeof(float));
+
+		TRY(runner.run("readback_round_trip", { { "buffer_size", size } }, 1, [&]() -> Result<double, Error> {
+			bool valid = false;
+			double durationNs = timeNs([&]() {
+				raii::CommandEncoder encoder = device.createCommandEncoder();
+				kernel.dispatch(*encoder, ThreadCount{ threadCount }, *bindGroup);
+				raii::CommandBuffer commands = encoder->finish();
+				queue->submit(*commands);
+
+				auto maybeReadback = readbacks.read(*buffer);
+				if (isError(maybeReadback)) return;
+				valid = !isError(readbacks.wait(std::get<ReadbackService::Readback>(maybeReadback)));
+			});
+			TRY_ASSERT(valid, "Could not read buffer back");
+			return durationNs;
+		}));
+	}
+	return {};
+}
+
+////////////////////////////////////////////
+// Output
+
+static std::string escapeJson(const std::string& value) {
+	std::string escaped;
+	for (char c : value) {
+		switch (c) {
+		case '"': escaped += "\\\""; break;
+		case '\\': escaped += "\\\\"; break;
+		case '\n': escaped += "\\n"; break;
+		default:
+			if ((unsigned char)c < 0x20) continue;
+			escaped += c;
+		}
+	}
+	return escaped;
+}
+
+/**
+ * Write results as JSON: the context (device, settings) and, for each
+ * benchmark, statistics of the duration of a single item in nanoseconds.
+ */
+Result<Void, Error> writeJson(
+	const std::filesystem::path& path,
+	const std::map<std::string, std::string>& context,
+	const std::vector<Measurement>& measurements
+) {
+	std::ofstream out(path);
+	TRY_ASSERT(out.is_open(), "Could not open output file " << path);
+
+	out << "{\n\t\"context\": {";
+	const char* separator = "\n";
+	for (const auto& [key, value] : context) {
+		out << separator << "\t\t\"" << escapeJson(key) << "\": \"" << escapeJson(value) << "\"";
+		separator = ",\n";
+	}
+	out << "\n\t},\n\t\"benchmarks\": [";
+
+	separator = "\n";
+	for (const Measurement& measurement : measurements) {
+		std::vector<double> samples = measurement.samplesNs;
+		for (double& sample : samples) {
+			sample /= measurement.itemsPerSample;
+		}
+		std::sort(samples.begin(), samples.end());
+		double mean = 0.0;
+		for (double sample : samples) mean += sample;
+		mean /= samples.size();
+		auto percentile = [&](double p) {
+			return samples[std::min(samples.size() - 1, (size_t)(p * (samples.size() - 1) + 0.5))];
+		};
+
+		out << separator << "\t\t{\n";
+		out << "\t\t\t\"name\": \"" << escapeJson(measurement.name) << "\",\n";
+		out << "\t\t\t\"parameters\": {";
+		const char* parameterSeparator = "";
+		for (const auto& [key, value] : measurement.parameters) {
+			out << parameterSeparator << " \"" << escapeJson(key) << "\": " << value;
+			parameterSeparator = ",";
+		}
+		out << (measurement.parameters.empty() ? "},\n" : " },\n");
+		out << "\t\t\t\"samples\": " << samples.size() << ",\n";
+		out << "\t\t\t\"items_per_sample\": " << measurement.itemsPerSample << ",\n";
+		out << "\t\t\t\"time_unit\": \"ns\",\n";
+		out << "\t\t\t\"min\": " << samples.front() << ",\n";
+		out << "\t\t\t\"median\": " << percentile(0.5) << ",\n";
+		out << "\t\t\t\"mean\": " << mean << ",\n";
+		out << "\t\t\t\"p90\": " << percentile(0.9) << ",\n";
+		out << "\t\t\t\"max\": " << samples.back() << "\n";
+		out << "\t\t}";
+		separator = ",\n";
+	}
+	out << "\n\t]\n}\n";
+	return {};
+}
+
+////////////////////////////////////////////
+// Main
+
+Result<Void, Error> run(
+	const std::string& backendName,
+	bool fallbackAdapter,
+	const BenchmarkOptions& options,
+	const std::filesystem::path& outputPath
+) {
+	std::optional<BackendType> backend = parseBackend(backendName);
+	TRY_ASSERT(backend, "Unknown backend '" << backendName << "'");
+
+	std::map<std::string, std::string> context;
+	context["requested_backend"] = backendName;
+	context["fallback_adapter"] = fallbackAdapter ? "true" : "false";
+	context["iterations"] = std::to_string(options.iterations);
+#ifdef NDEBUG
+	context["build_type"] = "release";
+#else // NDEBUG
+	context["build_type"] = "debug";
+#endif // NDEBUG
+
+	raii::Device device;
+	TRY_ASSIGN(device, createBenchmarkDevice(*backend, fallbackAdapter, context));
+
+	BenchmarkRunner runner(options);
+	TRY(benchmarkKernelConstruction(runner, *device));
+	TRY(benchmarkCreateBindGroup(runner, *device));
+	TRY(benchmarkEncodeDispatches(runner, *device));
+	TRY(benchmarkSubmit(runner, *device));
+	TRY(benchmarkReadbackRoundTrip(runner, *device));
+
+	TRY(writeJson(outputPath, context, runner.measurements()));
+	LOG(INFO) << "Wrote " << runner.measurements().size() << " result(s) to " << outputPath.string();
+	return {};
+}
+
+int main(int argc, char* argv[]) {
+	CLI::App app{ "Measure the CPU-side cost of constructing, binding, dispatching and reading back generated kernels" };
+	argv = app.ensure_utf8(argv);
+
+	std::string backend = "default";
+	bool fallbackAdapter = false;
+	BenchmarkOptions options;
+	std::filesystem::path outputPath = "benchmark-dispatch.json";
+	app.add_option("--backend", backend, "WebGPU backend: default, null, vulkan, metal, d3d12, d3d11, opengl or opengles. Use 'null' on machines without a GPU.");
+	app.add_flag("--fallback-adapter", fallbackAdapter, "Use a software adapter (e.g., SwiftShader)");
+	app.add_option("--iterations", options.iterations, "Number of samples per benchmark")
+		->check(CLI::PositiveNumber);
+	app.add_option("--filter", options.filter, "Only run benchmarks whose name contains this string");
+	app.add_option("-o,--output", outputPath, "Path of the JSON output");
+	CLI11_PARSE(app, argc, argv);
+
+	auto maybeError = run(backend, fallbackAdapter, options, outputPath);
+	if (isError(maybeError)) {
+		LOG(ERROR) << std::get<Error>(maybeError).message;
+		return 1;
+	}
+	return 0;
+}
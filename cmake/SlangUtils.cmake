@@ -121,23 +121,64 @@ endfunction(add_slang_shader)
 # NB: Contrary to 'add_slang_shader', this function is more tied to this
 # repository's mechanism: it needs our code generator target to be defined.
 #
+# Optional compiler options, forwarded to Slang:
+#   OPTIMIZATION         none | default | high | maximal
+#   FLOATING_POINT_MODE  default | fast | precise
+#   DEBUG_INFO           none | minimal | standard | maximal
+#   MATRIX_LAYOUT        row | column
+#
+# FUSE lists entry points (e.g., 'FUSE add multiplyAndAdd') that are fused into
+# an extra entry point 'addThenMultiplyAndAdd', which runs them in order within
+# each thread. This requires them to only access the buffers they write at the
+# index of the current thread, which the generator checks.
+#
+# DIFFERENTIABLE lists [Differentiable] functions of the form
+# 'float f(float a, ...)' for which entry points 'fForward' and 'fBackward' are
+# generated, together with the buffers they read and write ('f_a', 'f_result',
+# 'f_resultGrad', 'f_aGrad', ...). Parameters listed in
+# AUTODIFF_SHARED_PARAMETERS (either 'a' or 'f.a') are the same for all
+# elements, so their gradient is a sum over all elements. GRADIENT_ACCUMULATION
+# selects how this sum is computed: 'atomic', or 'workgroup' (default), which
+# writes per-workgroup partial sums reduced by an extra 'fReduceGradients' entry
+# point. AUTODIFF_WORKGROUP_SIZE (default 64) must be a power of two. When
+# DIFFERENTIABLE is used, ENTRY may be omitted.
+#
+# With DYNAMIC_UNIFORMS, the uniform buffer is bound with a dynamic offset and
+# dispatch methods get an extra 'uniformOffset' argument, so that the uniforms
+# of many dispatches may be packed into a single UniformRingBuffer.
+#
+# A report of the resources used by each entry point (workgroup storage,
+# bindings, invocations and estimated occupancy) is written next to the
+# generated code as generated/${NAME}Kernel.report.json. It is checked against
+# LIMITS (either 'webgpu-default' or the path to a limits file, defaults to
+# SLANG_WEBGPU_LIMITS_PROFILE). Exceeded limits are reported as warnings, or as
+# errors when the FAIL_ON_LIMITS option is set (or SLANG_WEBGPU_FAIL_ON_LIMITS).
+#
 # Example:
 #   add_slang_webgpu_kernel(
 #     generate_hello_world_kernel
 #     NAME HelloWorld
 #     SOURCE shaders/hello-world.slang
 #     ENTRY computeMain
+#     OPTIMIZATION high
+#     FLOATING_POINT_MODE fast
 #   )
 function(add_slang_webgpu_kernel TargetName)
-	set(options)
-	set(oneValueArgs NAME SOURCE)
-	set(multiValueArgs ENTRY SLANG_INCLUDE_DIRECTORIES)
+	set(options FAIL_ON_LIMITS DYNAMIC_UNIFORMS)
+	set(oneValueArgs NAME SOURCE OPTIMIZATION FLOATING_POINT_MODE DEBUG_INFO MATRIX_LAYOUT LIMITS GRADIENT_ACCUMULATION AUTODIFF_WORKGROUP_SIZE)
+	set(multiValueArgs ENTRY SLANG_INCLUDE_DIRECTORIES FUSE DIFFERENTIABLE AUTODIFF_SHARED_PARAMETERS)
 	cmake_parse_arguments(arg "${options}" "${oneValueArgs}" "${multiValueArgs}" ${ARGN})
 
 	if (NOT TARGET slang_webgpu_generator)
 		message(FATAL_ERROR "Could not find SlangWebGPU generator.")
 	endif()
 
+	# Generated kernels use the runtime library (e.g., its DeviceRegistry),
+	# which src/CMakeLists.txt only creates when a 'webgpu' target exists.
+	if (NOT TARGET slang_webgpu_runtime)
+		message(FATAL_ERROR "add_slang_webgpu_kernel(${TargetName}) requires the slang_webgpu_runtime library, which is only built when a WebGPU implementation is available: turn SLANG_WEBGPU_BUILD_EXAMPLES on (which fetches Dawn), or define your own 'webgpu' target before adding SlangWebGPU.")
+	endif()
+
 	# The input slang file
 	set(SLANG_SHADER "${CMAKE_CURRENT_SOURCE_DIR}/${arg_SOURCE}")
 	cmake_path(GET SLANG_SHADER PARENT_PATH SLANG_SHADER_DIR)
@@ -149,8 +190,14 @@ function(add_slang_webgpu_kernel TargetName)
 	# The generated C++ source
 	set(KERNEL_HEADER "${CMAKE_CURRENT_BINARY_DIR}/generated/${arg_NAME}Kernel.h")
 	set(KERNEL_IMPLEM "${CMAKE_CURRENT_BINARY_DIR}/generated/${arg_NAME}Kernel.cpp")
+	set(KERNEL_REPORT "${CMAKE_CURRENT_BINARY_DIR}/generated/${arg_NAME}Kernel.report.json")
 
-	set(ENTRYPOINTS ${arg_ENTRY})
+	set(ENTRYPOINT_OPTS)
+	if (arg_ENTRY)
+		list(APPEND ENTRYPOINT_OPTS --entrypoints ${arg_ENTRY})
+	elseif (NOT arg_DIFFERENTIABLE)
+		message(FATAL_ERROR "add_slang_webgpu_kernel(${TargetName}) requires ENTRY or DIFFERENTIABLE.")
+	endif()
 
 	set(INCLUDE_DIRECTORIES)
 	foreach (dir ${arg_SLANG_INCLUDE_DIRECTORIES})
@@ -159,6 +206,82 @@ function(add_slang_webgpu_kernel TargetName)
 	endforeach()
 	list(APPEND INCLUDE_DIRECTORIES ${SLANG_SHADER_DIR})
 
+	# Compiler options
+	set(COMPILER_OPTION_OPTS)
+	if (arg_OPTIMIZATION)
+		list(APPEND COMPILER_OPTION_OPTS --optimization ${arg_OPTIMIZATION})
+	endif()
+	if (arg_FLOATING_POINT_MODE)
+		list(APPEND COMPILER_OPTION_OPTS --floating-point-mode ${arg_FLOATING_POINT_MODE})
+	endif()
+	if (arg_DEBUG_INFO)
+		list(APPEND COMPILER_OPTION_OPTS --debug-info ${arg_DEBUG_INFO})
+	endif()
+	if (arg_MATRIX_LAYOUT)
+		list(APPEND COMPILER_OPTION_OPTS --matrix-layout ${arg_MATRIX_LAYOUT})
+	endif()
+
+	# Kernel fusion
+	if (arg_FUSE)
+		string(REPLACE ";" "," FUSED_ENTRYPOINTS "${arg_FUSE}")
+		list(APPEND COMPILER_OPTION_OPTS --fuse ${FUSED_ENTRYPOINTS})
+	endif()
+
+	# Autodiff
+	if (arg_DIFFERENTIABLE)
+		list(APPEND COMPILER_OPTION_OPTS --differentiable ${arg_DIFFERENTIABLE})
+		if (arg_AUTODIFF_SHARED_PARAMETERS)
+			list(APPEND COMPILER_OPTION_OPTS --autodiff-shared-parameters ${arg_AUTODIFF_SHARED_PARAMETERS})
+		endif()
+		if (arg_GRADIENT_ACCUMULATION)
+			list(APPEND COMPILER_OPTION_OPTS --gradient-accumulation ${arg_GRADIENT_ACCUMULATION})
+		endif()
+		if (arg_AUTODIFF_WORKGROUP_SIZE)
+			list(APPEND COMPILER_OPTION_OPTS --autodiff-workgroup-size ${arg_AUTODIFF_WORKGROUP_SIZE})
+		endif()
+	endif()
+
+	if (arg_DYNAMIC_UNIFORMS)
+		list(APPEND COMPILER_OPTION_OPTS --dynamic-uniforms)
+	endif()
+
+	# Resource report and device limits
+	set(LIMITS "${SLANG_WEBGPU_LIMITS_PROFILE}")
+	if (arg_LIMITS)
+		set(LIMITS "${arg_LIMITS}")
+	endif()
+	if (NOT LIMITS)
+		set(LIMITS "webgpu-default")
+	endif()
+	set(LIMITS_DEPENDS)
+	if (NOT LIMITS STREQUAL "webgpu-default")
+		cmake_path(ABSOLUTE_PATH LIMITS BASE_DIRECTORY "${CMAKE_CURRENT_SOURCE_DIR}" NORMALIZE)
+		set(LIMITS_DEPENDS "${LIMITS}")
+	endif()
+	list(APPEND COMPILER_OPTION_OPTS --output-report ${KERNEL_REPORT} --limits ${LIMITS})
+	if (arg_FAIL_ON_LIMITS OR SLANG_WEBGPU_FAIL_ON_LIMITS)
+		list(APPEND COMPILER_OPTION_OPTS --fail-on-limits)
+	endif()
+
+	# Serialized core module shared by all invocations of the generator
+	set(CORE_MODULE_CACHE_OPTS)
+	if (SLANG_WEBGPU_CORE_MODULE_CACHE)
+		list(APPEND CORE_MODULE_CACHE_OPTS --core-module-cache ${SLANG_WEBGPU_CORE_MODULE_CACHE})
+	endif()
+
+	# Not all generators re-run a custom command when only its command line
+	# changes, so we write the options into a file that the generation depends
+	# on. The file is only touched when the options actually change.
+	set(OPTIONS_FILE "${CMAKE_CURRENT_BINARY_DIR}/${TargetName}.options")
+	set(OPTIONS_CONTENT "${COMPILER_OPTION_OPTS}\n")
+	set(PREVIOUS_OPTIONS_CONTENT)
+	if (EXISTS "${OPTIONS_FILE}")
+		file(READ "${OPTIONS_FILE}" PREVIOUS_OPTIONS_CONTENT)
+	endif()
+	if (NOT PREVIOUS_OPTIONS_CONTENT STREQUAL OPTIONS_CONTENT)
+		file(WRITE "${OPTIONS_FILE}" "${OPTIONS_CONTENT}")
+	endif()
+
 	set(DEPFILE "${CMAKE_CURRENT_BINARY_DIR}/${TargetName}.depfile")
 
 	set(DEPFILE_OPT)
@@ -184,21 +307,26 @@ entry point '${arg_ENTRY}'..."
 			${WGSL_SHADER}
 			${KERNEL_HEADER}
 			${KERNEL_IMPLEM}
+			${KERNEL_REPORT}
 		COMMAND
 			${GENERATOR}
 			--name ${arg_NAME}
 			--input-slang ${SLANG_SHADER}
 			--input-template ${TEMPLATE}
-			--entrypoints ${ENTRYPOINTS}
+			${ENTRYPOINT_OPTS}
 			--output-hpp ${KERNEL_HEADER}
 			--output-cpp ${KERNEL_IMPLEM}
 			--output-depfile ${DEPFILE}
 			--include-directories ${INCLUDE_DIRECTORIES}
+			${COMPILER_OPTION_OPTS}
+			${CORE_MODULE_CACHE_OPTS}
 		MAIN_DEPENDENCY
 			${SLANG_SHADER}
 		DEPENDS
 			${GENERATOR}
 			${TEMPLATE}
+			${OPTIONS_FILE}
+			${LIMITS_DEPENDS}
 		${CODEGEN_OPT}
 		${DEPFILE_OPT}
 	)
@@ -214,15 +342,249 @@ entry point '${arg_ENTRY}'..."
 	set_target_properties(${TargetName}
 		PROPERTIES
 		FOLDER "SlangWebGPU/codegen"
+		SLANG_WEBGPU_KERNEL_NAME "${arg_NAME}"
 	)
 	# To be able to include "generated/FooKernel.h"
 	target_include_directories(${TargetName}
 		PUBLIC
 		${CMAKE_CURRENT_BINARY_DIR}
 	)
+	# The runtime library provides the registry of layouts that are shared
+	# across kernels.
 	target_link_libraries(${TargetName}
 		PUBLIC
 		webgpu
 		slang_webgpu_common
+		slang_webgpu_runtime
 	)
 endfunction(add_slang_webgpu_kernel)
+
+
+#############################################
+# Create a target that packs several kernels into a single kernel archive
+# file, which is loaded at runtime with KernelLibrary/DynamicKernel from the
+# slang_webgpu_runtime library. Contrary to 'add_slang_webgpu_kernel', no C++
+# code is generated, so updating a shader only requires building this target
+# again (and not relinking the application).
+#
+# Each kernel is described by a KERNEL block that contains its NAME, SOURCE
+# and ENTRY points. OUTPUT is relative to the current binary directory, and
+# is stored into the target's SLANG_WEBGPU_KERNEL_ARCHIVE property.
+#
+# Example:
+#   add_slang_webgpu_kernel_archive(
+#     generate_kernel_archive
+#     OUTPUT kernels.swka
+#     KERNEL
+#       NAME BufferMath
+#       SOURCE shaders/buffer-math.slang
+#       ENTRY computeMainAdd computeMainMultiply
+#     KERNEL
+#       NAME Scale
+#       SOURCE shaders/scale.slang
+#       ENTRY computeMain
+#   )
+function(add_slang_webgpu_kernel_archive TargetName)
+	if (NOT TARGET slang_webgpu_generator)
+		message(FATAL_ERROR "Could not find SlangWebGPU generator.")
+	endif()
+
+	# Split arguments into KERNEL blocks
+	set(OUTPUT)
+	set(GLOBAL_ARGS)
+	set(KERNEL_COUNT 0)
+	foreach (arg ${ARGN})
+		if (arg STREQUAL "KERNEL")
+			math(EXPR KERNEL_COUNT "${KERNEL_COUNT} + 1")
+			set(KERNEL_ARGS_${KERNEL_COUNT})
+		elseif (KERNEL_COUNT EQUAL 0)
+			list(APPEND GLOBAL_ARGS ${arg})
+		else()
+			list(APPEND KERNEL_ARGS_${KERNEL_COUNT} ${arg})
+		endif()
+	endforeach()
+	cmake_parse_arguments(arg "" "OUTPUT" "SLANG_INCLUDE_DIRECTORIES" ${GLOBAL_ARGS})
+	if (NOT arg_OUTPUT)
+		message(FATAL_ERROR "add_slang_webgpu_kernel_archive(${TargetName}) requires an OUTPUT.")
+	endif()
+	if (KERNEL_COUNT EQUAL 0)
+		message(FATAL_ERROR "add_slang_webgpu_kernel_archive(${TargetName}) requires at least one KERNEL.")
+	endif()
+
+	set(GENERATOR $<TARGET_FILE:slang_webgpu_generator>)
+	set(ARCHIVE "${CMAKE_CURRENT_BINARY_DIR}/${arg_OUTPUT}")
+	set(BATCH_FILE "${CMAKE_CURRENT_BINARY_DIR}/${TargetName}.batch")
+	set(DEPFILE "${CMAKE_CURRENT_BINARY_DIR}/${TargetName}.depfile")
+
+	set(INCLUDE_DIRECTORIES)
+	foreach (dir ${arg_SLANG_INCLUDE_DIRECTORIES})
+		cmake_path(ABSOLUTE_PATH dir BASE_DIRECTORY "${CMAKE_CURRENT_SOURCE_DIR}" NORMALIZE OUTPUT_VARIABLE abs_dir)
+		list(APPEND INCLUDE_DIRECTORIES "\"${abs_dir}\"")
+	endforeach()
+
+	# Kernels are generated by a single invocation of the generator, in batch
+	# mode, where all jobs write into the same archive and depfile.
+	set(SLANG_SHADERS)
+	set(BATCH_CONTENT)
+	foreach (i RANGE 1 ${KERNEL_COUNT})
+		cmake_parse_arguments(kernel "" "NAME;SOURCE" "ENTRY" ${KERNEL_ARGS_${i}})
+		if (NOT kernel_NAME OR NOT kernel_SOURCE OR NOT kernel_ENTRY)
+			message(FATAL_ERROR "Each KERNEL of add_slang_webgpu_kernel_archive(${TargetName}) requires a NAME, a SOURCE and an ENTRY.")
+		endif()
+		set(SLANG_SHADER "${CMAKE_CURRENT_SOURCE_DIR}/${kernel_SOURCE}")
+		cmake_path(GET SLANG_SHADER PARENT_PATH SLANG_SHADER_DIR)
+		list(APPEND SLANG_SHADERS ${SLANG_SHADER})
+		list(JOIN kernel_ENTRY " " ENTRYPOINTS)
+		list(JOIN INCLUDE_DIRECTORIES " " INCLUDE_DIRECTORY_LIST)
+		string(APPEND BATCH_CONTENT
+			"--name ${kernel_NAME} "
+			"--input-slang \"${SLANG_SHADER}\" "
+			"--entrypoints ${ENTRYPOINTS} "
+			"--include-directories ${INCLUDE_DIRECTORY_LIST} \"${SLANG_SHADER_DIR}\" "
+			"--output-archive \"${ARCHIVE}\" "
+			"--output-depfile \"${DEPFILE}\"\n"
+		)
+	endforeach()
+
+	# Only touch the batch file when it changes
+	set(PREVIOUS_BATCH_CONTENT)
+	if (EXISTS "${BATCH_FILE}")
+		file(READ "${BATCH_FILE}" PREVIOUS_BATCH_CONTENT)
+	endif()
+	if (NOT PREVIOUS_BATCH_CONTENT STREQUAL BATCH_CONTENT)
+		file(WRITE "${BATCH_FILE}" "${BATCH_CONTENT}")
+	endif()
+
+	set(CORE_MODULE_CACHE_OPTS)
+	if (SLANG_WEBGPU_CORE_MODULE_CACHE)
+		list(APPEND CORE_MODULE_CACHE_OPTS --core-module-cache ${SLANG_WEBGPU_CORE_MODULE_CACHE})
+	endif()
+
+	set(DEPFILE_OPT)
+	if (CMAKE_VERSION VERSION_GREATER_EQUAL "3.21.0")
+		list(APPEND DEPFILE_OPT "DEPFILE" "${DEPFILE}")
+	else()
+		message(AUTHOR_WARNING "Using a version of CMake older than 3.21 does not allow keeping track of Slang files imported in each others when building the compilation dependency graph. You may need to manually trigger shader transpilation.")
+	endif()
+
+	add_custom_command(
+		COMMENT
+			"Packing ${KERNEL_COUNT} Slang-WebGPU kernel(s) into archive '${ARCHIVE}'..."
+		OUTPUT
+			${ARCHIVE}
+		COMMAND
+			${GENERATOR}
+			--batch ${BATCH_FILE}
+			${CORE_MODULE_CACHE_OPTS}
+		DEPENDS
+			${GENERATOR}
+			${BATCH_FILE}
+			${SLANG_SHADERS}
+		${DEPFILE_OPT}
+	)
+
+	add_custom_target(${TargetName}
+		DEPENDS
+			${ARCHIVE}
+	)
+	set_target_properties(${TargetName}
+		PROPERTIES
+		FOLDER "SlangWebGPU/codegen"
+		SLANG_WEBGPU_KERNEL_ARCHIVE "${ARCHIVE}"
+	)
+endfunction(add_slang_webgpu_kernel_archive)
+
+
+#############################################
+# Create an executable that instantiates all the given kernel targets (created
+# with 'add_slang_webgpu_kernel') on a native device whose compiled shaders and
+# pipelines are stored in a BlobCache, so that applications that attach a
+# BlobCache to the same directory start faster. Run it as:
+#   ${TargetName} <cache-directory> [--max-size <bytes>]
+#
+# NB: This requires Dawn, as the browser manages its own cache with Emscripten.
+# Kernels must have distinct names, as they are all included in the same
+# source file.
+#
+# Example:
+#   add_slang_webgpu_cache_warmer(
+#     warm_kernel_cache
+#     KERNELS
+#       generate_hello_world_kernel
+#       generate_buffer_math_kernel
+#   )
+function(add_slang_webgpu_cache_warmer TargetName)
+	cmake_parse_arguments(arg "" "" "KERNELS" ${ARGN})
+
+	if (EMSCRIPTEN)
+		message(FATAL_ERROR "add_slang_webgpu_cache_warmer(${TargetName}) is not available with Emscripten.")
+	endif()
+	if (NOT arg_KERNELS)
+		message(FATAL_ERROR "add_slang_webgpu_cache_warmer(${TargetName}) requires at least one kernel in KERNELS.")
+	endif()
+
+	# Generate the function that instantiates all kernels, called by the main
+	set(INCLUDES)
+	set(INSTANCES)
+	set(INSTANCE_NAMES)
+	set(KERNEL_NAMES)
+	set(KERNEL_COUNT 0)
+	foreach (kernel ${arg_KERNELS})
+		get_target_property(KERNEL_NAME ${kernel} SLANG_WEBGPU_KERNEL_NAME)
+		if (NOT KERNEL_NAME)
+			message(FATAL_ERROR "Target '${kernel}' given to add_slang_webgpu_cache_warmer(${TargetName}) was not created by add_slang_webgpu_kernel.")
+		endif()
+		if (KERNEL_NAME IN_LIST KERNEL_NAMES)
+			message(FATAL_ERROR "Several kernels given to add_slang_webgpu_cache_warmer(${TargetName}) are named '${KERNEL_NAME}'.")
+		endif()
+		list(APPEND KERNEL_NAMES ${KERNEL_NAME})
+		string(APPEND INCLUDES "#include \"generated/${KERNEL_NAME}Kernel.h\"\n")
+		string(APPEND INSTANCES "\tgenerated::${KERNEL_NAME}Kernel kernel${KERNEL_COUNT}(device, PipelineCreation::Async);\n")
+		list(APPEND INSTANCE_NAMES "kernel${KERNEL_COUNT}")
+		math(EXPR KERNEL_COUNT "${KERNEL_COUNT} + 1")
+	endforeach()
+	list(JOIN INSTANCE_NAMES ", " INSTANCE_LIST)
+
+	set(WARMER_SOURCE "${CMAKE_CURRENT_BINARY_DIR}/generated/${TargetName}.cpp")
+	set(WARMER_CONTENT
+"// Generated by add_slang_webgpu_cache_warmer(${TargetName})
+${INCLUDES}
+#include <slang-webgpu/runtime/compute-pipeline-set.h>
+
+Result<Void, Error> warmKernels(wgpu::Device device, size_t& kernelCount) {
+	// Pipelines of all kernels are created concurrently
+${INSTANCES}	kernelCount = ${KERNEL_COUNT};
+	return waitUntilAllReady(${INSTANCE_LIST});
+}
+")
+
+	# Only touch the source file when it changes
+	set(PREVIOUS_WARMER_CONTENT)
+	if (EXISTS "${WARMER_SOURCE}")
+		file(READ "${WARMER_SOURCE}" PREVIOUS_WARMER_CONTENT)
+	endif()
+	if (NOT PREVIOUS_WARMER_CONTENT STREQUAL WARMER_CONTENT)
+		file(WRITE "${WARMER_SOURCE}" "${WARMER_CONTENT}")
+	endif()
+
+	add_executable(${TargetName})
+	set_common_target_properties(${TargetName})
+	target_sources(${TargetName}
+		PRIVATE
+		"${PROJECT_SOURCE_DIR}/src/cache-warmer/main.cpp"
+		${WARMER_SOURCE}
+	)
+	target_link_libraries(${TargetName}
+		PRIVATE
+		webgpu
+		slang_webgpu_common
+		slang_webgpu_runtime
+		CLI11
+		${arg_KERNELS}
+	)
+	set_target_properties(${TargetName}
+		PROPERTIES
+		FOLDER "SlangWebGPU/tools"
+	)
+	target_copy_webgpu_binaries(${TargetName})
+endfunction(add_slang_webgpu_cache_warmer)
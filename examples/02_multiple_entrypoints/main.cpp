@@ -4,10 +4,16 @@
 
 // Header generated from shaders/buffer-math.slang (see config in CMakeLists.txt)
 #include "generated/BufferMathKernel.h"
+// Header generated from shaders/buffer-max.slang
+#include "generated/BufferMaxKernel.h"
 
 #include <slang-webgpu/common/result.h>
 #include <slang-webgpu/common/logger.h>
 #include <slang-webgpu/common/io.h>
+#include <slang-webgpu/common/kernel-utils.h> // provides alignUp()
+
+#include <slang-webgpu/runtime/buffer-allocator.h>
+#include <slang-webgpu/runtime/compute-graph.h>
 
 #include <slang-webgpu/examples/webgpu-utils.h> // provides createDevice()
 
@@ -17,6 +23,8 @@
 
 #include <filesystem>
 #include <cstring> // for memcpy
+#include <type_traits>
+#include <algorithm>
 
 using namespace wgpu;
 
@@ -159,5 +167,346 @@ Result<Void, Error> run() {
 		}
 	}
 
+	// 9. Dispatch another kernel with the same bind group
+	// Kernels that have the same bindings share their bind group layout, which
+	// the generator checks by giving them the same SharedBindGroupLayout type.
+	static_assert(std::is_same_v<
+		generated::BufferMathKernel::SharedBindGroupLayout,
+		generated::BufferMaxKernel::SharedBindGroupLayout
+	>);
+	generated::BufferMaxKernel maxKernel(*device);
+	TRY_ASSERT(maxKernel, "Kernel could not load!");
+	{
+		raii::CommandEncoder encoder = device->createCommandEncoder();
+		maxKernel.dispatch(*encoder, ThreadCount{ 10 }, *bindGroup);
+		encoder->copyBufferToBuffer(*result, 0, *mapBuffer, 0, result->getSize());
+		raii::CommandBuffer commands = encoder->finish();
+		queue->submit(*commands);
+	}
+
+	// 10. Read back result
+	// Nothing specific to Slang here
+	{
+		bool done = false;
+		std::vector<float> resultData(10);
+		auto h = mapBuffer->mapAsync(MapMode::Read, 0, mapBuffer->getSize(), [&](BufferMapAsyncStatus status) {
+			done = true;
+			if (status == BufferMapAsyncStatus::Success) {
+				memcpy(resultData.data(), mapBuffer->getConstMappedRange(0, mapBuffer->getSize()), mapBuffer->getSize());
+			}
+			mapBuffer->unmap();
+		});
+
+		while (!done) {
+			pollDeviceEvents(*device);
+		}
+
+		LOG(INFO) << "Result data (max, from another kernel):";
+		for (int i = 0; i < 10; ++i) {
+			LOG(INFO) << "max(" << data0[i] << ", " << data1[i] << ") = " << resultData[i];
+			TRY_ASSERT(isClose(std::max(data0[i], data1[i]), resultData[i]), "Shader did not run correctly!");
+		}
+	}
+
+	// 11. Reuse bind groups through a cache
+	// When the same buffers are bound over and over, e.g. in a loop, bind
+	// groups can be looked up in a cache rather than created each time. The
+	// cache can be shared by kernels, and those that have the same layout even
+	// share cached bind groups.
+	BindGroupCache bindGroupCache(8);
+	{
+		raii::CommandEncoder encoder = device->createCommandEncoder();
+		for (int i = 0; i < 4; ++i) {
+			raii::BindGroup sumBindGroup = kernel.getOrCreateBindGroup(bindGroupCache, *buffer0, *buffer1, *result);
+			kernel.dispatchComputeMainAdd(*encoder, ThreadCount{ 10 }, *sumBindGroup);
+			raii::BindGroup maxBindGroup = maxKernel.getOrCreateBindGroup(bindGroupCache, *buffer1, *buffer0, *result);
+			maxKernel.dispatch(*encoder, ThreadCount{ 10 }, *maxBindGroup);
+		}
+		raii::CommandBuffer commands = encoder->finish();
+		queue->submit(*commands);
+	}
+	BindGroupCache::Stats stats = bindGroupCache.stats();
+	LOG(INFO) << "Bind group cache: " << stats.hits << " hit(s), " << stats.misses << " miss(es)";
+	TRY_ASSERT(stats.misses == 2 && stats.hits == 6, "Bind group cache did not behave as expected!");
+
+	// 12. Bind ranges of a single buffer
+	// Rather than allocating one buffer per array, arrays can be carved out of
+	// a large allocation and bound as BufferView (buffer, offset, size). Offsets
+	// must be multiples of the device's minStorageBufferOffsetAlignment.
+	// NB: WebGPU does not allow a buffer to be both read-only and writable
+	// within the same dispatch, so the output remains a separate buffer here.
+	uint64_t alignment = DeviceRegistry::get(*device)->getLimits().minStorageBufferOffsetAlignment;
+	uint64_t stride = alignUp(10 * sizeof(float), alignment);
+	bufferDesc.size = 2 * stride;
+	bufferDesc.label = StringView("pool");
+	bufferDesc.usage = BufferUsage::Storage | BufferUsage::CopyDst;
+	raii::Buffer pool = device->createBuffer(bufferDesc);
+	queue->writeBuffer(*pool, 0 * stride, data0.data(), 10 * sizeof(float));
+	queue->writeBuffer(*pool, 1 * stride, data1.data(), 10 * sizeof(float));
+
+	raii::BindGroup poolBindGroup;
+	TRY_ASSIGN(*poolBindGroup, kernel.createBindGroup(
+		BufferView(*pool, 0 * stride, 10 * sizeof(float)),
+		BufferView(*pool, 1 * stride, 10 * sizeof(float)),
+		*result
+	));
+
+	// Misaligned views are rejected before reaching the device
+	auto misaligned = kernel.createBindGroup(
+		BufferView(*pool, 0, 10 * sizeof(float)),
+		BufferView(*pool, 4, 10 * sizeof(float)),
+		*result
+	);
+	TRY_ASSERT(isError(misaligned), "A misaligned buffer view should have been rejected!");
+	LOG(INFO) << "Misaligned view rejected: " << std::get<Error>(misaligned).message;
+
+	{
+		raii::CommandEncoder encoder = device->createCommandEncoder();
+		kernel.dispatchComputeMainAdd(*encoder, ThreadCount{ 10 }, *poolBindGroup);
+		encoder->copyBufferToBuffer(*result, 0, *mapBuffer, 0, result->getSize());
+		raii::CommandBuffer commands = encoder->finish();
+		queue->submit(*commands);
+	}
+
+	// 13. Read back result
+	// Nothing specific to Slang here
+	{
+		bool done = false;
+		std::vector<float> resultData(10);
+		auto h = mapBuffer->mapAsync(MapMode::Read, 0, mapBuffer->getSize(), [&](BufferMapAsyncStatus status) {
+			done = true;
+			if (status == BufferMapAsyncStatus::Success) {
+				memcpy(resultData.data(), mapBuffer->getConstMappedRange(0, mapBuffer->getSize()), mapBuffer->getSize());
+			}
+			mapBuffer->unmap();
+		});
+
+		while (!done) {
+			pollDeviceEvents(*device);
+		}
+
+		LOG(INFO) << "Result data (from buffer views):";
+		for (int i = 0; i < 10; ++i) {
+			LOG(INFO) << data0[i] << " + " << data1[i] << " = " << resultData[i];
+			TRY_ASSERT(isClose(data0[i] + data1[i], resultData[i]), "Shader did not run correctly on buffer views!");
+		}
+	}
+
+	// 14. Record many dispatches into a single pass
+	// A recorder batches dispatches of any kernels that share a device into a
+	// single compute pass and submits it once. It remembers the pipeline and
+	// bind group of the pass, so that consecutive dispatches that use the same
+	// ones do not set them again.
+	{
+		generated::BufferMathKernel::Recorder recorder = kernel.createRecorder();
+		for (int i = 0; i < 2; ++i) {
+			kernel.dispatchComputeMainAdd(recorder, ThreadCount{ 10 }, *bindGroup);
+			kernel.dispatchComputeMainAdd(recorder, ThreadCount{ 10 }, *bindGroup);
+			maxKernel.dispatch(recorder, ThreadCount{ 10 }, *bindGroup);
+		}
+		recorder.submit();
+
+		const DispatchRecorder::Stats& recorderStats = recorder.stats();
+		LOG(INFO) << "Recorder: " << recorderStats.dispatches << " dispatch(es), " << recorderStats.savedStateChanges() << " redundant state change(s) skipped";
+		TRY_ASSERT(recorderStats.dispatches == 6, "Recorder did not behave as expected!");
+		TRY_ASSERT(recorderStats.pipelineChanges == 4 && recorderStats.skippedPipelineChanges == 2, "Recorder did not behave as expected!");
+		TRY_ASSERT(recorderStats.bindGroupChanges == 1 && recorderStats.skippedBindGroupChanges == 5, "Recorder did not behave as expected!");
+	}
+
+	// 15. Chain kernels in a compute graph
+	// Intermediate results only need to live between the node that writes
+	// them and the last node that reads them. The graph derives the order of
+	// the nodes from the access type of their bindings, and intermediate
+	// buffers whose lifetimes do not overlap share the same allocation.
+	{
+		using EntryPoint = generated::BufferMathKernel::EntryPoint;
+		ComputeGraph graph(*device, "example");
+		ComputeGraph::BufferHandle a = graph.importBuffer(*buffer0);
+		ComputeGraph::BufferHandle b = graph.importBuffer(*buffer1);
+		ComputeGraph::BufferHandle output = graph.importBuffer(*result);
+		ComputeGraph::BufferHandle sum = graph.createTransientBuffer(10 * sizeof(float), "sum");
+		ComputeGraph::BufferHandle product = graph.createTransientBuffer(10 * sizeof(float), "product");
+		ComputeGraph::BufferHandle difference = graph.createTransientBuffer(10 * sizeof(float), "difference");
+		ComputeGraph::BufferHandle scaled = graph.createTransientBuffer(10 * sizeof(float), "scaled");
+
+		// output = max(((a + b) - a * b) * b, a)
+		TRY(graph.addNode("sum", kernel, EntryPoint::ComputeMainAdd, ThreadCount{ 10 }, { a, b, sum }));
+		TRY(graph.addNode("product", kernel, EntryPoint::ComputeMainMultiply, ThreadCount{ 10 }, { a, b, product }));
+		TRY(graph.addNode("difference", kernel, EntryPoint::ComputeMainSub, ThreadCount{ 10 }, { sum, product, difference }));
+		TRY(graph.addNode("scaled", kernel, EntryPoint::ComputeMainMultiply, ThreadCount{ 10 }, { difference, b, scaled }));
+		TRY(graph.addNode("max", maxKernel, generated::BufferMaxKernel::EntryPoint::ComputeMain, ThreadCount{ 10 }, { scaled, a, output }));
+		TRY(graph.execute());
+
+		const ComputeGraph::Stats& graphStats = graph.stats();
+		LOG(INFO) << "Compute graph: " << graphStats.nodes << " node(s) in " << graphStats.waves << " wave(s), " << graphStats.transientBuffers << " transient buffer(s) (" << graphStats.transientBytes << " bytes) in " << graphStats.allocatedBuffers << " allocation(s) (" << graphStats.allocatedBytes << " bytes)";
+		// 'sum' and 'product' are independent so they run in the same wave,
+		// and 'scaled' reuses the allocation of 'sum'.
+		TRY_ASSERT(graphStats.waves == 4, "Compute graph did not behave as expected!");
+		TRY_ASSERT(graphStats.transientBuffers == 4 && graphStats.allocatedBuffers == 3, "Compute graph did not behave as expected!");
+		TRY_ASSERT((WGPUBuffer)graph.getBuffer(scaled) == (WGPUBuffer)graph.getBuffer(sum), "Compute graph did not behave as expected!");
+
+		raii::CommandEncoder encoder = device->createCommandEncoder();
+		encoder->copyBufferToBuffer(*result, 0, *mapBuffer, 0, result->getSize());
+		raii::CommandBuffer commands = encoder->finish();
+		queue->submit(*commands);
+	}
+
+	// 16. Read back result
+	// Nothing specific to Slang here
+	{
+		bool done = false;
+		std::vector<float> resultData(10);
+		auto h = mapBuffer->mapAsync(MapMode::Read, 0, mapBuffer->getSize(), [&](BufferMapAsyncStatus status) {
+			done = true;
+			if (status == BufferMapAsyncStatus::Success) {
+				memcpy(resultData.data(), mapBuffer->getConstMappedRange(0, mapBuffer->getSize()), mapBuffer->getSize());
+			}
+			mapBuffer->unmap();
+		});
+
+		while (!done) {
+			pollDeviceEvents(*device);
+		}
+
+		LOG(INFO) << "Result data (from compute graph):";
+		for (int i = 0; i < 10; ++i) {
+			float expected = std::max((data0[i] + data1[i] - data0[i] * data1[i]) * data1[i], data0[i]);
+			LOG(INFO) << "max((" << data0[i] << " + " << data1[i] << " - " << data0[i] << " * " << data1[i] << ") * " << data1[i] << ", " << data0[i] << ") = " << resultData[i];
+			TRY_ASSERT(isClose(expected, resultData[i], 1e-5f * std::max(1.0f, std::abs(expected))), "Shader did not run correctly in compute graph!");
+		}
+	}
+
+	// 17. Only create the pipelines that are used
+	// With PipelineCreation::Lazy, the constructor only creates the shader
+	// module, and the pipeline of each entry point is created by its first
+	// dispatch. Entry points known to be needed may be prewarmed, by name or
+	// by index (here right away, by default in the background).
+	{
+		generated::BufferMathKernel lazyKernel(*device, PipelineCreation::Lazy);
+		TRY_ASSERT(lazyKernel, "Kernel could not load!");
+		TRY(lazyKernel.prewarm({ "computeMainAdd" }, PipelineCreation::Immediate));
+		TRY_ASSERT(isError(lazyKernel.prewarm({ "computeMainDivide" })), "An unknown entry point should have been rejected!");
+
+		raii::CommandEncoder encoder = device->createCommandEncoder();
+		lazyKernel.dispatchComputeMainAdd(*encoder, ThreadCount{ 10 }, *bindGroup);
+		// This creates the pipeline of computeMainSub
+		lazyKernel.dispatchComputeMainSub(*encoder, ThreadCount{ 10 }, *bindGroup);
+		encoder->copyBufferToBuffer(*result, 0, *mapBuffer, 0, result->getSize());
+		raii::CommandBuffer commands = encoder->finish();
+		queue->submit(*commands);
+	}
+
+	// 18. Read back result
+	// Nothing specific to Slang here
+	{
+		bool done = false;
+		std::vector<float> resultData(10);
+		auto h = mapBuffer->mapAsync(MapMode::Read, 0, mapBuffer->getSize(), [&](BufferMapAsyncStatus status) {
+			done = true;
+			if (status == BufferMapAsyncStatus::Success) {
+				memcpy(resultData.data(), mapBuffer->getConstMappedRange(0, mapBuffer->getSize()), mapBuffer->getSize());
+			}
+			mapBuffer->unmap();
+		});
+
+		while (!done) {
+			pollDeviceEvents(*device);
+		}
+
+		LOG(INFO) << "Result data (subtraction, lazy pipelines):";
+		for (int i = 0; i < 10; ++i) {
+			LOG(INFO) << data0[i] << " - " << data1[i] << " = " << resultData[i];
+			TRY_ASSERT(isClose(data0[i] - data1[i], resultData[i]), "Shader did not run correctly with lazy pipelines!");
+		}
+	}
+
+	// 19. Instantiate the same kernel again
+	// Shader modules, layouts and pipelines are shared through the registry
+	// of the device, so this does not compile anything again.
+	{
+		std::shared_ptr<DeviceRegistry> registry = DeviceRegistry::get(*device);
+		size_t shaderModuleCount = registry->shaderModuleCount();
+		size_t pipelineSetCount = registry->pipelineSetCount();
+		generated::BufferMathKernel otherKernel(*device);
+		TRY_ASSERT(otherKernel, "Kernel could not load!");
+		TRY_ASSERT(registry->shaderModuleCount() == shaderModuleCount, "Shader module was not shared!");
+		TRY_ASSERT(registry->pipelineSetCount() == pipelineSetCount, "Pipelines were not shared!");
+		TRY_ASSERT((WGPUComputePipeline)otherKernel.getPipeline(0) == (WGPUComputePipeline)kernel.getPipeline(0), "Pipelines were not shared!");
+	}
+
+	// 20. Sub-allocate buffers
+	// Rather than creating many small buffers, a BufferAllocator hands out
+	// aligned ranges of a few large slabs, grouped by usage. Allocations
+	// convert into the BufferView expected by createBindGroup(). Transient
+	// allocations only live for the current frame, and their slabs are
+	// recycled once the GPU is done with the frame.
+	BufferAllocator allocator(*device, 64 * 1024, "example slab");
+	{
+		BufferUsage inputUsage = BufferUsage::Storage | BufferUsage::CopyDst;
+		BufferAllocator::Allocation a, b;
+		TRY_ASSIGN(a, allocator.allocate(inputUsage, 10 * sizeof(float)));
+		TRY_ASSIGN(b, allocator.allocate(inputUsage, 10 * sizeof(float)));
+		TRY_ASSERT((WGPUBuffer)a.getBuffer() == (WGPUBuffer)b.getBuffer(), "Allocations did not share a slab!");
+		queue->writeBuffer(a.getBuffer(), a.getOffset(), data0.data(), 10 * sizeof(float));
+		queue->writeBuffer(b.getBuffer(), b.getOffset(), data1.data(), 10 * sizeof(float));
+
+		// The output has another usage, so it lives in another slab
+		BufferView output;
+		TRY_ASSIGN(output, allocator.allocateTransient(BufferUsage::Storage | BufferUsage::CopySrc, 10 * sizeof(float)));
+
+		raii::BindGroup allocatedBindGroup;
+		TRY_ASSIGN(*allocatedBindGroup, kernel.createBindGroup(a, b, output));
+
+		raii::CommandEncoder encoder = device->createCommandEncoder();
+		kernel.dispatchComputeMainMultiply(*encoder, ThreadCount{ 10 }, *allocatedBindGroup);
+		encoder->copyBufferToBuffer(output.buffer, output.offset, *mapBuffer, 0, 10 * sizeof(float));
+		raii::CommandBuffer commands = encoder->finish();
+		queue->submit(*commands);
+		allocator.endFrame();
+	}
+
+	// 21. Read back result
+	// Nothing specific to Slang here
+	{
+		bool done = false;
+		std::vector<float> resultData(10);
+		auto h = mapBuffer->mapAsync(MapMode::Read, 0, mapBuffer->getSize(), [&](BufferMapAsyncStatus status) {
+			done = true;
+			if (status == BufferMapAsyncStatus::Success) {
+				memcpy(resultData.data(), mapBuffer->getConstMappedRange(0, mapBuffer->getSize()), mapBuffer->getSize());
+			}
+			mapBuffer->unmap();
+		});
+
+		while (!done) {
+			pollDeviceEvents(*device);
+		}
+
+		LOG(INFO) << "Result data (multiplication, sub-allocated buffers):";
+		for (int i = 0; i < 10; ++i) {
+			LOG(INFO) << data0[i] << " * " << data1[i] << " = " << resultData[i];
+			TRY_ASSERT(isClose(data0[i] * data1[i], resultData[i]), "Shader did not run correctly on sub-allocated buffers!");
+		}
+	}
+
+	{
+		// Ranges freed by 'a' and 'b' are handed out again, and the transient
+		// slab of the first frame is recycled, so no buffer gets created.
+		allocator.poll();
+		BufferAllocator::Allocation c;
+		TRY_ASSIGN(c, allocator.allocate(BufferUsage::Storage | BufferUsage::CopyDst, 20 * sizeof(float)));
+		TRY_ASSERT(c.getOffset() == 0, "Freed ranges were not reused!");
+		BufferView output;
+		TRY_ASSIGN(output, allocator.allocateTransient(BufferUsage::Storage | BufferUsage::CopySrc, 10 * sizeof(float)));
+		allocator.endFrame();
+
+		BufferAllocator::Stats allocatorStats = allocator.stats();
+		LOG(INFO) << "Buffer allocator: " << allocatorStats.allocations << " allocation(s) and " << allocatorStats.transientAllocations << " transient allocation(s) in " << allocatorStats.slabsCreated << " slab(s)";
+#ifndef __EMSCRIPTEN__
+		// With Emscripten, frames are only done once the browser regains control
+		TRY_ASSERT(allocatorStats.slabsCreated == 2 && allocatorStats.slabsRecycled == 1, "Buffer allocator did not behave as expected!");
+#endif // __EMSCRIPTEN__
+	}
+
 	return {};
 }
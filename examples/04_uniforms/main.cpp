@@ -4,11 +4,15 @@
 
 // Header generated from shaders/simple_autodiff.slang (see config in CMakeLists.txt)
 #include "generated/BufferScalarMathKernel.h"
+#include "generated/BufferScalarMathDynamicKernel.h"
 
 #include <slang-webgpu/common/result.h>
 #include <slang-webgpu/common/logger.h>
 #include <slang-webgpu/common/io.h>
 
+// Provides UniformRingBuffer, used with kernels that have DYNAMIC_UNIFORMS
+#include <slang-webgpu/runtime/uniform-ring-buffer.h>
+
 #include <slang-webgpu/examples/webgpu-utils.h> // provides createDevice()
 
 // NB: raii::Foo is the equivalent of Foo except its release()/addRef() methods
@@ -61,6 +65,38 @@ static bool isClose(float a, float b, float eps = 1e-6) {
 	return std::abs(b - a) < eps;
 }
 
+/**
+ * Copy a buffer into a new map buffer and read it back
+ */
+static std::vector<float> readBuffer(Device device, Buffer buffer) {
+	BufferDescriptor bufferDesc = Default;
+	bufferDesc.size = buffer.getSize();
+	bufferDesc.label = StringView("map");
+	bufferDesc.usage = BufferUsage::MapRead | BufferUsage::CopyDst;
+	raii::Buffer mapBuffer = device.createBuffer(bufferDesc);
+
+	raii::CommandEncoder encoder = device.createCommandEncoder();
+	encoder->copyBufferToBuffer(buffer, 0, *mapBuffer, 0, buffer.getSize());
+	raii::CommandBuffer commands = encoder->finish();
+	raii::Queue queue = device.getQueue();
+	queue->submit(*commands);
+
+	bool done = false;
+	std::vector<float> data(buffer.getSize() / sizeof(float));
+	auto h = mapBuffer->mapAsync(MapMode::Read, 0, mapBuffer->getSize(), [&](BufferMapAsyncStatus status) {
+		done = true;
+		if (status == BufferMapAsyncStatus::Success) {
+			memcpy(data.data(), mapBuffer->getConstMappedRange(0, mapBuffer->getSize()), mapBuffer->getSize());
+		}
+		mapBuffer->unmap();
+	});
+
+	while (!done) {
+		pollDeviceEvents(device);
+	}
+	return data;
+}
+
 Result<Void, Error> run() {
 	// 1. Create GPU device
 	// Nothing specific to Slang here
@@ -86,10 +122,6 @@ Result<Void, Error> run() {
 	bufferDesc.usage = BufferUsage::Storage | BufferUsage::CopyDst | BufferUsage::CopySrc;
 	raii::Buffer buffer = device->createBuffer(bufferDesc);
 
-	bufferDesc.label = StringView("map");
-	bufferDesc.usage = BufferUsage::MapRead | BufferUsage::CopyDst;
-	raii::Buffer mapBuffer = device->createBuffer(bufferDesc);
-
 	// 4. Fill in input buffers
 	// Nothing specific to Slang here
 	BufferScalarMathUniforms uniformData;
@@ -118,29 +150,11 @@ Result<Void, Error> run() {
 	queue->writeBuffer(*uniforms, 0, &uniformData, sizeof(BufferScalarMathUniforms));
 	kernel.dispatchMultiplyAndAdd(ThreadCount{ 16 }, *bindGroup);
 
-	// 7. Copy result to map buffer
-	raii::CommandEncoder encoder = device->createCommandEncoder();
-	encoder->copyBufferToBuffer(*buffer, 0, *mapBuffer, 0, buffer->getSize());
-	raii::CommandBuffer commands = encoder->finish();
-	queue->submit(*commands);
-
-	// 8. Read back result
+	// 7. Read back result
 	// Nothing specific to Slang here
-	bool done = false;
-	std::vector<float> resultData(16);
-	auto h = mapBuffer->mapAsync(MapMode::Read, 0, mapBuffer->getSize(), [&](BufferMapAsyncStatus status) {
-		done = true;
-		if (status == BufferMapAsyncStatus::Success) {
-			memcpy(resultData.data(), mapBuffer->getConstMappedRange(0, mapBuffer->getSize()), mapBuffer->getSize());
-		}
-		mapBuffer->unmap();
-	});
+	std::vector<float> resultData = readBuffer(*device, *buffer);
 
-	while (!done) {
-		pollDeviceEvents(*device);
-	}
-
-	// 9. Check result
+	// 8. Check result
 	// Nothing specific to Slang here
 	LOG(INFO) << "Result data:";
 	for (int i = 0; i < 16; ++i) {
@@ -148,5 +162,56 @@ Result<Void, Error> run() {
 		TRY_ASSERT(isClose((data0[i] + 3.14f) * 0.5f + 0.04f, resultData[i]), "Shader did not run correctly!");
 	}
 
+	// 9. Load the same kernel with dynamic uniforms
+	// With the DYNAMIC_UNIFORMS option (see CMakeLists.txt), dispatch methods
+	// take the offset of their uniforms within the uniform buffer, which is
+	// typically a UniformRingBuffer.
+	generated::BufferScalarMathDynamicKernel dynamicKernel(*device);
+	TRY_ASSERT(dynamicKernel, "Kernel could not load!");
+
+	UniformRingBuffer uniformRing;
+	TRY_ASSIGN(uniformRing, UniformRingBuffer::create(*device, 16 * 256));
+	raii::BindGroup dynamicBindGroup = dynamicKernel.createBindGroup(uniformRing.getBuffer(), *buffer);
+
+	// 10. Record dispatches with different uniforms into a single pass
+	// Uniforms are only copied on the CPU side for now, each push returning
+	// the offset to give to the dispatch.
+	queue->writeBuffer(*buffer, 0, data0.data(), data0.size() * sizeof(float));
+
+	raii::CommandEncoder encoder = device->createCommandEncoder();
+	ComputePassDescriptor computePassDesc = Default;
+	raii::ComputePassEncoder computePass = encoder->beginComputePass(computePassDesc);
+
+	uniformData.uniforms.offset = 3.14f;
+	uniformData.uniforms.scale = 0.5f;
+	uint32_t uniformOffset;
+	TRY_ASSIGN(uniformOffset, uniformRing.push(uniformData));
+	dynamicKernel.dispatchAdd(*computePass, ThreadCount{ 16 }, *dynamicBindGroup, uniformOffset);
+
+	uniformData.uniforms.offset = 0.04f;
+	TRY_ASSIGN(uniformOffset, uniformRing.push(uniformData));
+	dynamicKernel.dispatchMultiplyAndAdd(*computePass, ThreadCount{ 16 }, *dynamicBindGroup, uniformOffset);
+
+	uniformData.uniforms.offset = 1.0f;
+	uniformData.uniforms.scale = 2.0f;
+	TRY_ASSIGN(uniformOffset, uniformRing.push(uniformData));
+	dynamicKernel.dispatchMultiplyAndAdd(*computePass, ThreadCount{ 16 }, *dynamicBindGroup, uniformOffset);
+
+	computePass->end();
+	raii::CommandBuffer commands = encoder->finish();
+
+	// 11. Upload all uniforms at once, then submit all dispatches at once
+	// NB: Uniforms must be flushed before the submit that uses them.
+	LOG(INFO) << "Uploading " << uniformRing.getPendingSize() << " bytes of uniforms (offset alignment is " << uniformRing.getAlignment() << ")";
+	uniformRing.flush();
+	queue->submit(*commands);
+
+	// 12. Check result
+	resultData = readBuffer(*device, *buffer);
+	for (int i = 0; i < 16; ++i) {
+		float expected = ((data0[i] + 3.14f) * 0.5f + 0.04f) * 2.0f + 1.0f;
+		TRY_ASSERT(isClose(expected, resultData[i], 1e-5f), "Shader did not run correctly with dynamic uniforms!");
+	}
+
 	return {};
 }
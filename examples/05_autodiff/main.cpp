@@ -4,6 +4,8 @@
 
 // Header generated from shaders/simple_autodiff.slang (see config in CMakeLists.txt)
 #include "generated/SimpleAutodiffKernel.h"
+// Header generated from shaders/squared-error.slang with DIFFERENTIABLE
+#include "generated/SquaredErrorKernel.h"
 
 #include <slang-webgpu/common/result.h>
 #include <slang-webgpu/common/logger.h>
@@ -17,6 +19,8 @@
 
 #include <filesystem>
 #include <cstring> // for memcpy
+#include <cmath>
+#include <algorithm>
 
 using namespace wgpu;
 
@@ -25,6 +29,11 @@ using namespace wgpu;
  */
 Result<Void, Error> run();
 
+/**
+ * Second part of the example, using the generated forward/backward kernels
+ */
+Result<Void, Error> runGeneratedGradients(Device device);
+
 int main(int, char**) {
 	auto maybeError = run();
 	if (isError(maybeError)) {
@@ -105,5 +114,124 @@ Result<Void, Error> run() {
 	TRY_ASSERT(outputData[3] == 4.0, "validation error");
 	TRY_ASSERT(outputData[4] == 6.0, "validation error");
 
+	return runGeneratedGradients(*device);
+}
+
+static bool isClose(float a, float b, float eps = 1e-3) {
+	return std::abs(b - a) < eps * std::max(1.0f, std::abs(a));
+}
+
+/**
+ * Copy a buffer into a new map buffer and read it back
+ */
+static std::vector<float> readBuffer(Device device, Buffer buffer) {
+	BufferDescriptor bufferDesc = Default;
+	bufferDesc.size = buffer.getSize();
+	bufferDesc.label = StringView("map");
+	bufferDesc.usage = BufferUsage::MapRead | BufferUsage::CopyDst;
+	raii::Buffer mapBuffer = device.createBuffer(bufferDesc);
+
+	raii::CommandEncoder encoder = device.createCommandEncoder();
+	encoder->copyBufferToBuffer(buffer, 0, *mapBuffer, 0, buffer.getSize());
+	raii::CommandBuffer commands = encoder->finish();
+	raii::Queue queue = device.getQueue();
+	queue->submit(*commands);
+
+	bool done = false;
+	std::vector<float> data(buffer.getSize() / sizeof(float));
+	auto h = mapBuffer->mapAsync(MapMode::Read, 0, mapBuffer->getSize(), [&](BufferMapAsyncStatus status) {
+		done = true;
+		if (status == BufferMapAsyncStatus::Success) {
+			memcpy(data.data(), mapBuffer->getConstMappedRange(0, mapBuffer->getSize()), mapBuffer->getSize());
+		}
+		mapBuffer->unmap();
+	});
+
+	while (!done) {
+		pollDeviceEvents(device);
+	}
+	return data;
+}
+
+Result<Void, Error> runGeneratedGradients(Device device) {
+	raii::Queue queue = device.getQueue();
+
+	// 1. Load kernel
+	// It contains entry points 'squaredErrorForward', 'squaredErrorBackward'
+	// and 'squaredErrorReduceGradients' generated from the differentiable
+	// function 'squaredError'.
+	generated::SquaredErrorKernel kernel(device);
+	TRY_ASSERT(kernel, "Kernel could not load!");
+
+	// 2. Create and fill in buffers
+	// Gradient buffers are allocated by the kernel.
+	constexpr uint32_t count = 1000;
+	const float w = 0.25f;
+	std::vector<float> x(count);
+	for (uint32_t i = 0; i < count; ++i) {
+		x[i] = 0.01f * i - 3.0f;
+	}
+	std::vector<float> resultGrad(count, 1.0f);
+
+	BufferDescriptor bufferDesc = Default;
+	bufferDesc.size = 16;
+	bufferDesc.label = StringView("uniforms");
+	bufferDesc.usage = BufferUsage::Uniform | BufferUsage::CopyDst;
+	raii::Buffer uniforms = device.createBuffer(bufferDesc);
+	queue->writeBuffer(*uniforms, 0, &count, sizeof(uint32_t));
+
+	bufferDesc.usage = BufferUsage::Storage | BufferUsage::CopyDst | BufferUsage::CopySrc;
+	bufferDesc.size = count * sizeof(float);
+	bufferDesc.label = StringView("x");
+	raii::Buffer xBuffer = device.createBuffer(bufferDesc);
+	queue->writeBuffer(*xBuffer, 0, x.data(), bufferDesc.size);
+	bufferDesc.label = StringView("result");
+	raii::Buffer resultBuffer = device.createBuffer(bufferDesc);
+	bufferDesc.label = StringView("resultGrad");
+	raii::Buffer resultGradBuffer = device.createBuffer(bufferDesc);
+	queue->writeBuffer(*resultGradBuffer, 0, resultGrad.data(), bufferDesc.size);
+	bufferDesc.size = sizeof(float);
+	bufferDesc.label = StringView("w");
+	raii::Buffer wBuffer = device.createBuffer(bufferDesc);
+	queue->writeBuffer(*wBuffer, 0, &w, sizeof(float));
+
+	generated::SquaredErrorKernel::SquaredErrorGradients gradients = kernel.createSquaredErrorGradientBuffers(count);
+
+	raii::BindGroup bindGroup = kernel.createBindGroup(
+		*uniforms,
+		*xBuffer,
+		*wBuffer,
+		*resultBuffer,
+		*resultGradBuffer,
+		*gradients.xGrad,
+		*gradients.wGrad,
+		*gradients.partialGrads
+	);
+
+	// 3. Dispatch forward and backward passes
+	// Gradients are accumulated, so they must be zeroed before each backward
+	// pass (they are already zero after creation, this is for illustration).
+	raii::CommandEncoder encoder = device.createCommandEncoder();
+	kernel.dispatchSquaredErrorForward(*encoder, ThreadCount{ count }, *bindGroup);
+	kernel.zeroSquaredErrorGradients(*encoder, gradients);
+	kernel.dispatchSquaredErrorGradients(*encoder, count, *bindGroup);
+	raii::CommandBuffer commands = encoder->finish();
+	queue->submit(*commands);
+
+	// 4. Read back and check results
+	std::vector<float> result = readBuffer(device, *resultBuffer);
+	std::vector<float> xGrad = readBuffer(device, *gradients.xGrad);
+	std::vector<float> wGrad = readBuffer(device, *gradients.wGrad);
+
+	float expectedWGrad = 0.0f;
+	for (uint32_t i = 0; i < count; ++i) {
+		float d = x[i] * w - 1.0f;
+		TRY_ASSERT(isClose(result[i], d * d), "validation error (forward)");
+		TRY_ASSERT(isClose(xGrad[i], 2.0f * d * w), "validation error (per-element gradient)");
+		expectedWGrad += 2.0f * d * x[i];
+	}
+	LOG(INFO) << "Gradient of the loss wrt the shared weight: " << wGrad[0] << " (expected " << expectedWGrad << ")";
+	TRY_ASSERT(isClose(wGrad[0], expectedWGrad), "validation error (shared gradient)");
+
 	return {};
 }
@@ -0,0 +1,170 @@
+// NB: This WEBGPU_CPP_IMPLEMENTATION must be defined in **exactly one** source
+// file, and before including webgpu C++ header (see https://github.com/eliemichel/WebGPU-Cpp)
+#define WEBGPU_CPP_IMPLEMENTATION
+
+// Header generated from shaders/element-wise.slang (see config in CMakeLists.txt)
+#include "generated/ElementWiseKernel.h"
+
+#include <slang-webgpu/common/result.h>
+#include <slang-webgpu/common/logger.h>
+#include <slang-webgpu/common/io.h>
+
+#include <slang-webgpu/runtime/kernel-profiler.h>
+
+#include <slang-webgpu/examples/webgpu-utils.h> // provides createDevice()
+
+// NB: raii::Foo is the equivalent of Foo except its release()/addRef() methods
+// are automatically called
+#include <webgpu/webgpu-raii.hpp>
+
+#include <filesystem>
+#include <cstring> // for memcpy
+
+using namespace wgpu;
+
+// Mirror of what is in the Slang shader
+struct Parameters {
+	float offset;
+	float scale;
+	uint32_t count;
+	uint32_t _pad[1];
+};
+static_assert(sizeof(Parameters) % 16 == 0);
+
+/**
+ * Main entry point
+ */
+Result<Void, Error> run();
+
+int main(int, char**) {
+	auto maybeError = run();
+	if (isError(maybeError)) {
+		LOG(ERROR) << std::get<Error>(maybeError).message;
+		return 1;
+	}
+	return 0;
+}
+
+static bool isClose(float a, float b, float eps = 1e-5) {
+	return std::abs(b - a) < eps;
+}
+
+Result<Void, Error> run() {
+	// 1. Create GPU device
+	// Nothing specific to Slang here
+	raii::Device device = createDevice();
+	raii::Queue queue = device->getQueue();
+
+	// 2. Load kernel
+	// The kernel contains the fused entrypoint on top of the regular ones.
+	generated::ElementWiseKernel kernel(*device);
+	TRY_ASSERT(kernel, "Kernel could not load!");
+
+	// 3. Create buffers
+	// Nothing specific to Slang here
+	constexpr uint32_t count = 100;
+	BufferDescriptor bufferDesc = Default;
+	bufferDesc.size = sizeof(Parameters);
+	bufferDesc.label = StringView("uniforms");
+	bufferDesc.usage = BufferUsage::Uniform | BufferUsage::CopyDst;
+	raii::Buffer uniforms = device->createBuffer(bufferDesc);
+
+	bufferDesc.size = count * sizeof(float);
+	bufferDesc.label = StringView("separateBuffer");
+	bufferDesc.usage = BufferUsage::Storage | BufferUsage::CopyDst | BufferUsage::CopySrc;
+	raii::Buffer separateBuffer = device->createBuffer(bufferDesc);
+
+	bufferDesc.label = StringView("fusedBuffer");
+	raii::Buffer fusedBuffer = device->createBuffer(bufferDesc);
+
+	bufferDesc.size = 2 * count * sizeof(float);
+	bufferDesc.label = StringView("map");
+	bufferDesc.usage = BufferUsage::MapRead | BufferUsage::CopyDst;
+	raii::Buffer mapBuffer = device->createBuffer(bufferDesc);
+
+	// 4. Fill in input buffers
+	// Nothing specific to Slang here
+	Parameters parameters;
+	parameters.offset = 3.14f;
+	parameters.scale = 0.5f;
+	parameters.count = count;
+	queue->writeBuffer(*uniforms, 0, &parameters, sizeof(Parameters));
+	std::vector<float> data0(count);
+	for (uint32_t i = 0; i < count; ++i) {
+		data0[i] = 2.36f - 0.87f * i;
+	}
+	queue->writeBuffer(*separateBuffer, 0, data0.data(), count * sizeof(float));
+	queue->writeBuffer(*fusedBuffer, 0, data0.data(), count * sizeof(float));
+
+	// 5. Build bind groups
+	raii::BindGroup separateBindGroup = kernel.createBindGroup(*uniforms, *separateBuffer);
+	raii::BindGroup fusedBindGroup = kernel.createBindGroup(*uniforms, *fusedBuffer);
+
+	// 6. Dispatch the entrypoints one after the other, then the fused one
+	// A profiler counts the dispatches of the kernel and, if the device
+	// supports timestamp queries, measures the GPU time of their passes.
+	KernelProfiler profiler(*device);
+	kernel.setProfiler(&profiler);
+	kernel.dispatchAddOffset(ThreadCount{ count }, *separateBindGroup);
+	kernel.dispatchMultiplyAndAdd(ThreadCount{ count }, *separateBindGroup);
+
+	kernel.dispatchAddOffsetThenMultiplyAndAdd(ThreadCount{ count }, *fusedBindGroup);
+
+	// 7. Copy results to map buffer
+	raii::CommandEncoder encoder = device->createCommandEncoder();
+	encoder->copyBufferToBuffer(*separateBuffer, 0, *mapBuffer, 0, count * sizeof(float));
+	encoder->copyBufferToBuffer(*fusedBuffer, 0, *mapBuffer, count * sizeof(float), count * sizeof(float));
+	raii::CommandBuffer commands = encoder->finish();
+	queue->submit(*commands);
+	// Timestamps are resolved once the timed passes have been submitted
+	TRY(profiler.resolve());
+
+	// 8. Read back result
+	// Nothing specific to Slang here
+	bool done = false;
+	std::vector<float> resultData(2 * count);
+	auto h = mapBuffer->mapAsync(MapMode::Read, 0, mapBuffer->getSize(), [&](BufferMapAsyncStatus status) {
+		done = true;
+		if (status == BufferMapAsyncStatus::Success) {
+			memcpy(resultData.data(), mapBuffer->getConstMappedRange(0, mapBuffer->getSize()), mapBuffer->getSize());
+		}
+		mapBuffer->unmap();
+	});
+
+	while (!done) {
+		pollDeviceEvents(*device);
+	}
+
+	// 9. Check result
+	// Nothing specific to Slang here
+	LOG(INFO) << "Result data (separate / fused):";
+	for (uint32_t i = 0; i < count; ++i) {
+		float expected = (data0[i] + 3.14f) * 0.5f + 3.14f;
+		float separate = resultData[i];
+		float fused = resultData[count + i];
+		if (i < 8) {
+			LOG(INFO) << "(" << data0[i] << " + 3.14) * 0.5 + 3.14 = " << separate << " / " << fused;
+		}
+		TRY_ASSERT(isClose(expected, separate), "Separate entrypoints did not run correctly!");
+		TRY_ASSERT(isClose(separate, fused), "Fused entrypoint does not match separate entrypoints!");
+	}
+
+	// 10. Report profiling
+#ifdef __EMSCRIPTEN__
+	// Timings are read back once the browser regains control
+	pollDeviceEvents(*device);
+#else // __EMSCRIPTEN__
+	TRY(profiler.waitForResults(5'000'000'000)); // 5 seconds
+#endif // __EMSCRIPTEN__
+	profiler.logReport();
+	std::vector<KernelProfiler::EntryPointStats> profile = profiler.stats();
+	TRY_ASSERT(profile.size() == 3, "Profiler did not see all entrypoints!");
+	for (const KernelProfiler::EntryPointStats& stats : profile) {
+		TRY_ASSERT(stats.dispatches == 1 && stats.workgroups == divideAndCeil(count, kernel.getWorkgroupSize(0).x), "Profiler did not count dispatches correctly!");
+#ifndef __EMSCRIPTEN__
+		TRY_ASSERT(!profiler.hasTimestamps() || stats.gpuTime.count == 1, "Profiler did not time dispatches!");
+#endif // __EMSCRIPTEN__
+	}
+
+	return {};
+}
@@ -0,0 +1,157 @@
+// NB: This WEBGPU_CPP_IMPLEMENTATION must be defined in **exactly one** source
+// file, and before including webgpu C++ header (see https://github.com/eliemichel/WebGPU-Cpp)
+#define WEBGPU_CPP_IMPLEMENTATION
+
+#include <slang-webgpu/common/result.h>
+#include <slang-webgpu/common/logger.h>
+
+// Provides KernelLibrary and DynamicKernel, which load kernels from an archive
+#include <slang-webgpu/runtime/kernel-library.h>
+
+#include <slang-webgpu/examples/webgpu-utils.h> // provides createDevice()
+
+// NB: raii::Foo is the equivalent of Foo except its release()/addRef() methods
+// are automatically called
+#include <webgpu/webgpu-raii.hpp>
+
+#include <cstring> // for memcpy
+
+using namespace wgpu;
+
+/**
+ * Main entry point
+ */
+Result<Void, Error> run();
+
+int main(int, char**) {
+	auto maybeError = run();
+	if (isError(maybeError)) {
+		LOG(ERROR) << std::get<Error>(maybeError).message;
+		return 1;
+	}
+	return 0;
+}
+
+static bool isClose(float a, float b, float eps = 1e-6) {
+	return std::abs(b - a) < eps;
+}
+
+/**
+ * Copy a buffer into a new map buffer and read it back
+ */
+static std::vector<float> readBuffer(Device device, Buffer buffer) {
+	BufferDescriptor bufferDesc = Default;
+	bufferDesc.size = buffer.getSize();
+	bufferDesc.label = StringView("map");
+	bufferDesc.usage = BufferUsage::MapRead | BufferUsage::CopyDst;
+	raii::Buffer mapBuffer = device.createBuffer(bufferDesc);
+
+	raii::CommandEncoder encoder = device.createCommandEncoder();
+	encoder->copyBufferToBuffer(buffer, 0, *mapBuffer, 0, buffer.getSize());
+	raii::CommandBuffer commands = encoder->finish();
+	raii::Queue queue = device.getQueue();
+	queue->submit(*commands);
+
+	bool done = false;
+	std::vector<float> data(buffer.getSize() / sizeof(float));
+	auto h = mapBuffer->mapAsync(MapMode::Read, 0, mapBuffer->getSize(), [&](BufferMapAsyncStatus status) {
+		done = true;
+		if (status == BufferMapAsyncStatus::Success) {
+			memcpy(data.data(), mapBuffer->getConstMappedRange(0, mapBuffer->getSize()), mapBuffer->getSize());
+		}
+		mapBuffer->unmap();
+	});
+
+	while (!done) {
+		pollDeviceEvents(device);
+	}
+	return data;
+}
+
+Result<Void, Error> run() {
+	// 1. Create GPU device
+	// Nothing specific to Slang here
+	raii::Device device = createDevice();
+	raii::Queue queue = device->getQueue();
+
+	// 2. Open kernel archive
+	// Nothing is compiled yet, kernels are only loaded upon request.
+	KernelLibrary library;
+	TRY_ASSIGN(library, KernelLibrary::open(*device, KERNEL_ARCHIVE));
+	LOG(INFO) << "Kernels in archive:";
+	for (size_t i = 0; i < library.getArchive().kernelCount(); ++i) {
+		LOG(INFO) << " - " << library.getArchive().kernelName(i);
+	}
+
+	DynamicKernel* bufferMath;
+	TRY_ASSIGN(bufferMath, library.getKernel("BufferMath"));
+	DynamicKernel* scale;
+	TRY_ASSIGN(scale, library.getKernel("Scale"));
+
+	// 3. Create and fill in buffers
+	// Nothing specific to Slang here
+	BufferDescriptor bufferDesc = Default;
+	bufferDesc.size = 10 * sizeof(float);
+	bufferDesc.usage = BufferUsage::Storage | BufferUsage::CopyDst;
+	bufferDesc.label = StringView("buffer0");
+	raii::Buffer buffer0 = device->createBuffer(bufferDesc);
+	bufferDesc.label = StringView("buffer1");
+	raii::Buffer buffer1 = device->createBuffer(bufferDesc);
+
+	bufferDesc.label = StringView("result");
+	bufferDesc.usage = BufferUsage::Storage | BufferUsage::CopySrc;
+	raii::Buffer result = device->createBuffer(bufferDesc);
+
+	bufferDesc.size = 16;
+	bufferDesc.label = StringView("uniforms");
+	bufferDesc.usage = BufferUsage::Uniform | BufferUsage::CopyDst;
+	raii::Buffer uniforms = device->createBuffer(bufferDesc);
+
+	std::vector<float> data0(10);
+	std::vector<float> data1(10);
+	for (int i = 0; i < 10; ++i) {
+		data0[i] = i * 1.06f;
+		data1[i] = 2.36f - 0.87f * i;
+	}
+	queue->writeBuffer(*buffer0, 0, data0.data(), data0.size() * sizeof(float));
+	queue->writeBuffer(*buffer1, 0, data1.data(), data1.size() * sizeof(float));
+	float factor = 0.5f;
+	queue->writeBuffer(*uniforms, 0, &factor, sizeof(float));
+
+	// 4. Build bind groups
+	// Buffers are given in the same order as the arguments of the
+	// createBindGroup() method of a generated kernel.
+	raii::BindGroup bufferMathBindGroup;
+	TRY_ASSIGN(*bufferMathBindGroup, bufferMath->createBindGroup({ *buffer0, *buffer1, *result }));
+	raii::BindGroup scaleBindGroup;
+	TRY_ASSIGN(*scaleBindGroup, scale->createBindGroup({ *uniforms, *result }));
+
+	// 5. Dispatch entry points by name
+	// The pipeline of each entry point is created upon first dispatch.
+	raii::CommandEncoder encoder = device->createCommandEncoder();
+	TRY(bufferMath->dispatch(*encoder, "computeMainAdd", ThreadCount{ 10 }, *bufferMathBindGroup));
+	TRY(scale->dispatch(*encoder, "computeMain", ThreadCount{ 10 }, *scaleBindGroup));
+	raii::CommandBuffer commands = encoder->finish();
+	queue->submit(*commands);
+
+	std::vector<float> resultData = readBuffer(*device, *result);
+	LOG(INFO) << "Result data:";
+	for (int i = 0; i < 10; ++i) {
+		LOG(INFO) << "(" << data0[i] << " + " << data1[i] << ") * " << factor << " = " << resultData[i];
+		TRY_ASSERT(isClose((data0[i] + data1[i]) * factor, resultData[i]), "Shader did not run correctly!");
+	}
+
+	// 6. Reload kernels
+	// This is what happens when the archive file changes and the application
+	// calls library.reloadIfChanged(). Kernel pointers and bind groups remain
+	// valid.
+	TRY(library.reload());
+	TRY(bufferMath->dispatch("computeMainMultiply", ThreadCount{ 10 }, *bufferMathBindGroup));
+
+	resultData = readBuffer(*device, *result);
+	for (int i = 0; i < 10; ++i) {
+		TRY_ASSERT(isClose(data0[i] * data1[i], resultData[i]), "Shader did not run correctly after reload!");
+	}
+
+	return {};
+}
@@ -0,0 +1,184 @@
+// NB: This WEBGPU_CPP_IMPLEMENTATION must be defined in **exactly one** source
+// file, and before including webgpu C++ header (see https://github.com/eliemichel/WebGPU-Cpp)
+#define WEBGPU_CPP_IMPLEMENTATION
+
+// Headers generated from shaders/compact.slang and shaders/square.slang
+#include "generated/CompactKernel.h"
+#include "generated/SquareKernel.h"
+
+#include <slang-webgpu/common/result.h>
+#include <slang-webgpu/common/logger.h>
+
+#include <slang-webgpu/runtime/readback-service.h>
+#include <slang-webgpu/runtime/upload-belt.h>
+
+#include <slang-webgpu/examples/webgpu-utils.h> // provides createDevice()
+
+// NB: raii::Foo is the equivalent of Foo except its release()/addRef() methods
+// are automatically called
+#include <webgpu/webgpu-raii.hpp>
+
+#include <algorithm>
+#include <cmath>
+
+#ifdef __EMSCRIPTEN__
+#  include <emscripten/emscripten.h>
+#endif
+
+using namespace wgpu;
+
+// Mirror of what is in the Slang shader
+struct CompactUniforms {
+	uint32_t count;
+	uint32_t _pad[3];
+};
+static_assert(sizeof(CompactUniforms) % 16 == 0);
+
+/**
+ * Main entry point
+ */
+Result<Void, Error> run();
+
+int main(int, char**) {
+	auto maybeError = run();
+	if (isError(maybeError)) {
+		LOG(ERROR) << std::get<Error>(maybeError).message;
+		return 1;
+	}
+	return 0;
+}
+
+static bool isClose(float a, float b, float eps = 1e-5) {
+	return std::abs(b - a) < eps;
+}
+
+Result<Void, Error> run() {
+	// 1. Create GPU device
+	// Nothing specific to Slang here
+	raii::Device device = createDevice();
+	raii::Queue queue = device->getQueue();
+
+	// 2. Load kernels
+	// With PipelineCreation::Async, constructors return right away and the
+	// pipelines of all kernels are created concurrently in the background.
+	// Dispatching a kernel waits for its pipeline, but on the Web this is not
+	// possible, so we wait here in a way that gives control back to the browser.
+	generated::CompactKernel compactKernel(*device, PipelineCreation::Async);
+	TRY_ASSERT(compactKernel, "Kernel could not load!");
+	generated::SquareKernel squareKernel(*device, PipelineCreation::Async);
+	TRY_ASSERT(squareKernel, "Kernel could not load!");
+	while (!areAllReady(compactKernel, squareKernel)) {
+		pollDeviceEvents(*device);
+	}
+	TRY(waitUntilAllReady(compactKernel, squareKernel)); // only reports errors here
+
+	// 3. Create and fill in buffers
+	// Nothing specific to Slang here, except that 'dispatchArgs' must have the
+	// 'Indirect' usage to be used by indirect dispatches. Data is written
+	// straight into mapped memory by an UploadBelt rather than copied by
+	// Queue::writeBuffer().
+	UploadBelt uploads(*device);
+	const uint32_t count = 1000;
+	std::vector<float> inputData(count);
+	for (uint32_t i = 0; i < count; ++i) {
+		inputData[i] = std::sin(i * 0.37f) + 0.2f;
+	}
+
+	BufferDescriptor bufferDesc = Default;
+	bufferDesc.size = count * sizeof(float);
+	bufferDesc.label = StringView("input");
+	bufferDesc.usage = BufferUsage::Storage;
+	raii::Buffer input;
+	// Content is known at creation, so the buffer is filled while mapped
+	TRY_ASSIGN(input, uploads.createBuffer(bufferDesc, inputData.data(), count * sizeof(float)));
+
+	bufferDesc.label = StringView("compacted");
+	bufferDesc.usage = BufferUsage::Storage | BufferUsage::CopySrc;
+	raii::Buffer compacted = device->createBuffer(bufferDesc);
+
+	bufferDesc.size = 4 * sizeof(uint32_t);
+	bufferDesc.label = StringView("counter");
+	bufferDesc.usage = BufferUsage::Storage | BufferUsage::CopyDst | BufferUsage::CopySrc;
+	raii::Buffer counter = device->createBuffer(bufferDesc);
+
+	bufferDesc.size = 4 * sizeof(uint32_t);
+	bufferDesc.label = StringView("dispatchArgs");
+	bufferDesc.usage = BufferUsage::Storage | BufferUsage::Indirect | BufferUsage::CopySrc;
+	raii::Buffer dispatchArgs = device->createBuffer(bufferDesc);
+
+	bufferDesc.size = sizeof(CompactUniforms);
+	bufferDesc.label = StringView("uniforms");
+	bufferDesc.usage = BufferUsage::Uniform | BufferUsage::CopyDst;
+	raii::Buffer uniforms = device->createBuffer(bufferDesc);
+	CompactUniforms uniformData = {};
+	uniformData.count = count;
+	// Uploads into existing buffers go through staging buffers, and are
+	// submitted by flush().
+	TRY(uploads.upload(*uniforms, 0, &uniformData, sizeof(CompactUniforms)));
+	uploads.flush();
+	TRY_ASSERT(uploads.stats().buffersMappedAtCreation == 1 && uploads.stats().submits == 1, "Uploads were not batched!");
+
+	// 4. Build bind groups
+	raii::BindGroup compactBindGroup = compactKernel.createBindGroup(*uniforms, *input, *compacted, *counter);
+	raii::BindGroup squareBindGroup = squareKernel.createBindGroup(*counter, *compacted);
+
+	// 5. Record the whole pipeline without reading anything back
+	// The number of elements that 'compact' keeps is only known on the GPU.
+	// Rather than reading it back to size the next dispatch, the built-in
+	// WorkgroupCountKernel turns it into the arguments of an indirect dispatch,
+	// using the workgroup size of the entry point.
+	raii::CommandEncoder encoder = device->createCommandEncoder();
+	encoder->clearBuffer(*counter, 0, counter->getSize());
+	compactKernel.dispatch(*encoder, ThreadCount{ count }, *compactBindGroup);
+	TRY(squareKernel.writeDispatchArgs(*encoder, *counter, *dispatchArgs));
+	squareKernel.dispatchIndirect(*encoder, *dispatchArgs, 0, *squareBindGroup);
+	raii::CommandBuffer commands = encoder->finish();
+	queue->submit(*commands);
+
+	// 6. Read back and check results
+	std::vector<float> expected;
+	for (float value : inputData) {
+		if (value > 0.0f) expected.push_back(value * value);
+	}
+
+	// The three buffers are copied into pooled staging buffers within a single
+	// submit, then we block on the mapping futures (with a timeout) rather
+	// than polling the device.
+	ReadbackService readbacks(*device);
+	ReadbackService::Readback counterReadback, dispatchArgsReadback, compactedReadback;
+	TRY_ASSIGN(counterReadback, readbacks.read(*counter));
+	TRY_ASSIGN(dispatchArgsReadback, readbacks.read(*dispatchArgs));
+	TRY_ASSIGN(compactedReadback, readbacks.read(*compacted));
+	readbacks.flush();
+#ifdef __EMSCRIPTEN__
+	// The browser needs to regain control for mappings to complete, which the
+	// service cannot make faster. An application would rather go on from the
+	// onReady() callback of its readbacks, within its main loop. As this
+	// example is a single blocking function, it gives control back to the
+	// browser until then, without the 50 ms sleep of pollDeviceEvents().
+	while (readbacks.pendingCount() > 0) {
+		emscripten_sleep(0);
+	}
+#endif // __EMSCRIPTEN__
+	TRY(readbacks.waitAll(5'000'000'000)); // 5 seconds
+	TRY_ASSERT(readbacks.stats().submits == 1, "Readbacks were not batched!");
+
+	std::vector<uint32_t> counterData = counterReadback.as<uint32_t>();
+	std::vector<uint32_t> dispatchArgsData = dispatchArgsReadback.as<uint32_t>();
+	std::vector<float> compactedData = compactedReadback.as<float>();
+	uint32_t keptCount = counterData[0];
+	LOG(INFO) << "Kept " << keptCount << " element(s) out of " << count << ", squared by " << dispatchArgsData[0] << " workgroup(s) of " << squareKernel.getWorkgroupSize(0).x << " thread(s)";
+	TRY_ASSERT(keptCount == expected.size(), "Shader did not run correctly!");
+	TRY_ASSERT(dispatchArgsData[0] == divideAndCeil(keptCount, squareKernel.getWorkgroupSize(0).x), "Dispatch arguments are not correct!");
+	TRY_ASSERT(dispatchArgsData[1] == 1 && dispatchArgsData[2] == 1, "Dispatch arguments are not correct!");
+
+	// Compaction does not preserve order
+	compactedData.resize(keptCount);
+	std::sort(compactedData.begin(), compactedData.end());
+	std::sort(expected.begin(), expected.end());
+	for (uint32_t i = 0; i < keptCount; ++i) {
+		TRY_ASSERT(isClose(expected[i], compactedData[i]), "Shader did not run correctly!");
+	}
+
+	return {};
+}
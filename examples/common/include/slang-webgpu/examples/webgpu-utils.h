@@ -2,14 +2,19 @@
 
 #include <webgpu/webgpu.hpp>
 
+class BlobCache;
+
 /**
  * Create a WebGPU device.
  *
  * NB: On emscripten, this requires ASYNCIFY so that the API is simpler.
  * If you do not want to use ASYNCIFY, you may replace it with other mechanism
  * to get a device.
+ *
+ * When a blobCache is given, compiled shaders and pipelines are loaded from and
+ * stored into it (native only). It must outlive the device.
  */
-wgpu::Device createDevice();
+wgpu::Device createDevice(BlobCache* blobCache = nullptr);
 
 /**
  * Let the device trigger pending callbacks if they are ready.
@@ -1,11 +1,15 @@
 #include <slang-webgpu/examples/webgpu-utils.h>
 
 #include <slang-webgpu/common/logger.h>
+#include <slang-webgpu/runtime/blob-cache.h>
+#include <slang-webgpu/runtime/device-registry.h>
 
 // NB: raii::Foo is the equivalent of Foo except its release()/addRef() methods
 // are automatically called
 #include <webgpu/webgpu-raii.hpp>
 
+#include <vector>
+
 #ifdef __EMSCRIPTEN__
 #  include <emscripten/html5.h>
 #endif
@@ -14,13 +18,21 @@ using namespace wgpu;
 
 #ifdef __EMSCRIPTEN__
 
-Device createDevice() {
+Device createDevice([[maybe_unused]] BlobCache* blobCache) {
 	raii::Instance instance = createInstance();
 
 	RequestAdapterOptions options = Default;
 	raii::Adapter adapter = instance->requestAdapter(options);
 
+	// Timestamp queries let KernelProfiler measure GPU time
+	std::vector<WGPUFeatureName> requiredFeatures;
+	if (adapter->hasFeature(FeatureName::TimestampQuery)) {
+		requiredFeatures.push_back(FeatureName::TimestampQuery);
+	}
+
 	DeviceDescriptor descriptor = Default;
+	descriptor.requiredFeatureCount = requiredFeatures.size();
+	descriptor.requiredFeatures = requiredFeatures.data();
 	descriptor.deviceLostCallback = [](
 		WGPUDeviceLostReason reason,
 		const char* message,
@@ -60,13 +72,24 @@ Device createDevice() {
 
 #else // __EMSCRIPTEN__
 
-Device createDevice() {
-	raii::Instance instance = createInstance();
+Device createDevice(BlobCache* blobCache) {
+	// Timed waits let ReadbackService block on futures rather than polling
+	InstanceDescriptor instanceDesc = Default;
+	instanceDesc.features.timedWaitAnyEnable = true;
+	raii::Instance instance = createInstance(instanceDesc);
 
 	RequestAdapterOptions options = Default;
 	raii::Adapter adapter = instance->requestAdapter(options);
 
+	// Timestamp queries let KernelProfiler measure GPU time
+	std::vector<WGPUFeatureName> requiredFeatures;
+	if (adapter->hasFeature(FeatureName::TimestampQuery)) {
+		requiredFeatures.push_back(FeatureName::TimestampQuery);
+	}
+
 	DeviceDescriptor descriptor = Default;
+	descriptor.requiredFeatureCount = requiredFeatures.size();
+	descriptor.requiredFeatures = requiredFeatures.data();
 	descriptor.uncapturedErrorCallbackInfo2.callback = [](
 		[[maybe_unused]] WGPUDevice const* device,
 		WGPUErrorType type,
@@ -80,18 +103,23 @@ Device createDevice() {
 			LOG(ERROR) << "[WebGPU] Uncaptured error: (reason: " << type << ")";
 	};
 	descriptor.deviceLostCallbackInfo2.callback = [](
-		[[maybe_unused]] WGPUDevice const* device,
+		WGPUDevice const* device,
 		WGPUDeviceLostReason reason,
 		WGPUStringView message,
 		[[maybe_unused]] void* userdata1,
 		[[maybe_unused]] void* userdata2
 	) {
+		// Kernels created afterwards must not reuse the objects of a lost device
+		if (device && *device) DeviceRegistry::release(*device);
 		if (reason == DeviceLostReason::InstanceDropped) return;
 		if (message.data)
 			LOG(ERROR) << "[WebGPU] Device lost: " << StringView(message) << " (reason: " << reason << ")";
 		else
 			LOG(ERROR) << "[WebGPU] Device lost: (reason: " << reason << ")";
 	};
+	if (blobCache) {
+		blobCache->attach(descriptor, *adapter);
+	}
 	Device device = adapter->requestDevice(descriptor);
 
 	AdapterInfo info;
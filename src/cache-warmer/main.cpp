@@ -0,0 +1,113 @@
+/**
+ * Main of the executables created by add_slang_webgpu_cache_warmer(), which
+ * instantiate all the kernels they are linked with on a device that stores
+ * compiled shaders and pipelines in a BlobCache. Run it once (e.g., at install
+ * time) so that the first run of the application does not compile them again.
+ *
+ * The function warmKernels() is generated by add_slang_webgpu_cache_warmer().
+ */
+
+// NB: This WEBGPU_CPP_IMPLEMENTATION must be defined in **exactly one** source
+// file, and before including webgpu C++ header (see https://github.com/eliemichel/WebGPU-Cpp)
+#define WEBGPU_CPP_IMPLEMENTATION
+
+#include <slang-webgpu/common/result.h>
+#include <slang-webgpu/common/logger.h>
+#include <slang-webgpu/runtime/blob-cache.h>
+
+// NB: raii::Foo is the equivalent of Foo except its release()/addRef() methods
+// are automatically called
+#include <webgpu/webgpu-raii.hpp>
+
+#include <CLI11.hpp>
+
+#include <chrono>
+#include <filesystem>
+
+using namespace wgpu;
+
+Result<Void, Error> warmKernels(Device device, size_t& kernelCount);
+
+/**
+ * Create a device whose blobs are loaded from and stored into 'cache'.
+ */
+Result<raii::Device, Error> createCachedDevice(BlobCache& cache) {
+	raii::Instance instance = createInstance();
+
+	RequestAdapterOptions options = Default;
+	raii::Adapter adapter = instance->requestAdapter(options);
+	TRY_ASSERT(*adapter, "Could not get a WebGPU adapter");
+
+	DeviceDescriptor descriptor = Default;
+	descriptor.uncapturedErrorCallbackInfo2.callback = [](
+		[[maybe_unused]] WGPUDevice const* device,
+		WGPUErrorType type,
+		WGPUStringView message,
+		[[maybe_unused]] void* userdata1,
+		[[maybe_unused]] void* userdata2
+	) {
+		if (message.data)
+			LOG(ERROR) << "[WebGPU] Uncaptured error: " << StringView(message) << " (type: " << type << ")";
+		else
+			LOG(ERROR) << "[WebGPU] Uncaptured error: (reason: " << type << ")";
+	};
+	cache.attach(descriptor, *adapter);
+
+	raii::Device device = adapter->requestDevice(descriptor);
+	TRY_ASSERT(*device, "Could not get a WebGPU device");
+
+	AdapterInfo info;
+	device->getAdapterInfo(&info);
+	LOG(INFO)
+		<< "Using device: " << StringView(info.device)
+		<< " (vendor: " << StringView(info.vendor)
+		<< ", architecture: " << StringView(info.architecture) << ")";
+	info.freeMembers();
+	return device;
+}
+
+Result<Void, Error> run(const std::filesystem::path& cacheDirectory, uint64_t maxSize) {
+	BlobCache cache(cacheDirectory, maxSize);
+	{
+		// The device is destroyed before reading stats, as blobs may be
+		// stored up until then. Kernels, and the objects they share through
+		// the DeviceRegistry, are already destroyed by warmKernels().
+		raii::Device device;
+		TRY_ASSIGN(device, createCachedDevice(cache));
+
+		auto start = std::chrono::steady_clock::now();
+		size_t kernelCount = 0;
+		TRY(warmKernels(*device, kernelCount));
+		auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start);
+		LOG(INFO) << "Instantiated " << kernelCount << " kernel(s) in " << elapsed.count() << " ms";
+	}
+
+	BlobCache::Stats stats = cache.stats();
+	LOG(INFO)
+		<< "Blob cache '" << cache.getDirectory().string() << "': "
+		<< stats.hits << " hit(s), "
+		<< stats.misses << " miss(es), "
+		<< stats.stores << " store(s), "
+		<< stats.evictions << " eviction(s), "
+		<< stats.size << " bytes";
+	return {};
+}
+
+int main(int argc, char* argv[]) {
+	CLI::App app{ "Fill a blob cache with the compiled shaders and pipelines of all the kernels of the application" };
+	argv = app.ensure_utf8(argv);
+
+	std::filesystem::path cacheDirectory;
+	uint64_t maxSize = 256 * 1024 * 1024;
+	app.add_option("cache-directory", cacheDirectory, "Directory of the blob cache, given to BlobCache at runtime")
+		->required();
+	app.add_option("--max-size", maxSize, "Maximum size of the cache for the current adapter, in bytes");
+	CLI11_PARSE(app, argc, argv);
+
+	auto maybeError = run(cacheDirectory, maxSize);
+	if (isError(maybeError)) {
+		LOG(ERROR) << std::get<Error>(maybeError).message;
+		return 1;
+	}
+	return 0;
+}
@@ -3,6 +3,8 @@
 #include <slang-webgpu/common/result.h>
 
 #include <filesystem>
+#include <vector>
+#include <cstdint>
 
 Result<std::string, Error> loadTextFile(
 	const std::filesystem::path& path
@@ -12,3 +14,46 @@ Result<Void, Error> saveTextFile(
 	const std::filesystem::path& path,
 	const std::string& contents
 );
+
+Result<std::vector<uint8_t>, Error> loadBinaryFile(
+	const std::filesystem::path& path
+);
+
+/**
+ * Write the file under a temporary name then rename it, so that concurrent
+ * readers never see a partially written file.
+ */
+Result<Void, Error> saveBinaryFile(
+	const std::filesystem::path& path,
+	const void* data,
+	size_t size
+);
+
+/**
+ * Read-only memory mapping of a whole file. Where memory mapping is not
+ * available (e.g., with emscripten), the file is read into memory instead.
+ */
+class MappedFile {
+public:
+	static Result<MappedFile, Error> open(const std::filesystem::path& path);
+
+	MappedFile() = default;
+	~MappedFile();
+	MappedFile(MappedFile&& other) noexcept;
+	MappedFile& operator=(MappedFile&& other) noexcept;
+	MappedFile(const MappedFile&) = delete;
+	MappedFile& operator=(const MappedFile&) = delete;
+
+	const uint8_t* data() const { return m_data; }
+	size_t size() const { return m_size; }
+
+private:
+	void close();
+
+private:
+	const uint8_t* m_data = nullptr;
+	size_t m_size = 0;
+	bool m_mapped = false;
+	// Used when the file could not be mapped
+	std::vector<uint8_t> m_contents;
+};
@@ -0,0 +1,146 @@
+#pragma once
+
+#include <slang-webgpu/common/result.h>
+#include <slang-webgpu/common/io.h>
+
+#include <array>
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/**
+ * A kernel archive is a single file that packs many kernels: their shader
+ * source (WGSL or SPIR-V), their entry points and workgroup sizes, and the
+ * bindings of their bind group. It is produced by the generator (see
+ * --output-archive) and loaded at runtime by DynamicKernel, so that shaders
+ * may be updated without rebuilding the application.
+ *
+ * The file is designed to be memory-mapped: it is made of fixed-size
+ * little-endian tables that reference ranges of the file, and kernels are
+ * sorted by name so that they can be looked up without parsing the whole
+ * archive.
+ */
+
+constexpr uint32_t KernelArchiveVersion = 1;
+
+enum class KernelSourceFormat : uint32_t {
+	Wgsl = 0,
+	SpirV = 1,
+};
+
+enum class KernelBindingType : uint32_t {
+	Uniform = 0,
+	Storage = 1,
+	ReadOnlyStorage = 2,
+};
+
+struct KernelEntryPointInfo {
+	std::string name;
+	std::array<uint32_t, 3> workgroupSize = { 1, 1, 1 };
+};
+
+struct KernelBindingInfo {
+	std::string name;
+	uint32_t binding = 0;
+	KernelBindingType type = KernelBindingType::Storage;
+	// 0 means that there is no minimum size
+	uint64_t minBindingSize = 0;
+	// Not stored in archives, only used by generated kernels
+	bool hasDynamicOffset = false;
+};
+
+/**
+ * A string that identifies the bind group layout described by a list of
+ * bindings, e.g. "0:Uniform:16;1:Storage;2:ReadOnlyStorage" (the uniform
+ * binding reads "0:Uniform:16:dynamic" when it has a dynamic offset). Binding
+ * names are not part of it, so kernels that have the same signature may share
+ * the same bind group layout, hence the same bind groups.
+ */
+std::string bindingSignature(const std::vector<KernelBindingInfo>& bindings);
+
+/**
+ * Everything needed to create the pipelines of a kernel, as written into an
+ * archive.
+ */
+struct KernelDescription {
+	std::string name;
+	KernelSourceFormat sourceFormat = KernelSourceFormat::Wgsl;
+	std::string source;
+	std::vector<KernelEntryPointInfo> entryPoints;
+	std::vector<KernelBindingInfo> bindings;
+};
+
+/**
+ * A kernel read from an archive. The source points into the archive's
+ * memory, so it is only valid as long as the archive is alive.
+ */
+struct KernelView {
+	std::string_view name;
+	KernelSourceFormat sourceFormat = KernelSourceFormat::Wgsl;
+	std::string_view source;
+	std::vector<KernelEntryPointInfo> entryPoints;
+	std::vector<KernelBindingInfo> bindings;
+};
+
+/**
+ * Serialize kernels into the archive format. Kernel names must be unique.
+ */
+Result<std::vector<uint8_t>, Error> serializeKernelArchive(
+	const std::vector<KernelDescription>& kernels
+);
+
+Result<Void, Error> saveKernelArchive(
+	const std::filesystem::path& path,
+	const std::vector<KernelDescription>& kernels
+);
+
+/**
+ * Read access to an archive, either memory-mapped from a file or held in
+ * memory. The whole structure of the archive is validated upon opening, so
+ * accessors do not fail.
+ */
+class KernelArchive {
+public:
+	/**
+	 * Map an archive file into memory.
+	 */
+	static Result<KernelArchive, Error> open(const std::filesystem::path& path);
+
+	/**
+	 * Use an archive that has already been loaded into memory, e.g. fetched
+	 * from the network.
+	 */
+	static Result<KernelArchive, Error> fromMemory(std::vector<uint8_t> data);
+
+	KernelArchive() = default;
+	KernelArchive(KernelArchive&&) = default;
+	KernelArchive& operator=(KernelArchive&&) = default;
+	KernelArchive(const KernelArchive&) = delete;
+	KernelArchive& operator=(const KernelArchive&) = delete;
+
+	size_t kernelCount() const;
+	std::string_view kernelName(size_t index) const;
+	KernelView kernel(size_t index) const;
+
+	/**
+	 * Binary search of a kernel by name.
+	 */
+	std::optional<size_t> findKernel(std::string_view name) const;
+
+	/**
+	 * Copy all kernels, e.g. to pack them into another archive.
+	 */
+	std::vector<KernelDescription> kernels() const;
+
+private:
+	Result<Void, Error> validate() const;
+	const uint8_t* data() const;
+	size_t size() const;
+
+private:
+	MappedFile m_file;
+	std::vector<uint8_t> m_memory;
+};
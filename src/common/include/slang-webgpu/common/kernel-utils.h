@@ -22,3 +22,7 @@ using DispatchSize = std::variant<WorkgroupCount, ThreadCount>;
 inline uint32_t divideAndCeil(uint32_t x, uint32_t y) {
 	return (x + y - 1) / y;
 }
+
+inline uint64_t alignUp(uint64_t x, uint64_t alignment) {
+	return (x + alignment - 1) / alignment * alignment;
+}
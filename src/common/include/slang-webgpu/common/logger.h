@@ -1,11 +1,34 @@
 #pragma once
 
-#include <sstream>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
 #include <iostream>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+/**
+ * Maximum level of the messages that are compiled in, as an integer (0 for
+ * ERROR, 1 for WARNING, 2 for INFO and 3 for DEBUG). Messages above it are
+ * removed at compile time, including the evaluation of their arguments. Set
+ * through the SLANG_WEBGPU_LOG_LEVEL CMake option.
+ */
+#ifndef SLANG_WEBGPU_LOG_LEVEL
+#define SLANG_WEBGPU_LOG_LEVEL 3
+#endif // SLANG_WEBGPU_LOG_LEVEL
 
 /**
  * A very simple logging class.
  * Do not use this directly, prefer using the LOG macro below.
+ *
+ * Messages whose level is disabled (at compile time or with setLevel()) cost a
+ * single test, and what is streamed into them is not evaluated. Other messages
+ * are pushed into a lock-free ring buffer, which a background thread drains
+ * into the output (stdout by default, as text), so that logging threads never
+ * wait for the output stream. Errors are flushed right away, so that they are
+ * not lost if the program then terminates abruptly.
  */
 class Logger {
 public:
@@ -16,38 +39,161 @@ public:
 		DEBUG,
 	};
 
+	enum class Output {
+		Stdout,
+		Stderr,
+	};
+
+	enum class Format {
+		// "INFO: message", as printed before asynchronous logging was added
+		Text,
+		// One JSON object per line, with a timestamp and the thread of origin
+		Json,
+	};
+
+	struct Options {
+		Level level = Level::DEBUG;
+		Output output = Output::Stdout;
+		Format format = Format::Text;
+		// When false, messages are written by the thread that logs them
+		bool asynchronous = true;
+	};
+
+	struct Record {
+		Level level = Level::INFO;
+		const char* file = "";
+		int line = 0;
+		// Microseconds since the Unix epoch
+		uint64_t timestamp = 0;
+		uint64_t thread = 0;
+		std::string message;
+	};
+
 public:
 	Logger(Level level, const char* file, int line)
 		: m_level(level)
 		, m_file(file)
 		, m_line(line)
 	{}
-	~Logger() {
-		switch (m_level) {
-		case Level::ERROR:
-			std::cout << "ERROR: " << m_stream.str() << std::endl;
-			break;
-		case Level::WARNING:
-			std::cout << "WARNING: " << m_stream.str() << std::endl;
-			break;
-		case Level::INFO:
-			std::cout << "INFO: " << m_stream.str() << std::endl;
-			break;
-		case Level::DEBUG:
-			std::cout << "DEBUG(" << m_file << ", line" << m_line << "): " << m_stream.str() << std::endl;
-			break;
-		}
-	}
+	~Logger();
 	Logger(Logger&) = delete;
 	Logger& operator=(const Logger&) = delete;
 	std::ostringstream& stream() { return m_stream; }
 
+	/**
+	 * Whether messages of a given level are compiled in.
+	 */
+	static constexpr bool isCompiledIn(Level level) {
+		return static_cast<int>(level) <= SLANG_WEBGPU_LOG_LEVEL;
+	}
+
+	/**
+	 * Whether messages of a given level are logged.
+	 */
+	static bool isEnabled(Level level) {
+		return isCompiledIn(level) && static_cast<int>(level) <= s_level.load(std::memory_order_relaxed);
+	}
+
+	/**
+	 * Set the level of messages, output and format. This may be called at any
+	 * time: messages logged before are written with the previous settings.
+	 */
+	static void configure(const Options& options);
+
+	/**
+	 * Only change the runtime level of messages.
+	 */
+	static void setLevel(Level level);
+
+	/**
+	 * Block until all messages logged so far (by any thread) are written.
+	 */
+	static void flush();
+
+	/**
+	 * Write a record that was already created, e.g., by a LogCapture.
+	 */
+	static void write(Record record);
+
+	static const char* levelName(Level level);
+
+	/**
+	 * Format a record the way it is written by the Text and Json formats,
+	 * without the end of line.
+	 */
+	static std::string formatText(const Record& record);
+	static std::string formatJson(const Record& record);
+
 private:
+	inline static std::atomic<int> s_level = static_cast<int>(Level::DEBUG);
+
 	Level m_level;
 	const char* m_file;
 	int m_line;
 	std::ostringstream m_stream;
 };
 
-// General macro for logging
-#define LOG(LEVEL) Logger(Logger::Level::LEVEL, __FILE__ , __LINE__).stream()
+/**
+ * While a LogCapture object is alive, messages logged by the thread that
+ * created it are appended to it rather than printed. This is used to print the
+ * logs of jobs that run in parallel in a deterministic order.
+ * Captures may be nested, in which case the innermost one gets the messages.
+ */
+class LogCapture {
+public:
+	LogCapture()
+		: m_previous(current())
+	{
+		current() = this;
+	}
+	~LogCapture() {
+		current() = m_previous;
+	}
+	LogCapture(const LogCapture&) = delete;
+	LogCapture& operator=(const LogCapture&) = delete;
+
+	void add(Logger::Record record) { m_records.push_back(std::move(record)); }
+
+	/**
+	 * Captured messages, e.g., to give them to Logger::write() later on.
+	 */
+	const std::vector<Logger::Record>& records() const { return m_records; }
+	std::vector<Logger::Record> takeRecords() { return std::move(m_records); }
+
+	/**
+	 * Captured messages, in the Text format.
+	 */
+	std::string str() const {
+		std::string text;
+		for (const Logger::Record& record : m_records) {
+			text += Logger::formatText(record) + "\n";
+		}
+		return text;
+	}
+
+	/**
+	 * Capture of the current thread, if any.
+	 */
+	static LogCapture*& current() {
+		thread_local LogCapture* s_current = nullptr;
+		return s_current;
+	}
+
+private:
+	LogCapture* m_previous;
+	std::vector<Logger::Record> m_records;
+};
+
+/**
+ * Turns the stream expression of LOG into void, so that it may be the second
+ * branch of a conditional expression.
+ */
+struct LogVoidify {
+	void operator&(std::ostream&) {}
+};
+
+// General macro for logging. Arguments are only evaluated if LEVEL is enabled.
+#define LOG(LEVEL) \
+	!Logger::isEnabled(Logger::Level::LEVEL) \
+		? (void)0 \
+		: LogVoidify() & Logger(Logger::Level::LEVEL, __FILE__ , __LINE__).stream()
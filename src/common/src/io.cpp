@@ -2,6 +2,19 @@
 
 #include <fstream>
 #include <sstream>
+#include <random>
+
+#if defined(_WIN32)
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#elif !defined(__EMSCRIPTEN__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
 
 Result<std::string, Error> loadTextFile(
 	const std::filesystem::path& path
@@ -38,3 +51,151 @@ Result<Void, Error> saveTextFile(
 	file << contents;
 	return {};
 }
+
+Result<std::vector<uint8_t>, Error> loadBinaryFile(
+	const std::filesystem::path& path
+) {
+	std::ifstream file;
+	file.open(path, std::ios::binary | std::ios::ate);
+	if (!file.is_open()) {
+		return Error{ "Could not open input file '" + path.string() + "'" };
+	}
+	std::vector<uint8_t> contents((size_t)file.tellg());
+	file.seekg(0);
+	file.read(reinterpret_cast<char*>(contents.data()), contents.size());
+	if (!file) {
+		return Error{ "Could not read input file '" + path.string() + "'" };
+	}
+	return contents;
+}
+
+Result<Void, Error> saveBinaryFile(
+	const std::filesystem::path& path,
+	const void* data,
+	size_t size
+) {
+	// Ensure parent directory
+	auto parent = path.parent_path();
+	if (!std::filesystem::exists(parent)) {
+		std::error_code err;
+		if (!std::filesystem::create_directories(parent, err) && !std::filesystem::exists(parent)) {
+			return Error{ "Could not create parent directory for output file '" + path.string() + "': " + err.message() };
+		}
+	}
+
+	// Write into a temporary file, with a name that is unique to this process
+	std::filesystem::path tmpPath = path;
+	tmpPath += ".tmp" + std::to_string(std::random_device{}());
+	{
+		std::ofstream file;
+		file.open(tmpPath, std::ios::binary);
+		if (!file.is_open()) {
+			return Error{ "Could not open output file '" + tmpPath.string() + "'" };
+		}
+		file.write(static_cast<const char*>(data), size);
+		if (!file) {
+			return Error{ "Could not write output file '" + tmpPath.string() + "'" };
+		}
+	}
+
+	// Move it in place
+	std::error_code err;
+	std::filesystem::rename(tmpPath, path, err);
+	if (err) {
+		std::filesystem::remove(tmpPath, err);
+		return Error{ "Could not move temporary file into '" + path.string() + "': " + err.message() };
+	}
+	return {};
+}
+
+Result<MappedFile, Error> MappedFile::open(
+	const std::filesystem::path& path
+) {
+	MappedFile file;
+#if defined(_WIN32)
+	HANDLE fileHandle = CreateFileW(path.wstring().c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+	if (fileHandle == INVALID_HANDLE_VALUE) {
+		return Error{ "Could not open input file '" + path.string() + "'" };
+	}
+	LARGE_INTEGER size;
+	if (!GetFileSizeEx(fileHandle, &size)) {
+		CloseHandle(fileHandle);
+		return Error{ "Could not get size of input file '" + path.string() + "'" };
+	}
+	if (size.QuadPart > 0) {
+		HANDLE mappingHandle = CreateFileMappingW(fileHandle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+		void* view = mappingHandle ? MapViewOfFile(mappingHandle, FILE_MAP_READ, 0, 0, 0) : nullptr;
+		// The view keeps a reference to the mapping, so handles can be closed
+		if (mappingHandle) CloseHandle(mappingHandle);
+		if (view) {
+			file.m_data = static_cast<const uint8_t*>(view);
+			file.m_size = (size_t)size.QuadPart;
+			file.m_mapped = true;
+		}
+	}
+	CloseHandle(fileHandle);
+#elif !defined(__EMSCRIPTEN__)
+	int fd = ::open(path.c_str(), O_RDONLY);
+	if (fd < 0) {
+		return Error{ "Could not open input file '" + path.string() + "'" };
+	}
+	struct stat st;
+	if (fstat(fd, &st) != 0) {
+		::close(fd);
+		return Error{ "Could not get size of input file '" + path.string() + "'" };
+	}
+	if (st.st_size > 0) {
+		void* addr = mmap(nullptr, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+		if (addr != MAP_FAILED) {
+			file.m_data = static_cast<const uint8_t*>(addr);
+			file.m_size = (size_t)st.st_size;
+			file.m_mapped = true;
+		}
+	}
+	// The mapping remains valid after closing the descriptor
+	::close(fd);
+#endif
+
+	if (!file.m_mapped) {
+		TRY_ASSIGN(file.m_contents, loadBinaryFile(path));
+		file.m_data = file.m_contents.data();
+		file.m_size = file.m_contents.size();
+	}
+	return file;
+}
+
+MappedFile::~MappedFile() {
+	close();
+}
+
+MappedFile::MappedFile(MappedFile&& other) noexcept {
+	*this = std::move(other);
+}
+
+MappedFile& MappedFile::operator=(MappedFile&& other) noexcept {
+	if (this != &other) {
+		close();
+		m_mapped = other.m_mapped;
+		m_size = other.m_size;
+		m_contents = std::move(other.m_contents);
+		m_data = m_mapped ? other.m_data : m_contents.data();
+		other.m_data = nullptr;
+		other.m_size = 0;
+		other.m_mapped = false;
+	}
+	return *this;
+}
+
+void MappedFile::close() {
+	if (m_mapped) {
+#if defined(_WIN32)
+		UnmapViewOfFile(m_data);
+#elif !defined(__EMSCRIPTEN__)
+		munmap(const_cast<uint8_t*>(m_data), m_size);
+#endif
+	}
+	m_data = nullptr;
+	m_size = 0;
+	m_mapped = false;
+	m_contents.clear();
+}
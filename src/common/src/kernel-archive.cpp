@@ -0,0 +1,337 @@
+#include <slang-webgpu/common/kernel-archive.h>
+
+#include <algorithm>
+#include <cstring>
+
+namespace {
+
+/**
+ * On-disk layout of the archive. All offsets are absolute byte offsets in
+ * the file, and all structures are 8-byte aligned.
+ */
+constexpr char Magic[8] = { 'S', 'W', 'G', 'P', 'U', 'K', 'A', '\0' };
+
+struct FileRange {
+	uint64_t offset;
+	uint64_t size;
+};
+
+struct FileHeader {
+	char magic[8];
+	uint32_t version;
+	uint32_t kernelCount;
+	FileRange kernels;
+	FileRange entryPoints;
+	FileRange bindings;
+	uint64_t fileSize;
+};
+
+struct FileKernel {
+	FileRange name;
+	FileRange source;
+	uint32_t sourceFormat;
+	uint32_t firstEntryPoint;
+	uint32_t entryPointCount;
+	uint32_t firstBinding;
+	uint32_t bindingCount;
+	uint32_t reserved;
+};
+
+struct FileEntryPoint {
+	FileRange name;
+	uint32_t workgroupSize[3];
+	uint32_t reserved;
+};
+
+struct FileBinding {
+	FileRange name;
+	uint64_t minBindingSize;
+	uint32_t binding;
+	uint32_t type;
+};
+
+static_assert(sizeof(FileHeader) == 72);
+static_assert(sizeof(FileKernel) == 56);
+static_assert(sizeof(FileEntryPoint) == 32);
+static_assert(sizeof(FileBinding) == 32);
+
+size_t alignUp(size_t x) {
+	return (x + 7) & ~size_t(7);
+}
+
+/**
+ * Incrementally builds the archive bytes.
+ */
+class Writer {
+public:
+	size_t append(const void* data, size_t size) {
+		size_t offset = m_bytes.size();
+		m_bytes.resize(alignUp(offset + size), 0);
+		if (size > 0) std::memcpy(m_bytes.data() + offset, data, size);
+		return offset;
+	}
+
+	FileRange appendString(std::string_view str) {
+		return FileRange{ append(str.data(), str.size()), str.size() };
+	}
+
+	template <typename T>
+	void write(size_t offset, const T& value) {
+		std::memcpy(m_bytes.data() + offset, &value, sizeof(T));
+	}
+
+	std::vector<uint8_t>& bytes() { return m_bytes; }
+
+private:
+	std::vector<uint8_t> m_bytes;
+};
+
+template <typename T>
+T readAt(const uint8_t* data, uint64_t offset) {
+	T value;
+	std::memcpy(&value, data + offset, sizeof(T));
+	return value;
+}
+
+bool isInRange(const FileRange& range, size_t fileSize) {
+	return range.offset <= fileSize && range.size <= fileSize - range.offset;
+}
+
+const char* bindingTypeName(KernelBindingType type) {
+	switch (type) {
+	case KernelBindingType::Uniform:
+		return "Uniform";
+	case KernelBindingType::ReadOnlyStorage:
+		return "ReadOnlyStorage";
+	case KernelBindingType::Storage:
+	default:
+		return "Storage";
+	}
+}
+
+} // anonymous namespace
+
+std::string bindingSignature(const std::vector<KernelBindingInfo>& bindings) {
+	std::string signature;
+	for (const KernelBindingInfo& binding : bindings) {
+		if (!signature.empty()) signature += ";";
+		signature += std::to_string(binding.binding) + ":" + bindingTypeName(binding.type);
+		if (binding.minBindingSize > 0) {
+			signature += ":" + std::to_string(binding.minBindingSize);
+		}
+		if (binding.hasDynamicOffset) {
+			signature += ":dynamic";
+		}
+	}
+	return signature;
+}
+
+Result<std::vector<uint8_t>, Error> serializeKernelArchive(
+	const std::vector<KernelDescription>& kernels
+) {
+	// Kernels are sorted by name to enable binary search
+	std::vector<const KernelDescription*> sorted;
+	for (const KernelDescription& kernel : kernels) {
+		sorted.push_back(&kernel);
+	}
+	std::sort(sorted.begin(), sorted.end(), [](const KernelDescription* a, const KernelDescription* b) {
+		return a->name < b->name;
+	});
+	for (size_t i = 1; i < sorted.size(); ++i) {
+		TRY_ASSERT(sorted[i - 1]->name != sorted[i]->name, "Kernel '" << sorted[i]->name << "' appears twice in archive");
+	}
+
+	Writer writer;
+	FileHeader header = {};
+	std::memcpy(header.magic, Magic, sizeof(Magic));
+	header.version = KernelArchiveVersion;
+	header.kernelCount = (uint32_t)sorted.size();
+	writer.append(&header, sizeof(FileHeader));
+
+	std::vector<FileKernel> fileKernels;
+	std::vector<FileEntryPoint> fileEntryPoints;
+	std::vector<FileBinding> fileBindings;
+	for (const KernelDescription* kernel : sorted) {
+		FileKernel fileKernel = {};
+		fileKernel.name = writer.appendString(kernel->name);
+		fileKernel.source = writer.appendString(kernel->source);
+		fileKernel.sourceFormat = (uint32_t)kernel->sourceFormat;
+		fileKernel.firstEntryPoint = (uint32_t)fileEntryPoints.size();
+		fileKernel.entryPointCount = (uint32_t)kernel->entryPoints.size();
+		fileKernel.firstBinding = (uint32_t)fileBindings.size();
+		fileKernel.bindingCount = (uint32_t)kernel->bindings.size();
+		for (const KernelEntryPointInfo& entryPoint : kernel->entryPoints) {
+			FileEntryPoint fileEntryPoint = {};
+			fileEntryPoint.name = writer.appendString(entryPoint.name);
+			std::copy(entryPoint.workgroupSize.begin(), entryPoint.workgroupSize.end(), fileEntryPoint.workgroupSize);
+			fileEntryPoints.push_back(fileEntryPoint);
+		}
+		for (const KernelBindingInfo& binding : kernel->bindings) {
+			FileBinding fileBinding = {};
+			fileBinding.name = writer.appendString(binding.name);
+			fileBinding.minBindingSize = binding.minBindingSize;
+			fileBinding.binding = binding.binding;
+			fileBinding.type = (uint32_t)binding.type;
+			fileBindings.push_back(fileBinding);
+		}
+		fileKernels.push_back(fileKernel);
+	}
+
+	header.kernels = { writer.append(fileKernels.data(), fileKernels.size() * sizeof(FileKernel)), fileKernels.size() * sizeof(FileKernel) };
+	header.entryPoints = { writer.append(fileEntryPoints.data(), fileEntryPoints.size() * sizeof(FileEntryPoint)), fileEntryPoints.size() * sizeof(FileEntryPoint) };
+	header.bindings = { writer.append(fileBindings.data(), fileBindings.size() * sizeof(FileBinding)), fileBindings.size() * sizeof(FileBinding) };
+	header.fileSize = writer.bytes().size();
+	writer.write(0, header);
+
+	return std::move(writer.bytes());
+}
+
+Result<Void, Error> saveKernelArchive(
+	const std::filesystem::path& path,
+	const std::vector<KernelDescription>& kernels
+) {
+	std::vector<uint8_t> bytes;
+	TRY_ASSIGN(bytes, serializeKernelArchive(kernels));
+	return saveBinaryFile(path, bytes.data(), bytes.size());
+}
+
+Result<KernelArchive, Error> KernelArchive::open(const std::filesystem::path& path) {
+	KernelArchive archive;
+	TRY_ASSIGN(archive.m_file, MappedFile::open(path));
+	auto maybeError = archive.validate();
+	if (isError(maybeError)) {
+		return Error{ "Invalid kernel archive '" + path.string() + "': " + std::get<Error>(maybeError).message };
+	}
+	return archive;
+}
+
+Result<KernelArchive, Error> KernelArchive::fromMemory(std::vector<uint8_t> data) {
+	KernelArchive archive;
+	archive.m_memory = std::move(data);
+	auto maybeError = archive.validate();
+	if (isError(maybeError)) {
+		return Error{ "Invalid kernel archive: " + std::get<Error>(maybeError).message };
+	}
+	return archive;
+}
+
+const uint8_t* KernelArchive::data() const {
+	return m_memory.empty() ? m_file.data() : m_memory.data();
+}
+
+size_t KernelArchive::size() const {
+	return m_memory.empty() ? m_file.size() : m_memory.size();
+}
+
+Result<Void, Error> KernelArchive::validate() const {
+	const uint8_t* bytes = data();
+	size_t fileSize = size();
+	TRY_ASSERT(fileSize >= sizeof(FileHeader), "File is too small");
+	FileHeader header = readAt<FileHeader>(bytes, 0);
+	TRY_ASSERT(std::memcmp(header.magic, Magic, sizeof(Magic)) == 0, "Not a kernel archive");
+	TRY_ASSERT(header.version == KernelArchiveVersion, "Unsupported version " << header.version << " (expected " << KernelArchiveVersion << ")");
+	TRY_ASSERT(header.fileSize == fileSize, "File is truncated");
+
+	TRY_ASSERT(isInRange(header.kernels, fileSize) && header.kernels.size == header.kernelCount * sizeof(FileKernel), "Invalid kernel table");
+	TRY_ASSERT(isInRange(header.entryPoints, fileSize) && header.entryPoints.size % sizeof(FileEntryPoint) == 0, "Invalid entry point table");
+	TRY_ASSERT(isInRange(header.bindings, fileSize) && header.bindings.size % sizeof(FileBinding) == 0, "Invalid binding table");
+	uint64_t entryPointCount = header.entryPoints.size / sizeof(FileEntryPoint);
+	uint64_t bindingCount = header.bindings.size / sizeof(FileBinding);
+
+	std::string_view previousName;
+	for (uint32_t i = 0; i < header.kernelCount; ++i) {
+		FileKernel kernel = readAt<FileKernel>(bytes, header.kernels.offset + i * sizeof(FileKernel));
+		TRY_ASSERT(isInRange(kernel.name, fileSize) && isInRange(kernel.source, fileSize), "Kernel #" << i << " is out of bounds");
+		TRY_ASSERT(kernel.sourceFormat <= (uint32_t)KernelSourceFormat::SpirV, "Kernel #" << i << " has an unknown source format");
+		TRY_ASSERT((uint64_t)kernel.firstEntryPoint + kernel.entryPointCount <= entryPointCount, "Kernel #" << i << " has invalid entry points");
+		TRY_ASSERT((uint64_t)kernel.firstBinding + kernel.bindingCount <= bindingCount, "Kernel #" << i << " has invalid bindings");
+		std::string_view name(reinterpret_cast<const char*>(bytes + kernel.name.offset), kernel.name.size);
+		TRY_ASSERT(i == 0 || previousName < name, "Kernels are not sorted by name");
+		previousName = name;
+	}
+	for (uint64_t i = 0; i < entryPointCount; ++i) {
+		FileEntryPoint entryPoint = readAt<FileEntryPoint>(bytes, header.entryPoints.offset + i * sizeof(FileEntryPoint));
+		TRY_ASSERT(isInRange(entryPoint.name, fileSize), "Entry point #" << i << " is out of bounds");
+	}
+	for (uint64_t i = 0; i < bindingCount; ++i) {
+		FileBinding binding = readAt<FileBinding>(bytes, header.bindings.offset + i * sizeof(FileBinding));
+		TRY_ASSERT(isInRange(binding.name, fileSize), "Binding #" << i << " is out of bounds");
+		TRY_ASSERT(binding.type <= (uint32_t)KernelBindingType::ReadOnlyStorage, "Binding #" << i << " has an unknown type");
+	}
+	return {};
+}
+
+size_t KernelArchive::kernelCount() const {
+	if (size() == 0) return 0;
+	return readAt<FileHeader>(data(), 0).kernelCount;
+}
+
+std::string_view KernelArchive::kernelName(size_t index) const {
+	const uint8_t* bytes = data();
+	FileHeader header = readAt<FileHeader>(bytes, 0);
+	FileKernel kernel = readAt<FileKernel>(bytes, header.kernels.offset + index * sizeof(FileKernel));
+	return std::string_view(reinterpret_cast<const char*>(bytes + kernel.name.offset), kernel.name.size);
+}
+
+KernelView KernelArchive::kernel(size_t index) const {
+	const uint8_t* bytes = data();
+	FileHeader header = readAt<FileHeader>(bytes, 0);
+	FileKernel fileKernel = readAt<FileKernel>(bytes, header.kernels.offset + index * sizeof(FileKernel));
+	auto str = [bytes](const FileRange& range) {
+		return std::string_view(reinterpret_cast<const char*>(bytes + range.offset), range.size);
+	};
+
+	KernelView kernel;
+	kernel.name = str(fileKernel.name);
+	kernel.sourceFormat = (KernelSourceFormat)fileKernel.sourceFormat;
+	kernel.source = str(fileKernel.source);
+	for (uint32_t i = 0; i < fileKernel.entryPointCount; ++i) {
+		FileEntryPoint fileEntryPoint = readAt<FileEntryPoint>(bytes, header.entryPoints.offset + (fileKernel.firstEntryPoint + i) * sizeof(FileEntryPoint));
+		KernelEntryPointInfo entryPoint;
+		entryPoint.name = str(fileEntryPoint.name);
+		std::copy(fileEntryPoint.workgroupSize, fileEntryPoint.workgroupSize + 3, entryPoint.workgroupSize.begin());
+		kernel.entryPoints.push_back(entryPoint);
+	}
+	for (uint32_t i = 0; i < fileKernel.bindingCount; ++i) {
+		FileBinding fileBinding = readAt<FileBinding>(bytes, header.bindings.offset + (fileKernel.firstBinding + i) * sizeof(FileBinding));
+		KernelBindingInfo binding;
+		binding.name = str(fileBinding.name);
+		binding.binding = fileBinding.binding;
+		binding.type = (KernelBindingType)fileBinding.type;
+		binding.minBindingSize = fileBinding.minBindingSize;
+		kernel.bindings.push_back(binding);
+	}
+	return kernel;
+}
+
+std::optional<size_t> KernelArchive::findKernel(std::string_view name) const {
+	size_t begin = 0;
+	size_t end = kernelCount();
+	while (begin < end) {
+		size_t middle = begin + (end - begin) / 2;
+		std::string_view middleName = kernelName(middle);
+		if (middleName == name) return middle;
+		if (middleName < name) {
+			begin = middle + 1;
+		}
+		else {
+			end = middle;
+		}
+	}
+	return std::nullopt;
+}
+
+std::vector<KernelDescription> KernelArchive::kernels() const {
+	std::vector<KernelDescription> descriptions;
+	for (size_t i = 0; i < kernelCount(); ++i) {
+		KernelView view = kernel(i);
+		KernelDescription description;
+		description.name = view.name;
+		description.sourceFormat = view.sourceFormat;
+		description.source = view.source;
+		description.entryPoints = view.entryPoints;
+		description.bindings = view.bindings;
+		descriptions.push_back(description);
+	}
+	return descriptions;
+}
@@ -0,0 +1,349 @@
+#include <slang-webgpu/common/logger.h>
+
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+// Without threads, messages are always written synchronously
+#if defined(__EMSCRIPTEN__) && !defined(__EMSCRIPTEN_PTHREADS__)
+#define SLANG_WEBGPU_LOG_SYNCHRONOUS_ONLY
+#endif
+
+namespace {
+
+std::atomic<int> s_output = static_cast<int>(Logger::Output::Stdout);
+std::atomic<int> s_format = static_cast<int>(Logger::Format::Text);
+std::atomic<bool> s_asynchronous = true;
+// Keeps lines written synchronously from different threads apart
+std::mutex s_writeMutex;
+
+std::ostream& outputStream() {
+	return static_cast<Logger::Output>(s_output.load()) == Logger::Output::Stderr ? std::cerr : std::cout;
+}
+
+void writeRecord(std::ostream& out, const Logger::Record& record) {
+	if (static_cast<Logger::Format>(s_format.load()) == Logger::Format::Json) {
+		out << Logger::formatJson(record) << '\n';
+	}
+	else {
+		out << Logger::formatText(record) << '\n';
+	}
+}
+
+void writeSynchronously(const Logger::Record& record) {
+	std::lock_guard lock(s_writeMutex);
+	std::ostream& out = outputStream();
+	writeRecord(out, record);
+	out.flush();
+}
+
+#ifndef SLANG_WEBGPU_LOG_SYNCHRONOUS_ONLY
+
+// Set once the sink thread has been started, and once it is stopped during
+// static destruction. Messages logged after that are written synchronously.
+std::atomic<bool> s_sinkStarted = false;
+std::atomic<bool> s_sinkStopped = false;
+
+/**
+ * Bounded queue where any thread may push and a single thread pops, without
+ * locks (after Dmitry Vyukov's bounded MPMC queue): each slot has a sequence
+ * number that tells whether it is free for the producer of a given position,
+ * or ready for the consumer.
+ */
+class RingBuffer {
+public:
+	explicit RingBuffer(size_t capacity) // must be a power of two
+		: m_slots(std::make_unique<Slot[]>(capacity))
+		, m_mask(capacity - 1)
+	{
+		for (size_t i = 0; i < capacity; ++i) {
+			m_slots[i].sequence.store(i, std::memory_order_relaxed);
+		}
+	}
+
+	/**
+	 * Move 'record' into the buffer, or return false if it is full.
+	 */
+	bool tryPush(Logger::Record& record) {
+		size_t position = m_pushPosition.load(std::memory_order_relaxed);
+		for (;;) {
+			Slot& slot = m_slots[position & m_mask];
+			size_t sequence = slot.sequence.load(std::memory_order_acquire);
+			auto diff = static_cast<std::ptrdiff_t>(sequence - position);
+			if (diff == 0) {
+				if (m_pushPosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+					slot.record = std::move(record);
+					slot.sequence.store(position + 1, std::memory_order_release);
+					return true;
+				}
+			}
+			else if (diff < 0) {
+				return false;
+			}
+			else {
+				position = m_pushPosition.load(std::memory_order_relaxed);
+			}
+		}
+	}
+
+	/**
+	 * Only called by the consumer thread.
+	 */
+	bool tryPop(Logger::Record& record) {
+		Slot& slot = m_slots[m_popPosition & m_mask];
+		size_t sequence = slot.sequence.load(std::memory_order_acquire);
+		if (static_cast<std::ptrdiff_t>(sequence - (m_popPosition + 1)) < 0) return false;
+		record = std::move(slot.record);
+		slot.sequence.store(m_popPosition + m_mask + 1, std::memory_order_release);
+		++m_popPosition;
+		return true;
+	}
+
+	/**
+	 * Number of records pushed (or being pushed) so far.
+	 */
+	size_t pushedCount() const {
+		return m_pushPosition.load(std::memory_order_seq_cst);
+	}
+
+private:
+	struct Slot {
+		std::atomic<size_t> sequence;
+		Logger::Record record;
+	};
+
+	std::unique_ptr<Slot[]> m_slots;
+	size_t m_mask;
+	// Producers and consumer write to different cache lines
+	alignas(64) std::atomic<size_t> m_pushPosition = 0;
+	alignas(64) size_t m_popPosition = 0;
+};
+
+/**
+ * Background thread that drains the ring buffer into the output.
+ */
+class AsyncSink {
+public:
+	static constexpr size_t Capacity = 4096;
+
+	AsyncSink()
+		: m_buffer(Capacity)
+	{
+		m_thread = std::thread([this]() { run(); });
+	}
+
+	~AsyncSink() {
+		s_sinkStopped = true;
+		{
+			std::lock_guard lock(m_mutex);
+			m_stopping = true;
+		}
+		m_wakeUp.notify_one();
+		m_thread.join();
+	}
+
+	void push(Logger::Record record) {
+		// When the buffer is full, the logging thread waits for the sink
+		// rather than dropping messages.
+		while (!m_buffer.tryPush(record)) {
+			wakeUp();
+			std::this_thread::yield();
+		}
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		if (m_sleeping.load(std::memory_order_seq_cst)) {
+			wakeUp();
+		}
+	}
+
+	void flush() {
+		size_t target = m_buffer.pushedCount();
+		while (m_written.load(std::memory_order_acquire) < target) {
+			wakeUp();
+			std::this_thread::yield();
+		}
+	}
+
+private:
+	void wakeUp() {
+		// Taking the lock ensures that the sink is either not sleeping yet (and
+		// will see the new records) or already waiting (and gets notified).
+		{
+			std::lock_guard lock(m_mutex);
+		}
+		m_wakeUp.notify_one();
+	}
+
+	void run() {
+		for (;;) {
+			if (drain() > 0) continue;
+
+			std::unique_lock lock(m_mutex);
+			if (m_stopping) break;
+			m_sleeping.store(true, std::memory_order_seq_cst);
+			if (m_written.load(std::memory_order_relaxed) == m_buffer.pushedCount()) {
+				// The timeout only matters if a record is pushed while this
+				// thread is about to sleep.
+				m_wakeUp.wait_for(lock, std::chrono::milliseconds(50));
+			}
+			m_sleeping.store(false, std::memory_order_relaxed);
+		}
+		drain();
+	}
+
+	/**
+	 * Write all records available, then flush the output once.
+	 */
+	size_t drain() {
+		size_t count = 0;
+		Logger::Record record;
+		std::lock_guard lock(s_writeMutex);
+		std::ostream& out = outputStream();
+		while (m_buffer.tryPop(record)) {
+			writeRecord(out, record);
+			++count;
+		}
+		if (count > 0) {
+			out.flush();
+			m_written.fetch_add(count, std::memory_order_release);
+		}
+		return count;
+	}
+
+private:
+	RingBuffer m_buffer;
+	std::atomic<size_t> m_written = 0;
+	std::atomic<bool> m_sleeping = false;
+	std::mutex m_mutex;
+	std::condition_variable m_wakeUp;
+	bool m_stopping = false;
+	std::thread m_thread;
+};
+
+AsyncSink& sink() {
+	static AsyncSink s_sink;
+	s_sinkStarted = true;
+	return s_sink;
+}
+
+#endif // SLANG_WEBGPU_LOG_SYNCHRONOUS_ONLY
+
+std::string escapeJson(const std::string& value) {
+	static const char* hexDigits = "0123456789abcdef";
+	std::string escaped;
+	escaped.reserve(value.size());
+	for (char c : value) {
+		switch (c) {
+		case '"': escaped += "\\\""; break;
+		case '\\': escaped += "\\\\"; break;
+		case '\n': escaped += "\\n"; break;
+		case '\r': escaped += "\\r"; break;
+		case '\t': escaped += "\\t"; break;
+		default:
+			if (static_cast<unsigned char>(c) < 0x20) {
+				escaped += "\\u00";
+				escaped += hexDigits[(c >> 4) & 0xf];
+				escaped += hexDigits[c & 0xf];
+			}
+			else {
+				escaped += c;
+			}
+		}
+	}
+	return escaped;
+}
+
+} // anonymous namespace
+
+Logger::~Logger() {
+	Record record;
+	record.level = m_level;
+	record.file = m_file;
+	record.line = m_line;
+	record.timestamp = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(
+		std::chrono::system_clock::now().time_since_epoch()
+	).count());
+	record.thread = static_cast<uint64_t>(std::hash<std::thread::id>{}(std::this_thread::get_id()));
+	record.message = m_stream.str();
+
+	LogCapture* capture = LogCapture::current();
+	if (capture) {
+		capture->add(std::move(record));
+	}
+	else {
+		write(std::move(record));
+	}
+}
+
+void Logger::configure(const Options& options) {
+	// Messages logged so far are written with the previous settings
+	flush();
+	s_level = static_cast<int>(options.level);
+	s_output = static_cast<int>(options.output);
+	s_format = static_cast<int>(options.format);
+	s_asynchronous = options.asynchronous;
+}
+
+void Logger::setLevel(Level level) {
+	s_level = static_cast<int>(level);
+}
+
+void Logger::flush() {
+#ifndef SLANG_WEBGPU_LOG_SYNCHRONOUS_ONLY
+	if (s_sinkStarted && !s_sinkStopped) {
+		sink().flush();
+	}
+#endif // SLANG_WEBGPU_LOG_SYNCHRONOUS_ONLY
+}
+
+void Logger::write(Record record) {
+#ifndef SLANG_WEBGPU_LOG_SYNCHRONOUS_ONLY
+	if (s_asynchronous && !s_sinkStopped) {
+		bool isError = record.level == Level::ERROR;
+		sink().push(std::move(record));
+		if (isError) sink().flush();
+		return;
+	}
+#endif // SLANG_WEBGPU_LOG_SYNCHRONOUS_ONLY
+	writeSynchronously(record);
+}
+
+const char* Logger::levelName(Level level) {
+	switch (level) {
+	case Level::ERROR: return "ERROR";
+	case Level::WARNING: return "WARNING";
+	case Level::INFO: return "INFO";
+	case Level::DEBUG: return "DEBUG";
+	}
+	return "";
+}
+
+std::string Logger::formatText(const Record& record) {
+	std::ostringstream out;
+	switch (record.level) {
+	case Level::ERROR:
+	case Level::WARNING:
+	case Level::INFO:
+		out << levelName(record.level) << ": " << record.message;
+		break;
+	case Level::DEBUG:
+		out << "DEBUG(" << record.file << ", line" << record.line << "): " << record.message;
+		break;
+	}
+	return out.str();
+}
+
+std::string Logger::formatJson(const Record& record) {
+	std::ostringstream out;
+	out
+		<< "{\"time_us\":" << record.timestamp
+		<< ",\"level\":\"" << levelName(record.level)
+		<< "\",\"thread\":" << record.thread
+		<< ",\"file\":\"" << escapeJson(record.file)
+		<< "\",\"line\":" << record.line
+		<< ",\"message\":\"" << escapeJson(record.message)
+		<< "\"}";
+	return out.str();
+}
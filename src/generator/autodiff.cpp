@@ -0,0 +1,229 @@
+#include "autodiff.h"
+
+#include <sstream>
+
+size_t DifferentiableFunction::sharedParameterCount() const {
+	size_t count = 0;
+	for (const DifferentiableParameter& parameter : parameters) {
+		if (parameter.isShared) ++count;
+	}
+	return count;
+}
+
+bool DifferentiableFunction::needsReduction() const {
+	return accumulation == GradientAccumulation::Workgroup && sharedParameterCount() > 0;
+}
+
+std::vector<std::string> DifferentiableFunction::entryPoints() const {
+	std::vector<std::string> names = { forwardEntryPoint(), backwardEntryPoint() };
+	if (needsReduction()) {
+		names.push_back(reduceEntryPoint());
+	}
+	return names;
+}
+
+Result<GradientAccumulation, Error> parseGradientAccumulation(
+	const std::string& mode
+) {
+	if (mode == "atomic") return GradientAccumulation::Atomic;
+	if (mode == "workgroup") return GradientAccumulation::Workgroup;
+	return Error{ "Invalid gradient accumulation mode '" + mode + "', expected 'atomic' or 'workgroup'" };
+}
+
+const char* gradientAccumulationName(
+	GradientAccumulation mode
+) {
+	switch (mode) {
+	case GradientAccumulation::Atomic:
+		return "atomic";
+	case GradientAccumulation::Workgroup:
+		return "workgroup";
+	}
+	return "";
+}
+
+namespace {
+
+/**
+ * Emit a tree reduction of 'scratch' within a workgroup, for 'stride' values
+ * per thread. The workgroup size must be a power of two.
+ */
+void writeTreeReduction(std::ostringstream& out, const std::string& scratch, uint32_t workgroupSize, size_t stride) {
+	out << "\tGroupMemoryBarrierWithGroupSync();\n";
+	out << "\tfor (uint s = " << workgroupSize / 2 << "; s > 0; s /= 2)\n";
+	out << "\t{\n";
+	out << "\t\tif (groupIndex < s)\n";
+	out << "\t\t{\n";
+	if (stride == 1) {
+		out << "\t\t\t" << scratch << "[groupIndex] += " << scratch << "[groupIndex + s];\n";
+	}
+	else {
+		out << "\t\t\tfor (uint j = 0; j < " << stride << "; ++j)\n";
+		out << "\t\t\t{\n";
+		out << "\t\t\t\t" << scratch << "[groupIndex * " << stride << " + j] += " << scratch << "[(groupIndex + s) * " << stride << " + j];\n";
+		out << "\t\t\t}\n";
+	}
+	out << "\t\t}\n";
+	out << "\t\tGroupMemoryBarrierWithGroupSync();\n";
+	out << "\t}\n";
+}
+
+} // anonymous namespace
+
+std::string generateAutodiffKernels(
+	const DifferentiableFunction& function
+) {
+	const std::string& f = function.name;
+	const uint32_t wg = function.workgroupSize;
+	const size_t sharedCount = function.sharedParameterCount();
+	const bool atomic = function.accumulation == GradientAccumulation::Atomic;
+	const std::string count = f + "_count";
+	const std::string partials = f + "_partialGrads";
+	const std::string scratch = f + "_scratch";
+
+	std::ostringstream out;
+	out << "\n";
+	out << "// Autodiff kernels generated by slang_webgpu_generator for '" << f << "'\n";
+	out << "// (gradient accumulation: " << gradientAccumulationName(function.accumulation) << ")\n";
+
+	// Buffers
+	for (const DifferentiableParameter& parameter : function.parameters) {
+		out << "StructuredBuffer<float> " << function.bufferName(parameter.name) << ";\n";
+	}
+	out << "RWStructuredBuffer<float> " << function.bufferName("result") << ";\n";
+	out << "StructuredBuffer<float> " << function.gradientBufferName("result") << ";\n";
+	for (const DifferentiableParameter& parameter : function.parameters) {
+		// Shared gradients accumulated with atomics hold the bits of a float
+		const char* type = parameter.isShared && atomic ? "uint" : "float";
+		out << "RWStructuredBuffer<" << type << "> " << function.gradientBufferName(parameter.name) << ";\n";
+	}
+	if (function.needsReduction()) {
+		out << "RWStructuredBuffer<float> " << partials << ";\n";
+		out << "groupshared float " << scratch << "[" << wg * sharedCount << "];\n";
+	}
+	out << "uniform uint " << count << ";\n";
+
+	// Forward
+	out << "\n";
+	out << "[shader(\"compute\")]\n";
+	out << "[numthreads(" << wg << ", 1, 1)]\n";
+	out << "void " << function.forwardEntryPoint() << "(uint3 threadId : SV_DispatchThreadID)\n";
+	out << "{\n";
+	out << "\tuint index = threadId.x;\n";
+	out << "\tif (index >= " << count << ") return;\n";
+	out << "\t" << function.bufferName("result") << "[index] = " << f << "(";
+	for (size_t i = 0; i < function.parameters.size(); ++i) {
+		const DifferentiableParameter& parameter = function.parameters[i];
+		if (i > 0) out << ", ";
+		out << function.bufferName(parameter.name) << "[" << (parameter.isShared ? "0" : "index") << "]";
+	}
+	out << ");\n";
+	out << "}\n";
+
+	// Atomic accumulation helpers (WGSL has no floating point atomics)
+	if (atomic) {
+		for (const DifferentiableParameter& parameter : function.parameters) {
+			if (!parameter.isShared) continue;
+			std::string buffer = function.gradientBufferName(parameter.name);
+			out << "\n";
+			out << "void " << buffer << "_atomicAdd(float value)\n";
+			out << "{\n";
+			out << "\tuint expected = 0;\n";
+			out << "\tfor (;;)\n";
+			out << "\t{\n";
+			out << "\t\tuint original;\n";
+			out << "\t\tInterlockedCompareExchange(" << buffer << "[0], expected, asuint(asfloat(expected) + value), original);\n";
+			out << "\t\tif (original == expected) break;\n";
+			out << "\t\texpected = original;\n";
+			out << "\t}\n";
+			out << "}\n";
+		}
+	}
+
+	// Backward
+	out << "\n";
+	out << "[shader(\"compute\")]\n";
+	out << "[numthreads(" << wg << ", 1, 1)]\n";
+	out << "void " << function.backwardEntryPoint() << "(uint3 threadId : SV_DispatchThreadID, uint3 groupId : SV_GroupID, uint groupIndex : SV_GroupIndex)\n";
+	out << "{\n";
+	out << "\tuint index = threadId.x;\n";
+	if (function.needsReduction()) {
+		out << "\t// Threads past the end still take part in the workgroup reduction,\n";
+		out << "\t// with a null output gradient so that they contribute zero.\n";
+	}
+	out << "\tbool active = index < " << count << ";\n";
+	out << "\tuint readIndex = active ? index : 0;\n";
+	for (const DifferentiableParameter& parameter : function.parameters) {
+		out << "\tvar dp_" << parameter.name << " = diffPair(" << function.bufferName(parameter.name) << "[" << (parameter.isShared ? "0" : "readIndex") << "], 0.0);\n";
+	}
+	out << "\tfloat dResult = active ? " << function.gradientBufferName("result") << "[readIndex] : 0.0;\n";
+	out << "\tbwd_diff(" << f << ")(";
+	for (const DifferentiableParameter& parameter : function.parameters) {
+		out << "dp_" << parameter.name << ", ";
+	}
+	out << "dResult);\n";
+	out << "\n";
+
+	out << "\tif (active)\n";
+	out << "\t{\n";
+	for (const DifferentiableParameter& parameter : function.parameters) {
+		if (parameter.isShared) {
+			if (atomic) {
+				out << "\t\t" << function.gradientBufferName(parameter.name) << "_atomicAdd(dp_" << parameter.name << ".d);\n";
+			}
+		}
+		else {
+			out << "\t\t" << function.gradientBufferName(parameter.name) << "[index] = dp_" << parameter.name << ".d;\n";
+		}
+	}
+	out << "\t}\n";
+
+	if (function.needsReduction()) {
+		out << "\n";
+		size_t k = 0;
+		for (const DifferentiableParameter& parameter : function.parameters) {
+			if (!parameter.isShared) continue;
+			out << "\t" << scratch << "[groupIndex * " << sharedCount << " + " << k << "] = dp_" << parameter.name << ".d;\n";
+			++k;
+		}
+		writeTreeReduction(out, scratch, wg, sharedCount);
+		out << "\tif (groupIndex == 0)\n";
+		out << "\t{\n";
+		out << "\t\tfor (uint j = 0; j < " << sharedCount << "; ++j)\n";
+		out << "\t\t{\n";
+		out << "\t\t\t" << partials << "[groupId.x * " << sharedCount << " + j] = " << scratch << "[j];\n";
+		out << "\t\t}\n";
+		out << "\t}\n";
+	}
+	out << "}\n";
+
+	// Reduction of per-workgroup partial sums, one workgroup per shared parameter
+	if (function.needsReduction()) {
+		out << "\n";
+		out << "[shader(\"compute\")]\n";
+		out << "[numthreads(" << wg << ", 1, 1)]\n";
+		out << "void " << function.reduceEntryPoint() << "(uint3 groupId : SV_GroupID, uint groupIndex : SV_GroupIndex)\n";
+		out << "{\n";
+		out << "\tuint k = groupId.x;\n";
+		out << "\tuint partialCount = (" << count << " + " << wg - 1 << ") / " << wg << ";\n";
+		out << "\tfloat sum = 0.0;\n";
+		out << "\tfor (uint i = groupIndex; i < partialCount; i += " << wg << ")\n";
+		out << "\t{\n";
+		out << "\t\tsum += " << partials << "[i * " << sharedCount << " + k];\n";
+		out << "\t}\n";
+		out << "\t" << scratch << "[groupIndex] = sum;\n";
+		writeTreeReduction(out, scratch, wg, 1);
+		out << "\tif (groupIndex == 0)\n";
+		out << "\t{\n";
+		size_t sharedIndex = 0;
+		for (const DifferentiableParameter& parameter : function.parameters) {
+			if (!parameter.isShared) continue;
+			out << "\t\t" << (sharedIndex > 0 ? "else if" : "if") << " (k == " << sharedIndex << ") " << function.gradientBufferName(parameter.name) << "[0] = " << scratch << "[0];\n";
+			++sharedIndex;
+		}
+		out << "\t}\n";
+		out << "}\n";
+	}
+
+	return out.str();
+}
@@ -0,0 +1,79 @@
+#pragma once
+
+#include <slang-webgpu/common/result.h>
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ * Generation of forward and backward kernels for a [Differentiable] function
+ * of the form 'float f(float a, float b, ...)'.
+ *
+ * Each parameter is read from a buffer of the same name prefixed with the
+ * function name (e.g., 'f_a'), and the result is written to 'f_result'. By
+ * default, parameters are per-element: thread i reads 'f_a[i]' and the
+ * backward kernel writes its gradient into 'f_aGrad[i]'. Shared parameters are
+ * the same for all elements (thread i reads 'f_a[0]'), so their gradient is a
+ * sum over all elements, which is accumulated either with atomics, or with a
+ * per-workgroup partial sum followed by a reduction pass.
+ */
+
+enum class GradientAccumulation {
+	Atomic,
+	Workgroup,
+};
+
+struct DifferentiableParameter {
+	std::string name;
+	bool isShared = false;
+};
+
+struct DifferentiableFunction {
+	std::string name;
+	std::vector<DifferentiableParameter> parameters;
+	GradientAccumulation accumulation = GradientAccumulation::Workgroup;
+	uint32_t workgroupSize = 64;
+
+	std::string forwardEntryPoint() const { return name + "Forward"; }
+	std::string backwardEntryPoint() const { return name + "Backward"; }
+	std::string reduceEntryPoint() const { return name + "ReduceGradients"; }
+
+	/**
+	 * Name of the buffer binding that holds a parameter, or its gradient.
+	 */
+	std::string bufferName(const std::string& parameter) const { return name + "_" + parameter; }
+	std::string gradientBufferName(const std::string& parameter) const { return name + "_" + parameter + "Grad"; }
+
+	size_t sharedParameterCount() const;
+
+	/**
+	 * True if the gradients of shared parameters go through a reduction pass
+	 */
+	bool needsReduction() const;
+
+	/**
+	 * All generated entry points, in the order they must be dispatched
+	 */
+	std::vector<std::string> entryPoints() const;
+};
+
+/**
+ * Parse "atomic" or "workgroup"
+ */
+Result<GradientAccumulation, Error> parseGradientAccumulation(
+	const std::string& mode
+);
+
+const char* gradientAccumulationName(
+	GradientAccumulation mode
+);
+
+/**
+ * Generate the Slang source of the buffers and entry points used to evaluate
+ * and differentiate the function, to be appended to the module that defines
+ * the function.
+ */
+std::string generateAutodiffKernels(
+	const DifferentiableFunction& function
+);
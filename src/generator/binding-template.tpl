@@ -1,18 +1,52 @@
 [[header]]
 #pragma once
 
+#include <slang-webgpu/common/result.h>
 #include <slang-webgpu/common/kernel-utils.h>
+#include <slang-webgpu/runtime/device-registry.h>
+#include <slang-webgpu/runtime/bind-group-cache.h>
+#include <slang-webgpu/runtime/buffer-view.h>
+#include <slang-webgpu/runtime/compute-pipeline-set.h>
+#include <slang-webgpu/runtime/dispatch-recorder.h>
+#include <slang-webgpu/runtime/kernel-profiler.h>
 
 // NB: raii::Foo is the equivalent of Foo except its release()/addRef() methods
 // are automatically called
 #include <webgpu/webgpu-raii.hpp>
 
 #include <array>
+#include <memory>
+#include <vector>
 
 namespace generated {
 
+// This type may be defined by other generated kernels as well
+#ifndef GENERATED_{{bindGroupLayoutName}}
+#define GENERATED_{{bindGroupLayoutName}}
+/**
+ * The bind group layout shared by all generated kernels whose bindings are
+ * "{{bindGroupLayoutSignature}}". It is created only once per device, so a bind
+ * group created by any of these kernels may be used with all of them.
+ */
+class {{bindGroupLayoutName}} {
+public:
+	static constexpr const char* s_signature = "{{bindGroupLayoutSignature}}";
+
+	/**
+	 * Get the layout of a given device, creating it upon first call.
+	 */
+	static wgpu::raii::BindGroupLayout get(wgpu::Device device) {
+		std::vector<wgpu::BindGroupLayoutEntry> layoutEntries({{bindGroupEntryCount}}, wgpu::Default);
+		{{bindGroupLayoutEntries}}
+		return DeviceRegistry::get(device)->getOrCreateBindGroupLayout(s_signature, layoutEntries);
+	}
+};
+#endif // GENERATED_{{bindGroupLayoutName}}
+
 /**
  * A basic class that contains everything needed to dispatch a compute job.
+ *
+ * Slang compiler options: {{compilerOptions}}
  */
 class {{kernelName}}Kernel {
 	{{if hasUniforms}}
@@ -23,7 +57,88 @@ public:
 	{{uniformStructDefinition}}
 	{{end}}
 public:
-	{{kernelName}}Kernel(wgpu::Device device);
+	/**
+	 * Kernels that have the same shared bind group layout accept each other's
+	 * bind groups.
+	 */
+	using SharedBindGroupLayout = {{bindGroupLayoutName}};
+
+	/**
+	 * Index of each entry point, as expected by getPipeline() and
+	 * getWorkgroupSize().
+	 */
+	enum class EntryPoint : uint32_t {
+		{{foreach entryPoints}}
+		{{EntryPoint}} = {{entryPointIndex}},
+		{{end}}
+	};
+
+	/**
+	 * Load the kernel. With PipelineCreation::Async, pipelines are created in
+	 * the background: the kernel may be used right away, and dispatches wait
+	 * for the pipeline they need (or fail with Emscripten, see isReady()).
+	 * With PipelineCreation::Lazy, the pipeline of an entry point is only
+	 * created by its first dispatch (or getPipeline(), or prewarm()).
+	 */
+	{{kernelName}}Kernel(wgpu::Device device, PipelineCreation pipelineCreation = PipelineCreation::Immediate);
+
+	/**
+	 * Whether the pipelines of all entry points have been created. This is
+	 * always the case with PipelineCreation::Immediate. With
+	 * PipelineCreation::Lazy, only requested entry points are considered.
+	 */
+	bool isReady() const;
+
+	/**
+	 * Block until the pipelines of all entry points have been created, and
+	 * return an error if one of them could not be (see ComputePipelineSet).
+	 */
+	Result<Void, Error> waitUntilReady() const;
+
+	/**
+	 * Call 'callback' once all pipelines have been created, possibly from
+	 * another thread.
+	 */
+	void onReady(ComputePipelineSet::ReadyCallback callback) const;
+
+	/**
+	 * Start creating the pipelines of the given entry points, in the
+	 * background by default, so that their first dispatch does not wait for
+	 * them. Only useful with PipelineCreation::Lazy.
+	 */
+	Result<Void, Error> prewarm(
+		const std::vector<EntryPoint>& entryPoints,
+		PipelineCreation creation = PipelineCreation::Async
+	) const;
+
+	/**
+	 * Same as prewarm(), with entry points given by name (e.g., read from a
+	 * configuration file).
+	 */
+	Result<Void, Error> prewarm(
+		const std::vector<std::string>& entryPointNames,
+		PipelineCreation creation = PipelineCreation::Async
+	) const;
+
+	/**
+	 * A recorder batches dispatches of this and other kernels into a single
+	 * compute pass, submitted at once, and skips the setPipeline() and
+	 * setBindGroup() calls that would not change the state of the pass.
+	 */
+	using Recorder = DispatchRecorder;
+
+	/**
+	 * Create a recorder for the device of this kernel.
+	 */
+	Recorder createRecorder() const;
+
+	/**
+	 * Attach a profiler that counts and times the dispatches of this kernel
+	 * (see KernelProfiler), or detach it with nullptr. The profiler must be
+	 * detached before being destroyed if the kernel is still used.
+	 */
+	void setProfiler(KernelProfiler* profiler) { m_profiler = profiler; }
+	KernelProfiler* getProfiler() const { return m_profiler; }
 
 	/**
 	 * Create a bind group to be used with the dispatch methods of this kernel.
@@ -34,11 +149,42 @@ public:
 		{{bindGroupMembers}}
 	) const;
 
+	/**
+	 * Same as createBindGroup(), but the bind group is looked up in a cache
+	 * first, and only created (and added to the cache) if not found. The
+	 * cache may be shared with other kernels.
+	 */
+	wgpu::BindGroup getOrCreateBindGroup(
+		BindGroupCache& cache,
+		{{bindGroupMembers}}
+	) const;
+
+	/**
+	 * Variant of createBindGroup() that binds ranges of buffers, so that many
+	 * bindings may share the same allocation. A wgpu::Buffer may be given
+	 * wherever a BufferView is expected, to bind the whole buffer. Offsets
+	 * must be aligned to the device's minStorageBufferOffsetAlignment (or
+	 * minUniformBufferOffsetAlignment) and ranges must be at least as large as
+	 * required by the shader, otherwise an error is returned.
+	 */
+	Result<wgpu::BindGroup, Error> createBindGroup(
+		{{bindGroupViewMembers}}
+	) const;
+
+	/**
+	 * Variant of getOrCreateBindGroup() that binds ranges of buffers.
+	 */
+	Result<wgpu::BindGroup, Error> getOrCreateBindGroup(
+		BindGroupCache& cache,
+		{{bindGroupViewMembers}}
+	) const;
+
 	{{foreach entryPoints}}
 	/**
 	 * Dispatch the kernel's entry point '{{entryPoint}}' on a given number of
-	 * threads or workgroups. The bind group MUST have been created by this
-	 * Kernel's createBindGroup method.
+	 * threads or workgroups. The bind group MUST have been created by the
+	 * createBindGroup method of a kernel that has the same SharedBindGroupLayout
+	 * (e.g., this one).
 	 *
 	 * This overload creates its own command encoder, compute pass, and submit
 	 * all resulting commands to the device's queue.
@@ -67,13 +213,136 @@ public:
 		DispatchSize dispatchSize,
 		wgpu::BindGroup bindGroup
 	);
+	{{if dynamicUniforms}}
+
+	/**
+	 * Variants of dispatch{{EntryPoint}}() that read uniforms at a given byte
+	 * offset in the uniform buffer of the bind group, typically returned by
+	 * UniformRingBuffer::push(). The overloads above use an offset of 0.
+	 */
+	void dispatch{{EntryPoint}}(
+		DispatchSize dispatchSize,
+		wgpu::BindGroup bindGroup,
+		uint32_t uniformOffset
+	);
+	void dispatch{{EntryPoint}}(
+		wgpu::CommandEncoder encoder,
+		DispatchSize dispatchSize,
+		wgpu::BindGroup bindGroup,
+		uint32_t uniformOffset
+	);
+	void dispatch{{EntryPoint}}(
+		wgpu::ComputePassEncoder computePass,
+		DispatchSize dispatchSize,
+		wgpu::BindGroup bindGroup,
+		uint32_t uniformOffset
+	);
+	{{end}}
+
+	/**
+	 * Variants of dispatch{{EntryPoint}}() that read the workgroup count from
+	 * 'indirectBuffer' at 'indirectOffset' (3 consecutive u32), so that it may
+	 * be computed on the GPU, e.g. by writeDispatchArgs{{EntryPoint}}().
+	 */
+	void dispatchIndirect{{EntryPoint}}(
+		wgpu::Buffer indirectBuffer,
+		uint64_t indirectOffset,
+		wgpu::BindGroup bindGroup
+	);
+	void dispatchIndirect{{EntryPoint}}(
+		wgpu::CommandEncoder encoder,
+		wgpu::Buffer indirectBuffer,
+		uint64_t indirectOffset,
+		wgpu::BindGroup bindGroup
+	);
+	void dispatchIndirect{{EntryPoint}}(
+		wgpu::ComputePassEncoder computePass,
+		wgpu::Buffer indirectBuffer,
+		uint64_t indirectOffset,
+		wgpu::BindGroup bindGroup
+	);
+	{{if dynamicUniforms}}
+	// With an explicit uniform offset, as for dispatch{{EntryPoint}}()
+	void dispatchIndirect{{EntryPoint}}(
+		wgpu::Buffer indirectBuffer,
+		uint64_t indirectOffset,
+		wgpu::BindGroup bindGroup,
+		uint32_t uniformOffset
+	);
+	void dispatchIndirect{{EntryPoint}}(
+		wgpu::CommandEncoder encoder,
+		wgpu::Buffer indirectBuffer,
+		uint64_t indirectOffset,
+		wgpu::BindGroup bindGroup,
+		uint32_t uniformOffset
+	);
+	void dispatchIndirect{{EntryPoint}}(
+		wgpu::ComputePassEncoder computePass,
+		wgpu::Buffer indirectBuffer,
+		uint64_t indirectOffset,
+		wgpu::BindGroup bindGroup,
+		uint32_t uniformOffset
+	);
+	{{end}}
+
+	/**
+	 * Variants of dispatch{{EntryPoint}}() and dispatchIndirect{{EntryPoint}}()
+	 * that record into a Recorder, which only sets the pipeline and the bind
+	 * group when they differ from the previous dispatch.
+	 */
+	void dispatch{{EntryPoint}}(
+		Recorder& recorder,
+		DispatchSize dispatchSize,
+		wgpu::BindGroup bindGroup
+	);
+	{{if dynamicUniforms}}
+	void dispatch{{EntryPoint}}(
+		Recorder& recorder,
+		DispatchSize dispatchSize,
+		wgpu::BindGroup bindGroup,
+		uint32_t uniformOffset
+	);
+	{{end}}
+	void dispatchIndirect{{EntryPoint}}(
+		Recorder& recorder,
+		wgpu::Buffer indirectBuffer,
+		uint64_t indirectOffset,
+		wgpu::BindGroup bindGroup
+	);
+	{{if dynamicUniforms}}
+	void dispatchIndirect{{EntryPoint}}(
+		Recorder& recorder,
+		wgpu::Buffer indirectBuffer,
+		uint64_t indirectOffset,
+		wgpu::BindGroup bindGroup,
+		uint32_t uniformOffset
+	);
+	{{end}}
+
+	/**
+	 * Record a dispatch of the built-in WorkgroupCountKernel, which reads a
+	 * number of elements (the u32 at the beginning of 'elementCount') and
+	 * writes into 'dispatchArgs' the arguments of dispatchIndirect{{EntryPoint}}()
+	 * that run one thread per element, along the X axis. The workgroup count
+	 * is capped, see WorkgroupCountKernel::dispatch().
+	 */
+	Result<Void, Error> writeDispatchArgs{{EntryPoint}}(
+		wgpu::ComputePassEncoder computePass,
+		const BufferView& elementCount,
+		const BufferView& dispatchArgs
+	) const;
+	Result<Void, Error> writeDispatchArgs{{EntryPoint}}(
+		wgpu::CommandEncoder encoder,
+		const BufferView& elementCount,
+		const BufferView& dispatchArgs
+	) const;
 	{{end}}
 
 	{{if entryPointCount == 1}}
 	/**
 	 * Dispatch the kernel on a given number of threads or workgroups.
-	 * The bind group MUST have been created by this Kernel's createBindGroup
-	 * method.
+	 * The bind group MUST have been created by the createBindGroup method of a
+	 * kernel that has the same SharedBindGroupLayout (e.g., this one).
 	 *
 	 * This overload creates its own command encoder, compute pass, and submit
 	 * all resulting commands to the device's queue.
@@ -105,6 +374,158 @@ public:
 		DispatchSize dispatchSize,
 		wgpu::BindGroup bindGroup
 	);
+	{{if dynamicUniforms}}
+
+	/**
+	 * Variants of dispatch() that read uniforms at a given byte offset in the
+	 * uniform buffer of the bind group.
+	 */
+	void dispatch(
+		DispatchSize dispatchSize,
+		wgpu::BindGroup bindGroup,
+		uint32_t uniformOffset
+	);
+	void dispatch(
+		wgpu::CommandEncoder encoder,
+		DispatchSize dispatchSize,
+		wgpu::BindGroup bindGroup,
+		uint32_t uniformOffset
+	);
+	void dispatch(
+		wgpu::ComputePassEncoder computePass,
+		DispatchSize dispatchSize,
+		wgpu::BindGroup bindGroup,
+		uint32_t uniformOffset
+	);
+	{{end}}
+
+	/**
+	 * Variants of dispatch() whose workgroup count is read from a buffer.
+	 */
+	void dispatchIndirect(
+		wgpu::Buffer indirectBuffer,
+		uint64_t indirectOffset,
+		wgpu::BindGroup bindGroup
+	);
+	void dispatchIndirect(
+		wgpu::CommandEncoder encoder,
+		wgpu::Buffer indirectBuffer,
+		uint64_t indirectOffset,
+		wgpu::BindGroup bindGroup
+	);
+	void dispatchIndirect(
+		wgpu::ComputePassEncoder computePass,
+		wgpu::Buffer indirectBuffer,
+		uint64_t indirectOffset,
+		wgpu::BindGroup bindGroup
+	);
+	{{if dynamicUniforms}}
+	void dispatchIndirect(
+		wgpu::Buffer indirectBuffer,
+		uint64_t indirectOffset,
+		wgpu::BindGroup bindGroup,
+		uint32_t uniformOffset
+	);
+	void dispatchIndirect(
+		wgpu::CommandEncoder encoder,
+		wgpu::Buffer indirectBuffer,
+		uint64_t indirectOffset,
+		wgpu::BindGroup bindGroup,
+		uint32_t uniformOffset
+	);
+	void dispatchIndirect(
+		wgpu::ComputePassEncoder computePass,
+		wgpu::Buffer indirectBuffer,
+		uint64_t indirectOffset,
+		wgpu::BindGroup bindGroup,
+		uint32_t uniformOffset
+	);
+	{{end}}
+
+	/**
+	 * Variants of dispatch() and dispatchIndirect() that record into a Recorder.
+	 */
+	void dispatch(
+		Recorder& recorder,
+		DispatchSize dispatchSize,
+		wgpu::BindGroup bindGroup
+	);
+	{{if dynamicUniforms}}
+	void dispatch(
+		Recorder& recorder,
+		DispatchSize dispatchSize,
+		wgpu::BindGroup bindGroup,
+		uint32_t uniformOffset
+	);
+	{{end}}
+	void dispatchIndirect(
+		Recorder& recorder,
+		wgpu::Buffer indirectBuffer,
+		uint64_t indirectOffset,
+		wgpu::BindGroup bindGroup
+	);
+	{{if dynamicUniforms}}
+	void dispatchIndirect(
+		Recorder& recorder,
+		wgpu::Buffer indirectBuffer,
+		uint64_t indirectOffset,
+		wgpu::BindGroup bindGroup,
+		uint32_t uniformOffset
+	);
+	{{end}}
+
+	/**
+	 * Compute the arguments of dispatchIndirect() on the GPU.
+	 */
+	Result<Void, Error> writeDispatchArgs(
+		wgpu::ComputePassEncoder computePass,
+		const BufferView& elementCount,
+		const BufferView& dispatchArgs
+	) const;
+	Result<Void, Error> writeDispatchArgs(
+		wgpu::CommandEncoder encoder,
+		const BufferView& elementCount,
+		const BufferView& dispatchArgs
+	) const;
+	{{end}}
+
+	{{foreach differentiableFunctions}}
+	/**
+	 * Gradient buffers of the differentiable function '{{differentiableFunction}}'
+	 * ({{gradientAccumulation}} gradient accumulation), to be bound to the
+	 * '{{differentiableFunction}}_*Grad' arguments of createBindGroup().
+	 */
+	struct {{DifferentiableFunction}}Gradients {
+		{{gradientBufferMembers}}
+	};
+
+	/**
+	 * Allocate the gradient buffers of '{{differentiableFunction}}' for a given
+	 * number of elements. Buffers are zero-initialized by WebGPU upon creation.
+	 */
+	{{DifferentiableFunction}}Gradients create{{DifferentiableFunction}}GradientBuffers(uint32_t elementCount) const;
+
+	/**
+	 * Record commands that reset gradient buffers to zero. This is only needed
+	 * before each new backward pass with atomic gradient accumulation, where
+	 * the gradients of shared parameters are accumulated in their buffer.
+	 * Other gradients are overwritten by each backward pass.
+	 */
+	void zero{{DifferentiableFunction}}Gradients(
+		wgpu::CommandEncoder encoder,
+		const {{DifferentiableFunction}}Gradients& gradients
+	) const;
+
+	/**
+	 * Dispatch the backward entry point of '{{differentiableFunction}}', followed
+	 * by the reduction of shared gradients if needed.
+	 * NB: This does not zero gradients beforehand.
+	 */
+	void dispatch{{DifferentiableFunction}}Gradients(
+		wgpu::CommandEncoder encoder,
+		uint32_t elementCount,
+		wgpu::BindGroup bindGroup
+	);
 	{{end}}
 
 	/**
@@ -118,7 +539,8 @@ public:
 	wgpu::BindGroupLayout getBindGroupLayouts() const;
 
 	/**
-	 * Direct access to the lower level pipeline
+	 * Direct access to the lower level pipeline, waiting for its creation if
+	 * needed. Returns a null pipeline if it could not be created.
 	 */
 	wgpu::ComputePipeline getPipeline(uint32_t entryPointIndex) const;
 
@@ -137,19 +559,70 @@ public:
 	 */
 	static const char* getWgslSource();
 
+	/**
+	 * Description of the bindings, in the order of the arguments of
+	 * createBindGroup().
+	 */
+	static const std::array<KernelBindingInfo,{{bindGroupEntryCount}}>& getBindings() { return s_bindings; }
+
 private:
 	static constexpr const char* s_name = "{{kernelLabel}}";
+	static constexpr std::array<const char*,{{entryPointCount}}> s_entryPoints = {
+	{{foreach entryPoints}}
+		"{{entryPoint}}",
+	{{end}}
+	};
 	static constexpr std::array<ThreadCount,{{entryPointCount}}> s_workgroupSize = {
 	{{foreach entryPoints}}
 		ThreadCount{{workgroupSize}},
 	{{end}}
 	};
 	static const char* s_wgslSource;
+	static const std::array<KernelBindingInfo,{{bindGroupEntryCount}}> s_bindings;
+
+	/**
+	 * Number of workgroups run by a dispatch of a given entry point.
+	 */
+	static WorkgroupCount toWorkgroupCount(DispatchSize dispatchSize, uint32_t entryPointIndex);
+
+	/**
+	 * Begin a compute pass for a dispatch of a given entry point, timed by the
+	 * profiler if any. Callers first check that the pipeline exists, so that
+	 * no empty pass is timed.
+	 */
+	wgpu::raii::ComputePassEncoder beginDispatchPass(wgpu::CommandEncoder encoder, uint32_t entryPointIndex);
+
+	/**
+	 * Record a dispatch of a given entry point with its pipeline, which the
+	 * public overloads get only once.
+	 */
+	void encodeDispatch(
+		wgpu::ComputePassEncoder computePass,
+		wgpu::ComputePipeline pipeline,
+		uint32_t entryPointIndex,
+		DispatchSize dispatchSize,
+		wgpu::BindGroup bindGroup,
+		size_t dynamicOffsetCount,
+		const uint32_t* dynamicOffsets
+	);
+	void encodeDispatchIndirect(
+		wgpu::ComputePassEncoder computePass,
+		wgpu::ComputePipeline pipeline,
+		uint32_t entryPointIndex,
+		wgpu::Buffer indirectBuffer,
+		uint64_t indirectOffset,
+		wgpu::BindGroup bindGroup,
+		size_t dynamicOffsetCount,
+		const uint32_t* dynamicOffsets
+	);
 
 	wgpu::Device m_device;
+	// Keeps the objects shared with other kernels of the device alive
+	std::shared_ptr<DeviceRegistry> m_registry;
 	bool m_valid = false;
 	std::array<wgpu::raii::BindGroupLayout,1> m_bindGroupLayouts;
-	std::array<wgpu::raii::ComputePipeline,{{entryPointCount}}> m_pipelines;
+	ComputePipelineSet m_pipelines;
+	KernelProfiler* m_profiler = nullptr;
 };
 
 } // namespace generated
@@ -159,7 +632,10 @@ private:
 #include "{{kernelName}}Kernel.h"
 
 #include <slang-webgpu/common/variant-utils.h>
+#include <slang-webgpu/common/logger.h>
+#include <slang-webgpu/runtime/workgroup-count-kernel.h>
 
+#include <algorithm>
 #include <variant>
 #include <string>
 
@@ -170,47 +646,60 @@ namespace generated {
 ////////////////////////////////////////////
 // Initialization
 
-{{kernelName}}Kernel::{{kernelName}}Kernel(Device device)
+{{kernelName}}Kernel::{{kernelName}}Kernel(Device device, PipelineCreation pipelineCreation)
 	: m_device(device)
+	, m_registry(DeviceRegistry::get(device))
 {
+	// All GPU objects of the kernel are shared through the registry of the
+	// device, so that creating the same kernel again is cheap.
+	DeviceRegistry& registry = *m_registry;
+
 	// 1. Create shader module
-	ShaderSourceWGSL wgslDesc = Default;
-	wgslDesc.code = StringView(s_wgslSource);
-	ShaderModuleDescriptor shaderDesc = Default;
-	shaderDesc.nextInChain = &wgslDesc.chain;
-	shaderDesc.label = StringView(s_name);
-	raii::ShaderModule shaderModule = m_device.createShaderModule(shaderDesc);
+	// (shared by all kernels that have the same WGSL source)
+	raii::ShaderModule shaderModule = registry.getOrCreateShaderModule(s_name, s_wgslSource);
 	m_valid = shaderModule;
 
-	// 2. Create pipeline layout (automatically generated)
-	std::vector<BindGroupLayoutEntry> layoutEntries({{bindGroupEntryCount}}, Default);
-	{{bindGroupLayoutEntries}}
-
+	// 2. Create pipeline layout
+	// The bind group layout is shared by all kernels with the same bindings
 	// TODO: handle more than 1 bind group
-	std::vector<raii::BindGroupLayout> bindGroupLayouts(1);
-	BindGroupLayoutDescriptor bindGroupLayoutDesc = Default;
-	bindGroupLayoutDesc.entryCount = layoutEntries.size();
-	bindGroupLayoutDesc.entries = layoutEntries.data();
-	m_bindGroupLayouts[0] = m_device.createBindGroupLayout(bindGroupLayoutDesc);
-
-	PipelineLayoutDescriptor layoutDesc = Default;
-	layoutDesc.bindGroupLayoutCount = m_bindGroupLayouts.size();
-	layoutDesc.bindGroupLayouts = (WGPUBindGroupLayout*)m_bindGroupLayouts.data();
-	raii::PipelineLayout layout = m_device.createPipelineLayout(layoutDesc);
+	m_bindGroupLayouts[0] = SharedBindGroupLayout::get(m_device);
+	raii::PipelineLayout layout = registry.getOrCreatePipelineLayout({ *m_bindGroupLayouts[0] });
 
 	// 3. Create compute pipelines
-	{{foreach entryPoints}}
-	// 3.{{entryPointIndex}}. Entry point '{{entryPoint}}'
-	{
-		std::string label = std::string(s_name) + "::{{entryPoint}}";
-		ComputePipelineDescriptor pipelineDesc = Default;
-		pipelineDesc.label = StringView(label);
-		pipelineDesc.compute.module = *shaderModule;
-		pipelineDesc.compute.entryPoint = StringView("{{entryPoint}}");
-		pipelineDesc.layout = *layout;
-		m_pipelines[{{entryPointIndex}}] = m_device.createComputePipeline(pipelineDesc);
+	// (either right away, in the background or on first use, depending on
+	// pipelineCreation, and only for the first instance of this kernel)
+	std::vector<std::string> entryPoints(s_entryPoints.begin(), s_entryPoints.end());
+	m_pipelines = registry.getOrCreatePipelineSet(s_name, *shaderModule, *layout, entryPoints, pipelineCreation);
+}
+
+bool {{kernelName}}Kernel::isReady() const {
+	return m_pipelines.isReady();
+}
+
+Result<Void, Error> {{kernelName}}Kernel::waitUntilReady() const {
+	return m_pipelines.waitUntilReady();
+}
+
+void {{kernelName}}Kernel::onReady(ComputePipelineSet::ReadyCallback callback) const {
+	m_pipelines.onReady(std::move(callback));
+}
+
+Result<Void, Error> {{kernelName}}Kernel::prewarm(
+	const std::vector<EntryPoint>& entryPoints,
+	PipelineCreation creation
+) const {
+	std::vector<uint32_t> entryPointIndices;
+	for (EntryPoint entryPoint : entryPoints) {
+		entryPointIndices.push_back(static_cast<uint32_t>(entryPoint));
 	}
-	{{end}}
+	return m_pipelines.prewarm(entryPointIndices, creation);
+}
+
+Result<Void, Error> {{kernelName}}Kernel::prewarm(
+	const std::vector<std::string>& entryPointNames,
+	PipelineCreation creation
+) const {
+	return m_pipelines.prewarm(entryPointNames, creation);
 }
 
 ////////////////////////////////////////////
@@ -231,6 +720,90 @@ BindGroup {{kernelName}}Kernel::createBindGroup(
 	return m_device.createBindGroup(bindGroupDesc);
 }
 
+BindGroup {{kernelName}}Kernel::getOrCreateBindGroup(
+	BindGroupCache& cache,
+	{{bindGroupMembersImpl}}
+) const {
+	std::vector<BindGroupEntry> entries({{bindGroupEntryCount}}, Default);
+	{{bindGroupEntries}}
+
+	return cache.getOrCreate(m_device, *m_bindGroupLayouts[0], entries, s_name);
+}
+
+Result<BindGroup, Error> {{kernelName}}Kernel::createBindGroup(
+	{{bindGroupViewMembersImpl}}
+) const {
+	std::vector<BindGroupEntry> entries({{bindGroupEntryCount}}, Default);
+	{{bindGroupViewEntries}}
+
+	BindGroupDescriptor bindGroupDesc = Default;
+	bindGroupDesc.label = StringView(s_name);
+	bindGroupDesc.layout = *m_bindGroupLayouts[0];
+	bindGroupDesc.entryCount = entries.size();
+	bindGroupDesc.entries = entries.data();
+
+	return m_device.createBindGroup(bindGroupDesc);
+}
+
+Result<BindGroup, Error> {{kernelName}}Kernel::getOrCreateBindGroup(
+	BindGroupCache& cache,
+	{{bindGroupViewMembersImpl}}
+) const {
+	std::vector<BindGroupEntry> entries({{bindGroupEntryCount}}, Default);
+	{{bindGroupViewEntries}}
+
+	return cache.getOrCreate(m_device, *m_bindGroupLayouts[0], entries, s_name);
+}
+
+////////////////////////////////////////////
+// Recording
+
+{{kernelName}}Kernel::Recorder {{kernelName}}Kernel::createRecorder() const {
+	return Recorder(m_device, s_name);
+}
+
+raii::ComputePassEncoder {{kernelName}}Kernel::beginDispatchPass(CommandEncoder encoder, uint32_t entryPointIndex) {
+	ComputePassDescriptor computePassDesc = Default;
+	computePassDesc.label = StringView(s_name);
+	ComputePassTimestampWrites timestampWrites = Default;
+	if (m_profiler && m_profiler->writeTimestamps(s_name, s_entryPoints[entryPointIndex], timestampWrites)) {
+		computePassDesc.timestampWrites = &timestampWrites;
+	}
+	return encoder.beginComputePass(computePassDesc);
+}
+
+void {{kernelName}}Kernel::encodeDispatch(
+	ComputePassEncoder computePass,
+	ComputePipeline pipeline,
+	uint32_t entryPointIndex,
+	DispatchSize dispatchSize,
+	BindGroup bindGroup,
+	size_t dynamicOffsetCount,
+	const uint32_t* dynamicOffsets
+) {
+	WorkgroupCount workgroupCount = toWorkgroupCount(dispatchSize, entryPointIndex);
+	KernelProfiler::DispatchTimer timer(m_profiler, s_name, s_entryPoints[entryPointIndex], workgroupCount);
+	computePass.setPipeline(pipeline);
+	computePass.setBindGroup(0, bindGroup, dynamicOffsetCount, dynamicOffsets);
+	computePass.dispatchWorkgroups(workgroupCount.x, workgroupCount.y, workgroupCount.z);
+}
+
+void {{kernelName}}Kernel::encodeDispatchIndirect(
+	ComputePassEncoder computePass,
+	ComputePipeline pipeline,
+	uint32_t entryPointIndex,
+	Buffer indirectBuffer,
+	uint64_t indirectOffset,
+	BindGroup bindGroup,
+	size_t dynamicOffsetCount,
+	const uint32_t* dynamicOffsets
+) {
+	KernelProfiler::DispatchTimer timer(m_profiler, s_name, s_entryPoints[entryPointIndex]);
+	computePass.setPipeline(pipeline);
+	computePass.setBindGroup(0, bindGroup, dynamicOffsetCount, dynamicOffsets);
+	computePass.dispatchWorkgroupsIndirect(indirectBuffer, indirectOffset);
+}
+
 {{foreach entryPoints}}
 ////////////////////////////////////////////
 // Entry point '{{entryPoint}}'
@@ -254,31 +827,257 @@ void {{kernelName}}Kernel::dispatch{{EntryPoint}}(
 	DispatchSize dispatchSize,
 	BindGroup bindGroup
 ) {
-	ComputePassDescriptor computePassDesc = Default;
-	computePassDesc.label = StringView(s_name);
+	{{if dynamicUniforms}}
+	dispatch{{EntryPoint}}(encoder, dispatchSize, bindGroup, 0);
+	{{end}}
+	{{if !dynamicUniforms}}
+	ComputePipeline pipeline = getPipeline({{entryPointIndex}});
+	if (!pipeline) return;
+	raii::ComputePassEncoder computePass = beginDispatchPass(encoder, {{entryPointIndex}});
+	encodeDispatch(*computePass, pipeline, {{entryPointIndex}}, dispatchSize, bindGroup, 0, nullptr);
+	computePass->end();
+	{{end}}
+}
+
+void {{kernelName}}Kernel::dispatch{{EntryPoint}}(
+	ComputePassEncoder computePass,
+	DispatchSize dispatchSize,
+	BindGroup bindGroup
+) {
+	{{if dynamicUniforms}}
+	dispatch{{EntryPoint}}(computePass, dispatchSize, bindGroup, 0);
+	{{end}}
+	{{if !dynamicUniforms}}
+	ComputePipeline pipeline = getPipeline({{entryPointIndex}});
+	if (!pipeline) return;
+	encodeDispatch(computePass, pipeline, {{entryPointIndex}}, dispatchSize, bindGroup, 0, nullptr);
+	{{end}}
+}
+{{if dynamicUniforms}}
+
+void {{kernelName}}Kernel::dispatch{{EntryPoint}}(
+	DispatchSize dispatchSize,
+	BindGroup bindGroup,
+	uint32_t uniformOffset
+) {
+	CommandEncoderDescriptor encoderDesc = Default;
+	encoderDesc.label = StringView(s_name);
+
+	raii::CommandEncoder encoder = m_device.createCommandEncoder(encoderDesc);
+	dispatch{{EntryPoint}}(*encoder, dispatchSize, bindGroup, uniformOffset);
+	raii::CommandBuffer commands = encoder->finish();
+	raii::Queue queue = m_device.getQueue();
+	queue->submit(*commands);
+}
 
-	raii::ComputePassEncoder computePass = encoder.beginComputePass(computePassDesc);
-	dispatch{{EntryPoint}}(*computePass, dispatchSize, bindGroup);
+void {{kernelName}}Kernel::dispatch{{EntryPoint}}(
+	CommandEncoder encoder,
+	DispatchSize dispatchSize,
+	BindGroup bindGroup,
+	uint32_t uniformOffset
+) {
+	ComputePipeline pipeline = getPipeline({{entryPointIndex}});
+	if (!pipeline) return;
+	raii::ComputePassEncoder computePass = beginDispatchPass(encoder, {{entryPointIndex}});
+	encodeDispatch(*computePass, pipeline, {{entryPointIndex}}, dispatchSize, bindGroup, 1, &uniformOffset);
 	computePass->end();
 }
 
 void {{kernelName}}Kernel::dispatch{{EntryPoint}}(
 	ComputePassEncoder computePass,
 	DispatchSize dispatchSize,
+	BindGroup bindGroup,
+	uint32_t uniformOffset
+) {
+	ComputePipeline pipeline = getPipeline({{entryPointIndex}});
+	if (!pipeline) return;
+	encodeDispatch(computePass, pipeline, {{entryPointIndex}}, dispatchSize, bindGroup, 1, &uniformOffset);
+}
+{{end}}
+
+void {{kernelName}}Kernel::dispatchIndirect{{EntryPoint}}(
+	Buffer indirectBuffer,
+	uint64_t indirectOffset,
 	BindGroup bindGroup
 ) {
-	WorkgroupCount workgroupCount = std::visit(overloaded{
-		[](WorkgroupCount count) { return count; },
-		[](ThreadCount threadCount) { return WorkgroupCount{
-			divideAndCeil(threadCount.x, s_workgroupSize[{{entryPointIndex}}].x),
-			divideAndCeil(threadCount.y, s_workgroupSize[{{entryPointIndex}}].y),
-			divideAndCeil(threadCount.z, s_workgroupSize[{{entryPointIndex}}].z)
-		}; }
-	}, dispatchSize);
+	CommandEncoderDescriptor encoderDesc = Default;
+	encoderDesc.label = StringView(s_name);
 
-	computePass.setPipeline(*m_pipelines[{{entryPointIndex}}]);
-	computePass.setBindGroup(0, bindGroup, 0, nullptr);
-	computePass.dispatchWorkgroups(workgroupCount.x, workgroupCount.y, workgroupCount.z);
+	raii::CommandEncoder encoder = m_device.createCommandEncoder(encoderDesc);
+	dispatchIndirect{{EntryPoint}}(*encoder, indirectBuffer, indirectOffset, bindGroup);
+	raii::CommandBuffer commands = encoder->finish();
+	raii::Queue queue = m_device.getQueue();
+	queue->submit(*commands);
+}
+
+void {{kernelName}}Kernel::dispatchIndirect{{EntryPoint}}(
+	CommandEncoder encoder,
+	Buffer indirectBuffer,
+	uint64_t indirectOffset,
+	BindGroup bindGroup
+) {
+	{{if dynamicUniforms}}
+	dispatchIndirect{{EntryPoint}}(encoder, indirectBuffer, indirectOffset, bindGroup, 0);
+	{{end}}
+	{{if !dynamicUniforms}}
+	ComputePipeline pipeline = getPipeline({{entryPointIndex}});
+	if (!pipeline) return;
+	raii::ComputePassEncoder computePass = beginDispatchPass(encoder, {{entryPointIndex}});
+	encodeDispatchIndirect(*computePass, pipeline, {{entryPointIndex}}, indirectBuffer, indirectOffset, bindGroup, 0, nullptr);
+	computePass->end();
+	{{end}}
+}
+
+void {{kernelName}}Kernel::dispatchIndirect{{EntryPoint}}(
+	ComputePassEncoder computePass,
+	Buffer indirectBuffer,
+	uint64_t indirectOffset,
+	BindGroup bindGroup
+) {
+	{{if dynamicUniforms}}
+	dispatchIndirect{{EntryPoint}}(computePass, indirectBuffer, indirectOffset, bindGroup, 0);
+	{{end}}
+	{{if !dynamicUniforms}}
+	ComputePipeline pipeline = getPipeline({{entryPointIndex}});
+	if (!pipeline) return;
+	encodeDispatchIndirect(computePass, pipeline, {{entryPointIndex}}, indirectBuffer, indirectOffset, bindGroup, 0, nullptr);
+	{{end}}
+}
+{{if dynamicUniforms}}
+
+void {{kernelName}}Kernel::dispatchIndirect{{EntryPoint}}(
+	Buffer indirectBuffer,
+	uint64_t indirectOffset,
+	BindGroup bindGroup,
+	uint32_t uniformOffset
+) {
+	CommandEncoderDescriptor encoderDesc = Default;
+	encoderDesc.label = StringView(s_name);
+
+	raii::CommandEncoder encoder = m_device.createCommandEncoder(encoderDesc);
+	dispatchIndirect{{EntryPoint}}(*encoder, indirectBuffer, indirectOffset, bindGroup, uniformOffset);
+	raii::CommandBuffer commands = encoder->finish();
+	raii::Queue queue = m_device.getQueue();
+	queue->submit(*commands);
+}
+
+void {{kernelName}}Kernel::dispatchIndirect{{EntryPoint}}(
+	CommandEncoder encoder,
+	Buffer indirectBuffer,
+	uint64_t indirectOffset,
+	BindGroup bindGroup,
+	uint32_t uniformOffset
+) {
+	ComputePipeline pipeline = getPipeline({{entryPointIndex}});
+	if (!pipeline) return;
+	raii::ComputePassEncoder computePass = beginDispatchPass(encoder, {{entryPointIndex}});
+	encodeDispatchIndirect(*computePass, pipeline, {{entryPointIndex}}, indirectBuffer, indirectOffset, bindGroup, 1, &uniformOffset);
+	computePass->end();
+}
+
+void {{kernelName}}Kernel::dispatchIndirect{{EntryPoint}}(
+	ComputePassEncoder computePass,
+	Buffer indirectBuffer,
+	uint64_t indirectOffset,
+	BindGroup bindGroup,
+	uint32_t uniformOffset
+) {
+	ComputePipeline pipeline = getPipeline({{entryPointIndex}});
+	if (!pipeline) return;
+	encodeDispatchIndirect(computePass, pipeline, {{entryPointIndex}}, indirectBuffer, indirectOffset, bindGroup, 1, &uniformOffset);
+}
+{{end}}
+
+void {{kernelName}}Kernel::dispatch{{EntryPoint}}(
+	Recorder& recorder,
+	DispatchSize dispatchSize,
+	BindGroup bindGroup
+) {
+	{{if dynamicUniforms}}
+	dispatch{{EntryPoint}}(recorder, dispatchSize, bindGroup, 0);
+	{{end}}
+	{{if !dynamicUniforms}}
+	WorkgroupCount workgroupCount = toWorkgroupCount(dispatchSize, {{entryPointIndex}});
+
+	ComputePipeline pipeline = getPipeline({{entryPointIndex}});
+	if (!pipeline) return;
+	KernelProfiler::DispatchTimer timer(m_profiler, s_name, s_entryPoints[{{entryPointIndex}}], workgroupCount);
+	recorder.setPipeline(pipeline);
+	recorder.setBindGroup(0, bindGroup);
+	recorder.dispatchWorkgroups(workgroupCount.x, workgroupCount.y, workgroupCount.z);
+	{{end}}
+}
+{{if dynamicUniforms}}
+
+void {{kernelName}}Kernel::dispatch{{EntryPoint}}(
+	Recorder& recorder,
+	DispatchSize dispatchSize,
+	BindGroup bindGroup,
+	uint32_t uniformOffset
+) {
+	WorkgroupCount workgroupCount = toWorkgroupCount(dispatchSize, {{entryPointIndex}});
+
+	ComputePipeline pipeline = getPipeline({{entryPointIndex}});
+	if (!pipeline) return;
+	KernelProfiler::DispatchTimer timer(m_profiler, s_name, s_entryPoints[{{entryPointIndex}}], workgroupCount);
+	recorder.setPipeline(pipeline);
+	recorder.setBindGroup(0, bindGroup, 1, &uniformOffset);
+	recorder.dispatchWorkgroups(workgroupCount.x, workgroupCount.y, workgroupCount.z);
+}
+{{end}}
+
+void {{kernelName}}Kernel::dispatchIndirect{{EntryPoint}}(
+	Recorder& recorder,
+	Buffer indirectBuffer,
+	uint64_t indirectOffset,
+	BindGroup bindGroup
+) {
+	{{if dynamicUniforms}}
+	dispatchIndirect{{EntryPoint}}(recorder, indirectBuffer, indirectOffset, bindGroup, 0);
+	{{end}}
+	{{if !dynamicUniforms}}
+	ComputePipeline pipeline = getPipeline({{entryPointIndex}});
+	if (!pipeline) return;
+	KernelProfiler::DispatchTimer timer(m_profiler, s_name, s_entryPoints[{{entryPointIndex}}]);
+	recorder.setPipeline(pipeline);
+	recorder.setBindGroup(0, bindGroup);
+	recorder.dispatchWorkgroupsIndirect(indirectBuffer, indirectOffset);
+	{{end}}
+}
+{{if dynamicUniforms}}
+
+void {{kernelName}}Kernel::dispatchIndirect{{EntryPoint}}(
+	Recorder& recorder,
+	Buffer indirectBuffer,
+	uint64_t indirectOffset,
+	BindGroup bindGroup,
+	uint32_t uniformOffset
+) {
+	ComputePipeline pipeline = getPipeline({{entryPointIndex}});
+	if (!pipeline) return;
+	KernelProfiler::DispatchTimer timer(m_profiler, s_name, s_entryPoints[{{entryPointIndex}}]);
+	recorder.setPipeline(pipeline);
+	recorder.setBindGroup(0, bindGroup, 1, &uniformOffset);
+	recorder.dispatchWorkgroupsIndirect(indirectBuffer, indirectOffset);
+}
+{{end}}
+
+Result<Void, Error> {{kernelName}}Kernel::writeDispatchArgs{{EntryPoint}}(
+	ComputePassEncoder computePass,
+	const BufferView& elementCount,
+	const BufferView& dispatchArgs
+) const {
+	WorkgroupCountKernel& workgroupCountKernel = m_registry->getWorkgroupCountKernel();
+	return workgroupCountKernel.dispatch(computePass, elementCount, dispatchArgs, s_workgroupSize[{{entryPointIndex}}].x);
+}
+
+Result<Void, Error> {{kernelName}}Kernel::writeDispatchArgs{{EntryPoint}}(
+	CommandEncoder encoder,
+	const BufferView& elementCount,
+	const BufferView& dispatchArgs
+) const {
+	WorkgroupCountKernel& workgroupCountKernel = m_registry->getWorkgroupCountKernel();
+	return workgroupCountKernel.dispatch(encoder, elementCount, dispatchArgs, s_workgroupSize[{{entryPointIndex}}].x);
 }
 {{end}}
 
@@ -308,6 +1107,177 @@ void {{kernelName}}Kernel::dispatch(
 ) {
 	dispatch{{EntryPoint}}(computePass, dispatchSize, bindGroup);
 }
+{{if dynamicUniforms}}
+
+void {{kernelName}}Kernel::dispatch(
+	DispatchSize dispatchSize,
+	BindGroup bindGroup,
+	uint32_t uniformOffset
+) {
+	dispatch{{EntryPoint}}(dispatchSize, bindGroup, uniformOffset);
+}
+
+void {{kernelName}}Kernel::dispatch(
+	CommandEncoder encoder,
+	DispatchSize dispatchSize,
+	BindGroup bindGroup,
+	uint32_t uniformOffset
+) {
+	dispatch{{EntryPoint}}(encoder, dispatchSize, bindGroup, uniformOffset);
+}
+
+void {{kernelName}}Kernel::dispatch(
+	ComputePassEncoder computePass,
+	DispatchSize dispatchSize,
+	BindGroup bindGroup,
+	uint32_t uniformOffset
+) {
+	dispatch{{EntryPoint}}(computePass, dispatchSize, bindGroup, uniformOffset);
+}
+{{end}}
+
+void {{kernelName}}Kernel::dispatchIndirect(
+	Buffer indirectBuffer,
+	uint64_t indirectOffset,
+	BindGroup bindGroup
+) {
+	dispatchIndirect{{EntryPoint}}(indirectBuffer, indirectOffset, bindGroup);
+}
+
+void {{kernelName}}Kernel::dispatchIndirect(
+	CommandEncoder encoder,
+	Buffer indirectBuffer,
+	uint64_t indirectOffset,
+	BindGroup bindGroup
+) {
+	dispatchIndirect{{EntryPoint}}(encoder, indirectBuffer, indirectOffset, bindGroup);
+}
+
+void {{kernelName}}Kernel::dispatchIndirect(
+	ComputePassEncoder computePass,
+	Buffer indirectBuffer,
+	uint64_t indirectOffset,
+	BindGroup bindGroup
+) {
+	dispatchIndirect{{EntryPoint}}(computePass, indirectBuffer, indirectOffset, bindGroup);
+}
+{{if dynamicUniforms}}
+
+void {{kernelName}}Kernel::dispatchIndirect(
+	Buffer indirectBuffer,
+	uint64_t indirectOffset,
+	BindGroup bindGroup,
+	uint32_t uniformOffset
+) {
+	dispatchIndirect{{EntryPoint}}(indirectBuffer, indirectOffset, bindGroup, uniformOffset);
+}
+
+void {{kernelName}}Kernel::dispatchIndirect(
+	CommandEncoder encoder,
+	Buffer indirectBuffer,
+	uint64_t indirectOffset,
+	BindGroup bindGroup,
+	uint32_t uniformOffset
+) {
+	dispatchIndirect{{EntryPoint}}(encoder, indirectBuffer, indirectOffset, bindGroup, uniformOffset);
+}
+
+void {{kernelName}}Kernel::dispatchIndirect(
+	ComputePassEncoder computePass,
+	Buffer indirectBuffer,
+	uint64_t indirectOffset,
+	BindGroup bindGroup,
+	uint32_t uniformOffset
+) {
+	dispatchIndirect{{EntryPoint}}(computePass, indirectBuffer, indirectOffset, bindGroup, uniformOffset);
+}
+{{end}}
+
+void {{kernelName}}Kernel::dispatch(
+	Recorder& recorder,
+	DispatchSize dispatchSize,
+	BindGroup bindGroup
+) {
+	dispatch{{EntryPoint}}(recorder, dispatchSize, bindGroup);
+}
+{{if dynamicUniforms}}
+
+void {{kernelName}}Kernel::dispatch(
+	Recorder& recorder,
+	DispatchSize dispatchSize,
+	BindGroup bindGroup,
+	uint32_t uniformOffset
+) {
+	dispatch{{EntryPoint}}(recorder, dispatchSize, bindGroup, uniformOffset);
+}
+{{end}}
+
+void {{kernelName}}Kernel::dispatchIndirect(
+	Recorder& recorder,
+	Buffer indirectBuffer,
+	uint64_t indirectOffset,
+	BindGroup bindGroup
+) {
+	dispatchIndirect{{EntryPoint}}(recorder, indirectBuffer, indirectOffset, bindGroup);
+}
+{{if dynamicUniforms}}
+
+void {{kernelName}}Kernel::dispatchIndirect(
+	Recorder& recorder,
+	Buffer indirectBuffer,
+	uint64_t indirectOffset,
+	BindGroup bindGroup,
+	uint32_t uniformOffset
+) {
+	dispatchIndirect{{EntryPoint}}(recorder, indirectBuffer, indirectOffset, bindGroup, uniformOffset);
+}
+{{end}}
+
+Result<Void, Error> {{kernelName}}Kernel::writeDispatchArgs(
+	ComputePassEncoder computePass,
+	const BufferView& elementCount,
+	const BufferView& dispatchArgs
+) const {
+	return writeDispatchArgs{{EntryPoint}}(computePass, elementCount, dispatchArgs);
+}
+
+Result<Void, Error> {{kernelName}}Kernel::writeDispatchArgs(
+	CommandEncoder encoder,
+	const BufferView& elementCount,
+	const BufferView& dispatchArgs
+) const {
+	return writeDispatchArgs{{EntryPoint}}(encoder, elementCount, dispatchArgs);
+}
+{{end}}
+
+{{foreach differentiableFunctions}}
+////////////////////////////////////////////
+// Gradients of '{{differentiableFunction}}'
+
+{{kernelName}}Kernel::{{DifferentiableFunction}}Gradients {{kernelName}}Kernel::create{{DifferentiableFunction}}GradientBuffers(uint32_t elementCount) const {
+	{{DifferentiableFunction}}Gradients gradients;
+	BufferDescriptor bufferDesc = Default;
+	bufferDesc.mappedAtCreation = false;
+	bufferDesc.usage = BufferUsage::Storage | BufferUsage::CopySrc | BufferUsage::CopyDst;
+
+	{{gradientBufferCreation}}
+	return gradients;
+}
+
+void {{kernelName}}Kernel::zero{{DifferentiableFunction}}Gradients(
+	CommandEncoder encoder,
+	const {{DifferentiableFunction}}Gradients& gradients
+) const {
+	{{gradientBufferClears}}
+}
+
+void {{kernelName}}Kernel::dispatch{{DifferentiableFunction}}Gradients(
+	CommandEncoder encoder,
+	uint32_t elementCount,
+	BindGroup bindGroup
+) {
+	{{gradientDispatches}}
+}
 {{end}}
 
 ////////////////////////////////////////////
@@ -318,13 +1288,29 @@ wgpu::BindGroupLayout {{kernelName}}Kernel::getBindGroupLayouts() const {
 }
 
 wgpu::ComputePipeline {{kernelName}}Kernel::getPipeline(uint32_t entryPointIndex) const {
-	return *m_pipelines[entryPointIndex];
+	auto maybePipeline = m_pipelines.get(entryPointIndex);
+	if (isError(maybePipeline)) {
+		LOG(ERROR) << std::get<Error>(maybePipeline).message;
+		return nullptr;
+	}
+	return std::get<ComputePipeline>(maybePipeline);
 }
 
 const ThreadCount& {{kernelName}}Kernel::getWorkgroupSize(uint32_t entryPointIndex) const {
 	return s_workgroupSize[entryPointIndex];
 }
 
+WorkgroupCount {{kernelName}}Kernel::toWorkgroupCount(DispatchSize dispatchSize, uint32_t entryPointIndex) {
+	return std::visit(overloaded{
+		[](WorkgroupCount count) { return count; },
+		[entryPointIndex](ThreadCount threadCount) { return WorkgroupCount{
+			divideAndCeil(threadCount.x, s_workgroupSize[entryPointIndex].x),
+			divideAndCeil(threadCount.y, s_workgroupSize[entryPointIndex].y),
+			divideAndCeil(threadCount.z, s_workgroupSize[entryPointIndex].z)
+		}; }
+	}, dispatchSize);
+}
+
 wgpu::Device {{kernelName}}Kernel::getDevice() const {
 	return m_device;
 }
@@ -333,6 +1319,13 @@ const char* {{kernelName}}Kernel::getWgslSource() {
 	return s_wgslSource;
 }
 
+////////////////////////////////////////////
+// Bindings, as reflected from the shader
+
+const std::array<KernelBindingInfo,{{bindGroupEntryCount}}> {{kernelName}}Kernel::s_bindings = {
+	{{bindingInfos}}
+};
+
 ////////////////////////////////////////////
 // Shader source
 
@@ -0,0 +1,234 @@
+#include "caching-file-system.h"
+
+#include <slang-webgpu/common/io.h>
+
+namespace {
+
+/**
+ * FNV-1a hash of the file contents.
+ */
+uint64_t hashContents(const std::string& contents) {
+	uint64_t hash = 14695981039346656037ull;
+	for (char c : contents) {
+		hash ^= (uint8_t)c;
+		hash *= 1099511628211ull;
+	}
+	return hash;
+}
+
+/**
+ * A blob that shares the cached contents of a file rather than copying it.
+ */
+class SharedStringBlob : public ISlangBlob {
+public:
+	SharedStringBlob(std::shared_ptr<const std::string> contents)
+		: m_contents(std::move(contents))
+	{}
+	virtual ~SharedStringBlob() = default;
+
+	SLANG_NO_THROW SlangResult SLANG_MCALL queryInterface(SlangUUID const& uuid, void** outObject) SLANG_OVERRIDE {
+		if (uuid == ISlangUnknown::getTypeGuid() || uuid == ISlangBlob::getTypeGuid()) {
+			addRef();
+			*outObject = static_cast<ISlangBlob*>(this);
+			return SLANG_OK;
+		}
+		*outObject = nullptr;
+		return SLANG_E_NO_INTERFACE;
+	}
+	SLANG_NO_THROW uint32_t SLANG_MCALL addRef() SLANG_OVERRIDE {
+		return ++m_refCount;
+	}
+	SLANG_NO_THROW uint32_t SLANG_MCALL release() SLANG_OVERRIDE {
+		uint32_t count = --m_refCount;
+		if (count == 0) delete this;
+		return count;
+	}
+	SLANG_NO_THROW void const* SLANG_MCALL getBufferPointer() SLANG_OVERRIDE {
+		return m_contents->c_str();
+	}
+	SLANG_NO_THROW size_t SLANG_MCALL getBufferSize() SLANG_OVERRIDE {
+		return m_contents->size();
+	}
+
+private:
+	std::atomic<uint32_t> m_refCount = 0;
+	std::shared_ptr<const std::string> m_contents;
+};
+
+} // anonymous namespace
+
+SLANG_NO_THROW SlangResult SLANG_MCALL CachingFileSystem::queryInterface(SlangUUID const& uuid, void** outObject) {
+	void* object = castAs(uuid);
+	if (!object) {
+		*outObject = nullptr;
+		return SLANG_E_NO_INTERFACE;
+	}
+	addRef();
+	*outObject = object;
+	return SLANG_OK;
+}
+
+SLANG_NO_THROW uint32_t SLANG_MCALL CachingFileSystem::addRef() {
+	return ++m_refCount;
+}
+
+SLANG_NO_THROW uint32_t SLANG_MCALL CachingFileSystem::release() {
+	uint32_t count = --m_refCount;
+	if (count == 0) delete this;
+	return count;
+}
+
+SLANG_NO_THROW void* SLANG_MCALL CachingFileSystem::castAs(const SlangUUID& guid) {
+	if (
+		guid == ISlangUnknown::getTypeGuid() ||
+		guid == ISlangCastable::getTypeGuid() ||
+		guid == ISlangFileSystem::getTypeGuid()
+	) {
+		return static_cast<ISlangFileSystem*>(this);
+	}
+	return nullptr;
+}
+
+SLANG_NO_THROW SlangResult SLANG_MCALL CachingFileSystem::loadFile(char const* path, ISlangBlob** outBlob) {
+	auto maybeContents = lookup(path, nullptr);
+	if (isError(maybeContents)) {
+		*outBlob = nullptr;
+		return SLANG_E_NOT_FOUND;
+	}
+	ISlangBlob* blob = new SharedStringBlob(std::get<0>(maybeContents));
+	blob->addRef();
+	*outBlob = blob;
+	return SLANG_OK;
+}
+
+Result<std::string, Error> CachingFileSystem::readFile(const std::filesystem::path& path) {
+	std::shared_ptr<const std::string> contents;
+	TRY_ASSIGN(contents, lookup(path, nullptr));
+	return *contents;
+}
+
+Result<uint64_t, Error> CachingFileSystem::contentHash(const std::filesystem::path& path) {
+	uint64_t hash = 0;
+	TRY(lookup(path, &hash));
+	return hash;
+}
+
+void CachingFileSystem::addVirtualFile(const std::filesystem::path& path, std::string contents) {
+	Entry entry;
+	entry.hash = hashContents(contents);
+	entry.size = contents.size();
+	entry.contents = std::make_shared<const std::string>(std::move(contents));
+	std::lock_guard lock(m_mutex);
+	m_virtualFiles[makeKey(path)] = std::move(entry);
+}
+
+void CachingFileSystem::removeVirtualFile(const std::filesystem::path& path) {
+	std::lock_guard lock(m_mutex);
+	m_virtualFiles.erase(makeKey(path));
+}
+
+bool CachingFileSystem::isVirtualFile(const std::filesystem::path& path) const {
+	std::lock_guard lock(m_mutex);
+	return m_virtualFiles.count(makeKey(path)) > 0;
+}
+
+bool CachingFileSystem::exists(const std::filesystem::path& path) const {
+	if (isVirtualFile(path)) return true;
+	std::error_code err;
+	return std::filesystem::is_regular_file(path, err);
+}
+
+void CachingFileSystem::newGeneration() {
+	std::lock_guard lock(m_mutex);
+	++m_generation;
+}
+
+void CachingFileSystem::invalidate(const std::filesystem::path& path) {
+	std::lock_guard lock(m_mutex);
+	m_files.erase(makeKey(path));
+}
+
+void CachingFileSystem::invalidateAll() {
+	std::lock_guard lock(m_mutex);
+	m_files.clear();
+}
+
+CachingFileSystem::Stats CachingFileSystem::stats() const {
+	std::lock_guard lock(m_mutex);
+	return m_stats;
+}
+
+std::string CachingFileSystem::makeKey(const std::filesystem::path& path) {
+	std::error_code err;
+	std::filesystem::path absolutePath = std::filesystem::absolute(path, err);
+	if (err) absolutePath = path;
+	return absolutePath.lexically_normal().generic_string();
+}
+
+Result<std::shared_ptr<const std::string>, Error> CachingFileSystem::lookup(
+	const std::filesystem::path& path,
+	uint64_t* outHash
+) {
+	std::string key = makeKey(path);
+	std::lock_guard lock(m_mutex);
+
+	auto virtualIt = m_virtualFiles.find(key);
+	if (virtualIt != m_virtualFiles.end()) {
+		++m_stats.hits;
+		if (outHash) *outHash = virtualIt->second.hash;
+		return virtualIt->second.contents;
+	}
+
+	auto it = m_files.find(key);
+	if (it != m_files.end() && it->second.validatedGeneration == m_generation) {
+		++m_stats.hits;
+		if (outHash) *outHash = it->second.hash;
+		return it->second.contents;
+	}
+
+	std::error_code err;
+	auto modificationTime = std::filesystem::last_write_time(path, err);
+	uintmax_t size = err ? 0 : std::filesystem::file_size(path, err);
+	if (err) {
+		m_files.erase(key);
+		return Error{ "Could not open input file '" + path.string() + "'" };
+	}
+
+	if (it != m_files.end() && it->second.modificationTime == modificationTime && it->second.size == size) {
+		// Still valid
+		++m_stats.hits;
+		it->second.validatedGeneration = m_generation;
+		if (outHash) *outHash = it->second.hash;
+		return it->second.contents;
+	}
+
+	std::string contents;
+	TRY_ASSIGN(contents, loadTextFile(path));
+	uint64_t hash = hashContents(contents);
+
+	if (it != m_files.end()) {
+		++m_stats.reloads;
+		Entry& entry = it->second;
+		if (entry.hash != hash) {
+			entry.contents = std::make_shared<const std::string>(std::move(contents));
+			entry.hash = hash;
+		}
+		entry.modificationTime = modificationTime;
+		entry.size = size;
+		entry.validatedGeneration = m_generation;
+		if (outHash) *outHash = entry.hash;
+		return entry.contents;
+	}
+
+	++m_stats.misses;
+	Entry entry;
+	entry.contents = std::make_shared<const std::string>(std::move(contents));
+	entry.hash = hash;
+	entry.modificationTime = modificationTime;
+	entry.size = size;
+	entry.validatedGeneration = m_generation;
+	if (outHash) *outHash = entry.hash;
+	auto contentsPtr = entry.contents;
+	m_files[key] = std::move(entry);
+	return contentsPtr;
+}
@@ -0,0 +1,109 @@
+#pragma once
+
+#include <slang-webgpu/common/result.h>
+
+#include <slang.h>
+
+#include <atomic>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+/**
+ * A Slang file system that keeps the contents of the files it reads in
+ * memory, so that compiling several modules that import the same files only
+ * reads them once. It also serves virtual files, which only exist in memory.
+ *
+ * Files read from disk are validated against their modification time and size
+ * at most once per generation: call newGeneration() before each compilation to
+ * pick up files that changed in between. A file whose timestamp changed but
+ * whose content hash did not is kept as is.
+ *
+ * This object is reference counted like any Slang COM object, so it must be
+ * allocated with new and held by a Slang::ComPtr.
+ */
+class CachingFileSystem : public ISlangFileSystem {
+public:
+	struct Stats {
+		uint64_t hits = 0;
+		uint64_t misses = 0;
+		uint64_t reloads = 0;
+	};
+
+public:
+	CachingFileSystem() = default;
+	CachingFileSystem(const CachingFileSystem&) = delete;
+	CachingFileSystem& operator=(const CachingFileSystem&) = delete;
+	virtual ~CachingFileSystem() = default;
+
+	// ISlangUnknown
+	SLANG_NO_THROW SlangResult SLANG_MCALL queryInterface(SlangUUID const& uuid, void** outObject) SLANG_OVERRIDE;
+	SLANG_NO_THROW uint32_t SLANG_MCALL addRef() SLANG_OVERRIDE;
+	SLANG_NO_THROW uint32_t SLANG_MCALL release() SLANG_OVERRIDE;
+
+	// ISlangCastable
+	SLANG_NO_THROW void* SLANG_MCALL castAs(const SlangUUID& guid) SLANG_OVERRIDE;
+
+	// ISlangFileSystem
+	SLANG_NO_THROW SlangResult SLANG_MCALL loadFile(char const* path, ISlangBlob** outBlob) SLANG_OVERRIDE;
+
+	/**
+	 * Read a file through the cache (virtual files included).
+	 */
+	Result<std::string, Error> readFile(const std::filesystem::path& path);
+
+	/**
+	 * Hash of the contents of a file, as cached by the last read.
+	 */
+	Result<uint64_t, Error> contentHash(const std::filesystem::path& path);
+
+	/**
+	 * Register a file that only exists in memory. It shadows any file on disk
+	 * that has the same path.
+	 */
+	void addVirtualFile(const std::filesystem::path& path, std::string contents);
+	void removeVirtualFile(const std::filesystem::path& path);
+	bool isVirtualFile(const std::filesystem::path& path) const;
+
+	/**
+	 * True if the file is either virtual or on disk.
+	 */
+	bool exists(const std::filesystem::path& path) const;
+
+	/**
+	 * Require files read from disk to be validated again before being served.
+	 */
+	void newGeneration();
+
+	/**
+	 * Forget the cached contents of a file (or of all files), but not the
+	 * virtual files.
+	 */
+	void invalidate(const std::filesystem::path& path);
+	void invalidateAll();
+
+	Stats stats() const;
+
+private:
+	struct Entry {
+		std::shared_ptr<const std::string> contents;
+		uint64_t hash = 0;
+		std::filesystem::file_time_type modificationTime;
+		uintmax_t size = 0;
+		uint64_t validatedGeneration = 0;
+	};
+
+	static std::string makeKey(const std::filesystem::path& path);
+	Result<std::shared_ptr<const std::string>, Error> lookup(const std::filesystem::path& path, uint64_t* outHash);
+
+private:
+	std::atomic<uint32_t> m_refCount = 0;
+	mutable std::mutex m_mutex;
+	std::unordered_map<std::string, Entry> m_files;
+	std::unordered_map<std::string, Entry> m_virtualFiles;
+	uint64_t m_generation = 1;
+	Stats m_stats;
+};
@@ -0,0 +1,123 @@
+#include "kernel-fusion.h"
+
+#include <algorithm>
+#include <cctype>
+#include <sstream>
+
+namespace {
+
+const char* supportedSemantics[] = {
+	"SV_DispatchThreadID",
+	"SV_GroupThreadID",
+	"SV_GroupID",
+	"SV_GroupIndex",
+};
+
+std::string toUpper(std::string str) {
+	std::transform(str.begin(), str.end(), str.begin(), [](char c) { return (char)std::toupper((unsigned char)c); });
+	return str;
+}
+
+/**
+ * Name of the parameter of the fused entry point bound to a semantic, e.g.,
+ * "fusedDispatchThreadID".
+ */
+std::string fusedParameterName(const std::string& canonicalSemantic) {
+	return "fused" + canonicalSemantic.substr(3);
+}
+
+bool isIdentifier(const std::string& str) {
+	return !str.empty()
+		&& !std::isdigit((unsigned char)str[0])
+		&& std::all_of(str.begin(), str.end(), [](char c) { return std::isalnum((unsigned char)c) || c == '_'; });
+}
+
+} // anonymous namespace
+
+Result<FusionSpec, Error> parseFusionSpec(
+	const std::string& spec
+) {
+	FusionSpec fusion;
+	std::string stageList = spec;
+	size_t eq = spec.find('=');
+	if (eq != std::string::npos) {
+		fusion.name = spec.substr(0, eq);
+		stageList = spec.substr(eq + 1);
+	}
+
+	std::istringstream stream(stageList);
+	std::string stage;
+	while (std::getline(stream, stage, ',')) {
+		TRY_ASSERT(isIdentifier(stage), "Invalid entry point name '" << stage << "' in fusion '" << spec << "'");
+		fusion.stages.push_back(stage);
+	}
+	TRY_ASSERT(fusion.stages.size() >= 2, "Fusion '" << spec << "' must list at least two entry points");
+
+	if (fusion.name.empty()) {
+		fusion.name = fusion.stages[0];
+		for (size_t i = 1; i < fusion.stages.size(); ++i) {
+			std::string stageName = fusion.stages[i];
+			stageName[0] = (char)std::toupper((unsigned char)stageName[0]);
+			fusion.name += "Then" + stageName;
+		}
+	}
+	TRY_ASSERT(isIdentifier(fusion.name), "Invalid name '" << fusion.name << "' for fused entry point");
+
+	return fusion;
+}
+
+std::string canonicalFusionSemantic(
+	const std::string& semantic
+) {
+	std::string upper = toUpper(semantic);
+	for (const char* supported : supportedSemantics) {
+		if (toUpper(supported) == upper) return supported;
+	}
+	return {};
+}
+
+bool isVectorFusionSemantic(
+	const std::string& canonicalSemantic
+) {
+	return canonicalSemantic != "SV_GroupIndex";
+}
+
+std::string generateFusedEntryPoint(
+	const FusionSpec& spec,
+	const std::array<uint64_t, 3>& workgroupSize,
+	const std::vector<FusionStage>& stages
+) {
+	// Union of the semantics used by all stages
+	std::vector<std::string> semantics;
+	for (const FusionStage& stage : stages) {
+		for (const std::string& semantic : stage.semantics) {
+			if (std::find(semantics.begin(), semantics.end(), semantic) == semantics.end()) {
+				semantics.push_back(semantic);
+			}
+		}
+	}
+
+	std::ostringstream out;
+	out << "\n";
+	out << "// Fused entry point generated by slang_webgpu_generator\n";
+	out << "[shader(\"compute\")]\n";
+	out << "[numthreads(" << workgroupSize[0] << ", " << workgroupSize[1] << ", " << workgroupSize[2] << ")]\n";
+	out << "void " << spec.name << "(";
+	for (size_t i = 0; i < semantics.size(); ++i) {
+		if (i > 0) out << ", ";
+		out << (isVectorFusionSemantic(semantics[i]) ? "uint3 " : "uint ");
+		out << fusedParameterName(semantics[i]) << " : " << semantics[i];
+	}
+	out << ")\n";
+	out << "{\n";
+	for (const FusionStage& stage : stages) {
+		out << "\t" << stage.name << "(";
+		for (size_t i = 0; i < stage.semantics.size(); ++i) {
+			if (i > 0) out << ", ";
+			out << fusedParameterName(stage.semantics[i]);
+		}
+		out << ");\n";
+	}
+	out << "}\n";
+	return out.str();
+}
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <slang-webgpu/common/result.h>
+
+#include <array>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ * Kernel fusion generates a new entry point that calls a sequence of existing
+ * entry points in order, within each thread. This is only valid when the
+ * fused entry points access the buffers they write element-wise, which is
+ * checked on the generated WGSL (see checkElementWiseAccess()).
+ */
+
+/**
+ * A fused entry point, parsed from a specification of the form
+ * "add,multiplyAndAdd" or "myName=add,multiplyAndAdd". When no name is given,
+ * stage names are joined with "Then", e.g. "addThenMultiplyAndAdd".
+ */
+struct FusionSpec {
+	std::string name;
+	std::vector<std::string> stages;
+};
+
+Result<FusionSpec, Error> parseFusionSpec(
+	const std::string& spec
+);
+
+/**
+ * What the generator needs to know about each fused stage: the system value
+ * semantics of its parameters, in order.
+ */
+struct FusionStage {
+	std::string name;
+	std::vector<std::string> semantics;
+};
+
+/**
+ * Return the semantic as spelled in Slang (e.g., "SV_DispatchThreadID") if it
+ * is supported by fusion, or an empty string otherwise. Comparison is case
+ * insensitive because reflection may return upper-cased semantics.
+ */
+std::string canonicalFusionSemantic(
+	const std::string& semantic
+);
+
+/**
+ * Whether the parameter bound to the semantic is a vector (uint3) or a scalar
+ * (uint).
+ */
+bool isVectorFusionSemantic(
+	const std::string& canonicalSemantic
+);
+
+/**
+ * Generate the Slang source of the fused entry point, to be appended to the
+ * module that defines the stages.
+ */
+std::string generateFusedEntryPoint(
+	const FusionSpec& spec,
+	const std::array<uint64_t, 3>& workgroupSize,
+	const std::vector<FusionStage>& stages
+);
@@ -3,6 +3,12 @@
 #include <slang-webgpu/common/io.h>
 #include <slang-webgpu/common/variant-utils.h>
 #include <slang-webgpu/common/slang-result-utils.h>
+#include <slang-webgpu/common/kernel-archive.h>
+
+#include "autodiff.h"
+#include "caching-file-system.h"
+#include "kernel-fusion.h"
+#include "resource-report.h"
 
 #include <slang.h>
 #include <slang-com-ptr.h>
@@ -16,13 +22,33 @@
 #include <string_view>
 #include <optional>
 #include <algorithm>
+#include <cctype>
 #include <deque>
+#include <map>
+#include <set>
+#include <iomanip>
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <exception>
 
 using namespace slang;
 using magic_enum::enum_name;
 
 /**
- * Command line arguments
+ * Options forwarded to Slang compiler, which affect the generated code.
+ * Empty strings mean that Slang's default is used.
+ */
+struct CompilerOptions {
+	std::string optimization;
+	std::string floatingPointMode;
+	std::string debugInfo;
+	std::string matrixLayout;
+};
+
+/**
+ * Command line arguments that describe a kernel to generate
  */
 struct Arguments {
 	std::string name;
@@ -32,75 +58,375 @@ struct Arguments {
 	std::filesystem::path outputHpp;
 	std::filesystem::path outputCpp;
 	std::filesystem::path outputDepfile;
+	std::filesystem::path outputReport;
+	std::filesystem::path outputArchive;
+	std::string limits = "webgpu-default";
+	bool failOnLimits = false;
 	std::vector<std::string> entryPoints;
+	std::vector<std::string> fusions;
+	std::vector<std::string> differentiable;
+	std::vector<std::string> autodiffSharedParameters;
+	std::string gradientAccumulation = "workgroup";
+	uint32_t autodiffWorkgroupSize = 64;
+	bool dynamicUniforms = false;
 	std::vector<std::string> includeDirectories;
+	CompilerOptions compilerOptions;
+};
+
+/**
+ * Command line arguments that apply to the whole invocation of the generator,
+ * which may generate multiple kernels in batch mode.
+ */
+struct GlobalArguments {
+	std::filesystem::path batch;
+	std::filesystem::path coreModuleCache;
+	uint32_t jobs = 0;
+	std::string logLevel = "debug";
+	std::string logFormat = "text";
+	std::string logOutput = "stdout";
 };
 
-Result<Void, Error> run(const Arguments& args);
+/**
+ * Objects shared by all kernels generated by a single invocation.
+ */
+struct GeneratorContext {
+	Slang::ComPtr<IGlobalSession> globalSession;
+	Slang::ComPtr<CachingFileSystem> fileSystem;
+
+	// Outputs that may be shared by several kernels of a batch are only
+	// written once all kernels have been generated (see writeSharedOutputs).
+	struct Depfile {
+		std::vector<std::string> targets;
+		std::set<std::string> dependencies;
+	};
+	std::map<std::filesystem::path, std::vector<KernelDescription>> archives;
+	std::map<std::filesystem::path, Depfile> depfiles;
+
+	// Names of the kernels that use each shared bind group layout
+	std::map<std::string, std::vector<std::string>> bindGroupLayouts;
+};
+
+void addGlobalOptions(CLI::App& app, GlobalArguments& globalArgs);
+void configureLogger(const GlobalArguments& globalArgs);
+void addKernelOptions(CLI::App& app, Arguments& args, const CachingFileSystem* fileSystem);
+Result<GeneratorContext, Error> createGeneratorContext(const GlobalArguments& globalArgs);
+Result<Void, Error> run(const Arguments& args, GeneratorContext& context);
+Result<Void, Error> runBatch(const GlobalArguments& globalArgs, GeneratorContext& context);
+Result<Void, Error> writeSharedOutputs(GeneratorContext& context);
+int runPack(int argc, char* argv[]);
 
 int main(int argc, char* argv[]) {
 	CLI::App app{ "App description" };
 	argv = app.ensure_utf8(argv);
 
+	// The 'pack' command merges existing kernel archives
+	if (argc > 1 && std::string(argv[1]) == "pack") {
+		return runPack(argc - 1, argv + 1);
+	}
+
+	// Global options are parsed first, because in batch mode the options that
+	// describe kernels are read from the batch file rather than from argv.
+	GlobalArguments globalArgs;
+	CLI::App globalApp;
+	globalApp.set_help_flag();
+	globalApp.allow_extras();
+	addGlobalOptions(globalApp, globalArgs);
+	CLI11_PARSE(globalApp, argc, argv);
+	configureLogger(globalArgs);
+
 	Arguments args;
+	if (globalArgs.batch.empty()) {
+		addGlobalOptions(app, globalArgs);
+		addKernelOptions(app, args, nullptr);
+		CLI11_PARSE(app, argc, argv);
+	}
+	else if (!globalApp.remaining().empty()) {
+		LOG(ERROR) << "Options that describe a kernel must be given in the batch file when using --batch.";
+		return 1;
+	}
+
+	Result<Void, Error> maybeError = Void{};
+	auto maybeContext = createGeneratorContext(globalArgs);
+	if (isError(maybeContext)) {
+		maybeError = std::get<Error>(maybeContext);
+	}
+	else if (globalArgs.batch.empty()) {
+		maybeError = run(args, std::get<0>(maybeContext));
+	}
+	else {
+		maybeError = runBatch(globalArgs, std::get<0>(maybeContext));
+	}
+	if (!isError(maybeError)) {
+		maybeError = writeSharedOutputs(std::get<0>(maybeContext));
+	}
+
+	if (isError(maybeError)) {
+		LOG(ERROR) << std::get<Error>(maybeError).message;
+		return 1;
+	}
+
+	return 0;
+}
+
+void addGlobalOptions(CLI::App& app, GlobalArguments& globalArgs) {
+	app.add_option("--batch", globalArgs.batch, "Path to a batch file that lists the options of one kernel per line. All kernels share the same file cache, and the same Slang global session unless they run on different workers (see --jobs). A block starting with a line '@file <path>' and ending with '@end' defines a virtual file that may be used as an input Slang source.")
+		->check(CLI::ExistingFile);
+	app.add_option("--core-module-cache", globalArgs.coreModuleCache, "Directory where a serialized Slang core module is cached, to speed up the creation of the global session. The cache is keyed by Slang version.");
+	app.add_option("-j,--jobs", globalArgs.jobs, "Maximum number of kernels of a batch that are generated in parallel, 0 meaning one per CPU core. Each parallel worker holds its own Slang global session, so this also bounds memory usage. Outputs, and the logs of each job, do not depend on this.")
+		->capture_default_str();
+	app.add_option("--log-level", globalArgs.logLevel, "Most verbose level of messages that are printed. Messages more verbose than SLANG_WEBGPU_LOG_LEVEL are never printed, as they are not compiled in.")
+		->check(CLI::IsMember({ "error", "warning", "info", "debug" }))
+		->capture_default_str();
+	app.add_option("--log-format", globalArgs.logFormat, "Format of the messages: plain 'text', or 'json' with one object per line, e.g., to be parsed by a build system.")
+		->check(CLI::IsMember({ "text", "json" }))
+		->capture_default_str();
+	app.add_option("--log-output", globalArgs.logOutput, "Stream where messages are printed.")
+		->check(CLI::IsMember({ "stdout", "stderr" }))
+		->capture_default_str();
+}
+
+void configureLogger(const GlobalArguments& globalArgs) {
+	Logger::Options options;
+	if (globalArgs.logLevel == "error") options.level = Logger::Level::ERROR;
+	else if (globalArgs.logLevel == "warning") options.level = Logger::Level::WARNING;
+	else if (globalArgs.logLevel == "info") options.level = Logger::Level::INFO;
+	else options.level = Logger::Level::DEBUG;
+	options.format = globalArgs.logFormat == "json" ? Logger::Format::Json : Logger::Format::Text;
+	options.output = globalArgs.logOutput == "stderr" ? Logger::Output::Stderr : Logger::Output::Stdout;
+	Logger::configure(options);
+}
+
+void addKernelOptions(CLI::App& app, Arguments& args, const CachingFileSystem* fileSystem) {
+	// Input files may also be virtual files of the generator's file system
+	CLI::Validator existingInput(
+		[fileSystem](std::string& path) -> std::string {
+			if (fileSystem && fileSystem->exists(path)) return {};
+			return CLI::ExistingFile(path);
+		},
+		"FILE"
+	);
+
 	app.add_option("-n,--name", args.name, "Name of the shader module. This must be a valid C identifier.")
 		->required();
 	app.add_option("-i,--input-slang", args.inputSlang, "Path to the input Slang shader source")
 		->required()
-		->check(CLI::ExistingFile);
+		->check(existingInput);
 	auto inputTemplateOpt = app.add_option("-t,--input-template", args.inputTemplate, "Path to the template used to generate binding source")
 		->check(CLI::ExistingFile);
 	app.add_option("-w,--output-wgsl", args.outputWgsl, "Path to the output WGSL shader source");
 	auto outputHppOpt = app.add_option("-g,--output-hpp", args.outputHpp, "Path to the output C++ header file that define kernels for each entry point");
 	auto outputCppOpt = app.add_option("-c,--output-cpp", args.outputCpp, "Path to the output C++ source file that implements the header file");
-	app.add_option("-d,--output-depfile", args.outputDepfile, "Path to the depfile that lists dependencies of the shader through import statements. This is designed to be used with CMake's DEPFILE option in add_custom_command().");
-	app.add_option("-e,--entrypoint,--entrypoints", args.entryPoints, "Entry points to generate kernel for")
-		->required()
+	app.add_option("-d,--output-depfile", args.outputDepfile, "Path to the depfile that lists dependencies of the shader through import statements. This is designed to be used with CMake's DEPFILE option in add_custom_command(). Kernels of a batch may share the same depfile.");
+	app.add_option("-a,--output-archive", args.outputArchive, "Path to a kernel archive into which the WGSL source and reflection of the kernel are written, to be loaded at runtime with DynamicKernel. Kernels of a batch that have the same output archive are packed together.");
+	app.add_option("-e,--entrypoint,--entrypoints", args.entryPoints, "Entry points to generate kernel for. May be omitted when --differentiable is used.")
+		->delimiter(';');
+	app.add_option("--fuse", args.fusions, "Generate an extra entry point that runs the given entry points in order within each thread, e.g., 'add,multiplyAndAdd' (or 'name=add,multiplyAndAdd' to choose its name). The fused entry points must have the same workgroup size and only access the buffers they write at the index of the current thread.");
+	app.add_option("--differentiable", args.differentiable, "[Differentiable] functions of the form 'float f(float a, ...)' for which forward and backward entry points are generated ('fForward', 'fBackward' and, if needed, 'fReduceGradients')")
+		->delimiter(';');
+	app.add_option("--autodiff-shared-parameters", args.autodiffSharedParameters, "Parameters of differentiable functions that are shared by all elements (either 'a' or 'f.a'), whose gradient is summed over all elements")
 		->delimiter(';');
+	app.add_option("--gradient-accumulation", args.gradientAccumulation, "How gradients of shared parameters are summed: with atomics, or with per-workgroup partial sums followed by a reduction pass")
+		->check(CLI::IsMember({ "atomic", "workgroup" }))
+		->capture_default_str();
+	app.add_option("--autodiff-workgroup-size", args.autodiffWorkgroupSize, "Workgroup size of generated autodiff entry points (must be a power of two)")
+		->capture_default_str();
+	app.add_flag("--dynamic-uniforms", args.dynamicUniforms, "Bind the uniform buffer with a dynamic offset, so that uniforms of many dispatches may be stored in a single buffer (see UniformRingBuffer)");
 	app.add_option("-I,--include-directories", args.includeDirectories, "Directories where to look for includes in slang shader")
 		->delimiter(';');
+	app.add_option("-O,--optimization", args.compilerOptions.optimization, "Optimization level used by Slang when generating code")
+		->check(CLI::IsMember({ "none", "default", "high", "maximal" }));
+	app.add_option("--floating-point-mode", args.compilerOptions.floatingPointMode, "Floating point mode (fast mode allows reordering and approximations)")
+		->check(CLI::IsMember({ "default", "fast", "precise" }));
+	app.add_option("--debug-info", args.compilerOptions.debugInfo, "Level of debug information emitted in the generated code")
+		->check(CLI::IsMember({ "none", "minimal", "standard", "maximal" }));
+	app.add_option("--matrix-layout", args.compilerOptions.matrixLayout, "Default matrix layout")
+		->check(CLI::IsMember({ "row", "column" }));
+	app.add_option("-r,--output-report", args.outputReport, "Path to the output JSON report that lists resources used by each entry point (workgroup storage, bindings, invocations) and their estimated occupancy");
+	app.add_option("--limits", args.limits, "Device limits used to check the kernel: either 'webgpu-default' or the path to a limits file")
+		->capture_default_str();
+	app.add_flag("--fail-on-limits", args.failOnLimits, "Fail when an entry point exceeds the device limits, instead of only warning");
 
 	// These options need each others
 	outputHppOpt->needs(outputCppOpt, inputTemplateOpt);
 	outputCppOpt->needs(outputHppOpt, inputTemplateOpt);
 	inputTemplateOpt->needs(outputHppOpt, outputCppOpt);
+}
 
-	CLI11_PARSE(app, argc, argv);
+struct SessionInfo {
+	// We need to keep the global session alive throughout the entire program.
+	Slang::ComPtr<IGlobalSession> globalSession;
+	Slang::ComPtr<ISession> session;
+};
 
-	auto maybeError = run(args);
+/**
+ * Translate our compiler options into Slang's option entries. Options that
+ * affect the whole session (e.g., matrix layout) are returned separately from
+ * the ones that affect code generation for the target.
+ */
+struct CompilerOptionEntries {
+	std::vector<CompilerOptionEntry> session;
+	std::vector<CompilerOptionEntry> target;
+};
 
-	if (isError(maybeError)) {
-		LOG(ERROR) << std::get<Error>(maybeError).message;
-		return 1;
+CompilerOptionEntries buildCompilerOptionEntries(const CompilerOptions& options) {
+	auto makeEntry = [](CompilerOptionName name, int32_t value) {
+		CompilerOptionEntry entry;
+		entry.name = name;
+		entry.value.kind = CompilerOptionValueKind::Int;
+		entry.value.intValue0 = value;
+		return entry;
+	};
+
+	CompilerOptionEntries entries;
+
+	if (!options.optimization.empty()) {
+		SlangOptimizationLevel level =
+			options.optimization == "none" ? SLANG_OPTIMIZATION_LEVEL_NONE :
+			options.optimization == "high" ? SLANG_OPTIMIZATION_LEVEL_HIGH :
+			options.optimization == "maximal" ? SLANG_OPTIMIZATION_LEVEL_MAXIMAL :
+			SLANG_OPTIMIZATION_LEVEL_DEFAULT;
+		entries.target.push_back(makeEntry(CompilerOptionName::Optimization, (int32_t)level));
 	}
 
-	return 0;
+	if (!options.floatingPointMode.empty()) {
+		SlangFloatingPointMode mode =
+			options.floatingPointMode == "fast" ? SLANG_FLOATING_POINT_MODE_FAST :
+			options.floatingPointMode == "precise" ? SLANG_FLOATING_POINT_MODE_PRECISE :
+			SLANG_FLOATING_POINT_MODE_DEFAULT;
+		entries.target.push_back(makeEntry(CompilerOptionName::FloatingPointMode, (int32_t)mode));
+	}
+
+	if (!options.debugInfo.empty()) {
+		SlangDebugInfoLevel level =
+			options.debugInfo == "minimal" ? SLANG_DEBUG_INFO_LEVEL_MINIMAL :
+			options.debugInfo == "standard" ? SLANG_DEBUG_INFO_LEVEL_STANDARD :
+			options.debugInfo == "maximal" ? SLANG_DEBUG_INFO_LEVEL_MAXIMAL :
+			SLANG_DEBUG_INFO_LEVEL_NONE;
+		entries.target.push_back(makeEntry(CompilerOptionName::DebugInformation, (int32_t)level));
+	}
+
+	if (options.matrixLayout == "row") {
+		entries.session.push_back(makeEntry(CompilerOptionName::MatrixLayoutRow, 1));
+	}
+	else if (options.matrixLayout == "column") {
+		entries.session.push_back(makeEntry(CompilerOptionName::MatrixLayoutColumn, 1));
+	}
+
+	return entries;
 }
 
-struct SessionInfo {
-	// We need to keep the global session alive throughout the entire program.
+/**
+ * Human readable summary of the compiler options, used in logs and in the
+ * generated code.
+ */
+std::string describeCompilerOptions(const CompilerOptions& options) {
+	std::ostringstream out;
+	auto append = [&](const char* name, const std::string& value) {
+		if (value.empty()) return;
+		if (out.tellp() > 0) out << ", ";
+		out << name << "=" << value;
+	};
+	append("optimization", options.optimization);
+	append("floating-point-mode", options.floatingPointMode);
+	append("debug-info", options.debugInfo);
+	append("matrix-layout", options.matrixLayout);
+	std::string description = out.str();
+	return description.empty() ? "default" : description;
+}
+
+/**
+ * Loading and checking Slang's core module is most of the cost of creating a
+ * global session. When a cache directory is provided, the core module is
+ * serialized there the first time, and later sessions are created from it.
+ */
+Result<Slang::ComPtr<IGlobalSession>, Error> createGlobalSessionWithCache(
+	const std::filesystem::path& coreModuleCache
+) {
 	Slang::ComPtr<IGlobalSession> globalSession;
-	Slang::ComPtr<ISession> session;
-};
+	if (coreModuleCache.empty()) {
+		TRY_SLANG(createGlobalSession(globalSession.writeRef()));
+		return globalSession;
+	}
+
+	// Key the cache with the version of the Slang library actually loaded
+	TRY_SLANG(slang_createGlobalSessionWithoutCoreModule(SLANG_API_VERSION, globalSession.writeRef()));
+	std::string key = globalSession->getBuildTagString();
+#ifdef SLANG_WEBGPU_SLANG_VERSION
+	key = std::string(SLANG_WEBGPU_SLANG_VERSION) + "-" + key;
+#endif // SLANG_WEBGPU_SLANG_VERSION
+	std::replace_if(key.begin(), key.end(), [](char c) { return !std::isalnum((unsigned char)c) && c != '.' && c != '-'; }, '_');
+	std::filesystem::path cachePath = coreModuleCache / ("slang-core-module-" + key + ".bin");
+
+	if (std::filesystem::exists(cachePath)) {
+		LOG(INFO) << "Loading Slang core module from cache " << cachePath << "...";
+		auto maybeBlob = loadBinaryFile(cachePath);
+		if (isError(maybeBlob)) {
+			LOG(WARNING) << std::get<Error>(maybeBlob).message;
+		}
+		else {
+			const std::vector<uint8_t>& blob = std::get<0>(maybeBlob);
+			if (SLANG_SUCCEEDED(globalSession->loadCoreModule(blob.data(), blob.size()))) {
+				return globalSession;
+			}
+			LOG(WARNING) << "Could not load cached Slang core module, building it again.";
+		}
+	}
+
+	// Cache miss: create a regular session and serialize its core module
+	globalSession = nullptr;
+	TRY_SLANG(createGlobalSession(globalSession.writeRef()));
+
+	LOG(INFO) << "Saving Slang core module into cache " << cachePath << "...";
+	Slang::ComPtr<ISlangBlob> coreModule;
+	SlangResult res = globalSession->saveCoreModule(SLANG_ARCHIVE_TYPE_RIFF_LZ4, coreModule.writeRef());
+	if (SLANG_FAILED(res)) {
+		LOG(WARNING) << "Could not serialize Slang core module, status = " << res;
+		return globalSession;
+	}
+	auto maybeError = saveBinaryFile(cachePath, coreModule->getBufferPointer(), coreModule->getBufferSize());
+	if (isError(maybeError)) {
+		// Not fatal, the session is valid anyways
+		LOG(WARNING) << std::get<Error>(maybeError).message;
+	}
+
+	return globalSession;
+}
+
+Result<GeneratorContext, Error> createGeneratorContext(const GlobalArguments& globalArgs) {
+	LOG(INFO) << "Creating global Slang session...";
+	GeneratorContext context;
+	TRY_ASSIGN(context.globalSession, createGlobalSessionWithCache(globalArgs.coreModuleCache));
+	context.fileSystem = new CachingFileSystem();
+	return context;
+}
 
 Result<SessionInfo, Error> createSlangSession(
-	std::vector<std::string> includeDirectories
+	const GeneratorContext& context,
+	std::vector<std::string> includeDirectories,
+	const CompilerOptions& compilerOptions
 ) {
 
 	// This function is highly based on instructions found at
 	// https://shader-slang.com/slang/user-guide/compiling#using-the-compilation-api
 
-	LOG(INFO) << "Creating global Slang session...";
 	SessionInfo sessionInfo;
-	TRY_SLANG(createGlobalSession(sessionInfo.globalSession.writeRef()));
+	sessionInfo.globalSession = context.globalSession;
 
 	LOG(INFO) << "Creating Slang session...";
 	SessionDesc sessionDesc;
+	sessionDesc.fileSystem = context.fileSystem.get();
+
+	LOG(INFO) << "Compiler options: " << describeCompilerOptions(compilerOptions);
+	CompilerOptionEntries optionEntries = buildCompilerOptionEntries(compilerOptions);
 
 	TargetDesc target;
 	target.format = SLANG_WGSL;
+	target.compilerOptionEntries = optionEntries.target.data();
+	target.compilerOptionEntryCount = (uint32_t)optionEntries.target.size();
 	sessionDesc.targets = &target;
 	sessionDesc.targetCount = 1;
+	sessionDesc.compilerOptionEntries = optionEntries.session.data();
+	sessionDesc.compilerOptionEntryCount = (uint32_t)optionEntries.session.size();
 
 	if (!includeDirectories.empty()) {
 		LOG(INFO) << "Extra include directories:";
@@ -132,16 +458,13 @@ Result<ModuleInfo, Error> loadSlangModule(
 	const Slang::ComPtr<ISession>& session,
 	const std::string& name,
 	const std::filesystem::path& inputSlang,
+	const std::string& source,
 	const std::vector<std::string>& entryPoints
 ) {
 
 	// This function is highly based on instructions found at
 	// https://shader-slang.com/slang/user-guide/compiling#using-the-compilation-api
 
-	LOG(INFO) << "Loading file " << inputSlang << "...";
-	std::string source;
-	TRY_ASSIGN(source, loadTextFile(inputSlang));
-
 	LOG(INFO) << "Loading Slang module...";
 	Slang::ComPtr<IBlob> diagnostics;
 	IModule* module = session->loadModuleFromSourceString(
@@ -187,7 +510,7 @@ Result<ModuleInfo, Error> loadSlangModule(
 	};
 }
 
-Result<std::string, Error> compileToWgsl(
+Result<Slang::ComPtr<IComponentType>, Error> linkProgram(
 	const Slang::ComPtr<IComponentType>& program,
 	const std::filesystem::path& inputSlang // only to give context in error messages
 ) {
@@ -204,6 +527,13 @@ Result<std::string, Error> compileToWgsl(
 		return Error{ "Could not link slang module from file '" + inputSlang.string() + "': " + message };
 	}
 
+	return linkedProgram;
+}
+
+Result<std::string, Error> compileToWgsl(
+	const Slang::ComPtr<IComponentType>& linkedProgram,
+	const std::filesystem::path& inputSlang // only to give context in error messages
+) {
 	Slang::ComPtr<IBlob> codeBlob;
 	Slang::ComPtr<ISlangBlob> codeDiagnostics;
 	int targetIndex = 0; // only one target
@@ -222,6 +552,235 @@ Result<std::string, Error> compileToWgsl(
 	return wgslSource;
 }
 
+/**
+ * Generate the code of a single entry point, which only contains the
+ * declarations that this entry point uses.
+ */
+Result<std::string, Error> compileEntryPointToWgsl(
+	const Slang::ComPtr<IComponentType>& linkedProgram,
+	int entryPointIndex,
+	const std::filesystem::path& inputSlang // only to give context in error messages
+) {
+	Slang::ComPtr<IBlob> codeBlob;
+	Slang::ComPtr<ISlangBlob> codeDiagnostics;
+	int targetIndex = 0; // only one target
+	TRY_SLANG(linkedProgram->getEntryPointCode(
+		entryPointIndex,
+		targetIndex,
+		codeBlob.writeRef(),
+		codeDiagnostics.writeRef()
+	));
+	if (codeDiagnostics) {
+		std::string message = (const char*)codeDiagnostics->getBufferPointer();
+		return Error{ "Could not generate WGSL source code of entry point #" + std::to_string(entryPointIndex) + " from file '" + inputSlang.string() + "': " + message };
+	}
+
+	return std::string((const char*)codeBlob->getBufferPointer());
+}
+
+/**
+ * Gather static information about resources used by each entry point.
+ */
+Result<KernelReport, Error> buildKernelReport(
+	const Slang::ComPtr<IComponentType>& linkedProgram,
+	const std::string& name,
+	const std::string& wgslSource,
+	const std::filesystem::path& inputSlang // only to give context in error messages
+) {
+	LOG(INFO) << "Analyzing resources used by each entry point...";
+	slang::ProgramLayout* layout = linkedProgram->getLayout();
+
+	KernelReport report;
+	report.name = name;
+	report.bindings = countWgslBindings(wgslSource);
+
+	SlangUInt entryPointCount = layout->getEntryPointCount();
+	for (SlangUInt i = 0; i < entryPointCount; ++i) {
+		EntryPointReflection* entryPointLayout = layout->getEntryPointByIndex(i);
+		EntryPointReport entryPoint;
+		entryPoint.name = entryPointLayout->getName();
+
+		std::array<SlangUInt, 3> size;
+		entryPointLayout->getComputeThreadGroupSize(3, size.data());
+		entryPoint.workgroupSize = { size[0], size[1], size[2] };
+		entryPoint.invocations = size[0] * size[1] * size[2];
+
+		std::string entryPointSource;
+		TRY_ASSIGN(entryPointSource, compileEntryPointToWgsl(linkedProgram, (int)i, inputSlang));
+		TRY_ASSIGN(entryPoint.workgroupStorageSize, computeWorkgroupStorageSize(entryPointSource));
+		entryPoint.bindings = countWgslBindings(entryPointSource);
+
+		report.entryPoints.push_back(entryPoint);
+	}
+
+	return report;
+}
+
+/**
+ * Append to the module source the forward and backward entry points of each
+ * differentiable function. The module is first loaded on its own, in a
+ * separate session, to reflect the signature of the functions.
+ */
+Result<std::string, Error> addAutodiffEntryPoints(
+	const GeneratorContext& context,
+	const Arguments& args,
+	const std::string& source,
+	std::vector<DifferentiableFunction>& functions
+) {
+	GradientAccumulation accumulation;
+	TRY_ASSIGN(accumulation, parseGradientAccumulation(args.gradientAccumulation));
+	uint32_t workgroupSize = args.autodiffWorkgroupSize;
+	TRY_ASSERT(
+		workgroupSize > 0 && (workgroupSize & (workgroupSize - 1)) == 0,
+		"Autodiff workgroup size must be a power of two, but got " << workgroupSize
+	);
+
+	LOG(INFO) << "Reflecting differentiable functions...";
+	SessionInfo sessionInfo;
+	TRY_ASSIGN(sessionInfo, createSlangSession(context, args.includeDirectories, args.compilerOptions));
+	ModuleInfo moduleInfo;
+	TRY_ASSIGN(moduleInfo, loadSlangModule(sessionInfo.session, args.name, args.inputSlang, source, {}));
+	slang::ProgramLayout* layout = moduleInfo.program->getLayout();
+
+	std::set<std::string> usedSharedParameters;
+	auto isFloat = [](TypeReflection* type) {
+		return type
+			&& type->getKind() == TypeReflection::Kind::Scalar
+			&& type->getScalarType() == TypeReflection::ScalarType::Float32;
+	};
+
+	std::string autodiffSource = source;
+	for (const std::string& name : args.differentiable) {
+		FunctionReflection* functionLayout = layout->findFunctionByName(name.c_str());
+		TRY_ASSERT(functionLayout, "Differentiable function '" << name << "' not found in shader '" << args.inputSlang.string() << "'");
+		TRY_ASSERT(isFloat(functionLayout->getReturnType()), "Differentiable function '" << name << "' must return a float");
+
+		DifferentiableFunction function;
+		function.name = name;
+		function.accumulation = accumulation;
+		function.workgroupSize = workgroupSize;
+		unsigned parameterCount = functionLayout->getParameterCount();
+		for (unsigned i = 0; i < parameterCount; ++i) {
+			VariableReflection* parameterLayout = functionLayout->getParameterByIndex(i);
+			DifferentiableParameter parameter;
+			parameter.name = parameterLayout->getName();
+			TRY_ASSERT(isFloat(parameterLayout->getType()), "Parameter '" << parameter.name << "' of differentiable function '" << name << "' must be a float");
+			for (const std::string& qualifiedName : { parameter.name, name + "." + parameter.name }) {
+				const auto& shared = args.autodiffSharedParameters;
+				if (std::find(shared.begin(), shared.end(), qualifiedName) != shared.end()) {
+					parameter.isShared = true;
+					usedSharedParameters.insert(qualifiedName);
+				}
+			}
+			function.parameters.push_back(parameter);
+		}
+
+		LOG(INFO) << "- Adding autodiff entry points for '" << name << "' (" << gradientAccumulationName(accumulation) << " gradient accumulation)...";
+		autodiffSource += generateAutodiffKernels(function);
+		functions.push_back(function);
+	}
+
+	for (const std::string& sharedParameter : args.autodiffSharedParameters) {
+		TRY_ASSERT(
+			usedSharedParameters.count(sharedParameter) > 0,
+			"Shared parameter '" << sharedParameter << "' does not match any parameter of differentiable functions"
+		);
+	}
+
+	return autodiffSource;
+}
+
+/**
+ * Append to the module source a fused entry point for each fusion spec. The
+ * stages are first compiled on their own, in a separate session, to check
+ * that they can be fused.
+ */
+Result<std::string, Error> addFusedEntryPoints(
+	const GeneratorContext& context,
+	const Arguments& args,
+	const std::string& source,
+	const std::vector<FusionSpec>& fusions
+) {
+	std::vector<std::string> stageNames;
+	for (const FusionSpec& fusion : fusions) {
+		for (const std::string& stage : fusion.stages) {
+			if (std::find(stageNames.begin(), stageNames.end(), stage) == stageNames.end()) {
+				stageNames.push_back(stage);
+			}
+		}
+	}
+
+	LOG(INFO) << "Checking that entry points can be fused...";
+	SessionInfo sessionInfo;
+	TRY_ASSIGN(sessionInfo, createSlangSession(context, args.includeDirectories, args.compilerOptions));
+	ModuleInfo moduleInfo;
+	TRY_ASSIGN(moduleInfo, loadSlangModule(sessionInfo.session, args.name, args.inputSlang, source, stageNames));
+	Slang::ComPtr<IComponentType> linkedProgram;
+	TRY_ASSIGN(linkedProgram, linkProgram(moduleInfo.program, args.inputSlang));
+	slang::ProgramLayout* layout = linkedProgram->getLayout();
+
+	std::string fusedSource = source;
+	for (const FusionSpec& fusion : fusions) {
+		std::vector<FusionStage> stages;
+		std::array<uint64_t, 3> workgroupSize = { 0, 0, 0 };
+		for (const std::string& stageName : fusion.stages) {
+			size_t index = std::find(stageNames.begin(), stageNames.end(), stageName) - stageNames.begin();
+			EntryPointReflection* entryPoint = layout->getEntryPointByIndex(index);
+
+			std::array<SlangUInt, 3> size;
+			entryPoint->getComputeThreadGroupSize(3, size.data());
+			std::array<uint64_t, 3> stageWorkgroupSize = { size[0], size[1], size[2] };
+			if (stages.empty()) {
+				workgroupSize = stageWorkgroupSize;
+			}
+			TRY_ASSERT(
+				stageWorkgroupSize == workgroupSize,
+				"Cannot fuse '" << fusion.name << "': entry point '" << stageName << "' does not have the same workgroup size as '" << fusion.stages[0] << "'"
+			);
+			TRY_ASSERT(
+				workgroupSize[1] == 1 && workgroupSize[2] == 1,
+				"Cannot fuse '" << fusion.name << "': only one-dimensional workgroups are supported"
+			);
+
+			FusionStage stage;
+			stage.name = stageName;
+			unsigned parameterCount = entryPoint->getParameterCount();
+			for (unsigned i = 0; i < parameterCount; ++i) {
+				VariableLayoutReflection* parameter = entryPoint->getParameterByIndex(i);
+				const char* semanticName = parameter->getSemanticName();
+				std::string semantic = canonicalFusionSemantic(semanticName ? semanticName : "");
+				TRY_ASSERT(
+					!semantic.empty(),
+					"Cannot fuse '" << fusion.name << "': parameter '" << parameter->getName() << "' of entry point '" << stageName << "' does not have a supported system value semantic"
+				);
+				TypeReflection* type = parameter->getTypeLayout()->getType();
+				bool isExpectedType = isVectorFusionSemantic(semantic)
+					? type->getKind() == TypeReflection::Kind::Vector && type->getElementCount() == 3
+					: type->getKind() == TypeReflection::Kind::Scalar;
+				TRY_ASSERT(
+					isExpectedType,
+					"Cannot fuse '" << fusion.name << "': parameter '" << parameter->getName() << "' of entry point '" << stageName << "' must be a " << (isVectorFusionSemantic(semantic) ? "uint3" : "uint")
+				);
+				stage.semantics.push_back(semantic);
+			}
+
+			std::string stageWgsl;
+			TRY_ASSIGN(stageWgsl, compileEntryPointToWgsl(linkedProgram, (int)index, args.inputSlang));
+			auto maybeElementWise = checkElementWiseAccess(stageWgsl, stageName);
+			if (isError(maybeElementWise)) {
+				return Error{ "Cannot fuse '" + fusion.name + "': " + std::get<Error>(maybeElementWise).message };
+			}
+
+			stages.push_back(stage);
+		}
+
+		LOG(INFO) << "- Adding fused entry point '" << fusion.name << "'...";
+		fusedSource += generateFusedEntryPoint(fusion, workgroupSize, stages);
+	}
+
+	return fusedSource;
+}
+
 /**
  * This is a very basic templating system.
  */
@@ -355,6 +914,7 @@ public:
 	struct BufferBindingInfo {
 		std::string type;
 		std::optional<size_t> minBindingSize;
+		bool hasDynamicOffset;
 	};
 	using BindingDetails = std::variant<BufferBindingInfo>;
 	struct BindingInfo {
@@ -376,11 +936,17 @@ public:
 	BindingGenerator(
 		const std::string& name,
 		slang::ProgramLayout* layout,
-		const std::string& wgslSource
+		const std::string& wgslSource,
+		const std::string& compilerOptions,
+		const std::vector<DifferentiableFunction>& differentiableFunctions,
+		bool dynamicUniforms
 	)
 		: m_name(name)
 		, m_layout(layout)
 		, m_wgslSource(wgslSource)
+		, m_compilerOptions(compilerOptions)
+		, m_differentiableFunctions(differentiableFunctions)
+		, m_dynamicUniforms(dynamicUniforms)
 	{
 		m_initError = buildLayoutInfo();
 	}
@@ -389,6 +955,72 @@ public:
 		return m_initError;
 	}
 
+	/**
+	 * Describe the kernel for a kernel archive, which holds the same
+	 * information as the generated binding.
+	 */
+	Result<KernelDescription, Error> describeKernel() const {
+		TRY(check());
+		KernelDescription kernel;
+		kernel.name = m_name;
+		kernel.sourceFormat = KernelSourceFormat::Wgsl;
+		kernel.source = m_wgslSource;
+
+		for (SlangUInt i = 0; i < m_layout->getEntryPointCount(); ++i) {
+			EntryPointReflection* entryPointLayout = m_layout->getEntryPointByIndex(i);
+			std::array<SlangUInt, 3> size;
+			entryPointLayout->getComputeThreadGroupSize(3, size.data());
+			KernelEntryPointInfo entryPoint;
+			entryPoint.name = entryPointLayout->getName();
+			entryPoint.workgroupSize = { (uint32_t)size[0], (uint32_t)size[1], (uint32_t)size[2] };
+			kernel.entryPoints.push_back(entryPoint);
+		}
+
+		kernel.bindings = describeBindings();
+		return kernel;
+	}
+
+	/**
+	 * Describe the bindings in the same way as in a kernel archive.
+	 */
+	std::vector<KernelBindingInfo> describeBindings() const {
+		std::vector<KernelBindingInfo> bindings;
+		for (const BindingInfo& binding : m_layoutInfo.bindings) {
+			KernelBindingInfo bindingInfo;
+			bindingInfo.name = binding.name;
+			bindingInfo.binding = binding.index;
+			std::visit(overloaded{
+				[&](const BufferBindingInfo& bufferBinding) {
+					bindingInfo.minBindingSize = bufferBinding.minBindingSize.value_or(0);
+					bindingInfo.hasDynamicOffset = bufferBinding.hasDynamicOffset;
+					bindingInfo.type
+						= bufferBinding.type == "Uniform" ? KernelBindingType::Uniform
+						: bufferBinding.type == "ReadOnlyStorage" ? KernelBindingType::ReadOnlyStorage
+						: KernelBindingType::Storage;
+				}
+			}, binding.details);
+			bindings.push_back(bindingInfo);
+		}
+		return bindings;
+	}
+
+	/**
+	 * Name of the bind group layout type shared by all kernels that have the
+	 * same binding signature. It is derived from a hash of the signature, so
+	 * that kernels generated separately agree on it.
+	 */
+	std::string bindGroupLayoutName() const {
+		// 64-bit FNV-1a, which is stable across platforms and runs
+		uint64_t hash = 0xcbf29ce484222325ull;
+		for (char c : bindingSignature(describeBindings())) {
+			hash ^= (uint8_t)c;
+			hash *= 0x100000001b3ull;
+		}
+		std::ostringstream out;
+		out << "BindGroupLayout" << std::hex << std::setw(16) << std::setfill('0') << hash;
+		return out.str();
+	}
+
 	Result<Void, Error> processExpression(const std::string& expr, std::ostringstream& out) {
 		if (expr == "kernelName") {
 			out << m_name;
@@ -399,6 +1031,9 @@ public:
 		else if (expr == "wgslSource") {
 			out << m_wgslSource;
 		}
+		else if (expr == "compilerOptions") {
+			out << m_compilerOptions;
+		}
 		else if (expr == "workgroupSize") {
 			EntryPointReflection* entryPoint = m_layout->getEntryPointByIndex(m_currentEntryPoint);
 			std::array<SlangUInt, 3> size;
@@ -448,19 +1083,61 @@ public:
 				}, binding.details);
 			}));
 		}
+		else if (expr == "bindGroupViewMembers") {
+			TRY(visitBindings([&](unsigned i, const BindingInfo& binding) {
+				if (i > 0) out << ",\n\t\t";
+				out << "const BufferView& " << binding.name;
+			}));
+		}
+		else if (expr == "bindGroupViewMembersImpl") {
+			TRY(visitBindings([&](unsigned i, const BindingInfo& binding) {
+				if (i > 0) out << ",\n\t";
+				out << "const BufferView& " << binding.name;
+			}));
+		}
+		else if (expr == "bindingInfos") {
+			TRY(check());
+			const char* sep = "";
+			for (const KernelBindingInfo& binding : describeBindings()) {
+				const char* type
+					= binding.type == KernelBindingType::Uniform ? "Uniform"
+					: binding.type == KernelBindingType::ReadOnlyStorage ? "ReadOnlyStorage"
+					: "Storage";
+				out << sep << "KernelBindingInfo{ \"" << binding.name << "\", " << binding.binding << ", KernelBindingType::" << type << ", " << binding.minBindingSize << ", " << (binding.hasDynamicOffset ? "true" : "false") << " },";
+				sep = "\n\t";
+			}
+		}
+		else if (expr == "bindGroupViewEntries") {
+			TRY(visitBindings([&](unsigned i, const BindingInfo& binding) {
+				if (i > 0) out << "\n\t";
+				out << "TRY_ASSIGN(entries[" << i << "], makeBufferBindGroupEntry(m_device, s_bindings[" << i << "], " << binding.name << "));";
+			}));
+		}
+		else if (expr == "bindGroupLayoutName") {
+			TRY(check());
+			out << bindGroupLayoutName();
+		}
+		else if (expr == "bindGroupLayoutSignature") {
+			TRY(check());
+			out << bindingSignature(describeBindings());
+		}
 		else if (expr == "bindGroupLayoutEntries") {
-			static constexpr const char* nl = "\n\t";
+			// NB: This is shared by all kernels with the same layout, so it must
+			// not depend on binding names.
+			static constexpr const char* nl = "\n\t\t";
 			TRY(visitBindings([&](unsigned i, const BindingInfo& binding) {
 				if (i > 0) out << nl << nl;
-				out << "// Member '" << binding.name << "'" << nl;
 				out << "layoutEntries[" << i << "].binding = " << binding.index << ";" << nl;
-				out << "layoutEntries[" << i << "].visibility = ShaderStage::Compute;" << nl;
+				out << "layoutEntries[" << i << "].visibility = wgpu::ShaderStage::Compute;" << nl;
 				std::visit(overloaded{
 					[&](const BufferBindingInfo& bufferBinding) {
 						if (bufferBinding.minBindingSize.has_value()) {
 							out << "layoutEntries[" << i << "].buffer.minBindingSize = " << bufferBinding.minBindingSize.value() << ";" << nl;
 						}
-						out << "layoutEntries[" << i << "].buffer.type = BufferBindingType::" << bufferBinding.type << ";";
+						if (bufferBinding.hasDynamicOffset) {
+							out << "layoutEntries[" << i << "].buffer.hasDynamicOffset = true;" << nl;
+						}
+						out << "layoutEntries[" << i << "].buffer.type = wgpu::BufferBindingType::" << bufferBinding.type << ";";
 					}
 				}, binding.details);
 			}));
@@ -471,13 +1148,80 @@ public:
 				if (i > 0) out << nl << nl;
 				out << "entries[" << i << "].binding = " << binding.index << ";" << nl;
 				std::visit(overloaded{
-					[&](const BufferBindingInfo&) {
+					[&](const BufferBindingInfo& bufferBinding) {
 						out << "entries[" << i << "].buffer = " << binding.name << ";" << nl;
-						out << "entries[" << i << "].size = " << binding.name << ".getSize();";
+						if (bufferBinding.hasDynamicOffset) {
+							// The bound range is moved by the dynamic offset, so
+							// it only covers the uniforms of a single dispatch.
+							out << "entries[" << i << "].size = " << (bufferBinding.minBindingSize.value_or(0) + 15) / 16 * 16 << ";";
+						}
+						else {
+							out << "entries[" << i << "].size = " << binding.name << ".getSize();";
+						}
 					}
 				}, binding.details);
 			}));
 		}
+		else if (expr == "differentiableFunction") {
+			out << currentDifferentiableFunction().name;
+		}
+		else if (expr == "DifferentiableFunction") {
+			std::string functionName = currentDifferentiableFunction().name;
+			functionName[0] = (char)std::toupper((int)functionName[0]);
+			out << functionName;
+		}
+		else if (expr == "gradientAccumulation") {
+			out << gradientAccumulationName(currentDifferentiableFunction().accumulation);
+		}
+		else if (expr == "gradientBufferMembers") {
+			const DifferentiableFunction& function = currentDifferentiableFunction();
+			const char* sep = "";
+			for (const DifferentiableParameter& parameter : function.parameters) {
+				out << sep << "wgpu::raii::Buffer " << parameter.name << "Grad;";
+				sep = "\n\t\t";
+			}
+			if (function.needsReduction()) {
+				out << sep << "wgpu::raii::Buffer partialGrads;";
+			}
+		}
+		else if (expr == "gradientBufferCreation") {
+			static constexpr const char* nl = "\n\t";
+			const DifferentiableFunction& function = currentDifferentiableFunction();
+			const char* sep = "";
+			for (const DifferentiableParameter& parameter : function.parameters) {
+				out << sep;
+				out << "bufferDesc.label = StringView(\"" << function.gradientBufferName(parameter.name) << "\");" << nl;
+				out << "bufferDesc.size = " << (parameter.isShared ? "sizeof(float)" : "elementCount * sizeof(float)") << ";" << nl;
+				out << "gradients." << parameter.name << "Grad = m_device.createBuffer(bufferDesc);";
+				sep = "\n\n\t";
+			}
+			if (function.needsReduction()) {
+				out << sep;
+				out << "bufferDesc.label = StringView(\"" << function.name << "_partialGrads\");" << nl;
+				out << "bufferDesc.size = std::max(divideAndCeil(elementCount, " << function.workgroupSize << "), 1u) * " << function.sharedParameterCount() << " * sizeof(float);" << nl;
+				out << "gradients.partialGrads = m_device.createBuffer(bufferDesc);";
+			}
+		}
+		else if (expr == "gradientBufferClears") {
+			const DifferentiableFunction& function = currentDifferentiableFunction();
+			const char* sep = "";
+			for (const DifferentiableParameter& parameter : function.parameters) {
+				out << sep << "encoder.clearBuffer(*gradients." << parameter.name << "Grad, 0, gradients." << parameter.name << "Grad->getSize());";
+				sep = "\n\t";
+			}
+		}
+		else if (expr == "gradientDispatches") {
+			static constexpr const char* nl = "\n\t";
+			const DifferentiableFunction& function = currentDifferentiableFunction();
+			std::string backward = function.backwardEntryPoint();
+			backward[0] = (char)std::toupper((int)backward[0]);
+			out << "dispatch" << backward << "(encoder, ThreadCount{ elementCount }, bindGroup);";
+			if (function.needsReduction()) {
+				std::string reduce = function.reduceEntryPoint();
+				reduce[0] = (char)std::toupper((int)reduce[0]);
+				out << nl << "dispatch" << reduce << "(encoder, WorkgroupCount{ " << function.sharedParameterCount() << " }, bindGroup);";
+			}
+		}
 		else if (expr == "uniformStructDefinition") {
 			static constexpr const char* nl = "\n\t";
 			out << "struct Uniforms {" << nl;
@@ -505,6 +1249,12 @@ public:
 		else if (iterator_name == "hasUniforms") {
 			// Nothing to step, this is in effect a "if".
 		}
+		else if (iterator_name == "dynamicUniforms" || iterator_name == "!dynamicUniforms") {
+			// Nothing to step, this is in effect a "if".
+		}
+		else if (iterator_name == "differentiableFunctions") {
+			m_currentDifferentiableFunction = 0;
+		}
 		else {
 			return Error{ "Invalid iterator name: " + iterator_name };
 		}
@@ -521,6 +1271,12 @@ public:
 		else if (iterator_name == "hasUniforms") {
 			// Nothing to step, this is in effect a "if".
 		}
+		else if (iterator_name == "dynamicUniforms" || iterator_name == "!dynamicUniforms") {
+			// Nothing to step, this is in effect a "if".
+		}
+		else if (iterator_name == "differentiableFunctions") {
+			m_currentDifferentiableFunction += 1;
+		}
 		else {
 			return Error{ "Invalid iterator name: " + iterator_name };
 		}
@@ -539,6 +1295,15 @@ public:
 		else if (iterator_name == "hasUniforms") {
 			return !m_layoutInfo.uniforms.has_value(); // 'iteratorEnded' is the inverse of the if condition
 		}
+		else if (iterator_name == "dynamicUniforms") {
+			return !m_dynamicUniforms;
+		}
+		else if (iterator_name == "!dynamicUniforms") {
+			return m_dynamicUniforms;
+		}
+		else if (iterator_name == "differentiableFunctions") {
+			return m_currentDifferentiableFunction >= m_differentiableFunctions.size();
+		}
 		else {
 			return Error{ "Invalid iterator name: " + iterator_name };
 		}
@@ -579,7 +1344,7 @@ private:
 				BindingInfo binding;
 				binding.index = parameter->getBindingIndex();
 				binding.name = parameter->getName();
-				BufferBindingInfo bufferBinding;
+				BufferBindingInfo bufferBinding{};
 				SlangResourceAccess access = typeLayout->getResourceAccess();
 				switch (access) {
 				case SLANG_RESOURCE_ACCESS_READ:
@@ -624,16 +1389,24 @@ private:
 			BindingInfo binding;
 			binding.index = 0;
 			binding.name = "uniforms";
-			BufferBindingInfo uniformBufferBinding;
+			BufferBindingInfo uniformBufferBinding{};
 			uniformBufferBinding.minBindingSize = m_layoutInfo.uniforms->minBindingSize;
 			uniformBufferBinding.type = "Uniform";
+			uniformBufferBinding.hasDynamicOffset = m_dynamicUniforms;
 			binding.details = uniformBufferBinding;
 			m_layoutInfo.bindings.push_front(binding);
 		}
+		else {
+			TRY_ASSERT(!m_dynamicUniforms, "Option --dynamic-uniforms is set but the kernel has no uniforms");
+		}
 
 		return {};
 	}
 
+	const DifferentiableFunction& currentDifferentiableFunction() const {
+		return m_differentiableFunctions[m_currentDifferentiableFunction];
+	}
+
 	/**
 	 * An internal utility function that visits all the bindings and provides to
 	 * the visitor the reflection information that we actually need.
@@ -654,6 +1427,9 @@ private:
 	const std::string m_name;
 	slang::ProgramLayout* m_layout;
 	const std::string m_wgslSource;
+	const std::string m_compilerOptions;
+	const std::vector<DifferentiableFunction> m_differentiableFunctions;
+	const bool m_dynamicUniforms;
 
 	// Information extracted from m_layout in a form better suited for our generator
 	LayoutInfo m_layoutInfo;
@@ -661,27 +1437,19 @@ private:
 
 	// Iterators
 	size_t m_currentEntryPoint;
+	size_t m_currentDifferentiableFunction;
 };
 
 Result<Void, Error> generateCppBinding(
-	const Slang::ComPtr<IComponentType>& program,
-	const std::string& name,
-	[[maybe_unused]] const std::vector<std::string>& entryPoints,
+	BindingGenerator& generator,
 	const std::filesystem::path& inputTemplate,
-	const std::string& wgslSource,
 	const std::filesystem::path& outputHpp,
 	const std::filesystem::path& outputCpp
 ) {
-	LOG(INFO) << "Getting reflection information...";
-	slang::ProgramLayout* layout = program->getLayout();
-	
 	LOG(INFO) << "Loading binding template from " << inputTemplate << "...";
 	std::string tpl;
 	TRY_ASSIGN(tpl, loadTextFile(inputTemplate));
 
-	BindingGenerator generator(name, layout, wgslSource);
-	TRY(generator.check());
-
 	LOG(INFO) << "Generating binding header into " << outputHpp << "...";
 	std::string hpp;
 	TRY_ASSIGN(hpp, generateFromTemplate(tpl, "header", generator));
@@ -695,17 +1463,35 @@ Result<Void, Error> generateCppBinding(
 	return {};
 }
 
-Result<Void, Error> generateDepfile(
+/**
+ * Add the dependencies of generated files to a depfile, which is written once
+ * all kernels have been generated.
+ */
+void addToDepfile(
+	GeneratorContext& context,
 	const std::vector<std::string>& dependencyFiles,
 	const std::filesystem::path& outputDepfile,
-	const std::filesystem::path& outputHpp,
-	const std::filesystem::path& outputCpp
+	const std::vector<std::filesystem::path>& outputs
+) {
+	GeneratorContext::Depfile& depfile = context.depfiles[outputDepfile];
+	for (const auto& generated : outputs) {
+		if (generated.empty()) continue;
+		if (std::find(depfile.targets.begin(), depfile.targets.end(), generated.string()) == depfile.targets.end()) {
+			depfile.targets.push_back(generated.string());
+		}
+	}
+	depfile.dependencies.insert(dependencyFiles.begin(), dependencyFiles.end());
+}
+
+Result<Void, Error> generateDepfile(
+	const GeneratorContext::Depfile& depfile,
+	const std::filesystem::path& outputDepfile
 ) {
 	LOG(INFO) << "Generating dependency file into " << outputDepfile << "...";
 	std::ostringstream out;
-	for (const auto& generated : { outputHpp, outputCpp }) {
-		out << generated.string() << ":";
-		for (const auto& dep : dependencyFiles) {
+	for (const auto& generated : depfile.targets) {
+		out << generated << ":";
+		for (const auto& dep : depfile.dependencies) {
 			out << " \\\n\t" << dep;
 		}
 		out << "\n";
@@ -714,22 +1500,92 @@ Result<Void, Error> generateDepfile(
 	return {};
 }
 
-Result<Void, Error> run(const Arguments& args) {
+Result<Void, Error> generateReport(
+	const Slang::ComPtr<IComponentType>& linkedProgram,
+	const std::string& name,
+	const std::string& wgslSource,
+	const std::filesystem::path& inputSlang,
+	const std::string& limitsProfile,
+	bool failOnLimits,
+	const std::filesystem::path& outputReport
+) {
+	LOG(INFO) << "Loading device limits '" << limitsProfile << "'...";
+	DeviceLimits limits;
+	TRY_ASSIGN(limits, loadDeviceLimits(limitsProfile));
+
+	KernelReport report;
+	TRY_ASSIGN(report, buildKernelReport(linkedProgram, name, wgslSource, inputSlang));
+
+	if (!outputReport.empty()) {
+		LOG(INFO) << "Writing resource report into " << outputReport << "...";
+		TRY(saveTextFile(outputReport, formatReport(report, limits)));
+	}
+
+	std::vector<std::string> violations = checkLimits(report, limits);
+	for (const std::string& violation : violations) {
+		if (failOnLimits) {
+			LOG(ERROR) << violation;
+		}
+		else {
+			LOG(WARNING) << violation;
+		}
+	}
+	if (failOnLimits && !violations.empty()) {
+		return Error{ "Kernel '" + name + "' exceeds " + std::to_string(violations.size()) + " device limit(s)." };
+	}
+
+	return {};
+}
+
+Result<Void, Error> run(const Arguments& args, GeneratorContext& context) {
 
 	SessionInfo sessionInfo;
-	TRY_ASSIGN(sessionInfo, createSlangSession(args.includeDirectories));
+	TRY_ASSIGN(sessionInfo, createSlangSession(context, args.includeDirectories, args.compilerOptions));
+
+	LOG(INFO) << "Loading file " << args.inputSlang << "...";
+	std::string source;
+	TRY_ASSIGN(source, context.fileSystem->readFile(args.inputSlang));
+
+	std::vector<std::string> entryPoints = args.entryPoints;
+	std::vector<DifferentiableFunction> differentiableFunctions;
+	if (!args.differentiable.empty()) {
+		TRY_ASSIGN(source, addAutodiffEntryPoints(context, args, source, differentiableFunctions));
+		for (const DifferentiableFunction& function : differentiableFunctions) {
+			for (const std::string& entryPoint : function.entryPoints()) {
+				entryPoints.push_back(entryPoint);
+			}
+		}
+	}
+	if (!args.fusions.empty()) {
+		std::vector<FusionSpec> fusions;
+		for (const std::string& spec : args.fusions) {
+			FusionSpec fusion;
+			TRY_ASSIGN(fusion, parseFusionSpec(spec));
+			fusions.push_back(fusion);
+			entryPoints.push_back(fusion.name);
+		}
+		TRY_ASSIGN(source, addFusedEntryPoints(context, args, source, fusions));
+	}
+	TRY_ASSERT(!entryPoints.empty(), "No entry point to generate, use --entrypoints or --differentiable");
 
 	ModuleInfo moduleInfo;
 	TRY_ASSIGN(moduleInfo, loadSlangModule(
 		sessionInfo.session,
 		args.name,
 		args.inputSlang,
-		args.entryPoints
+		source,
+		entryPoints
+	));
+
+	Slang::ComPtr<IComponentType> linkedProgram;
+	TRY_ASSIGN(linkedProgram, linkProgram(
+		moduleInfo.program,
+		args.inputSlang
 	));
 
 	std::string wgslSource;
 	TRY_ASSIGN(wgslSource, compileToWgsl(
-		moduleInfo.program,
+		linkedProgram,
 		args.inputSlang
 	));
 
@@ -738,6 +1594,20 @@ Result<Void, Error> run(const Arguments& args) {
 		TRY(saveTextFile(args.outputWgsl, wgslSource));
 	}
 
+	BindingGenerator generator(
+		args.name,
+		moduleInfo.program->getLayout(),
+		wgslSource,
+		describeCompilerOptions(args.compilerOptions),
+		differentiableFunctions,
+		args.dynamicUniforms
+	);
+	if (!args.outputHpp.empty() || !args.outputArchive.empty()) {
+		LOG(INFO) << "Getting reflection information...";
+		TRY(generator.check());
+		context.bindGroupLayouts[generator.bindGroupLayoutName()].push_back(args.name);
+	}
+
 	if (!args.outputHpp.empty()) {
 		if (args.outputCpp.empty()) {
 			return Error{ "Option --output-cpp must be non-empty when --output-hpp is non-empty."};
@@ -747,24 +1617,346 @@ Result<Void, Error> run(const Arguments& args) {
 		}
 		
 		TRY(generateCppBinding(
-			moduleInfo.program,
-			args.name,
-			args.entryPoints,
+			generator,
 			args.inputTemplate,
-			wgslSource,
 			args.outputHpp,
 			args.outputCpp
 		));
 	}
 
+	if (!args.outputArchive.empty()) {
+		if (args.dynamicUniforms) {
+			// Kernel archives do not record dynamic offsets
+			return Error{ "Option --dynamic-uniforms is not supported together with --output-archive." };
+		}
+		KernelDescription kernel;
+		TRY_ASSIGN(kernel, generator.describeKernel());
+		context.archives[args.outputArchive].push_back(kernel);
+	}
+
+	if (!args.outputReport.empty() || args.failOnLimits) {
+		TRY(generateReport(
+			linkedProgram,
+			args.name,
+			wgslSource,
+			args.inputSlang,
+			args.limits,
+			args.failOnLimits,
+			args.outputReport
+		));
+	}
+
 	if (!args.outputDepfile.empty()) {
-		TRY(generateDepfile(
-			moduleInfo.dependencyFiles,
+		// Virtual files do not exist for the build system
+		std::vector<std::string> dependencyFiles;
+		for (const std::string& dep : moduleInfo.dependencyFiles) {
+			if (!context.fileSystem->isVirtualFile(dep)) {
+				dependencyFiles.push_back(dep);
+			}
+		}
+		addToDepfile(
+			context,
+			dependencyFiles,
 			args.outputDepfile,
-			args.outputHpp,
-			args.outputCpp
-		));
+			{ args.outputHpp, args.outputCpp, args.outputArchive }
+		);
+	}
+
+	return {};
+}
+
+/**
+ * Slang global sessions must not be used by multiple threads at once, so each
+ * worker of a parallel batch creates its own. It loads the core module that
+ * the main global session serialized in memory, if available, which is much
+ * faster than building it again.
+ */
+Result<Slang::ComPtr<IGlobalSession>, Error> createWorkerGlobalSession(ISlangBlob* coreModule) {
+	Slang::ComPtr<IGlobalSession> globalSession;
+	if (coreModule) {
+		TRY_SLANG(slang_createGlobalSessionWithoutCoreModule(SLANG_API_VERSION, globalSession.writeRef()));
+		if (SLANG_SUCCEEDED(globalSession->loadCoreModule(coreModule->getBufferPointer(), coreModule->getBufferSize()))) {
+			return globalSession;
+		}
+		LOG(WARNING) << "Could not load Slang core module in worker, building it again.";
+		globalSession = nullptr;
+	}
+	TRY_SLANG(createGlobalSession(globalSession.writeRef()));
+	return globalSession;
+}
+
+/**
+ * Gather the outputs of a job into the outputs of the whole batch. Jobs are
+ * merged in the order of the batch file, so that shared outputs do not depend
+ * on which job finished first.
+ */
+void mergeJobOutputs(GeneratorContext& context, const GeneratorContext& jobContext) {
+	for (const auto& [path, kernels] : jobContext.archives) {
+		auto& archive = context.archives[path];
+		archive.insert(archive.end(), kernels.begin(), kernels.end());
+	}
+	for (const auto& [path, jobDepfile] : jobContext.depfiles) {
+		auto& depfile = context.depfiles[path];
+		for (const auto& target : jobDepfile.targets) {
+			if (std::find(depfile.targets.begin(), depfile.targets.end(), target) == depfile.targets.end()) {
+				depfile.targets.push_back(target);
+			}
+		}
+		depfile.dependencies.insert(jobDepfile.dependencies.begin(), jobDepfile.dependencies.end());
+	}
+	for (const auto& [layoutName, kernelNames] : jobContext.bindGroupLayouts) {
+		auto& names = context.bindGroupLayouts[layoutName];
+		names.insert(names.end(), kernelNames.begin(), kernelNames.end());
+	}
+}
+
+/**
+ * Run a batch job, turning the exceptions it may throw (e.g., std::bad_alloc
+ * or an exception of Slang) into an error of this job only.
+ */
+Result<Void, Error> runJob(const std::function<Result<Void, Error>()>& job) {
+	try {
+		return job();
+	}
+	catch (const std::exception& e) {
+		return Error{ std::string("Unexpected exception: ") + e.what() };
+	}
+	catch (...) {
+		return Error{ "Unexpected exception" };
+	}
+}
+
+/**
+ * Run batch jobs on a pool of worker threads, and return the number of jobs
+ * that failed. The logs of each job are captured and printed once the job is
+ * done, in the order of the batch file.
+ */
+size_t runJobsInParallel(
+	const std::vector<std::string>& jobs,
+	const std::vector<std::optional<Arguments>>& jobArgs,
+	uint32_t workerCount,
+	GeneratorContext& context
+) {
+	// Core module shared by workers
+	Slang::ComPtr<ISlangBlob> coreModule;
+	if (SLANG_FAILED(context.globalSession->saveCoreModule(SLANG_ARCHIVE_TYPE_RIFF_LZ4, coreModule.writeRef()))) {
+		LOG(WARNING) << "Could not serialize Slang core module, each worker builds its own.";
+		coreModule = nullptr;
+	}
+
+	struct JobResult {
+		bool done = false;
+		std::vector<Logger::Record> log;
+		Result<Void, Error> result = Void{};
+		GeneratorContext outputs;
+	};
+	std::vector<JobResult> results(jobs.size());
+	std::mutex mutex;
+	std::condition_variable jobDone;
+	std::atomic<size_t> nextJob = 0;
+
+	auto worker = [&]() {
+		Slang::ComPtr<IGlobalSession> globalSession;
+		for (size_t i = nextJob++; i < jobs.size(); i = nextJob++) {
+			JobResult result;
+			if (jobArgs[i].has_value()) {
+				LogCapture capture;
+				LOG(INFO) << "Batch job " << (i + 1) << "/" << jobs.size() << ": " << jobs[i];
+				result.result = runJob([&]() -> Result<Void, Error> {
+					if (!globalSession) {
+						TRY_ASSIGN(globalSession, createWorkerGlobalSession(coreModule.get()));
+					}
+					result.outputs.globalSession = globalSession;
+					result.outputs.fileSystem = context.fileSystem;
+					return run(*jobArgs[i], result.outputs);
+				});
+				result.outputs.globalSession = nullptr;
+				result.log = capture.takeRecords();
+			}
+			result.done = true;
+
+			std::lock_guard lock(mutex);
+			results[i] = std::move(result);
+			jobDone.notify_one();
+		}
+	};
+
+	std::vector<std::thread> workers;
+	for (uint32_t i = 0; i < workerCount; ++i) {
+		workers.emplace_back(worker);
+	}
+
+	// Print logs and merge outputs in order, as soon as jobs are done
+	size_t failureCount = 0;
+	for (size_t i = 0; i < jobs.size(); ++i) {
+		JobResult result;
+		{
+			std::unique_lock lock(mutex);
+			jobDone.wait(lock, [&]() { return results[i].done; });
+			result = std::move(results[i]);
+		}
+		if (!jobArgs[i].has_value()) continue;
+		for (Logger::Record& record : result.log) {
+			Logger::write(std::move(record));
+		}
+		if (isError(result.result)) {
+			LOG(ERROR) << "Batch job #" << (i + 1) << " failed: " << std::get<Error>(result.result).message;
+			++failureCount;
+		}
+		else {
+			mergeJobOutputs(context, result.outputs);
+		}
+	}
+
+	for (std::thread& thread : workers) {
+		thread.join();
+	}
+	return failureCount;
+}
+
+Result<Void, Error> runBatch(const GlobalArguments& globalArgs, GeneratorContext& context) {
+	const std::filesystem::path& batchFile = globalArgs.batch;
+	LOG(INFO) << "Loading batch file " << batchFile << "...";
+	std::string batch;
+	TRY_ASSIGN(batch, loadTextFile(batchFile));
+
+	// Read jobs and virtual files
+	std::vector<std::string> jobs;
+	std::istringstream lines(batch);
+	std::string line;
+	while (std::getline(lines, line)) {
+		if (!line.empty() && line.back() == '\r') line.pop_back();
+		if (line.empty() || line[0] == '#') continue;
+		if (line.rfind("@file ", 0) == 0) {
+			std::string path = line.substr(6);
+			std::ostringstream contents;
+			bool ended = false;
+			while (std::getline(lines, line)) {
+				if (!line.empty() && line.back() == '\r') line.pop_back();
+				if (line == "@end") {
+					ended = true;
+					break;
+				}
+				contents << line << "\n";
+			}
+			TRY_ASSERT(ended, "Virtual file '" << path << "' in batch file has no matching @end line");
+			LOG(INFO) << "Adding virtual file '" << path << "'";
+			context.fileSystem->addVirtualFile(path, contents.str());
+			continue;
+		}
+		jobs.push_back(line);
 	}
 
+	// Parse all jobs first, so that invalid ones are reported in order
+	size_t failureCount = 0;
+	std::vector<std::optional<Arguments>> jobArgs(jobs.size());
+	for (size_t i = 0; i < jobs.size(); ++i) {
+		CLI::App app{ "Batch job" };
+		Arguments args;
+		addKernelOptions(app, args, context.fileSystem.get());
+		try {
+			app.parse(jobs[i], false);
+		}
+		catch (const CLI::ParseError& e) {
+			LOG(ERROR) << "Invalid options in batch job #" << (i + 1) << ": " << e.what();
+			++failureCount;
+			continue;
+		}
+		jobArgs[i] = std::move(args);
+	}
+
+	uint32_t workerCount = globalArgs.jobs > 0 ? globalArgs.jobs : std::max(std::thread::hardware_concurrency(), 1u);
+	workerCount = (uint32_t)std::min<size_t>(workerCount, jobs.size());
+
+	LOG(INFO) << "Running " << jobs.size() << " batch job(s) on " << std::max(workerCount, 1u) << " worker(s)...";
+	if (workerCount <= 1) {
+		for (size_t i = 0; i < jobs.size(); ++i) {
+			if (!jobArgs[i].has_value()) continue;
+			LOG(INFO) << "Batch job " << (i + 1) << "/" << jobs.size() << ": " << jobs[i];
+
+			// Files that changed since the previous job are read again
+			context.fileSystem->newGeneration();
+
+			auto maybeError = runJob([&]() { return run(*jobArgs[i], context); });
+			if (isError(maybeError)) {
+				LOG(ERROR) << "Batch job #" << (i + 1) << " failed: " << std::get<Error>(maybeError).message;
+				++failureCount;
+			}
+		}
+	}
+	else {
+		context.fileSystem->newGeneration();
+		failureCount += runJobsInParallel(jobs, jobArgs, workerCount, context);
+	}
+
+	CachingFileSystem::Stats stats = context.fileSystem->stats();
+	LOG(INFO) << "File cache: " << stats.hits << " hit(s), " << stats.misses << " miss(es), " << stats.reloads << " reload(s)";
+
+	if (failureCount > 0) {
+		return Error{ std::to_string(failureCount) + " out of " + std::to_string(jobs.size()) + " batch job(s) failed." };
+	}
 	return {};
 }
+
+Result<Void, Error> writeSharedOutputs(GeneratorContext& context) {
+	for (const auto& [layoutName, kernelNames] : context.bindGroupLayouts) {
+		if (kernelNames.size() < 2) continue;
+		std::ostringstream names;
+		for (size_t i = 0; i < kernelNames.size(); ++i) {
+			names << (i > 0 ? ", " : "") << kernelNames[i];
+		}
+		LOG(INFO) << "Kernels " << names.str() << " share bind group layout " << layoutName;
+	}
+	for (const auto& [path, kernels] : context.archives) {
+		LOG(INFO) << "Writing " << kernels.size() << " kernel(s) into archive " << path << "...";
+		TRY(saveKernelArchive(path, kernels));
+	}
+	for (const auto& [path, depfile] : context.depfiles) {
+		TRY(generateDepfile(depfile, path));
+	}
+	return {};
+}
+
+Result<Void, Error> pack(
+	const std::vector<std::filesystem::path>& inputs,
+	const std::filesystem::path& output
+) {
+	std::vector<KernelDescription> kernels;
+	for (const auto& input : inputs) {
+		LOG(INFO) << "Reading kernel archive " << input << "...";
+		KernelArchive archive;
+		TRY_ASSIGN(archive, KernelArchive::open(input));
+		for (KernelDescription& kernel : archive.kernels()) {
+			auto it = std::find_if(kernels.begin(), kernels.end(), [&](const KernelDescription& k) { return k.name == kernel.name; });
+			if (it != kernels.end()) {
+				LOG(INFO) << "Kernel '" << kernel.name << "' from " << input << " replaces a previous one";
+				*it = std::move(kernel);
+			}
+			else {
+				kernels.push_back(std::move(kernel));
+			}
+		}
+	}
+
+	LOG(INFO) << "Writing " << kernels.size() << " kernel(s) into archive " << output << "...";
+	return saveKernelArchive(output, kernels);
+}
+
+int runPack(int argc, char* argv[]) {
+	CLI::App app{ "Merge kernel archives into a single one. When a kernel appears in multiple input archives, the last one wins." };
+	std::vector<std::filesystem::path> inputs;
+	std::filesystem::path output;
+	app.add_option("inputs", inputs, "Input kernel archives")
+		->required()
+		->check(CLI::ExistingFile);
+	app.add_option("-o,--output", output, "Output kernel archive")
+		->required();
+	CLI11_PARSE(app, argc, argv);
+
+	auto maybeError = pack(inputs, output);
+	if (isError(maybeError)) {
+		LOG(ERROR) << std::get<Error>(maybeError).message;
+		return 1;
+	}
+	return 0;
+}
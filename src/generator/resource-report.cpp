@@ -0,0 +1,214 @@
+#include "resource-report.h"
+
+#include <slang-webgpu/common/io.h>
+#include <slang-webgpu/common/logger.h>
+
+#include <algorithm>
+#include <charconv>
+#include <iomanip>
+#include <map>
+#include <sstream>
+
+namespace {
+
+using LimitField = uint64_t DeviceLimits::*;
+
+const std::map<std::string, LimitField>& limitFields() {
+	static const std::map<std::string, LimitField> fields = {
+		{ "maxComputeWorkgroupSizeX", &DeviceLimits::maxComputeWorkgroupSizeX },
+		{ "maxComputeWorkgroupSizeY", &DeviceLimits::maxComputeWorkgroupSizeY },
+		{ "maxComputeWorkgroupSizeZ", &DeviceLimits::maxComputeWorkgroupSizeZ },
+		{ "maxComputeInvocationsPerWorkgroup", &DeviceLimits::maxComputeInvocationsPerWorkgroup },
+		{ "maxComputeWorkgroupStorageSize", &DeviceLimits::maxComputeWorkgroupStorageSize },
+		{ "maxStorageBuffersPerShaderStage", &DeviceLimits::maxStorageBuffersPerShaderStage },
+		{ "maxUniformBuffersPerShaderStage", &DeviceLimits::maxUniformBuffersPerShaderStage },
+		{ "maxUniformBufferBindingSize", &DeviceLimits::maxUniformBufferBindingSize },
+		{ "maxBindingsPerBindGroup", &DeviceLimits::maxBindingsPerBindGroup },
+		{ "computeUnitInvocations", &DeviceLimits::computeUnitInvocations },
+		{ "computeUnitWorkgroupStorage", &DeviceLimits::computeUnitWorkgroupStorage },
+		{ "computeUnitMaxWorkgroups", &DeviceLimits::computeUnitMaxWorkgroups },
+	};
+	return fields;
+}
+
+std::string trim(const std::string& str) {
+	size_t begin = str.find_first_not_of(" \t\r\n");
+	if (begin == std::string::npos) return "";
+	size_t end = str.find_last_not_of(" \t\r\n");
+	return str.substr(begin, end - begin + 1);
+}
+
+void writeBindings(std::ostringstream& out, const WgslBindingCounts& bindings, const char* indent) {
+	out << "{\n";
+	out << indent << "\t\"storage\": " << bindings.storage << ",\n";
+	out << indent << "\t\"readOnlyStorage\": " << bindings.readOnlyStorage << ",\n";
+	out << indent << "\t\"uniform\": " << bindings.uniform << ",\n";
+	out << indent << "\t\"other\": " << bindings.other << ",\n";
+	out << indent << "\t\"maxUniformBindingSize\": " << bindings.maxUniformBindingSize << "\n";
+	out << indent << "}";
+}
+
+} // anonymous namespace
+
+Result<DeviceLimits, Error> loadDeviceLimits(
+	const std::string& profile
+) {
+	DeviceLimits limits;
+	if (profile.empty() || profile == "webgpu-default") {
+		return limits;
+	}
+
+	std::string contents;
+	TRY_ASSIGN(contents, loadTextFile(profile));
+	limits.profile = profile;
+
+	std::istringstream lines(contents);
+	std::string line;
+	int lineNumber = 0;
+	while (std::getline(lines, line)) {
+		++lineNumber;
+		std::string location = "line " + std::to_string(lineNumber) + " of limits file '" + profile + "'";
+
+		// Comments are stripped before splitting a flat JSON object into
+		// one "key: value" entry per field
+		line = line.substr(0, line.find('#'));
+		for (char& c : line) {
+			if (c == '{' || c == '}' || c == ',') c = '\n';
+		}
+		line.erase(std::remove(line.begin(), line.end(), '"'), line.end());
+
+		std::istringstream entries(line);
+		std::string entry;
+		while (std::getline(entries, entry)) {
+			entry = trim(entry);
+			if (entry.empty()) continue;
+
+			size_t separator = entry.find_first_of("=:");
+			if (separator == std::string::npos) {
+				return Error{ "Invalid entry at " + location + ": " + entry };
+			}
+			std::string key = trim(entry.substr(0, separator));
+			std::string value = trim(entry.substr(separator + 1));
+
+			auto it = limitFields().find(key);
+			if (it == limitFields().end()) {
+				LOG(INFO) << "Ignoring limit '" << key << "', which is not used by the report.";
+				continue;
+			}
+			uint64_t parsed = 0;
+			const char* valueEnd = value.data() + value.size();
+			auto [ptr, ec] = std::from_chars(value.data(), valueEnd, parsed);
+			if (value.empty() || ec != std::errc() || ptr != valueEnd) {
+				return Error{ "Invalid value for limit '" + key + "' at " + location + ": " + value };
+			}
+			limits.*(it->second) = parsed;
+		}
+	}
+
+	return limits;
+}
+
+OccupancyEstimate estimateOccupancy(
+	const EntryPointReport& entryPoint,
+	const DeviceLimits& limits
+) {
+	OccupancyEstimate estimate;
+	if (entryPoint.invocations == 0 || limits.computeUnitInvocations == 0) return estimate;
+
+	estimate.residentWorkgroups = limits.computeUnitInvocations / entryPoint.invocations;
+	estimate.limitingFactor = "invocations";
+
+	if (entryPoint.workgroupStorageSize > 0) {
+		uint64_t byStorage = limits.computeUnitWorkgroupStorage / entryPoint.workgroupStorageSize;
+		if (byStorage < estimate.residentWorkgroups) {
+			estimate.residentWorkgroups = byStorage;
+			estimate.limitingFactor = "workgroupStorage";
+		}
+	}
+
+	if (limits.computeUnitMaxWorkgroups < estimate.residentWorkgroups) {
+		estimate.residentWorkgroups = limits.computeUnitMaxWorkgroups;
+		estimate.limitingFactor = "workgroups";
+	}
+
+	estimate.occupancy = std::min(1.0,
+		double(estimate.residentWorkgroups * entryPoint.invocations) / double(limits.computeUnitInvocations)
+	);
+	return estimate;
+}
+
+std::vector<std::string> checkLimits(
+	const KernelReport& report,
+	const DeviceLimits& limits
+) {
+	std::vector<std::string> violations;
+	auto check = [&](const std::string& context, const char* what, uint64_t value, uint64_t limit) {
+		if (value <= limit) return;
+		std::ostringstream out;
+		out << context << ": " << what << " is " << value << ", which exceeds the limit of " << limit << " (profile '" << limits.profile << "')";
+		violations.push_back(out.str());
+	};
+
+	for (const EntryPointReport& entryPoint : report.entryPoints) {
+		std::string context = "Entry point '" + entryPoint.name + "'";
+		check(context, "workgroup size x", entryPoint.workgroupSize[0], limits.maxComputeWorkgroupSizeX);
+		check(context, "workgroup size y", entryPoint.workgroupSize[1], limits.maxComputeWorkgroupSizeY);
+		check(context, "workgroup size z", entryPoint.workgroupSize[2], limits.maxComputeWorkgroupSizeZ);
+		check(context, "invocations per workgroup", entryPoint.invocations, limits.maxComputeInvocationsPerWorkgroup);
+		check(context, "workgroup storage size", entryPoint.workgroupStorageSize, limits.maxComputeWorkgroupStorageSize);
+	}
+
+	// All entry points share the same bind group layout, which is what
+	// pipeline creation validates against per-stage limits.
+	std::string context = "Kernel '" + report.name + "'";
+	const WgslBindingCounts& bindings = report.bindings;
+	check(context, "number of storage buffers", bindings.storage + bindings.readOnlyStorage, limits.maxStorageBuffersPerShaderStage);
+	check(context, "number of uniform buffers", bindings.uniform, limits.maxUniformBuffersPerShaderStage);
+	check(context, "uniform binding size", bindings.maxUniformBindingSize, limits.maxUniformBufferBindingSize);
+	check(context, "number of bindings in the bind group", bindings.storage + bindings.readOnlyStorage + bindings.uniform + bindings.other, limits.maxBindingsPerBindGroup);
+
+	return violations;
+}
+
+std::string formatReport(
+	const KernelReport& report,
+	const DeviceLimits& limits
+) {
+	std::vector<std::string> violations = checkLimits(report, limits);
+
+	std::ostringstream out;
+	out << "{\n";
+	out << "\t\"kernel\": " << std::quoted(report.name) << ",\n";
+	out << "\t\"limitsProfile\": " << std::quoted(limits.profile) << ",\n";
+	out << "\t\"bindings\": ";
+	writeBindings(out, report.bindings, "\t");
+	out << ",\n";
+	out << "\t\"entryPoints\": [";
+	for (size_t i = 0; i < report.entryPoints.size(); ++i) {
+		const EntryPointReport& entryPoint = report.entryPoints[i];
+		OccupancyEstimate occupancy = estimateOccupancy(entryPoint, limits);
+		out << (i > 0 ? ",\n" : "\n");
+		out << "\t\t{\n";
+		out << "\t\t\t\"name\": " << std::quoted(entryPoint.name) << ",\n";
+		out << "\t\t\t\"workgroupSize\": [" << entryPoint.workgroupSize[0] << ", " << entryPoint.workgroupSize[1] << ", " << entryPoint.workgroupSize[2] << "],\n";
+		out << "\t\t\t\"invocationsPerWorkgroup\": " << entryPoint.invocations << ",\n";
+		out << "\t\t\t\"workgroupStorageSize\": " << entryPoint.workgroupStorageSize << ",\n";
+		out << "\t\t\t\"bindings\": ";
+		writeBindings(out, entryPoint.bindings, "\t\t\t");
+		out << ",\n";
+		out << "\t\t\t\"estimatedOccupancy\": {\n";
+		out << "\t\t\t\t\"residentWorkgroups\": " << occupancy.residentWorkgroups << ",\n";
+		out << "\t\t\t\t\"occupancy\": " << std::fixed << std::setprecision(3) << occupancy.occupancy << ",\n";
+		out << "\t\t\t\t\"limitingFactor\": " << std::quoted(occupancy.limitingFactor) << "\n";
+		out << "\t\t\t}\n";
+		out << "\t\t}";
+	}
+	out << (report.entryPoints.empty() ? "],\n" : "\n\t],\n");
+	out << "\t\"violations\": [";
+	for (size_t i = 0; i < violations.size(); ++i) {
+		out << (i > 0 ? ",\n" : "\n") << "\t\t" << std::quoted(violations[i]);
+	}
+	out << (violations.empty() ? "]\n" : "\n\t]\n");
+	out << "}\n";
+	return out.str();
+}
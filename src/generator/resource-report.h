@@ -0,0 +1,98 @@
+#pragma once
+
+#include "wgsl-utils.h"
+
+#include <slang-webgpu/common/result.h>
+
+#include <string>
+#include <vector>
+#include <array>
+#include <cstdint>
+
+/**
+ * Device limits against which kernels are checked. Default values are the
+ * ones guaranteed by the WebGPU specification, and may be overridden by a
+ * limits file (e.g., dumped from a given adapter).
+ */
+struct DeviceLimits {
+	std::string profile = "webgpu-default";
+
+	// WebGPU limits
+	uint64_t maxComputeWorkgroupSizeX = 256;
+	uint64_t maxComputeWorkgroupSizeY = 256;
+	uint64_t maxComputeWorkgroupSizeZ = 64;
+	uint64_t maxComputeInvocationsPerWorkgroup = 256;
+	uint64_t maxComputeWorkgroupStorageSize = 16384;
+	uint64_t maxStorageBuffersPerShaderStage = 8;
+	uint64_t maxUniformBuffersPerShaderStage = 12;
+	uint64_t maxUniformBufferBindingSize = 65536;
+	uint64_t maxBindingsPerBindGroup = 1000;
+
+	// Characteristics of a single compute unit, which are not exposed by
+	// WebGPU and only used to estimate occupancy.
+	uint64_t computeUnitInvocations = 2048;
+	uint64_t computeUnitWorkgroupStorage = 65536;
+	uint64_t computeUnitMaxWorkgroups = 32;
+};
+
+/**
+ * Either "webgpu-default" or the path to a limits file, which contains lines
+ * of the form "maxComputeWorkgroupStorageSize = 32768". A flat JSON object
+ * (such as a dump of wgpu::Limits) is also accepted. Fields that are not
+ * listed keep their WebGPU default value.
+ */
+Result<DeviceLimits, Error> loadDeviceLimits(
+	const std::string& profile
+);
+
+/**
+ * Static information about resources used by a single entry point.
+ */
+struct EntryPointReport {
+	std::string name;
+	std::array<uint64_t, 3> workgroupSize = { 1, 1, 1 };
+	uint64_t invocations = 1;
+	uint64_t workgroupStorageSize = 0;
+	WgslBindingCounts bindings;
+};
+
+/**
+ * Static information about a kernel, i.e., all entry points of a module.
+ */
+struct KernelReport {
+	std::string name;
+	// Bindings of the whole bind group layout shared by all entry points
+	WgslBindingCounts bindings;
+	std::vector<EntryPointReport> entryPoints;
+};
+
+/**
+ * Estimated number of workgroups that may run concurrently on a compute unit,
+ * and the ratio of used invocation slots.
+ */
+struct OccupancyEstimate {
+	uint64_t residentWorkgroups = 0;
+	double occupancy = 0.0;
+	std::string limitingFactor;
+};
+
+OccupancyEstimate estimateOccupancy(
+	const EntryPointReport& entryPoint,
+	const DeviceLimits& limits
+);
+
+/**
+ * Return a human readable message for each limit exceeded by the kernel.
+ */
+std::vector<std::string> checkLimits(
+	const KernelReport& report,
+	const DeviceLimits& limits
+);
+
+/**
+ * Format the report as JSON.
+ */
+std::string formatReport(
+	const KernelReport& report,
+	const DeviceLimits& limits
+);
@@ -0,0 +1,392 @@
+#include "wgsl-utils.h"
+
+#include <algorithm>
+#include <cctype>
+#include <set>
+#include <vector>
+
+namespace {
+
+std::string trim(const std::string& str) {
+	size_t begin = 0;
+	size_t end = str.size();
+	while (begin < end && std::isspace((unsigned char)str[begin])) ++begin;
+	while (end > begin && std::isspace((unsigned char)str[end - 1])) --end;
+	return str.substr(begin, end - begin);
+}
+
+bool isIdentifierChar(char c) {
+	return std::isalnum((unsigned char)c) || c == '_';
+}
+
+uint64_t roundUp(uint64_t alignment, uint64_t value) {
+	return (value + alignment - 1) / alignment * alignment;
+}
+
+/**
+ * Find the next occurrence of 'word' that is not part of a longer identifier.
+ */
+size_t findWord(const std::string& source, const std::string& word, size_t pos = 0) {
+	while (true) {
+		pos = source.find(word, pos);
+		if (pos == std::string::npos) return pos;
+		bool startOk = pos == 0 || !isIdentifierChar(source[pos - 1]);
+		size_t end = pos + word.size();
+		bool endOk = end >= source.size() || !isIdentifierChar(source[end]);
+		if (startOk && endOk) return pos;
+		pos = end;
+	}
+}
+
+/**
+ * Split a list at its top-level commas (i.e., not inside <>, () or []).
+ */
+std::vector<std::string> splitTopLevel(const std::string& list, char separator) {
+	std::vector<std::string> items;
+	int depth = 0;
+	size_t start = 0;
+	for (size_t i = 0; i < list.size(); ++i) {
+		char c = list[i];
+		if (c == '<' || c == '(' || c == '[' || c == '{') ++depth;
+		else if (c == '>' || c == ')' || c == ']' || c == '}') --depth;
+		else if (c == separator && depth == 0) {
+			items.push_back(trim(list.substr(start, i - start)));
+			start = i + 1;
+		}
+	}
+	std::string last = trim(list.substr(start));
+	if (!last.empty()) items.push_back(last);
+	return items;
+}
+
+/**
+ * Given "name<args>", return name and the content of the angle brackets.
+ */
+bool splitTemplate(const std::string& type, std::string& name, std::string& args) {
+	size_t open = type.find('<');
+	if (open == std::string::npos || type.back() != '>') return false;
+	name = trim(type.substr(0, open));
+	args = type.substr(open + 1, type.size() - open - 2);
+	return true;
+}
+
+/**
+ * Evaluate a constant integer expression as emitted by Slang, e.g. "64",
+ * "64u", "i32(64)" or the name of a 'const' declaration.
+ */
+std::optional<uint64_t> evaluateInteger(const std::string& wgslSource, std::string expr, int depth = 0) {
+	expr = trim(expr);
+	if (expr.empty() || depth > 8) return std::nullopt;
+
+	// Strip conversions and parentheses
+	for (const char* prefix : { "i32(", "u32(", "(" }) {
+		size_t len = std::char_traits<char>::length(prefix);
+		if (expr.rfind(prefix, 0) == 0 && expr.back() == ')') {
+			return evaluateInteger(wgslSource, expr.substr(len, expr.size() - len - 1), depth + 1);
+		}
+	}
+
+	// Literal
+	if (std::isdigit((unsigned char)expr[0])) {
+		while (!expr.empty() && (expr.back() == 'u' || expr.back() == 'i')) expr.pop_back();
+		if (!std::all_of(expr.begin(), expr.end(), [](char c) { return std::isdigit((unsigned char)c); })) {
+			return std::nullopt;
+		}
+		return std::stoull(expr);
+	}
+
+	// Named constant
+	for (const char* keyword : { "const ", "override " }) {
+		size_t pos = 0;
+		while ((pos = wgslSource.find(keyword, pos)) != std::string::npos) {
+			pos += std::char_traits<char>::length(keyword);
+			size_t nameEnd = pos;
+			while (nameEnd < wgslSource.size() && isIdentifierChar(wgslSource[nameEnd])) ++nameEnd;
+			if (wgslSource.substr(pos, nameEnd - pos) != expr) continue;
+			size_t eq = wgslSource.find('=', nameEnd);
+			size_t semicolon = wgslSource.find(';', nameEnd);
+			if (eq == std::string::npos || semicolon == std::string::npos || eq > semicolon) return std::nullopt;
+			return evaluateInteger(wgslSource, wgslSource.substr(eq + 1, semicolon - eq - 1), depth + 1);
+		}
+	}
+
+	return std::nullopt;
+}
+
+std::optional<WgslTypeLayout> computeLayout(const std::string& wgslSource, std::string type, int depth);
+
+std::optional<WgslTypeLayout> computeStructLayout(const std::string& wgslSource, const std::string& structName, int depth) {
+	size_t pos = 0;
+	while ((pos = findWord(wgslSource, "struct", pos)) != std::string::npos) {
+		pos += 6;
+		size_t open = wgslSource.find('{', pos);
+		if (open == std::string::npos) return std::nullopt;
+		if (trim(wgslSource.substr(pos, open - pos)) != structName) continue;
+		size_t close = wgslSource.find('}', open);
+		if (close == std::string::npos) return std::nullopt;
+
+		std::string body = wgslSource.substr(open + 1, close - open - 1);
+		std::replace(body.begin(), body.end(), ';', ',');
+
+		WgslTypeLayout layout;
+		uint64_t offset = 0;
+		for (std::string member : splitTopLevel(body, ',')) {
+			// Attributes
+			std::optional<uint64_t> forcedAlign;
+			std::optional<uint64_t> forcedSize;
+			while (!member.empty() && member[0] == '@') {
+				size_t nameEnd = 1;
+				while (nameEnd < member.size() && isIdentifierChar(member[nameEnd])) ++nameEnd;
+				std::string attribute = member.substr(1, nameEnd - 1);
+				size_t end = nameEnd;
+				std::optional<uint64_t> value;
+				if (end < member.size() && member[end] == '(') {
+					size_t closeParen = member.find(')', end);
+					if (closeParen == std::string::npos) return std::nullopt;
+					value = evaluateInteger(wgslSource, member.substr(end + 1, closeParen - end - 1));
+					end = closeParen + 1;
+				}
+				if (attribute == "align") forcedAlign = value;
+				if (attribute == "size") forcedSize = value;
+				member = trim(member.substr(end));
+			}
+
+			size_t colon = member.find(':');
+			if (colon == std::string::npos) return std::nullopt;
+			auto memberLayout = computeLayout(wgslSource, member.substr(colon + 1), depth + 1);
+			if (!memberLayout.has_value()) return std::nullopt;
+			uint64_t align = forcedAlign.value_or(memberLayout->align);
+			uint64_t size = forcedSize.value_or(memberLayout->size);
+			offset = roundUp(align, offset) + size;
+			layout.align = std::max(layout.align, align);
+		}
+		layout.size = roundUp(layout.align, offset);
+		return layout;
+	}
+	return std::nullopt;
+}
+
+std::optional<WgslTypeLayout> computeLayout(const std::string& wgslSource, std::string type, int depth) {
+	type = trim(type);
+	if (depth > 16) return std::nullopt;
+
+	// Scalars
+	if (type == "f32" || type == "i32" || type == "u32" || type == "bool") return WgslTypeLayout{ 4, 4 };
+	if (type == "f16") return WgslTypeLayout{ 2, 2 };
+
+	// Shorthands such as vec3f or mat4x4f
+	if (type.size() > 4 && (type.rfind("vec", 0) == 0 || type.rfind("mat", 0) == 0)) {
+		char suffix = type.back();
+		const char* scalar =
+			suffix == 'f' ? "f32" :
+			suffix == 'h' ? "f16" :
+			suffix == 'i' ? "i32" :
+			suffix == 'u' ? "u32" :
+			nullptr;
+		if (scalar && type.find('<') == std::string::npos) {
+			return computeLayout(wgslSource, type.substr(0, type.size() - 1) + "<" + scalar + ">", depth + 1);
+		}
+	}
+
+	std::string name, args;
+	if (splitTemplate(type, name, args)) {
+		std::vector<std::string> params = splitTopLevel(args, ',');
+		if (name == "atomic") {
+			return WgslTypeLayout{ 4, 4 };
+		}
+		if (name.size() == 4 && name.rfind("vec", 0) == 0 && params.size() == 1) {
+			auto scalar = computeLayout(wgslSource, params[0], depth + 1);
+			if (!scalar.has_value()) return std::nullopt;
+			uint64_t n = (uint64_t)(name[3] - '0');
+			uint64_t alignCount = n == 3 ? 4 : n;
+			return WgslTypeLayout{ n * scalar->size, alignCount * scalar->align };
+		}
+		if (name.size() == 6 && name.rfind("mat", 0) == 0 && name[4] == 'x' && params.size() == 1) {
+			std::string columnType = "vec" + std::string(1, name[5]) + "<" + params[0] + ">";
+			auto column = computeLayout(wgslSource, columnType, depth + 1);
+			if (!column.has_value()) return std::nullopt;
+			uint64_t columnCount = (uint64_t)(name[3] - '0');
+			return WgslTypeLayout{ columnCount * roundUp(column->align, column->size), column->align };
+		}
+		if (name == "array" && params.size() == 2) {
+			auto element = computeLayout(wgslSource, params[0], depth + 1);
+			auto count = evaluateInteger(wgslSource, params[1]);
+			if (!element.has_value() || !count.has_value()) return std::nullopt;
+			return WgslTypeLayout{ count.value() * roundUp(element->align, element->size), element->align };
+		}
+		return std::nullopt;
+	}
+
+	// User-defined struct
+	if (std::all_of(type.begin(), type.end(), isIdentifierChar)) {
+		return computeStructLayout(wgslSource, type, depth + 1);
+	}
+
+	return std::nullopt;
+}
+
+} // anonymous namespace
+
+std::optional<WgslTypeLayout> computeWgslTypeLayout(
+	const std::string& wgslSource,
+	const std::string& type
+) {
+	return computeLayout(wgslSource, type, 0);
+}
+
+Result<uint64_t, Error> computeWorkgroupStorageSize(
+	const std::string& wgslSource
+) {
+	static const std::string token = "var<workgroup>";
+	uint64_t total = 0;
+	size_t pos = 0;
+	while ((pos = wgslSource.find(token, pos)) != std::string::npos) {
+		pos += token.size();
+		size_t colon = wgslSource.find(':', pos);
+		size_t semicolon = wgslSource.find(';', pos);
+		if (colon == std::string::npos || semicolon == std::string::npos || colon > semicolon) {
+			return Error{ "Could not parse workgroup variable declaration at position " + std::to_string(pos) };
+		}
+		std::string name = trim(wgslSource.substr(pos, colon - pos));
+		std::string type = trim(wgslSource.substr(colon + 1, semicolon - colon - 1));
+		auto layout = computeWgslTypeLayout(wgslSource, type);
+		if (!layout.has_value()) {
+			return Error{ "Could not compute the size of workgroup variable '" + name + "' of type '" + type + "'" };
+		}
+		total += layout->size;
+		pos = semicolon;
+	}
+	return total;
+}
+
+WgslBindingCounts countWgslBindings(
+	const std::string& wgslSource
+) {
+	WgslBindingCounts counts;
+	size_t pos = 0;
+	while ((pos = wgslSource.find("@binding(", pos)) != std::string::npos) {
+		size_t var = findWord(wgslSource, "var", pos);
+		size_t semicolon = wgslSource.find(';', pos);
+		pos += 9;
+		if (var == std::string::npos || var > semicolon) continue;
+		std::string decl = wgslSource.substr(var + 3, semicolon - var - 3);
+		decl.erase(std::remove_if(decl.begin(), decl.end(), [](char c) { return std::isspace((unsigned char)c); }), decl.end());
+		if (decl.rfind("<storage,read_write>", 0) == 0) counts.storage += 1;
+		else if (decl.rfind("<storage", 0) == 0) counts.readOnlyStorage += 1;
+		else if (decl.rfind("<uniform>", 0) == 0) {
+			counts.uniform += 1;
+			size_t colon = decl.find(':');
+			auto layout = colon == std::string::npos
+				? std::nullopt
+				: computeWgslTypeLayout(wgslSource, decl.substr(colon + 1));
+			if (layout.has_value()) {
+				counts.maxUniformBindingSize = std::max(counts.maxUniformBindingSize, layout->size);
+			}
+		}
+		else counts.other += 1;
+	}
+	return counts;
+}
+
+Result<Void, Error> checkElementWiseAccess(
+	const std::string& wgslSource,
+	const std::string& entryPointName
+) {
+	for (const char* forbidden : { "var<workgroup>", "workgroupBarrier", "storageBarrier", "atomic" }) {
+		TRY_ASSERT(
+			wgslSource.find(forbidden) == std::string::npos,
+			"Entry point '" << entryPointName << "' uses '" << forbidden << "', which prevents proving element-wise access."
+		);
+	}
+
+	// Name of the global invocation id parameter
+	size_t fnPos = findWord(wgslSource, "fn " + entryPointName);
+	TRY_ASSERT(fnPos != std::string::npos, "Could not find entry point '" << entryPointName << "' in generated WGSL code.");
+	size_t paramsEnd = wgslSource.find('{', fnPos);
+	size_t builtinPos = wgslSource.find("@builtin(global_invocation_id)", fnPos);
+	TRY_ASSERT(
+		builtinPos != std::string::npos && builtinPos < paramsEnd,
+		"Entry point '" << entryPointName << "' does not use SV_DispatchThreadID, so its accesses cannot be proven element-wise."
+	);
+	size_t nameStart = wgslSource.find(')', builtinPos) + 1;
+	size_t colon = wgslSource.find(':', nameStart);
+	std::string threadIdName = trim(wgslSource.substr(nameStart, colon - nameStart));
+
+	// Expressions that evaluate to the thread index
+	std::set<std::string> threadIndices = { threadIdName + ".x" };
+	for (const char* keyword : { "var ", "let " }) {
+		size_t pos = 0;
+		while ((pos = findWord(wgslSource, trim(keyword), pos)) != std::string::npos) {
+			pos += 3;
+			size_t semicolon = wgslSource.find(';', pos);
+			size_t eq = wgslSource.find('=', pos);
+			if (semicolon == std::string::npos || eq == std::string::npos || eq > semicolon) continue;
+			std::string declared = wgslSource.substr(pos, eq - pos);
+			declared = trim(declared.substr(0, declared.find(':')));
+			size_t declaredPos = findWord(wgslSource, declared, pos);
+			std::string value = trim(wgslSource.substr(eq + 1, semicolon - eq - 1));
+			if (threadIndices.count(value) == 0) continue;
+
+			// The variable must never be assigned after its declaration
+			size_t assignmentCount = 0;
+			size_t usePos = 0;
+			while ((usePos = findWord(wgslSource, declared, usePos)) != std::string::npos) {
+				bool isDeclaration = usePos == declaredPos;
+				usePos += declared.size();
+				if (isDeclaration) continue;
+				size_t next = usePos;
+				while (next < wgslSource.size() && std::isspace((unsigned char)wgslSource[next])) ++next;
+				std::string op = wgslSource.substr(next, 2);
+				bool isAssignment =
+					(op.size() == 2 && op[0] == '=' && op[1] != '=') ||
+					(op.size() == 2 && op[1] == '=' && std::string("+-*/%&|^").find(op[0]) != std::string::npos) ||
+					op == "++" || op == "--";
+				if (isAssignment) ++assignmentCount;
+			}
+			if (assignmentCount == 0) {
+				threadIndices.insert(declared);
+			}
+		}
+	}
+
+	// Every access to a read-write storage buffer must use one of these
+	static const std::string storageToken = "var<storage, read_write>";
+	size_t pos = 0;
+	while ((pos = wgslSource.find(storageToken, pos)) != std::string::npos) {
+		pos += storageToken.size();
+		size_t bufferColon = wgslSource.find(':', pos);
+		std::string buffer = trim(wgslSource.substr(pos, bufferColon - pos));
+
+		size_t usePos = bufferColon;
+		while ((usePos = findWord(wgslSource, buffer, usePos)) != std::string::npos) {
+			size_t before = usePos;
+			usePos += buffer.size();
+			size_t next = usePos;
+			while (next < wgslSource.size() && std::isspace((unsigned char)wgslSource[next])) ++next;
+
+			if (next < wgslSource.size() && wgslSource[next] == '[') {
+				int depth = 0;
+				size_t end = next;
+				for (; end < wgslSource.size(); ++end) {
+					if (wgslSource[end] == '[') ++depth;
+					else if (wgslSource[end] == ']' && --depth == 0) break;
+				}
+				std::string index = trim(wgslSource.substr(next + 1, end - next - 1));
+				TRY_ASSERT(
+					threadIndices.count(index) > 0,
+					"Entry point '" << entryPointName << "' accesses buffer '" << buffer << "' at index '" << index << "', which is not proven to be the thread index."
+				);
+				continue;
+			}
+
+			// Taking the buffer's address is only allowed to get its length
+			bool isArrayLength = before >= 13 && wgslSource.compare(before - 13, 13, "arrayLength(&") == 0;
+			TRY_ASSERT(
+				isArrayLength,
+				"Entry point '" << entryPointName << "' uses buffer '" << buffer << "' in a way that cannot be proven element-wise."
+			);
+		}
+	}
+
+	return {};
+}
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <slang-webgpu/common/result.h>
+
+#include <string>
+#include <cstdint>
+#include <optional>
+
+/**
+ * Very light analysis of the WGSL code produced by Slang. This is not a full
+ * WGSL parser, it only understands the declarations that Slang emits.
+ */
+
+/**
+ * Size and alignment of a WGSL type, following WGSL memory layout rules.
+ */
+struct WgslTypeLayout {
+	uint64_t size = 0;
+	uint64_t align = 1;
+};
+
+/**
+ * Number of resources bound by a WGSL source, by type of binding.
+ */
+struct WgslBindingCounts {
+	uint32_t storage = 0;
+	uint32_t readOnlyStorage = 0;
+	uint32_t uniform = 0;
+	uint32_t other = 0;
+
+	// Size of the largest uniform binding, in bytes
+	uint64_t maxUniformBindingSize = 0;
+};
+
+/**
+ * Compute the layout of a type expression (e.g., "array<vec4<f32>, 64>"),
+ * given the WGSL source where struct types and constants are declared.
+ * Returns nothing if the type could not be understood.
+ */
+std::optional<WgslTypeLayout> computeWgslTypeLayout(
+	const std::string& wgslSource,
+	const std::string& type
+);
+
+/**
+ * Sum the size of all 'var<workgroup>' declared in a WGSL source.
+ * When called on the code of a single entry point, this is the amount of
+ * workgroup storage used by this entry point.
+ */
+Result<uint64_t, Error> computeWorkgroupStorageSize(
+	const std::string& wgslSource
+);
+
+/**
+ * Count 'var<storage>' and 'var<uniform>' declarations.
+ */
+WgslBindingCounts countWgslBindings(
+	const std::string& wgslSource
+);
+
+/**
+ * Check that the entry point only accesses its read-write storage buffers at
+ * the index of the current thread, i.e., at 'global_invocation_id.x' (or at a
+ * variable initialized with it and never modified). This is conservative: an
+ * error is returned whenever this cannot be proven, with the reason why.
+ * Entry points that use workgroup memory, barriers or atomics are rejected.
+ */
+Result<Void, Error> checkElementWiseAccess(
+	const std::string& wgslSource,
+	const std::string& entryPointName
+);
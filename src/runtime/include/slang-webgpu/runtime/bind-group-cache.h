@@ -0,0 +1,105 @@
+#pragma once
+
+// NB: raii::Foo is the equivalent of Foo except its release()/addRef() methods
+// are automatically called
+#include <webgpu/webgpu-raii.hpp>
+
+#include <cstdint>
+#include <list>
+#include <mutex>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * A cache of bind groups keyed by their layout and bound buffer ranges, for
+ * applications that keep on binding the same few combinations of buffers.
+ * Generated kernels use it through their getOrCreateBindGroup() method, and
+ * a single cache may be shared by several kernels.
+ *
+ * The least recently used bind group is evicted when the capacity is reached.
+ * Cached bind groups hold a reference to their buffers, so call invalidate()
+ * when a buffer is destroyed or no longer needed, to drop the bind groups that
+ * use it and let it be released.
+ */
+class BindGroupCache {
+public:
+	struct Stats {
+		uint64_t hits = 0;
+		uint64_t misses = 0;
+		uint64_t evictions = 0;
+	};
+
+public:
+	BindGroupCache(size_t capacity = 64);
+	BindGroupCache(const BindGroupCache&) = delete;
+	BindGroupCache& operator=(const BindGroupCache&) = delete;
+
+	/**
+	 * Return the bind group that binds the given entries with the given
+	 * layout, creating it if it is not in the cache. Like with
+	 * Device::createBindGroup(), the caller owns a reference to the returned
+	 * bind group.
+	 */
+	wgpu::BindGroup getOrCreate(
+		wgpu::Device device,
+		wgpu::BindGroupLayout layout,
+		const std::vector<wgpu::BindGroupEntry>& entries,
+		std::string_view label = {}
+	);
+
+	/**
+	 * Drop all the bind groups that bind a given buffer.
+	 */
+	void invalidate(wgpu::Buffer buffer);
+
+	/**
+	 * Drop all bind groups.
+	 */
+	void clear();
+
+	/**
+	 * Change the maximum number of bind groups, evicting the least recently
+	 * used ones if needed.
+	 */
+	void setCapacity(size_t capacity);
+
+	size_t capacity() const;
+	size_t size() const;
+	Stats stats() const;
+	void resetStats();
+
+private:
+	struct BufferRange {
+		uint32_t binding;
+		WGPUBuffer buffer;
+		uint64_t offset;
+		uint64_t size;
+		bool operator==(const BufferRange& other) const;
+	};
+	struct Key {
+		WGPUBindGroupLayout layout;
+		std::vector<BufferRange> ranges;
+		bool operator==(const Key& other) const;
+	};
+	struct KeyHash {
+		size_t operator()(const Key& key) const;
+	};
+	struct Node {
+		Key key;
+		wgpu::raii::BindGroup bindGroup;
+		// Keep buffers alive so that their handles are not reused while cached
+		std::vector<wgpu::raii::Buffer> buffers;
+	};
+	using NodeList = std::list<Node>;
+
+	void evict(size_t capacity);
+
+private:
+	mutable std::mutex m_mutex;
+	size_t m_capacity;
+	// Most recently used first
+	NodeList m_nodes;
+	std::unordered_map<Key, NodeList::iterator, KeyHash> m_index;
+	Stats m_stats;
+};
@@ -0,0 +1,100 @@
+#pragma once
+
+#include <webgpu/webgpu.hpp>
+
+#include <cstdint>
+#include <filesystem>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * A persistent on-disk cache of the blobs (compiled shaders, pipeline caches,
+ * etc.) that Dawn produces while creating shader modules and pipelines, so
+ * that the next runs of the application start faster.
+ *
+ * Blobs are stored in a sub-directory named after the adapter and its driver,
+ * so that a driver update or another GPU does not load incompatible blobs.
+ * The total size of this sub-directory is bounded, and the least recently used
+ * blobs are evicted first.
+ *
+ * Usage: call attach() on the descriptor given to Adapter::requestDevice().
+ * The cache must outlive the device.
+ *
+ * NB: This only has an effect with Dawn. With Emscripten, the browser manages
+ * its own cache and attach() does nothing.
+ */
+class BlobCache {
+public:
+	struct Stats {
+		uint64_t hits = 0;
+		uint64_t misses = 0;
+		uint64_t stores = 0;
+		uint64_t evictions = 0;
+		// Current size of the cache on disk, in bytes
+		uint64_t size = 0;
+	};
+
+public:
+	BlobCache(const std::filesystem::path& directory, uint64_t maxSize = 256 * 1024 * 1024);
+	BlobCache(const BlobCache&) = delete;
+	BlobCache& operator=(const BlobCache&) = delete;
+
+	/**
+	 * Chain the load/store callbacks of this cache into a device descriptor,
+	 * and select the sub-directory that corresponds to the adapter.
+	 */
+	void attach(wgpu::DeviceDescriptor& descriptor, wgpu::Adapter adapter);
+
+	/**
+	 * Copy the blob stored under 'key' into 'value' if it is large enough,
+	 * and return the size of the blob (0 if there is none).
+	 */
+	size_t load(const void* key, size_t keySize, void* value, size_t valueSize);
+
+	/**
+	 * Store a blob under 'key', evicting older blobs if needed.
+	 */
+	void store(const void* key, size_t keySize, const void* value, size_t valueSize);
+
+	/**
+	 * A string that identifies the adapter and the version of its driver.
+	 */
+	static std::string isolationKey(wgpu::Adapter adapter);
+
+	/**
+	 * Directory where blobs of the attached adapter are stored.
+	 */
+	const std::filesystem::path& getDirectory() const { return m_directory; }
+
+	Stats stats() const;
+
+private:
+	struct Entry {
+		uint64_t size;
+		uint64_t lastUse;
+	};
+
+	void scanDirectory();
+	void evict();
+
+private:
+	std::filesystem::path m_rootDirectory;
+	std::filesystem::path m_directory;
+	uint64_t m_maxSize;
+	std::string m_isolationKey;
+#ifndef __EMSCRIPTEN__
+	wgpu::DawnCacheDeviceDescriptor m_cacheDesc;
+#endif // __EMSCRIPTEN__
+
+	mutable std::mutex m_mutex;
+	// Files of the cache directory, by name
+	std::unordered_map<std::string, Entry> m_entries;
+	uint64_t m_clock = 0;
+	// Dawn first queries the size of a blob, then loads it, so the last loaded
+	// file is kept to avoid reading it twice.
+	std::string m_lastLoadedName;
+	std::vector<uint8_t> m_lastLoaded;
+	Stats m_stats;
+};
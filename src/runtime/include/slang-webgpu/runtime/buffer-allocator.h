@@ -0,0 +1,152 @@
+#pragma once
+
+#include <slang-webgpu/common/result.h>
+#include <slang-webgpu/runtime/buffer-view.h>
+
+// NB: raii::Foo is the equivalent of Foo except its release()/addRef() methods
+// are automatically called
+#include <webgpu/webgpu-raii.hpp>
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+
+/**
+ * Sub-allocate many small buffers out of a few large ones (slabs), rather than
+ * creating and destroying a wgpu::Buffer for each of them. Slabs are grouped
+ * by usage flags, and allocations convert into the BufferView expected by the
+ * createBindGroup() overloads of generated kernels:
+ *
+ *   BufferAllocator allocator(device);
+ *   BufferAllocator::Allocation a;
+ *   TRY_ASSIGN(a, allocator.allocate(BufferUsage::Storage | BufferUsage::CopyDst, 10 * sizeof(float)));
+ *   queue.writeBuffer(a.getBuffer(), a.getOffset(), data, 10 * sizeof(float));
+ *   TRY_ASSIGN(bindGroup, kernel.createBindGroup(a, b, result));
+ *
+ * Offsets are aligned to the device's minStorageBufferOffsetAlignment and/or
+ * minUniformBufferOffsetAlignment (depending on the usage), so that any
+ * allocation may be bound. Allocations larger than a slab get a dedicated
+ * buffer.
+ *
+ * There are two kinds of allocations:
+ *  - allocate() returns a range that is given back to its slab when the last
+ *    copy of the Allocation is destroyed.
+ *  - allocateTransient() returns a range that is only valid for the current
+ *    frame. Transient slabs are bump allocated, and are all recycled at once
+ *    when the work submitted before the next endFrame() is done on the GPU.
+ *
+ * NB: A range given back to its slab may be handed out again right away, so
+ * it must only be written again through the queue (e.g., writeBuffer or
+ * commands), which is ordered after the work that used it.
+ */
+class BufferAllocator {
+public:
+	struct Stats {
+		uint64_t allocations = 0;
+		uint64_t transientAllocations = 0;
+		// Number of wgpu::Buffer created, including dedicated ones
+		uint64_t slabsCreated = 0;
+		// Number of transient slabs reused after the GPU was done with them
+		uint64_t slabsRecycled = 0;
+		uint64_t frames = 0;
+		// Bytes currently handed out by allocate()
+		uint64_t bytesInUse = 0;
+	};
+
+	/**
+	 * A range of a slab, that converts into a BufferView. Copies share the
+	 * same range, which is freed when the last of them is destroyed.
+	 */
+	class Allocation {
+	public:
+		Allocation() = default;
+
+		wgpu::Buffer getBuffer() const;
+		uint64_t getOffset() const;
+		uint64_t getSize() const;
+
+		operator BufferView() const;
+		operator bool() const { return (bool)m_block; }
+
+	private:
+		friend class BufferAllocator;
+		struct Block;
+		std::shared_ptr<Block> m_block;
+	};
+
+public:
+	BufferAllocator(
+		wgpu::Device device,
+		uint64_t slabSize = 4 * 1024 * 1024,
+		std::string_view label = "slab"
+	);
+	BufferAllocator(const BufferAllocator&) = delete;
+	BufferAllocator& operator=(const BufferAllocator&) = delete;
+
+	/**
+	 * Allocate 'size' bytes in a slab of the given usage. The offset is a
+	 * multiple of 'alignment' if non-zero, and of getAlignment(usage).
+	 */
+	Result<Allocation, Error> allocate(
+		wgpu::BufferUsage usage,
+		uint64_t size,
+		uint64_t alignment = 0
+	);
+
+	/**
+	 * Allocate 'size' bytes that are only valid until the work submitted
+	 * before the next call to endFrame() is done.
+	 */
+	Result<BufferView, Error> allocateTransient(
+		wgpu::BufferUsage usage,
+		uint64_t size,
+		uint64_t alignment = 0
+	);
+
+	/**
+	 * Close the current frame. Call this once the work that uses transient
+	 * allocations of the frame has been submitted: their slabs are recycled
+	 * once this work is done on the GPU.
+	 */
+	void endFrame();
+
+	/**
+	 * Process device events without blocking, so that the slabs of frames
+	 * that are done get recycled.
+	 */
+	void poll();
+
+	/**
+	 * Alignment of the offsets of allocations with the given usage.
+	 */
+	uint64_t getAlignment(wgpu::BufferUsage usage) const;
+
+	uint64_t getSlabSize() const { return m_slabSize; }
+
+	Stats stats() const;
+
+private:
+	struct Slab;
+	struct Core;
+
+	Result<std::shared_ptr<Slab>, Error> createSlab(wgpu::BufferUsage usage, uint64_t size);
+
+	/**
+	 * Give the transient slabs of a frame back to the pool once the GPU is
+	 * done with the frame.
+	 */
+	static void onFrameDone(const std::shared_ptr<Core>& core, uint64_t frame);
+
+private:
+	wgpu::raii::Device m_device;
+	wgpu::raii::Instance m_instance;
+	wgpu::raii::Queue m_queue;
+	std::string m_label;
+	uint64_t m_slabSize;
+	uint64_t m_storageAlignment = 256;
+	uint64_t m_uniformAlignment = 256;
+	// Shared with allocations and completion callbacks, which may outlive the
+	// allocator
+	std::shared_ptr<Core> m_core;
+};
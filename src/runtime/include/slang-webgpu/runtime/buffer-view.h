@@ -0,0 +1,47 @@
+#pragma once
+
+#include <slang-webgpu/common/result.h>
+#include <slang-webgpu/common/kernel-archive.h>
+
+#include <webgpu/webgpu.hpp>
+
+#include <cstdint>
+
+/**
+ * A range of a buffer bound to a kernel, so that many logical arrays may be
+ * carved out of a single large allocation. A buffer is implicitly converted
+ * into a view of its whole content.
+ *
+ * NB: WebGPU tracks usages per buffer rather than per range, so a buffer that
+ * is bound as writable storage by a dispatch may not be bound as read-only
+ * storage or uniform by the same dispatch, even through disjoint views.
+ */
+struct BufferView {
+	BufferView() = default;
+	BufferView(wgpu::Buffer buffer, uint64_t offset = 0, uint64_t size = WGPU_WHOLE_SIZE)
+		: buffer(buffer)
+		, offset(offset)
+		, size(size)
+	{}
+
+	wgpu::Buffer buffer = nullptr;
+	uint64_t offset = 0;
+	// WGPU_WHOLE_SIZE means up to the end of the buffer
+	uint64_t size = WGPU_WHOLE_SIZE;
+};
+
+/**
+ * Build the bind group entry that binds a view to a binding, after checking
+ * that the device accepts it: the offset must be a multiple of the device's
+ * minStorageBufferOffsetAlignment (or minUniformBufferOffsetAlignment), and
+ * the range must fit in the buffer and be at least of the binding's
+ * minBindingSize.
+ *
+ * NB: The size of the entry is always explicit, so that binding a buffer or
+ * a view of its whole content give the same entry.
+ */
+Result<wgpu::BindGroupEntry, Error> makeBufferBindGroupEntry(
+	wgpu::Device device,
+	const KernelBindingInfo& binding,
+	const BufferView& view
+);
@@ -0,0 +1,190 @@
+#pragma once
+
+#include <slang-webgpu/common/result.h>
+#include <slang-webgpu/common/kernel-utils.h>
+#include <slang-webgpu/common/kernel-archive.h>
+#include <slang-webgpu/runtime/dispatch-recorder.h>
+
+// NB: raii::Foo is the equivalent of Foo except its release()/addRef() methods
+// are automatically called
+#include <webgpu/webgpu-raii.hpp>
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+class DynamicKernel;
+
+/**
+ * A graph of dispatches, declared once and executed as many times as needed.
+ *
+ * Each node dispatches an entry point of a kernel with one graph buffer per
+ * binding. Whether a node reads or writes a buffer is derived from the type
+ * of its binding (ReadOnlyStorage and Uniform read, Storage reads and writes),
+ * from which compile() derives the dependencies between nodes. Nodes are then
+ * grouped into waves of nodes that do not depend on each other, and recorded
+ * wave after wave into a single compute pass.
+ *
+ * Buffers are either imported (created and owned by the application, e.g.,
+ * inputs and outputs) or transient (intermediate results that only live
+ * between their first and last use within the graph). Transient buffers whose
+ * lifetimes do not overlap share the same GPU allocation, which reduces the
+ * peak memory used by long chains of kernels.
+ *
+ * NB: The content of a transient buffer is undefined before it is written by
+ * the graph, and after its last use. Nodes reference the pipelines of their
+ * kernels, so kernels must outlive the graph.
+ */
+class ComputeGraph {
+public:
+	using BufferHandle = uint32_t;
+
+	/**
+	 * Everything needed to dispatch a kernel's entry point. Generated and
+	 * dynamic kernels are turned into nodes by addNode().
+	 */
+	struct Node {
+		std::string label;
+		wgpu::ComputePipeline pipeline;
+		wgpu::BindGroupLayout bindGroupLayout;
+		std::vector<KernelBindingInfo> bindings;
+		ThreadCount workgroupSize;
+		DispatchSize dispatchSize;
+		// One buffer per binding, in the order of the bindings
+		std::vector<BufferHandle> buffers;
+	};
+
+	struct Stats {
+		uint32_t nodes = 0;
+		uint32_t waves = 0;
+		uint32_t transientBuffers = 0;
+		// Number of GPU buffers allocated for the transient buffers
+		uint32_t allocatedBuffers = 0;
+		// Total size of the transient buffers, if they were not aliased
+		uint64_t transientBytes = 0;
+		// Total size actually allocated for the transient buffers
+		uint64_t allocatedBytes = 0;
+	};
+
+public:
+	ComputeGraph(wgpu::Device device, std::string_view label = "ComputeGraph");
+	ComputeGraph(const ComputeGraph&) = delete;
+	ComputeGraph& operator=(const ComputeGraph&) = delete;
+
+	/**
+	 * Use a buffer created by the application. It is never aliased, and must
+	 * remain alive as long as the graph.
+	 */
+	BufferHandle importBuffer(wgpu::Buffer buffer);
+
+	/**
+	 * Declare an intermediate buffer of 'size' bytes, allocated by compile().
+	 */
+	BufferHandle createTransientBuffer(uint64_t size, std::string_view label = {});
+
+	/**
+	 * Add a node that dispatches an entry point of a generated kernel, e.g.,
+	 *   graph.addNode("sum", kernel, BufferMathKernel::EntryPoint::ComputeMainAdd, ThreadCount{ 10 }, { a, b, sum });
+	 */
+	template <typename Kernel>
+	Result<Void, Error> addNode(
+		std::string_view label,
+		const Kernel& kernel,
+		typename Kernel::EntryPoint entryPoint,
+		DispatchSize dispatchSize,
+		const std::vector<BufferHandle>& buffers
+	) {
+		const auto& bindings = Kernel::getBindings();
+		Node node;
+		node.label = label;
+		node.pipeline = kernel.getPipeline((uint32_t)entryPoint);
+		node.bindGroupLayout = kernel.getBindGroupLayouts();
+		node.bindings.assign(bindings.begin(), bindings.end());
+		node.workgroupSize = kernel.getWorkgroupSize((uint32_t)entryPoint);
+		node.dispatchSize = dispatchSize;
+		node.buffers = buffers;
+		return addNode(std::move(node));
+	}
+
+	/**
+	 * Add a node that dispatches an entry point of a kernel loaded from an
+	 * archive.
+	 */
+	Result<Void, Error> addNode(
+		std::string_view label,
+		DynamicKernel& kernel,
+		std::string_view entryPoint,
+		DispatchSize dispatchSize,
+		const std::vector<BufferHandle>& buffers
+	);
+
+	/**
+	 * Add a node that was manually described.
+	 */
+	Result<Void, Error> addNode(Node node);
+
+	/**
+	 * Order nodes, allocate transient buffers and create bind groups. This is
+	 * automatically called by record() when the graph changed since the last
+	 * compilation.
+	 */
+	Result<Void, Error> compile();
+
+	/**
+	 * Record all nodes into a recorder, which may also contain other
+	 * dispatches. Nothing is submitted.
+	 */
+	Result<Void, Error> record(DispatchRecorder& recorder);
+
+	/**
+	 * Record all nodes into their own compute pass and submit it.
+	 */
+	Result<Void, Error> execute();
+
+	/**
+	 * Get the GPU buffer behind a graph buffer. For transient buffers, this
+	 * is only available after compile(), and the buffer may be shared with
+	 * other transient buffers.
+	 */
+	wgpu::Buffer getBuffer(BufferHandle handle) const;
+
+	const Stats& stats() const { return m_stats; }
+
+private:
+	struct BufferEntry {
+		std::string label;
+		bool transient;
+		uint64_t size;
+		wgpu::BufferUsage usage;
+		// Imported buffer, or allocation assigned by compile()
+		wgpu::Buffer buffer;
+		// Range of waves in which the buffer is used
+		uint32_t firstWave;
+		uint32_t lastWave;
+	};
+
+	struct CompiledNode {
+		uint32_t node;
+		uint32_t wave;
+		WorkgroupCount workgroupCount;
+		std::vector<uint32_t> dynamicOffsets;
+		wgpu::raii::BindGroup bindGroup;
+	};
+
+	Result<Void, Error> scheduleNodes();
+	Result<Void, Error> allocateTransientBuffers();
+	Result<Void, Error> createBindGroups();
+
+private:
+	wgpu::Device m_device;
+	std::string m_label;
+	std::vector<Node> m_nodes;
+	std::vector<BufferEntry> m_buffers;
+	bool m_compiled = false;
+
+	// Output of compile(), sorted by wave
+	std::vector<CompiledNode> m_schedule;
+	std::vector<wgpu::raii::Buffer> m_allocations;
+	Stats m_stats;
+};
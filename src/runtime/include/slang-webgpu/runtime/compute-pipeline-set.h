@@ -0,0 +1,175 @@
+#pragma once
+
+#include <slang-webgpu/common/result.h>
+
+// NB: raii::Foo is the equivalent of Foo except its release()/addRef() methods
+// are automatically called
+#include <webgpu/webgpu-raii.hpp>
+
+#include <functional>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/**
+ * How the compute pipelines of a kernel are created.
+ */
+enum class PipelineCreation {
+	// All pipelines are created by the constructor of the kernel
+	Immediate,
+	// Pipelines are created in the background with createComputePipelineAsync(),
+	// and the constructor returns right away
+	Async,
+	// Each pipeline is only created when it is first needed (or prewarmed),
+	// which saves startup time and memory when only a few entry points of a
+	// kernel are used
+	Lazy,
+};
+
+/**
+ * The compute pipelines of all the entry points of a kernel, which share the
+ * same shader module and pipeline layout. Generated kernels hold one of these.
+ *
+ * With PipelineCreation::Async, pipelines become available progressively.
+ * Their creation is tracked in a state shared with WebGPU callbacks, so that
+ * the set may be moved or destroyed while pipelines are still being created.
+ *
+ * With PipelineCreation::Lazy, the set keeps the shader module and layout
+ * until all pipelines have been created, and creates each of them on the first
+ * call to get() or through prewarm().
+ */
+class ComputePipelineSet {
+public:
+	using ReadyCallback = std::function<void(Result<Void, Error>)>;
+
+public:
+	ComputePipelineSet() = default;
+
+	ComputePipelineSet(
+		wgpu::Device device,
+		wgpu::ShaderModule shaderModule,
+		wgpu::PipelineLayout layout,
+		const std::vector<std::string>& entryPoints,
+		std::string_view label,
+		PipelineCreation creation = PipelineCreation::Immediate
+	);
+
+	/**
+	 * Whether all pipelines have been created (successfully or not). With
+	 * PipelineCreation::Lazy, only the pipelines that were requested (by get()
+	 * or prewarm()) are taken into account.
+	 */
+	bool isReady() const;
+
+	/**
+	 * Block until all pipelines have been created, and return an error if any
+	 * of them failed. With Dawn, this waits on the futures of the pipelines
+	 * with Instance::waitAny().
+	 * NB: With Emscripten, the browser must regain control for pipelines to be
+	 * created, so this returns an error if they are not ready yet. Use
+	 * onReady() or poll isReady() from the main loop instead.
+	 */
+	Result<Void, Error> waitUntilReady() const;
+
+	/**
+	 * Call 'callback' once all pipelines have been created, or right away if
+	 * they already are. The callback may be called from another thread.
+	 */
+	void onReady(ReadyCallback callback) const;
+
+	/**
+	 * Get the pipeline of an entry point, waiting for its creation if needed
+	 * (see waitUntilReady() for the Emscripten case). With
+	 * PipelineCreation::Lazy, this creates the pipeline if it was not yet.
+	 */
+	Result<wgpu::ComputePipeline, Error> get(uint32_t entryPointIndex) const;
+
+	/**
+	 * Start creating the pipelines of the given entry points, if they are not
+	 * already, either in the background (Async) or right away (Immediate).
+	 * This only matters for sets created with PipelineCreation::Lazy.
+	 */
+	Result<Void, Error> prewarm(
+		const std::vector<uint32_t>& entryPointIndices,
+		PipelineCreation creation = PipelineCreation::Async
+	) const;
+
+	/**
+	 * Same as prewarm(), with entry points given by name.
+	 */
+	Result<Void, Error> prewarm(
+		const std::vector<std::string>& entryPointNames,
+		PipelineCreation creation = PipelineCreation::Async
+	) const;
+
+	/**
+	 * Whether the pipeline of an entry point has been requested, i.e., is
+	 * created or being created.
+	 */
+	bool isRequested(uint32_t entryPointIndex) const;
+
+	size_t size() const;
+
+	/**
+	 * Share the pipelines of this set with a kernel that uses another creation
+	 * mode. Pipelines that were not requested yet are requested with
+	 * 'creation', unless it is Lazy. With PipelineCreation::Immediate, this
+	 * also waits for the pipelines that are still being created, so that the
+	 * returned set behaves as if it had created them itself.
+	 */
+	ComputePipelineSet share(PipelineCreation creation) const;
+
+private:
+	struct State;
+	struct PendingPipeline;
+
+	/**
+	 * Record the outcome of the creation of a pipeline and call the ready
+	 * callbacks if it was the last one.
+	 */
+	static void onPipelineCreated(
+		const std::shared_ptr<State>& state,
+		uint32_t entryPointIndex,
+		wgpu::ComputePipeline pipeline,
+		std::string_view errorMessage
+	);
+
+	/**
+	 * Mark the pipeline as requested and create it, unless it already was.
+	 * The state must not be locked, as callbacks may be called right away.
+	 */
+	void request(uint32_t entryPointIndex, PipelineCreation creation) const;
+
+	Result<Void, Error> waitFor(std::function<bool()> isDone) const;
+
+private:
+	wgpu::Device m_device = nullptr;
+	PipelineCreation m_creation = PipelineCreation::Immediate;
+	std::shared_ptr<State> m_state;
+};
+
+/**
+ * Whether all given kernels (or pipeline sets) are ready.
+ */
+template <typename... Kernels>
+bool areAllReady(const Kernels&... kernels) {
+	return (kernels.isReady() && ...);
+}
+
+/**
+ * Wait until all given kernels (or pipeline sets) are ready, and return the
+ * first error encountered. Kernels created with PipelineCreation::Async create
+ * their pipelines concurrently, so creating all of them before waiting for
+ * them takes about as long as creating the slowest one.
+ */
+template <typename... Kernels>
+Result<Void, Error> waitUntilAllReady(const Kernels&... kernels) {
+	Result<Void, Error> result;
+	auto wait = [&](const auto& kernel) {
+		auto maybeError = kernel.waitUntilReady();
+		if (isError(maybeError) && !isError(result)) result = maybeError;
+	};
+	(wait(kernels), ...);
+	return result;
+}
@@ -0,0 +1,152 @@
+#pragma once
+
+// NB: raii::Foo is the equivalent of Foo except its release()/addRef() methods
+// are automatically called
+#include <webgpu/webgpu-raii.hpp>
+
+#include <slang-webgpu/runtime/compute-pipeline-set.h>
+
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <unordered_map>
+#include <vector>
+
+class WorkgroupCountKernel;
+
+/**
+ * GPU objects that are shared by all kernels created on the same device.
+ *
+ * It holds the device limits, queried once, and bind group layouts, keyed by
+ * binding signature (see bindingSignature() in kernel-archive.h). Generated kernels and dynamic
+ * kernels that have identical bindings thus use the very same layout, so that
+ * a bind group created for one of them may be used with any other. It also
+ * holds built-in kernels, like WorkgroupCountKernel.
+ *
+ * Shader modules are keyed by WGSL source, so that identical sources are only
+ * compiled once, even across different kernels, and pipeline layouts are keyed
+ * by bind group layouts. Sources are looked up by hash, and only copied when
+ * they are first requested. The compute pipelines of generated kernels are shared
+ * by all instances of the same kernel type (name and shader module), so that
+ * constructing a kernel again costs little more than a few lookups. Shader
+ * modules and pipelines are created outside of the registry's lock, and
+ * concurrent requests of the same one wait for the first.
+ *
+ * NB: Registries are keyed by device without holding a reference to it. A
+ * registry lives as long as the kernels that use it (which keep the pointer
+ * returned by get()), so the objects it caches, which reference the device, do
+ * not outlive them.
+ */
+class DeviceRegistry {
+public:
+	/**
+	 * Get the registry of a device, creating it if no kernel of this device
+	 * currently uses one.
+	 */
+	static std::shared_ptr<DeviceRegistry> get(wgpu::Device device);
+
+	/**
+	 * Forget the registry of a device, e.g., when the device is lost, so that
+	 * kernels created afterwards use a new one. Kernels that still use the
+	 * previous registry keep it alive.
+	 */
+	static void release(wgpu::Device device);
+
+	/**
+	 * Get the layout that has a given signature, creating it from the entries
+	 * if this is the first time it is requested.
+	 */
+	wgpu::raii::BindGroupLayout getOrCreateBindGroupLayout(
+		const std::string& signature,
+		const std::vector<wgpu::BindGroupLayoutEntry>& entries
+	);
+
+	size_t bindGroupLayoutCount() const;
+
+	/**
+	 * Get the shader module compiled from a given WGSL source, creating it if
+	 * this is the first time this source is requested. The label is only used
+	 * upon creation.
+	 */
+	wgpu::raii::ShaderModule getOrCreateShaderModule(
+		std::string_view label,
+		std::string_view wgslSource
+	);
+
+	size_t shaderModuleCount() const;
+
+	/**
+	 * Get the pipeline layout made of the given bind group layouts, creating
+	 * it if this is the first time it is requested.
+	 */
+	wgpu::raii::PipelineLayout getOrCreatePipelineLayout(
+		const std::vector<wgpu::BindGroupLayout>& bindGroupLayouts
+	);
+
+	/**
+	 * Get the pipelines of a kernel type, creating the set if this is the
+	 * first time it is requested. When the set already exists, the returned
+	 * set follows the given creation mode rather than the one of the kernel
+	 * that created it (see ComputePipelineSet::share()).
+	 */
+	ComputePipelineSet getOrCreatePipelineSet(
+		std::string_view kernelName,
+		wgpu::ShaderModule shaderModule,
+		wgpu::PipelineLayout layout,
+		const std::vector<std::string>& entryPoints,
+		PipelineCreation creation
+	);
+
+	size_t pipelineSetCount() const;
+
+	/**
+	 * Get the built-in kernel that computes indirect dispatch arguments,
+	 * creating it upon first call.
+	 */
+	WorkgroupCountKernel& getWorkgroupCountKernel();
+
+	wgpu::Device getDevice() const { return m_device; }
+
+	/**
+	 * Limits of the device, as returned by Device::getLimits() when the
+	 * registry was created.
+	 */
+	const wgpu::Limits& getLimits() const { return m_limits; }
+
+	~DeviceRegistry();
+
+private:
+	DeviceRegistry(wgpu::Device device);
+
+	/**
+	 * An entry that is inserted under m_mutex, and whose object is created
+	 * outside of it by the first requester while the others wait.
+	 */
+	template <typename T>
+	struct PendingEntry {
+		std::once_flag created;
+		T object;
+	};
+
+	struct ShaderModuleEntry : PendingEntry<wgpu::raii::ShaderModule> {
+		std::string wgslSource;
+	};
+
+private:
+	// Not referenced by the registry, see get()
+	wgpu::Device m_device;
+	wgpu::Limits m_limits;
+	mutable std::mutex m_mutex;
+	std::unordered_map<std::string, wgpu::raii::BindGroupLayout> m_bindGroupLayouts;
+	// Keyed by hash of the WGSL source
+	std::unordered_multimap<size_t, std::shared_ptr<ShaderModuleEntry>> m_shaderModules;
+	std::map<std::vector<WGPUBindGroupLayout>, wgpu::raii::PipelineLayout> m_pipelineLayouts;
+	std::map<std::tuple<std::string, WGPUShaderModule, WGPUPipelineLayout>, std::shared_ptr<PendingEntry<ComputePipelineSet>>> m_pipelineSets;
+	// NB: Built-in kernels use the registry upon creation, so they are not
+	// created while holding m_mutex.
+	std::once_flag m_workgroupCountKernelFlag;
+	std::unique_ptr<WorkgroupCountKernel> m_workgroupCountKernel;
+};
@@ -0,0 +1,106 @@
+#pragma once
+
+// NB: raii::Foo is the equivalent of Foo except its release()/addRef() methods
+// are automatically called
+#include <webgpu/webgpu-raii.hpp>
+
+#include <array>
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+/**
+ * Records many dispatches, possibly of different kernels and entry points,
+ * into a single compute pass that is submitted at once.
+ *
+ * Contrary to the dispatch methods that take a compute pass, which set the
+ * pipeline and bind group before each dispatch, the recorder remembers the
+ * state of the pass and skips setPipeline() and setBindGroup() calls that do
+ * not change it. Generated kernels accept a recorder in place of a compute
+ * pass (see their Recorder type).
+ */
+class DispatchRecorder {
+public:
+	struct Stats {
+		uint64_t dispatches = 0;
+		uint64_t pipelineChanges = 0;
+		uint64_t bindGroupChanges = 0;
+		// Calls that were skipped because they did not change the state
+		uint64_t skippedPipelineChanges = 0;
+		uint64_t skippedBindGroupChanges = 0;
+
+		uint64_t savedStateChanges() const { return skippedPipelineChanges + skippedBindGroupChanges; }
+	};
+
+public:
+	/**
+	 * Create a command encoder and begin a compute pass.
+	 */
+	DispatchRecorder(wgpu::Device device, std::string_view label = "DispatchRecorder");
+	DispatchRecorder(DispatchRecorder&&) = default;
+	DispatchRecorder& operator=(DispatchRecorder&&) = default;
+	DispatchRecorder(const DispatchRecorder&) = delete;
+	DispatchRecorder& operator=(const DispatchRecorder&) = delete;
+
+	void setPipeline(wgpu::ComputePipeline pipeline);
+
+	void setBindGroup(
+		uint32_t groupIndex,
+		wgpu::BindGroup bindGroup,
+		uint32_t dynamicOffsetCount = 0,
+		const uint32_t* dynamicOffsets = nullptr
+	);
+
+	void dispatchWorkgroups(uint32_t x, uint32_t y = 1, uint32_t z = 1);
+	void dispatchWorkgroupsIndirect(wgpu::Buffer indirectBuffer, uint64_t indirectOffset);
+
+	/**
+	 * End the compute pass and return the recorded commands.
+	 * NB: Nothing can be recorded afterwards.
+	 */
+	wgpu::raii::CommandBuffer finish();
+
+	/**
+	 * Finish and submit the recorded commands to the device's queue.
+	 */
+	void submit();
+
+	/**
+	 * Whether finish() or submit() has been called.
+	 */
+	bool isFinished() const { return m_finished; }
+
+	/**
+	 * Direct access to the compute pass, which is not tracked.
+	 * NB: Call invalidateState() after setting its state directly.
+	 */
+	wgpu::ComputePassEncoder getComputePass() const { return *m_computePass; }
+
+	/**
+	 * Forget the tracked state, so that the next calls are not skipped.
+	 */
+	void invalidateState();
+
+	const Stats& stats() const { return m_stats; }
+
+private:
+	bool checkRecording() const;
+
+private:
+	static constexpr uint32_t s_maxBindGroups = 4;
+	// The tracked objects are referenced, so that their handles cannot be
+	// reused by new objects while they are compared to.
+	struct BindGroupState {
+		wgpu::raii::BindGroup bindGroup;
+		std::vector<uint32_t> dynamicOffsets;
+	};
+
+	wgpu::Device m_device;
+	wgpu::raii::CommandEncoder m_encoder;
+	wgpu::raii::ComputePassEncoder m_computePass;
+	bool m_finished = false;
+
+	wgpu::raii::ComputePipeline m_pipeline;
+	std::array<BindGroupState, s_maxBindGroups> m_bindGroups;
+	Stats m_stats;
+};
@@ -0,0 +1,150 @@
+#pragma once
+
+#include <slang-webgpu/common/result.h>
+#include <slang-webgpu/common/kernel-utils.h>
+#include <slang-webgpu/common/kernel-archive.h>
+#include <slang-webgpu/runtime/bind-group-cache.h>
+#include <slang-webgpu/runtime/buffer-view.h>
+
+// NB: raii::Foo is the equivalent of Foo except its release()/addRef() methods
+// are automatically called
+#include <webgpu/webgpu-raii.hpp>
+
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+class DeviceRegistry;
+
+/**
+ * A kernel loaded at runtime from a kernel archive, rather than generated as a
+ * C++ class. It offers the same features as generated kernels, except that
+ * entry points are addressed by name and resources are given as a list.
+ *
+ * The shader module and bind group layout are created upon loading, but the
+ * compute pipeline of each entry point is only created the first time it is
+ * used, so that loading an archive with many kernels remains cheap.
+ */
+class DynamicKernel {
+public:
+	/**
+	 * Load kernel 'name' from the archive. The archive may be closed
+	 * afterwards, the kernel does not reference it.
+	 */
+	static Result<DynamicKernel, Error> create(
+		wgpu::Device device,
+		const KernelArchive& archive,
+		std::string_view name
+	);
+
+	DynamicKernel() = default;
+
+	/**
+	 * Replace the shader of this kernel with the one found in the archive
+	 * under the same name. The bindings must not have changed, so that bind
+	 * groups created before the reload remain valid. In case of error, the
+	 * previous version of the kernel is kept.
+	 */
+	Result<Void, Error> reload(const KernelArchive& archive);
+
+	/**
+	 * Create a bind group to be used with the dispatch methods of this kernel.
+	 * Buffers must be given in the order of getBindings(), which is the order
+	 * of the arguments of a generated kernel's createBindGroup(). They may be
+	 * whole buffers or views of a range of a buffer.
+	 */
+	Result<wgpu::BindGroup, Error> createBindGroup(
+		const std::vector<BufferView>& buffers
+	) const;
+
+	/**
+	 * Same as createBindGroup(), but looks up the bind group in a cache first.
+	 */
+	Result<wgpu::BindGroup, Error> getOrCreateBindGroup(
+		BindGroupCache& cache,
+		const std::vector<BufferView>& buffers
+	) const;
+
+	/**
+	 * Dispatch an entry point on a given number of threads or workgroups.
+	 * This overload creates its own command encoder, compute pass, and submit
+	 * all resulting commands to the device's queue.
+	 */
+	Result<Void, Error> dispatch(
+		std::string_view entryPoint,
+		DispatchSize dispatchSize,
+		wgpu::BindGroup bindGroup
+	);
+
+	/**
+	 * Variant of dispatch() that uses an already existing command encoder.
+	 * NB: This does not finish and submit the encoder.
+	 */
+	Result<Void, Error> dispatch(
+		wgpu::CommandEncoder encoder,
+		std::string_view entryPoint,
+		DispatchSize dispatchSize,
+		wgpu::BindGroup bindGroup
+	);
+
+	/**
+	 * Variant of dispatch() that uses an already existing compute pass.
+	 * NB: This does not end the pass.
+	 */
+	Result<Void, Error> dispatch(
+		wgpu::ComputePassEncoder computePass,
+		std::string_view entryPoint,
+		DispatchSize dispatchSize,
+		wgpu::BindGroup bindGroup
+	);
+
+	/**
+	 * In case of trouble loading shader, the kernel might be invalid.
+	 */
+	operator bool() const { return m_valid; }
+
+	const std::string& getName() const { return m_name; }
+	const std::vector<KernelEntryPointInfo>& getEntryPoints() const { return m_entryPoints; }
+	const std::vector<KernelBindingInfo>& getBindings() const { return m_bindings; }
+	bool hasEntryPoint(std::string_view entryPoint) const;
+
+	/**
+	 * Direct access to the lower level bind group layout
+	 */
+	wgpu::BindGroupLayout getBindGroupLayout() const;
+
+	/**
+	 * Direct access to the lower level pipeline, which is created if needed
+	 */
+	Result<wgpu::ComputePipeline, Error> getPipeline(std::string_view entryPoint);
+
+	/**
+	 * Direct access to the lower level workgroup size
+	 */
+	Result<ThreadCount, Error> getWorkgroupSize(std::string_view entryPoint) const;
+
+	/**
+	 * Direct access to the lower level device
+	 */
+	wgpu::Device getDevice() const { return m_device; }
+
+private:
+	Result<size_t, Error> findEntryPoint(std::string_view entryPoint) const;
+	Result<std::vector<wgpu::BindGroupEntry>, Error> makeBindGroupEntries(const std::vector<BufferView>& buffers) const;
+	Result<Void, Error> load(const KernelView& kernel);
+
+private:
+	wgpu::Device m_device = nullptr;
+	// Keeps the layouts shared with other kernels of the device alive
+	std::shared_ptr<DeviceRegistry> m_registry;
+	bool m_valid = false;
+	std::string m_name;
+	std::vector<KernelEntryPointInfo> m_entryPoints;
+	std::vector<KernelBindingInfo> m_bindings;
+	wgpu::raii::ShaderModule m_shaderModule;
+	wgpu::raii::BindGroupLayout m_bindGroupLayout;
+	wgpu::raii::PipelineLayout m_pipelineLayout;
+	// Null until the entry point is first used
+	std::vector<wgpu::raii::ComputePipeline> m_pipelines;
+};
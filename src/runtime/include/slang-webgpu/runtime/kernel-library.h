@@ -0,0 +1,60 @@
+#pragma once
+
+#include <slang-webgpu/common/result.h>
+#include <slang-webgpu/common/kernel-archive.h>
+#include <slang-webgpu/runtime/dynamic-kernel.h>
+
+#include <webgpu/webgpu.hpp>
+
+#include <filesystem>
+#include <functional>
+#include <map>
+#include <memory>
+#include <string>
+#include <string_view>
+
+/**
+ * A kernel archive file together with the kernels loaded from it. Kernels are
+ * only loaded upon first request, and can all be reloaded when the archive
+ * file changes, which enables updating shaders without rebuilding the
+ * application.
+ */
+class KernelLibrary {
+public:
+	static Result<KernelLibrary, Error> open(
+		wgpu::Device device,
+		const std::filesystem::path& path
+	);
+
+	KernelLibrary() = default;
+
+	/**
+	 * Get a kernel by name, loading it on first request. The returned pointer
+	 * remains valid as long as the library is alive, including across reloads.
+	 */
+	Result<DynamicKernel*, Error> getKernel(std::string_view name);
+
+	/**
+	 * Map the archive file again and reload all kernels loaded so far. Kernels
+	 * that fail to reload keep their previous version, and the error lists
+	 * them all.
+	 */
+	Result<Void, Error> reload();
+
+	/**
+	 * Reload the archive only if its file has been modified since last loaded,
+	 * and return whether it was reloaded. Call this e.g. once per frame to
+	 * get hot shader updates.
+	 */
+	Result<bool, Error> reloadIfChanged();
+
+	const KernelArchive& getArchive() const { return m_archive; }
+	const std::filesystem::path& getPath() const { return m_path; }
+
+private:
+	wgpu::Device m_device = nullptr;
+	std::filesystem::path m_path;
+	std::filesystem::file_time_type m_modificationTime;
+	KernelArchive m_archive;
+	std::map<std::string, std::unique_ptr<DynamicKernel>, std::less<>> m_kernels;
+};
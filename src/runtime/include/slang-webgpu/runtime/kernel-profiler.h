@@ -0,0 +1,220 @@
+#pragma once
+
+#include <slang-webgpu/common/result.h>
+#include <slang-webgpu/common/kernel-utils.h>
+#include <slang-webgpu/runtime/readback-service.h>
+
+// NB: raii::Foo is the equivalent of Foo except its release()/addRef() methods
+// are automatically called
+#include <webgpu/webgpu-raii.hpp>
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+/**
+ * Collect per entry point statistics about the dispatches of generated
+ * kernels, once attached to them with setProfiler():
+ *  - CPU-side counters: number of dispatches and of workgroups, and the time
+ *    spent encoding each dispatch.
+ *  - GPU time, when the device has the TimestampQuery feature. Dispatches that
+ *    begin their own compute pass (i.e., that are given a command encoder or
+ *    nothing) write timestamps at the beginning and end of their pass, which
+ *    resolve() reads back asynchronously.
+ *
+ * Typical usage:
+ *
+ *   KernelProfiler profiler(device);
+ *   kernel.setProfiler(&profiler);
+ *   kernel.dispatchFoo(encoder, size, bindGroup); // for each frame:
+ *   queue.submit(commands);
+ *   profiler.resolve(); // after the submit
+ *   ...
+ *   profiler.waitForResults(); // or poll()
+ *   for (const auto& stats : profiler.stats()) { ... }
+ *
+ * NB: Dispatches recorded in a compute pass or a DispatchRecorder share their
+ * pass with others, so they only have CPU-side statistics.
+ */
+class KernelProfiler {
+public:
+	/**
+	 * Durations in nanoseconds, counted by power of two.
+	 */
+	struct Histogram {
+		static constexpr size_t BucketCount = 64;
+
+		// Bucket i counts durations in [2^i, 2^(i+1)[ (and 0 in bucket 0)
+		std::array<uint64_t, BucketCount> buckets = {};
+		uint64_t count = 0;
+		uint64_t totalNs = 0;
+		uint64_t minNs = UINT64_MAX;
+		uint64_t maxNs = 0;
+
+		void add(uint64_t durationNs);
+
+		double meanNs() const;
+
+		/**
+		 * Upper bound of the bucket that contains the p-th percentile, with p
+		 * in [0, 1].
+		 */
+		uint64_t percentileNs(double p) const;
+	};
+
+	struct EntryPointStats {
+		std::string kernel;
+		std::string entryPoint;
+		uint64_t dispatches = 0;
+		// Workgroups of indirect dispatches are not counted
+		uint64_t indirectDispatches = 0;
+		uint64_t workgroups = 0;
+		Histogram cpuEncodeTime;
+		// Empty without the TimestampQuery feature
+		Histogram gpuTime;
+	};
+
+	/**
+	 * Measure the CPU time spent encoding a dispatch, from construction to
+	 * destruction. Does nothing if the profiler is null or disabled.
+	 */
+	class DispatchTimer {
+	public:
+		DispatchTimer(KernelProfiler* profiler, const char* kernel, const char* entryPoint, WorkgroupCount workgroupCount);
+
+		/**
+		 * Indirect dispatch, whose workgroup count is not known on the CPU.
+		 */
+		DispatchTimer(KernelProfiler* profiler, const char* kernel, const char* entryPoint);
+
+		DispatchTimer(const DispatchTimer&) = delete;
+		DispatchTimer& operator=(const DispatchTimer&) = delete;
+
+		~DispatchTimer();
+
+	private:
+		KernelProfiler* m_profiler;
+		const char* m_kernel;
+		const char* m_entryPoint;
+		uint64_t m_workgroups;
+		bool m_indirect;
+		std::chrono::steady_clock::time_point m_start;
+	};
+
+public:
+	/**
+	 * Create a profiler that can time up to 'maxTimedPasses' compute passes
+	 * between two calls to resolve(). Passes beyond this are not timed.
+	 */
+	KernelProfiler(wgpu::Device device, uint32_t maxTimedPasses = 256);
+	KernelProfiler(const KernelProfiler&) = delete;
+	KernelProfiler& operator=(const KernelProfiler&) = delete;
+
+	/**
+	 * Whether GPU timings are available, i.e., whether the device has the
+	 * TimestampQuery feature.
+	 */
+	bool hasTimestamps() const { return (bool)m_querySet; }
+
+	/**
+	 * Profiling can be turned off and on at runtime, without detaching the
+	 * profiler from kernels.
+	 */
+	void setEnabled(bool enabled) { m_enabled = enabled; }
+	bool isEnabled() const { return m_enabled; }
+
+	/**
+	 * Called by generated kernels before beginning the compute pass of a
+	 * dispatch: fill 'timestampWrites' and return true if this pass must be
+	 * timed.
+	 */
+	bool writeTimestamps(
+		const char* kernel,
+		const char* entryPoint,
+		wgpu::ComputePassTimestampWrites& timestampWrites
+	);
+
+	/**
+	 * Called by DispatchTimer.
+	 */
+	void recordDispatch(
+		const char* kernel,
+		const char* entryPoint,
+		uint64_t workgroups,
+		bool indirect,
+		uint64_t cpuEncodeTimeNs
+	);
+
+	/**
+	 * Resolve the timestamps written since the last call and read them back.
+	 * This must be called after submitting the commands that contain the
+	 * timed passes. GPU timings are added to the statistics once read back.
+	 */
+	Result<Void, Error> resolve();
+
+	/**
+	 * Process device events without blocking, so that timings that have been
+	 * read back are added to the statistics.
+	 */
+	void poll();
+
+	/**
+	 * Block until all resolved timings have been read back (not available
+	 * with Emscripten, see ReadbackService).
+	 */
+	Result<Void, Error> waitForResults(uint64_t timeoutNs = ReadbackService::Infinite);
+
+	/**
+	 * Statistics of all entry points dispatched so far, sorted by kernel and
+	 * entry point names.
+	 */
+	std::vector<EntryPointStats> stats() const;
+
+	/**
+	 * Statistics of a single entry point, or an error if it was never
+	 * dispatched.
+	 */
+	Result<EntryPointStats, Error> stats(const std::string& kernel, const std::string& entryPoint) const;
+
+	/**
+	 * Number of passes that were not timed because 'maxTimedPasses' was
+	 * reached.
+	 */
+	uint64_t droppedPassCount() const;
+
+	/**
+	 * Log a line per entry point.
+	 */
+	void logReport() const;
+
+	void reset();
+
+private:
+	struct Core;
+
+	/**
+	 * Turn timestamps read back from the GPU into durations.
+	 */
+	static void onTimestampsRead(
+		const std::shared_ptr<Core>& core,
+		const std::vector<std::pair<std::string, std::string>>& passes,
+		const ReadbackService::Readback& readback
+	);
+
+private:
+	wgpu::raii::Device m_device;
+	wgpu::raii::Queue m_queue;
+	wgpu::raii::QuerySet m_querySet;
+	wgpu::raii::Buffer m_resolveBuffer;
+	uint32_t m_maxTimedPasses;
+	bool m_enabled = true;
+	// Kernel and entry point of the passes timed since the last resolve()
+	std::vector<std::pair<std::string, std::string>> m_timedPasses;
+	ReadbackService m_readbacks;
+	// Shared with readback callbacks, which may outlive the profiler
+	std::shared_ptr<Core> m_core;
+};
@@ -0,0 +1,182 @@
+#pragma once
+
+#include <slang-webgpu/common/result.h>
+
+// NB: raii::Foo is the equivalent of Foo except its release()/addRef() methods
+// are automatically called
+#include <webgpu/webgpu-raii.hpp>
+
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/**
+ * Read GPU buffers back to the CPU without creating a map buffer per read and
+ * without polling the device in a loop.
+ *
+ * Copies into staging buffers are recorded by read(), and flush() submits all
+ * of them at once before mapping the staging buffers. Staging buffers return
+ * to a pool once their content has been copied out, to be reused by the next
+ * reads. Typical usage:
+ *
+ *   ReadbackService readbacks(device);
+ *   ReadbackService::Readback a, b;
+ *   TRY_ASSIGN(a, readbacks.read(bufferA));
+ *   TRY_ASSIGN(b, readbacks.read(bufferB));
+ *   TRY(readbacks.waitAll()); // flushes, then blocks on futures
+ *   std::vector<float> values = a.as<float>();
+ *
+ * With Dawn, wait() and waitAll() block on the mapping futures with
+ * Instance::waitAny(). Timeouts require the instance to be created with
+ * InstanceFeatures::timedWaitAnyEnable, otherwise the device is ticked until
+ * completion or timeout.
+ *
+ * NB: With Emscripten, the browser must regain control for mappings to
+ * complete, so wait() returns an error if the readback is not ready yet. Use
+ * onReady() or poll isReady() from the main loop instead.
+ */
+class ReadbackService {
+public:
+	static constexpr uint64_t Infinite = UINT64_MAX;
+
+	struct Stats {
+		uint64_t readbacks = 0;
+		// Number of command buffers submitted by flush()
+		uint64_t submits = 0;
+		uint64_t stagingBuffersCreated = 0;
+		uint64_t stagingBuffersReused = 0;
+	};
+
+	/**
+	 * The result of a single read, filled in once its mapping completes.
+	 */
+	class Readback {
+	public:
+		using ReadyCallback = std::function<void(const Readback&)>;
+
+	public:
+		Readback() = default;
+
+		/**
+		 * Whether the mapping completed, successfully or not.
+		 */
+		bool isReady() const;
+
+		/**
+		 * Error if the mapping failed, or if it is not ready yet.
+		 */
+		Result<Void, Error> status() const;
+
+		/**
+		 * Content of the buffer range, once ready.
+		 */
+		const std::vector<uint8_t>& data() const;
+
+		template <typename T>
+		std::vector<T> as() const {
+			const std::vector<uint8_t>& bytes = data();
+			std::vector<T> values(bytes.size() / sizeof(T));
+			std::memcpy(values.data(), bytes.data(), values.size() * sizeof(T));
+			return values;
+		}
+
+		/**
+		 * Call 'callback' once ready, or right away if it already is. The
+		 * callback is called from within wait(), poll() or device events.
+		 */
+		void onReady(ReadyCallback callback) const;
+
+		operator bool() const { return (bool)m_state; }
+
+	private:
+		friend class ReadbackService;
+		struct State;
+		std::shared_ptr<State> m_state;
+	};
+
+public:
+	ReadbackService(wgpu::Device device, std::string_view label = "readback");
+	ReadbackService(const ReadbackService&) = delete;
+	ReadbackService& operator=(const ReadbackService&) = delete;
+
+	/**
+	 * Record the copy of a range of 'buffer' (which must have the CopySrc
+	 * usage) into a staging buffer. Offset and size must be multiples of 4.
+	 * Nothing is submitted until flush() (or a wait) is called.
+	 */
+	Result<Readback, Error> read(
+		wgpu::Buffer buffer,
+		uint64_t offset = 0,
+		uint64_t size = WGPU_WHOLE_SIZE
+	);
+
+	/**
+	 * Submit the copies of all reads recorded since the last flush in a
+	 * single command buffer, and start mapping their staging buffers.
+	 */
+	void flush();
+
+	/**
+	 * Block until a readback is ready, for at most 'timeoutNs' nanoseconds,
+	 * flushing first if needed. Returns an error on timeout or if the
+	 * mapping failed.
+	 */
+	Result<Void, Error> wait(const Readback& readback, uint64_t timeoutNs = Infinite);
+
+	/**
+	 * Same as wait() for all readbacks that are not ready yet.
+	 */
+	Result<Void, Error> waitAll(uint64_t timeoutNs = Infinite);
+
+	/**
+	 * Process device events without blocking, so that readbacks that are
+	 * done become ready.
+	 */
+	void poll();
+
+	/**
+	 * Number of readbacks that are not ready yet.
+	 */
+	size_t pendingCount() const;
+
+	Stats stats() const;
+
+	~ReadbackService();
+
+private:
+	struct Core;
+
+	/**
+	 * Take the smallest staging buffer of the pool that is large enough, or
+	 * create one if there is none.
+	 */
+	wgpu::raii::Buffer acquireStagingBuffer(uint64_t size);
+
+	/**
+	 * Start mapping the staging buffer of a flushed readback.
+	 */
+	void startMapping(const Readback& readback);
+
+	/**
+	 * Copy the content of the staging buffer once mapped, give the staging
+	 * buffer back to the pool, and call the ready callbacks.
+	 */
+	static void onMapped(const Readback& readback, bool success, std::string_view errorMessage);
+
+	Result<Void, Error> waitFor(const std::vector<Readback>& readbacks, uint64_t timeoutNs);
+
+private:
+	wgpu::raii::Device m_device;
+	wgpu::raii::Instance m_instance;
+	wgpu::raii::Queue m_queue;
+	std::string m_label;
+	// Encoder that holds the copies recorded since the last flush
+	wgpu::raii::CommandEncoder m_encoder;
+	std::vector<Readback> m_unflushed;
+	// Shared with mapping callbacks, which may outlive the service
+	std::shared_ptr<Core> m_core;
+};
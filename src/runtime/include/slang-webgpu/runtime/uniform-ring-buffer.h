@@ -0,0 +1,83 @@
+#pragma once
+
+#include <slang-webgpu/common/result.h>
+
+// NB: raii::Foo is the equivalent of Foo except its release()/addRef() methods
+// are automatically called
+#include <webgpu/webgpu-raii.hpp>
+
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+/**
+ * A uniform buffer into which the uniforms of many dispatches are packed, to
+ * be used with kernels generated with the DYNAMIC_UNIFORMS option. Each call
+ * to push() returns the offset to give to the dispatch, and flush() uploads
+ * all pushed uniforms at once.
+ *
+ * Since dispatches read their uniforms when they run rather than when they
+ * are recorded, the usual pattern is:
+ *
+ *   uint32_t offsetA = ring.push(uniformsA); // same for B, C, ...
+ *   kernel.dispatchFoo(computePass, size, bindGroup, offsetA); // B, C, ...
+ *   ring.flush(); // a single writeBuffer
+ *   queue.submit(commands); // a single submit
+ *
+ * After flush(), the buffer is filled again from the start. This is safe
+ * because the next flush() is ordered after the submit that uses the current
+ * content on the device queue.
+ */
+class UniformRingBuffer {
+public:
+	/**
+	 * Create a ring of 'capacity' bytes. The alignment of offsets is the
+	 * device's minUniformBufferOffsetAlignment.
+	 */
+	static Result<UniformRingBuffer, Error> create(
+		wgpu::Device device,
+		uint64_t capacity,
+		std::string_view label = "uniforms"
+	);
+
+	UniformRingBuffer() = default;
+
+	/**
+	 * Copy uniforms into the ring and return their offset, to be given to the
+	 * dispatch methods of a generated kernel. Nothing is uploaded until
+	 * flush() is called.
+	 */
+	Result<uint32_t, Error> push(const void* data, uint64_t size);
+
+	template <typename T>
+	Result<uint32_t, Error> push(const T& uniforms) {
+		return push(&uniforms, sizeof(T));
+	}
+
+	/**
+	 * Upload all uniforms pushed since the last flush with a single
+	 * writeBuffer, and start filling the ring from the beginning again.
+	 */
+	void flush();
+
+	/**
+	 * The buffer to give as 'uniforms' to createBindGroup()
+	 */
+	wgpu::Buffer getBuffer() const;
+
+	uint64_t getCapacity() const;
+	uint32_t getAlignment() const;
+
+	/**
+	 * Number of bytes pushed since the last flush.
+	 */
+	uint64_t getPendingSize() const;
+
+private:
+	wgpu::raii::Queue m_queue;
+	wgpu::raii::Buffer m_buffer;
+	uint32_t m_alignment = 256;
+	// CPU-side copy of the part of the buffer written since the last flush
+	std::vector<uint8_t> m_staging;
+	uint64_t m_head = 0;
+};
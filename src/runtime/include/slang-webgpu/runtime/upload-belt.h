@@ -0,0 +1,189 @@
+#pragma once
+
+#include <slang-webgpu/common/result.h>
+
+// NB: raii::Foo is the equivalent of Foo except its release()/addRef() methods
+// are automatically called
+#include <webgpu/webgpu-raii.hpp>
+
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/**
+ * Upload data to GPU buffers by writing it directly into mapped memory, rather
+ * than handing a CPU copy to Queue::writeBuffer().
+ *
+ * Buffers whose content is known at creation are created with
+ * mappedAtCreation, so that no staging memory is involved at all. Uploads into
+ * existing buffers go through a ring of MapWrite|CopySrc staging buffers of
+ * 'chunkSize' bytes each: large uploads are split into chunks, and once all
+ * 'maxChunks' staging buffers are in use, the belt waits for one to be mapped
+ * again, which bounds staging memory.
+ *
+ * Data is produced by a FillFunction that writes a given range of the source
+ * into mapped memory, which lets the source be decoded in place, or streamed
+ * from a memory-mapped file (see uploadFile()).
+ *
+ * Copies are recorded into a command encoder until flush(), which submits them
+ * at once. A buffer must not be used by the GPU before the flush() that
+ * follows its upload.
+ *
+ * NB: With Emscripten, waiting for a staging buffer is not possible, so chunks
+ * that do not fit in the ring fall back to Queue::writeBuffer().
+ */
+class UploadBelt {
+public:
+	/**
+	 * Write bytes [sourceOffset, sourceOffset + size[ of the source into
+	 * 'destination'.
+	 */
+	using FillFunction = std::function<void(uint8_t* destination, uint64_t sourceOffset, uint64_t size)>;
+
+	struct Stats {
+		uint64_t uploads = 0;
+		uint64_t bytes = 0;
+		// Number of copies from staging buffers
+		uint64_t chunks = 0;
+		// Number of command buffers submitted by flush()
+		uint64_t submits = 0;
+		uint64_t stagingBuffersCreated = 0;
+		// Number of times the ring was full and the belt had to wait
+		uint64_t waits = 0;
+		uint64_t buffersMappedAtCreation = 0;
+		// Chunks uploaded with writeBuffer() because the ring was full
+		uint64_t fallbackWrites = 0;
+	};
+
+public:
+	UploadBelt(
+		wgpu::Device device,
+		uint64_t chunkSize = 4 * 1024 * 1024,
+		uint32_t maxChunks = 4,
+		std::string_view label = "upload"
+	);
+	UploadBelt(const UploadBelt&) = delete;
+	UploadBelt& operator=(const UploadBelt&) = delete;
+
+	/**
+	 * Create a buffer of 'size' bytes that is filled while mapped at creation.
+	 * The size of the descriptor is ignored, and rounded up to a multiple of 4
+	 * (padding is filled with zeros).
+	 */
+	Result<wgpu::raii::Buffer, Error> createBuffer(
+		const wgpu::BufferDescriptor& descriptor,
+		uint64_t size,
+		const FillFunction& fill
+	);
+
+	Result<wgpu::raii::Buffer, Error> createBuffer(
+		const wgpu::BufferDescriptor& descriptor,
+		const void* data,
+		uint64_t size
+	);
+
+	/**
+	 * Create a buffer filled with the content of a file, which is memory
+	 * mapped and copied straight into the buffer.
+	 */
+	Result<wgpu::raii::Buffer, Error> createBufferFromFile(
+		const wgpu::BufferDescriptor& descriptor,
+		const std::filesystem::path& path
+	);
+
+	/**
+	 * Upload 'size' bytes into 'destination' (which must have the CopyDst
+	 * usage) at 'destinationOffset', by chunks of at most chunkSize bytes.
+	 * Offset and size must be multiples of 4.
+	 */
+	Result<Void, Error> upload(
+		wgpu::Buffer destination,
+		uint64_t destinationOffset,
+		uint64_t size,
+		const FillFunction& fill
+	);
+
+	Result<Void, Error> upload(
+		wgpu::Buffer destination,
+		uint64_t destinationOffset,
+		const void* data,
+		uint64_t size
+	);
+
+	/**
+	 * Upload the content of a memory-mapped file, chunk by chunk, so that the
+	 * file is never fully copied into RAM.
+	 */
+	Result<Void, Error> uploadFile(
+		wgpu::Buffer destination,
+		uint64_t destinationOffset,
+		const std::filesystem::path& path
+	);
+
+	/**
+	 * Submit the copies recorded since the last flush, and start mapping
+	 * their staging buffers again so that they can be reused.
+	 */
+	void flush();
+
+	/**
+	 * Process device events without blocking, so that staging buffers that
+	 * are mapped again become available.
+	 */
+	void poll();
+
+	uint64_t getChunkSize() const { return m_chunkSize; }
+
+	Stats stats() const;
+
+	~UploadBelt();
+
+private:
+	struct Staging;
+	struct Core;
+	struct PendingStaging;
+
+	/**
+	 * Make sure that the current staging buffer has 'size' bytes left, taking
+	 * another one from the ring if needed. The current staging buffer is null
+	 * after this if the ring is full and waiting is not possible.
+	 */
+	Result<Void, Error> reserve(uint64_t size);
+
+	Result<std::shared_ptr<Staging>, Error> acquireStagingBuffer();
+
+	/**
+	 * Unmap the current staging buffer, whose copies are submitted by the
+	 * next flush().
+	 */
+	void closeCurrent();
+
+	/**
+	 * Start mapping a flushed staging buffer again.
+	 */
+	void startMapping(const std::shared_ptr<Staging>& staging);
+
+	/**
+	 * Mark the staging buffer as free once mapped, or drop it if the mapping
+	 * failed.
+	 */
+	static void onMapped(const PendingStaging& pending, bool success);
+
+private:
+	wgpu::raii::Device m_device;
+	wgpu::raii::Instance m_instance;
+	wgpu::raii::Queue m_queue;
+	std::string m_label;
+	uint64_t m_chunkSize;
+	uint32_t m_maxChunks;
+	wgpu::raii::CommandEncoder m_encoder;
+	std::shared_ptr<Staging> m_current;
+	// Closed since the last flush
+	std::vector<std::shared_ptr<Staging>> m_closed;
+	// Shared with mapping callbacks, which may outlive the belt
+	std::shared_ptr<Core> m_core;
+};
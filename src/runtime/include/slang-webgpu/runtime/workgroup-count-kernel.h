@@ -0,0 +1,90 @@
+#pragma once
+
+#include <slang-webgpu/common/result.h>
+#include <slang-webgpu/runtime/buffer-view.h>
+
+// NB: raii::Foo is the equivalent of Foo except its release()/addRef() methods
+// are automatically called
+#include <webgpu/webgpu-raii.hpp>
+
+#include <cstdint>
+#include <mutex>
+#include <unordered_map>
+
+class DeviceRegistry;
+
+/**
+ * A built-in kernel that turns an element count computed on the GPU (e.g., by
+ * a stream compaction) into the arguments of an indirect dispatch, so that
+ * data-dependent pipelines do not need to read the count back on the CPU.
+ *
+ * Generated kernels use it through their writeDispatchArgs{EntryPoint}()
+ * methods, which provide the workgroup size of the entry point. There is one
+ * per device, see DeviceRegistry::getWorkgroupCountKernel().
+ */
+class WorkgroupCountKernel {
+public:
+	/**
+	 * Create the kernel of the registry's device, sharing its layout.
+	 */
+	explicit WorkgroupCountKernel(DeviceRegistry& registry);
+	WorkgroupCountKernel(const WorkgroupCountKernel&) = delete;
+	WorkgroupCountKernel& operator=(const WorkgroupCountKernel&) = delete;
+
+	/**
+	 * Record a dispatch that reads the u32 element count at the beginning of
+	 * 'elementCount' and writes at the beginning of 'dispatchArgs' the 3 u32
+	 * arguments of an indirect dispatch of ceil(count / workgroupSize) x 1 x 1
+	 * workgroups, clamped to the device's maxComputeWorkgroupsPerDimension.
+	 *
+	 * NB: The dispatch is one-dimensional, so when the count exceeds
+	 * maxComputeWorkgroupsPerDimension * workgroupSize (e.g., 65535 * 64
+	 * elements with default limits), the elements past this cap are NOT
+	 * processed by the indirect dispatch, and no error is reported. Kernels
+	 * that may receive such counts must loop over the elements themselves.
+	 *
+	 * NB: Both views are bound as storage, so their offsets must be aligned
+	 * to the device's minStorageBufferOffsetAlignment, and they must not be
+	 * views of the same buffer.
+	 */
+	Result<Void, Error> dispatch(
+		wgpu::ComputePassEncoder computePass,
+		const BufferView& elementCount,
+		const BufferView& dispatchArgs,
+		uint32_t workgroupSize
+	);
+
+	/**
+	 * Variant of dispatch() that records its own compute pass.
+	 */
+	Result<Void, Error> dispatch(
+		wgpu::CommandEncoder encoder,
+		const BufferView& elementCount,
+		const BufferView& dispatchArgs,
+		uint32_t workgroupSize
+	);
+
+	/**
+	 * In case of trouble loading shader, the kernel might be invalid.
+	 */
+	operator bool() const { return m_valid; }
+
+private:
+	/**
+	 * The workgroup size is a pipeline-overridable constant of the shader, so
+	 * there is one pipeline per workgroup size.
+	 */
+	wgpu::ComputePipeline getPipeline(uint32_t workgroupSize);
+
+private:
+	static const char* s_wgslSource;
+
+	wgpu::Device m_device;
+	bool m_valid = false;
+	uint32_t m_maxWorkgroupCount;
+	wgpu::raii::ShaderModule m_shaderModule;
+	wgpu::raii::BindGroupLayout m_bindGroupLayout;
+	wgpu::raii::PipelineLayout m_pipelineLayout;
+	std::mutex m_mutex;
+	std::unordered_map<uint32_t, wgpu::raii::ComputePipeline> m_pipelines;
+};
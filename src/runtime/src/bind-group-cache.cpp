@@ -0,0 +1,147 @@
+#include <slang-webgpu/runtime/bind-group-cache.h>
+
+#include <algorithm>
+#include <functional>
+
+using namespace wgpu;
+
+namespace {
+
+void hashCombine(size_t& seed, size_t value) {
+	seed ^= value + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+}
+
+} // anonymous namespace
+
+bool BindGroupCache::BufferRange::operator==(const BufferRange& other) const {
+	return binding == other.binding
+		&& buffer == other.buffer
+		&& offset == other.offset
+		&& size == other.size;
+}
+
+bool BindGroupCache::Key::operator==(const Key& other) const {
+	return layout == other.layout && ranges == other.ranges;
+}
+
+size_t BindGroupCache::KeyHash::operator()(const Key& key) const {
+	size_t seed = std::hash<const void*>{}(key.layout);
+	for (const BufferRange& range : key.ranges) {
+		hashCombine(seed, std::hash<uint32_t>{}(range.binding));
+		hashCombine(seed, std::hash<const void*>{}(range.buffer));
+		hashCombine(seed, std::hash<uint64_t>{}(range.offset));
+		hashCombine(seed, std::hash<uint64_t>{}(range.size));
+	}
+	return seed;
+}
+
+BindGroupCache::BindGroupCache(size_t capacity)
+	: m_capacity(capacity)
+{}
+
+BindGroup BindGroupCache::getOrCreate(
+	Device device,
+	BindGroupLayout layout,
+	const std::vector<BindGroupEntry>& entries,
+	std::string_view label
+) {
+	Key key;
+	key.layout = layout;
+	key.ranges.reserve(entries.size());
+	for (const BindGroupEntry& entry : entries) {
+		key.ranges.push_back({ entry.binding, entry.buffer, entry.offset, entry.size });
+	}
+
+	std::lock_guard lock(m_mutex);
+	auto it = m_index.find(key);
+	if (it != m_index.end()) {
+		++m_stats.hits;
+		// Move to front
+		m_nodes.splice(m_nodes.begin(), m_nodes, it->second);
+		BindGroup bindGroup = *it->second->bindGroup;
+		bindGroup.addRef();
+		return bindGroup;
+	}
+	++m_stats.misses;
+
+	BindGroupDescriptor bindGroupDesc = Default;
+	bindGroupDesc.label = StringView(label);
+	bindGroupDesc.layout = layout;
+	bindGroupDesc.entryCount = entries.size();
+	bindGroupDesc.entries = entries.data();
+	BindGroup bindGroup = device.createBindGroup(bindGroupDesc);
+	if (!bindGroup || m_capacity == 0) {
+		return bindGroup;
+	}
+
+	evict(m_capacity - 1);
+	Node node;
+	node.key = key;
+	bindGroup.addRef();
+	node.bindGroup = std::move(bindGroup);
+	for (const BindGroupEntry& entry : entries) {
+		Buffer buffer = entry.buffer;
+		buffer.addRef();
+		node.buffers.push_back(std::move(buffer));
+	}
+	m_nodes.push_front(std::move(node));
+	m_index.emplace(std::move(key), m_nodes.begin());
+	return *m_nodes.front().bindGroup;
+}
+
+void BindGroupCache::invalidate(Buffer buffer) {
+	std::lock_guard lock(m_mutex);
+	for (auto it = m_nodes.begin(); it != m_nodes.end();) {
+		const auto& ranges = it->key.ranges;
+		bool usesBuffer = std::any_of(ranges.begin(), ranges.end(), [&](const BufferRange& range) {
+			return range.buffer == buffer;
+		});
+		if (usesBuffer) {
+			m_index.erase(it->key);
+			it = m_nodes.erase(it);
+		}
+		else {
+			++it;
+		}
+	}
+}
+
+void BindGroupCache::clear() {
+	std::lock_guard lock(m_mutex);
+	m_index.clear();
+	m_nodes.clear();
+}
+
+void BindGroupCache::setCapacity(size_t capacity) {
+	std::lock_guard lock(m_mutex);
+	m_capacity = capacity;
+	evict(capacity);
+}
+
+size_t BindGroupCache::capacity() const {
+	std::lock_guard lock(m_mutex);
+	return m_capacity;
+}
+
+size_t BindGroupCache::size() const {
+	std::lock_guard lock(m_mutex);
+	return m_nodes.size();
+}
+
+BindGroupCache::Stats BindGroupCache::stats() const {
+	std::lock_guard lock(m_mutex);
+	return m_stats;
+}
+
+void BindGroupCache::resetStats() {
+	std::lock_guard lock(m_mutex);
+	m_stats = {};
+}
+
+void BindGroupCache::evict(size_t capacity) {
+	while (m_nodes.size() > capacity) {
+		m_index.erase(m_nodes.back().key);
+		m_nodes.pop_back();
+		++m_stats.evictions;
+	}
+}
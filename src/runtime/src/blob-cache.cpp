@@ -0,0 +1,236 @@
+#include <slang-webgpu/runtime/blob-cache.h>
+
+#include <slang-webgpu/common/io.h>
+#include <slang-webgpu/common/logger.h>
+
+#include <algorithm>
+#include <cstring>
+#include <iomanip>
+#include <sstream>
+#include <string_view>
+
+using namespace wgpu;
+
+namespace {
+
+constexpr char s_magic[4] = { 'S', 'W', 'B', 'C' };
+constexpr uint32_t s_version = 1;
+constexpr const char* s_extension = ".blob";
+
+/**
+ * Header of a blob file, followed by the key then the value.
+ */
+struct BlobHeader {
+	char magic[4];
+	uint32_t version;
+	uint64_t keySize;
+};
+
+/**
+ * 64-bit FNV-1a, which is stable across platforms and runs
+ */
+std::string hashToHex(std::string_view data) {
+	uint64_t hash = 0xcbf29ce484222325ull;
+	for (char c : data) {
+		hash ^= (uint8_t)c;
+		hash *= 0x100000001b3ull;
+	}
+	std::ostringstream out;
+	out << std::hex << std::setw(16) << std::setfill('0') << hash;
+	return out.str();
+}
+
+} // anonymous namespace
+
+BlobCache::BlobCache(const std::filesystem::path& directory, uint64_t maxSize)
+	: m_rootDirectory(directory)
+	, m_directory(directory)
+	, m_maxSize(maxSize)
+{}
+
+void BlobCache::attach([[maybe_unused]] DeviceDescriptor& descriptor, [[maybe_unused]] Adapter adapter) {
+#ifndef __EMSCRIPTEN__
+	{
+		std::lock_guard lock(m_mutex);
+		m_isolationKey = isolationKey(adapter);
+		m_directory = m_rootDirectory / hashToHex(m_isolationKey);
+		scanDirectory();
+	}
+
+	m_cacheDesc = Default;
+	m_cacheDesc.isolationKey = StringView(m_isolationKey);
+	m_cacheDesc.loadDataFunction = [](
+		const void* key,
+		size_t keySize,
+		void* value,
+		size_t valueSize,
+		void* userdata
+	) {
+		return static_cast<BlobCache*>(userdata)->load(key, keySize, value, valueSize);
+	};
+	m_cacheDesc.storeDataFunction = [](
+		const void* key,
+		size_t keySize,
+		const void* value,
+		size_t valueSize,
+		void* userdata
+	) {
+		static_cast<BlobCache*>(userdata)->store(key, keySize, value, valueSize);
+	};
+	m_cacheDesc.functionUserdata = this;
+
+	// Prepend to the chain of the descriptor
+	m_cacheDesc.chain.next = descriptor.nextInChain;
+	descriptor.nextInChain = &m_cacheDesc.chain;
+#endif // __EMSCRIPTEN__
+}
+
+std::string BlobCache::isolationKey(Adapter adapter) {
+	AdapterInfo info;
+	adapter.getInfo(&info);
+	std::ostringstream out;
+	out
+		<< std::string_view(StringView(info.vendor)) << "/"
+		<< std::string_view(StringView(info.architecture)) << "/"
+		<< std::string_view(StringView(info.device)) << "/"
+		// With Dawn, the description holds the version of the driver
+		<< std::string_view(StringView(info.description)) << "/"
+		<< info.vendorID << ":" << info.deviceID << "/"
+		<< (int)info.backendType;
+	info.freeMembers();
+	return out.str();
+}
+
+size_t BlobCache::load(const void* key, size_t keySize, void* value, size_t valueSize) {
+	std::string_view keyView(static_cast<const char*>(key), keySize);
+	std::string name = hashToHex(keyView) + s_extension;
+
+	std::lock_guard lock(m_mutex);
+	auto it = m_entries.find(name);
+	if (it == m_entries.end()) {
+		++m_stats.misses;
+		return 0;
+	}
+
+	if (m_lastLoadedName != name) {
+		auto maybeData = loadBinaryFile(m_directory / name);
+		if (isError(maybeData)) {
+			++m_stats.misses;
+			return 0;
+		}
+		m_lastLoaded = std::move(std::get<0>(maybeData));
+		m_lastLoadedName = name;
+	}
+
+	// Check that the file is a blob of this very key (and not a collision)
+	BlobHeader header;
+	bool valid = m_lastLoaded.size() >= sizeof(BlobHeader);
+	if (valid) {
+		std::memcpy(&header, m_lastLoaded.data(), sizeof(BlobHeader));
+		valid =
+			std::memcmp(header.magic, s_magic, sizeof(s_magic)) == 0
+			&& header.version == s_version
+			&& header.keySize == keySize
+			&& m_lastLoaded.size() >= sizeof(BlobHeader) + keySize
+			&& std::memcmp(m_lastLoaded.data() + sizeof(BlobHeader), key, keySize) == 0;
+	}
+	if (!valid) {
+		++m_stats.misses;
+		return 0;
+	}
+
+	const uint8_t* blob = m_lastLoaded.data() + sizeof(BlobHeader) + keySize;
+	size_t blobSize = m_lastLoaded.size() - sizeof(BlobHeader) - keySize;
+	if (value != nullptr && valueSize >= blobSize) {
+		std::memcpy(value, blob, blobSize);
+		it->second.lastUse = ++m_clock;
+		++m_stats.hits;
+		// Keep track of the use across runs
+		std::error_code err;
+		std::filesystem::last_write_time(m_directory / name, std::filesystem::file_time_type::clock::now(), err);
+		m_lastLoadedName.clear();
+		m_lastLoaded.clear();
+	}
+	return blobSize;
+}
+
+void BlobCache::store(const void* key, size_t keySize, const void* value, size_t valueSize) {
+	std::string_view keyView(static_cast<const char*>(key), keySize);
+	std::string name = hashToHex(keyView) + s_extension;
+
+	BlobHeader header;
+	std::memcpy(header.magic, s_magic, sizeof(s_magic));
+	header.version = s_version;
+	header.keySize = keySize;
+	std::vector<uint8_t> data(sizeof(BlobHeader) + keySize + valueSize);
+	std::memcpy(data.data(), &header, sizeof(BlobHeader));
+	std::memcpy(data.data() + sizeof(BlobHeader), key, keySize);
+	std::memcpy(data.data() + sizeof(BlobHeader) + keySize, value, valueSize);
+
+	std::lock_guard lock(m_mutex);
+	if (data.size() > m_maxSize) return;
+	auto maybeError = saveBinaryFile(m_directory / name, data.data(), data.size());
+	if (isError(maybeError)) {
+		LOG(WARNING) << "Could not store blob in cache: " << std::get<Error>(maybeError).message;
+		return;
+	}
+
+	Entry& entry = m_entries[name];
+	m_stats.size -= entry.size;
+	entry.size = data.size();
+	entry.lastUse = ++m_clock;
+	m_stats.size += entry.size;
+	++m_stats.stores;
+	if (m_lastLoadedName == name) m_lastLoadedName.clear();
+	evict();
+}
+
+BlobCache::Stats BlobCache::stats() const {
+	std::lock_guard lock(m_mutex);
+	return m_stats;
+}
+
+void BlobCache::scanDirectory() {
+	m_entries.clear();
+	m_stats.size = 0;
+
+	std::error_code err;
+	if (!std::filesystem::is_directory(m_directory, err)) return;
+
+	struct File {
+		std::string name;
+		uint64_t size;
+		std::filesystem::file_time_type time;
+	};
+	std::vector<File> files;
+	for (const auto& dirEntry : std::filesystem::directory_iterator(m_directory, err)) {
+		if (!dirEntry.is_regular_file(err)) continue;
+		std::filesystem::path path = dirEntry.path();
+		if (path.extension() != s_extension) continue;
+		files.push_back(File{ path.filename().string(), (uint64_t)dirEntry.file_size(err), dirEntry.last_write_time(err) });
+	}
+
+	// The least recently used files get the lowest clock values
+	std::sort(files.begin(), files.end(), [](const File& a, const File& b) {
+		return a.time < b.time;
+	});
+	for (const File& file : files) {
+		m_entries[file.name] = Entry{ file.size, ++m_clock };
+		m_stats.size += file.size;
+	}
+	evict();
+}
+
+void BlobCache::evict() {
+	while (m_stats.size > m_maxSize && !m_entries.empty()) {
+		auto oldest = std::min_element(m_entries.begin(), m_entries.end(), [](const auto& a, const auto& b) {
+			return a.second.lastUse < b.second.lastUse;
+		});
+		std::error_code err;
+		std::filesystem::remove(m_directory / oldest->first, err);
+		m_stats.size -= oldest->second.size;
+		++m_stats.evictions;
+		if (m_lastLoadedName == oldest->first) m_lastLoadedName.clear();
+		m_entries.erase(oldest);
+	}
+}
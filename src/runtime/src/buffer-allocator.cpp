@@ -0,0 +1,313 @@
+#include <slang-webgpu/runtime/buffer-allocator.h>
+
+#include <slang-webgpu/common/kernel-utils.h>
+
+#include <algorithm>
+#include <map>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+using namespace wgpu;
+
+struct BufferAllocator::Slab {
+	raii::Buffer buffer;
+	uint64_t size = 0;
+	uint64_t usage = 0;
+	// Free ranges of a persistent slab, as offset -> size
+	std::map<uint64_t, uint64_t> freeRanges;
+	// Bump pointer of a transient slab
+	uint64_t cursor = 0;
+	// Created for a single allocation larger than a slab
+	bool dedicated = false;
+};
+
+struct BufferAllocator::Core {
+	std::mutex mutex;
+	// Persistent slabs, per usage
+	std::unordered_map<uint64_t, std::vector<std::shared_ptr<Slab>>> slabs;
+	// Transient slab currently filled, per usage
+	std::unordered_map<uint64_t, std::shared_ptr<Slab>> currentTransient;
+	// Transient slabs used by the current frame
+	std::vector<std::shared_ptr<Slab>> frameSlabs;
+	// Transient slabs of closed frames, that the GPU may still be using
+	std::map<uint64_t, std::vector<std::shared_ptr<Slab>>> retiringSlabs;
+	// Transient slabs ready for reuse, per usage
+	std::unordered_map<uint64_t, std::vector<std::shared_ptr<Slab>>> freeTransient;
+	uint64_t frame = 0;
+	Stats stats;
+};
+
+////////////////////////////////////////////
+// Allocation
+
+struct BufferAllocator::Allocation::Block {
+	std::shared_ptr<Core> core;
+	std::shared_ptr<Slab> slab;
+	uint64_t offset = 0;
+	uint64_t size = 0;
+
+	~Block() {
+		std::lock_guard lock(core->mutex);
+		core->stats.bytesInUse -= size;
+
+		if (slab->dedicated) {
+			std::vector<std::shared_ptr<Slab>>& slabs = core->slabs[slab->usage];
+			auto it = std::find(slabs.begin(), slabs.end(), slab);
+			if (it != slabs.end()) slabs.erase(it);
+			return;
+		}
+
+		// Give the range back, merging it with its free neighbors
+		std::map<uint64_t, uint64_t>& freeRanges = slab->freeRanges;
+		auto it = freeRanges.emplace(offset, size).first;
+		auto next = std::next(it);
+		if (next != freeRanges.end() && it->first + it->second == next->first) {
+			it->second += next->second;
+			freeRanges.erase(next);
+		}
+		if (it != freeRanges.begin()) {
+			auto previous = std::prev(it);
+			if (previous->first + previous->second == it->first) {
+				previous->second += it->second;
+				freeRanges.erase(it);
+			}
+		}
+	}
+};
+
+Buffer BufferAllocator::Allocation::getBuffer() const {
+	return m_block ? *m_block->slab->buffer : Buffer{};
+}
+
+uint64_t BufferAllocator::Allocation::getOffset() const {
+	return m_block ? m_block->offset : 0;
+}
+
+uint64_t BufferAllocator::Allocation::getSize() const {
+	return m_block ? m_block->size : 0;
+}
+
+BufferAllocator::Allocation::operator BufferView() const {
+	return BufferView(getBuffer(), getOffset(), getSize());
+}
+
+////////////////////////////////////////////
+// BufferAllocator
+
+BufferAllocator::BufferAllocator(Device device, uint64_t slabSize, std::string_view label)
+	: m_label(label)
+	, m_slabSize(alignUp(std::max<uint64_t>(slabSize, 4), 4))
+	, m_core(std::make_shared<Core>())
+{
+	SupportedLimits supportedLimits = Default;
+	device.getLimits(&supportedLimits);
+	const Limits& limits = supportedLimits.limits;
+	if (limits.minStorageBufferOffsetAlignment != 0 && limits.minStorageBufferOffsetAlignment != WGPU_LIMIT_U32_UNDEFINED) {
+		m_storageAlignment = limits.minStorageBufferOffsetAlignment;
+	}
+	if (limits.minUniformBufferOffsetAlignment != 0 && limits.minUniformBufferOffsetAlignment != WGPU_LIMIT_U32_UNDEFINED) {
+		m_uniformAlignment = limits.minUniformBufferOffsetAlignment;
+	}
+
+	device.addRef();
+	m_device = std::move(device);
+	m_queue = m_device->getQueue();
+#ifndef __EMSCRIPTEN__
+	raii::Adapter adapter = m_device->getAdapter();
+	m_instance = adapter->getInstance();
+#endif // __EMSCRIPTEN__
+}
+
+uint64_t BufferAllocator::getAlignment(BufferUsage usage) const {
+	uint64_t flags = (uint64_t)(WGPUBufferUsage)usage;
+	uint64_t alignment = 4;
+	if (flags & (uint64_t)BufferUsage::Storage) alignment = std::max(alignment, m_storageAlignment);
+	if (flags & (uint64_t)BufferUsage::Uniform) alignment = std::max(alignment, m_uniformAlignment);
+	return alignment;
+}
+
+Result<BufferAllocator::Allocation, Error> BufferAllocator::allocate(
+	BufferUsage usage,
+	uint64_t size,
+	uint64_t alignment
+) {
+	TRY_ASSERT(size > 0, "Cannot allocate an empty range");
+	TRY_ASSERT((alignment & (alignment - 1)) == 0, "Alignment " << alignment << " is not a power of two");
+	alignment = std::max(alignment, getAlignment(usage));
+	// Copies and storage bindings work on multiples of 4 bytes, uniform
+	// bindings on blocks of 16 bytes.
+	uint64_t flags = (uint64_t)(WGPUBufferUsage)usage;
+	size = alignUp(size, (flags & (uint64_t)BufferUsage::Uniform) ? 16 : 4);
+
+	std::lock_guard lock(m_core->mutex);
+	std::vector<std::shared_ptr<Slab>>& slabs = m_core->slabs[flags];
+
+	std::shared_ptr<Slab> slab;
+	uint64_t offset = 0;
+	if (size > m_slabSize) {
+		TRY_ASSIGN(slab, createSlab(usage, size));
+		slab->dedicated = true;
+		slab->freeRanges.clear();
+		slabs.push_back(slab);
+	}
+	else {
+		// First fit among the free ranges of existing slabs
+		for (const std::shared_ptr<Slab>& candidate : slabs) {
+			if (candidate->dedicated) continue;
+			for (const auto& [rangeOffset, rangeSize] : candidate->freeRanges) {
+				uint64_t alignedOffset = alignUp(rangeOffset, alignment);
+				if (alignedOffset + size <= rangeOffset + rangeSize) {
+					slab = candidate;
+					offset = alignedOffset;
+					break;
+				}
+			}
+			if (slab) break;
+		}
+		if (!slab) {
+			TRY_ASSIGN(slab, createSlab(usage, m_slabSize));
+			slabs.push_back(slab);
+		}
+
+		// Split the free range around the allocation
+		auto it = std::prev(slab->freeRanges.upper_bound(offset));
+		uint64_t rangeOffset = it->first;
+		uint64_t rangeEnd = it->first + it->second;
+		slab->freeRanges.erase(it);
+		if (offset > rangeOffset) slab->freeRanges.emplace(rangeOffset, offset - rangeOffset);
+		if (offset + size < rangeEnd) slab->freeRanges.emplace(offset + size, rangeEnd - offset - size);
+	}
+
+	++m_core->stats.allocations;
+	m_core->stats.bytesInUse += size;
+
+	Allocation allocation;
+	allocation.m_block = std::make_shared<Allocation::Block>();
+	allocation.m_block->core = m_core;
+	allocation.m_block->slab = slab;
+	allocation.m_block->offset = offset;
+	allocation.m_block->size = size;
+	return allocation;
+}
+
+Result<BufferView, Error> BufferAllocator::allocateTransient(
+	BufferUsage usage,
+	uint64_t size,
+	uint64_t alignment
+) {
+	TRY_ASSERT(size > 0, "Cannot allocate an empty range");
+	TRY_ASSERT((alignment & (alignment - 1)) == 0, "Alignment " << alignment << " is not a power of two");
+	alignment = std::max(alignment, getAlignment(usage));
+	uint64_t flags = (uint64_t)(WGPUBufferUsage)usage;
+	size = alignUp(size, (flags & (uint64_t)BufferUsage::Uniform) ? 16 : 4);
+
+	std::lock_guard lock(m_core->mutex);
+	std::shared_ptr<Slab>& current = m_core->currentTransient[flags];
+	if (!current || alignUp(current->cursor, alignment) + size > current->size) {
+		current = nullptr;
+
+		// Reuse a slab of a frame that is done, if one is large enough
+		std::vector<std::shared_ptr<Slab>>& pool = m_core->freeTransient[flags];
+		auto it = std::find_if(pool.begin(), pool.end(), [size](const std::shared_ptr<Slab>& slab) {
+			return slab->size >= size;
+		});
+		if (it != pool.end()) {
+			current = *it;
+			pool.erase(it);
+			++m_core->stats.slabsRecycled;
+		}
+		else {
+			TRY_ASSIGN(current, createSlab(usage, std::max(size, m_slabSize)));
+		}
+		current->cursor = 0;
+		m_core->frameSlabs.push_back(current);
+	}
+
+	uint64_t offset = alignUp(current->cursor, alignment);
+	current->cursor = offset + size;
+	++m_core->stats.transientAllocations;
+	return BufferView(*current->buffer, offset, size);
+}
+
+void BufferAllocator::endFrame() {
+	uint64_t frame;
+	{
+		std::lock_guard lock(m_core->mutex);
+		frame = m_core->frame++;
+		++m_core->stats.frames;
+		m_core->currentTransient.clear();
+		if (m_core->frameSlabs.empty()) return;
+		m_core->retiringSlabs[frame] = std::move(m_core->frameSlabs);
+		m_core->frameSlabs.clear();
+	}
+
+	// The callback owns a reference to the core
+	auto userdata = new std::pair<std::shared_ptr<Core>, uint64_t>(m_core, frame);
+	using Userdata = std::pair<std::shared_ptr<Core>, uint64_t>;
+#ifdef __EMSCRIPTEN__
+	wgpuQueueOnSubmittedWorkDone(
+		*m_queue,
+		[](WGPUQueueWorkDoneStatus, void* userdata) {
+			std::unique_ptr<Userdata> pending((Userdata*)userdata);
+			onFrameDone(pending->first, pending->second);
+		},
+		userdata
+	);
+#else // __EMSCRIPTEN__
+	WGPUQueueWorkDoneCallbackInfo2 callbackInfo = {};
+	// Callbacks fire within processEvents(), i.e., within poll(), or when the
+	// application processes device events.
+	callbackInfo.mode = WGPUCallbackMode_AllowProcessEvents;
+	callbackInfo.callback = [](
+		WGPUQueueWorkDoneStatus,
+		void* userdata1,
+		[[maybe_unused]] void* userdata2
+	) {
+		std::unique_ptr<Userdata> pending((Userdata*)userdata1);
+		onFrameDone(pending->first, pending->second);
+	};
+	callbackInfo.userdata1 = userdata;
+	wgpuQueueOnSubmittedWorkDone2(*m_queue, callbackInfo);
+#endif // __EMSCRIPTEN__
+}
+
+void BufferAllocator::onFrameDone(const std::shared_ptr<Core>& core, uint64_t frame) {
+	std::lock_guard lock(core->mutex);
+	auto it = core->retiringSlabs.find(frame);
+	if (it == core->retiringSlabs.end()) return;
+	// Slabs are recycled even if the device was lost, as they are not used
+	// anymore either way.
+	for (const std::shared_ptr<Slab>& slab : it->second) {
+		slab->cursor = 0;
+		core->freeTransient[slab->usage].push_back(slab);
+	}
+	core->retiringSlabs.erase(it);
+}
+
+void BufferAllocator::poll() {
+#ifndef __EMSCRIPTEN__
+	m_device->tick();
+	m_instance->processEvents();
+#endif // __EMSCRIPTEN__
+}
+
+BufferAllocator::Stats BufferAllocator::stats() const {
+	std::lock_guard lock(m_core->mutex);
+	return m_core->stats;
+}
+
+Result<std::shared_ptr<BufferAllocator::Slab>, Error> BufferAllocator::createSlab(BufferUsage usage, uint64_t size) {
+	BufferDescriptor bufferDesc = Default;
+	bufferDesc.label = StringView(m_label);
+	bufferDesc.size = size;
+	bufferDesc.usage = usage;
+	auto slab = std::make_shared<Slab>();
+	slab->buffer = m_device->createBuffer(bufferDesc);
+	TRY_ASSERT(*slab->buffer, "Could not create a slab of " << size << " bytes");
+	slab->size = size;
+	slab->usage = (uint64_t)(WGPUBufferUsage)usage;
+	slab->freeRanges.emplace(0, size);
+	++m_core->stats.slabsCreated;
+	return slab;
+}
@@ -0,0 +1,68 @@
+#include <slang-webgpu/runtime/buffer-view.h>
+#include <slang-webgpu/runtime/device-registry.h>
+
+#include <slang-webgpu/common/kernel-utils.h>
+
+using namespace wgpu;
+
+Result<BindGroupEntry, Error> makeBufferBindGroupEntry(
+	Device device,
+	const KernelBindingInfo& binding,
+	const BufferView& view
+) {
+	TRY_ASSERT(view.buffer, "No buffer given for binding '" << binding.name << "'");
+	std::shared_ptr<DeviceRegistry> registry = DeviceRegistry::get(device);
+	const Limits& limits = registry->getLimits();
+	bool isUniform = binding.type == KernelBindingType::Uniform;
+
+	uint64_t alignment = isUniform
+		? limits.minUniformBufferOffsetAlignment
+		: limits.minStorageBufferOffsetAlignment;
+	TRY_ASSERT(
+		alignment == 0 || alignment == WGPU_LIMIT_U32_UNDEFINED || view.offset % alignment == 0,
+		"Offset " << view.offset << " of binding '" << binding.name << "' is not a multiple of the device's "
+		<< (isUniform ? "minUniformBufferOffsetAlignment" : "minStorageBufferOffsetAlignment") << " (" << alignment << ")"
+	);
+
+	uint64_t bufferSize = view.buffer.getSize();
+	TRY_ASSERT(
+		view.offset <= bufferSize,
+		"Offset " << view.offset << " of binding '" << binding.name << "' is past the end of its buffer (" << bufferSize << " bytes)"
+	);
+
+	uint64_t size = view.size;
+	if (size == WGPU_WHOLE_SIZE) {
+		// With a dynamic offset, the bound range only covers the uniforms of a
+		// single dispatch (see UniformRingBuffer)
+		size = binding.hasDynamicOffset
+			? alignUp(binding.minBindingSize, 16)
+			: bufferSize - view.offset;
+	}
+	TRY_ASSERT(
+		size <= bufferSize - view.offset,
+		"Range [" << view.offset << ", " << view.offset + size << ") of binding '" << binding.name << "' exceeds the size of its buffer (" << bufferSize << " bytes)"
+	);
+	TRY_ASSERT(
+		size >= binding.minBindingSize,
+		"Binding '" << binding.name << "' requires at least " << binding.minBindingSize << " bytes, but its range has " << size
+	);
+	TRY_ASSERT(
+		isUniform || size % 4 == 0,
+		"Size " << size << " of storage binding '" << binding.name << "' is not a multiple of 4"
+	);
+	uint64_t maxSize = isUniform
+		? limits.maxUniformBufferBindingSize
+		: limits.maxStorageBufferBindingSize;
+	TRY_ASSERT(
+		maxSize == 0 || maxSize == WGPU_LIMIT_U64_UNDEFINED || size <= maxSize,
+		"Size " << size << " of binding '" << binding.name << "' exceeds the device's "
+		<< (isUniform ? "maxUniformBufferBindingSize" : "maxStorageBufferBindingSize") << " (" << maxSize << ")"
+	);
+
+	BindGroupEntry entry = Default;
+	entry.binding = binding.binding;
+	entry.buffer = view.buffer;
+	entry.offset = view.offset;
+	entry.size = size;
+	return entry;
+}
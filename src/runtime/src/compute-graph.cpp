@@ -0,0 +1,322 @@
+#include <slang-webgpu/runtime/compute-graph.h>
+#include <slang-webgpu/runtime/dynamic-kernel.h>
+#include <slang-webgpu/runtime/buffer-view.h>
+
+#include <slang-webgpu/common/variant-utils.h>
+
+#include <algorithm>
+#include <limits>
+#include <unordered_map>
+#include <variant>
+
+using namespace wgpu;
+
+namespace {
+
+constexpr uint32_t s_unused = std::numeric_limits<uint32_t>::max();
+
+/**
+ * Storage bindings are read-write, other ones are read-only
+ */
+bool isWritable(const KernelBindingInfo& binding) {
+	return binding.type == KernelBindingType::Storage;
+}
+
+} // anonymous namespace
+
+ComputeGraph::ComputeGraph(Device device, std::string_view label)
+	: m_device(device)
+	, m_label(label)
+{}
+
+ComputeGraph::BufferHandle ComputeGraph::importBuffer(Buffer buffer) {
+	BufferEntry entry;
+	entry.transient = false;
+	entry.size = buffer.getSize();
+	entry.usage = BufferUsage::None;
+	entry.buffer = buffer;
+	entry.firstWave = s_unused;
+	entry.lastWave = 0;
+	m_buffers.push_back(entry);
+	m_compiled = false;
+	return (BufferHandle)(m_buffers.size() - 1);
+}
+
+ComputeGraph::BufferHandle ComputeGraph::createTransientBuffer(uint64_t size, std::string_view label) {
+	BufferEntry entry;
+	entry.label = label;
+	entry.transient = true;
+	// Storage bindings must be a multiple of 4 bytes
+	entry.size = alignUp(size, 4);
+	entry.usage = BufferUsage::None;
+	entry.buffer = nullptr;
+	entry.firstWave = s_unused;
+	entry.lastWave = 0;
+	m_buffers.push_back(entry);
+	m_compiled = false;
+	return (BufferHandle)(m_buffers.size() - 1);
+}
+
+Result<Void, Error> ComputeGraph::addNode(
+	std::string_view label,
+	DynamicKernel& kernel,
+	std::string_view entryPoint,
+	DispatchSize dispatchSize,
+	const std::vector<BufferHandle>& buffers
+) {
+	Node node;
+	node.label = label;
+	TRY_ASSIGN(node.pipeline, kernel.getPipeline(entryPoint));
+	node.bindGroupLayout = kernel.getBindGroupLayout();
+	node.bindings = kernel.getBindings();
+	TRY_ASSIGN(node.workgroupSize, kernel.getWorkgroupSize(entryPoint));
+	node.dispatchSize = dispatchSize;
+	node.buffers = buffers;
+	return addNode(std::move(node));
+}
+
+Result<Void, Error> ComputeGraph::addNode(Node node) {
+	TRY_ASSERT(node.pipeline, "Node '" << node.label << "' has no pipeline");
+	TRY_ASSERT(
+		node.buffers.size() == node.bindings.size(),
+		"Node '" << node.label << "' expects " << node.bindings.size() << " buffer(s), but " << node.buffers.size() << " were given"
+	);
+
+	for (size_t i = 0; i < node.buffers.size(); ++i) {
+		BufferHandle handle = node.buffers[i];
+		const KernelBindingInfo& binding = node.bindings[i];
+		TRY_ASSERT(handle < m_buffers.size(), "Invalid buffer handle given to binding '" << binding.name << "' of node '" << node.label << "'");
+
+		// WebGPU does not allow a buffer to be both writable and bound
+		// elsewhere within the same dispatch.
+		for (size_t j = 0; j < node.buffers.size(); ++j) {
+			TRY_ASSERT(
+				j == i || node.buffers[j] != handle || !isWritable(binding),
+				"Buffer of writable binding '" << binding.name << "' of node '" << node.label << "' is also bound to '" << node.bindings[j].name << "'"
+			);
+		}
+	}
+
+	for (size_t i = 0; i < node.buffers.size(); ++i) {
+		BufferEntry& entry = m_buffers[node.buffers[i]];
+		entry.usage = entry.usage | (
+			node.bindings[i].type == KernelBindingType::Uniform
+			? BufferUsage::Uniform
+			: BufferUsage::Storage
+		);
+	}
+
+	m_nodes.push_back(std::move(node));
+	m_compiled = false;
+	return {};
+}
+
+Result<Void, Error> ComputeGraph::compile() {
+	m_schedule.clear();
+	m_allocations.clear();
+	m_stats = {};
+	for (BufferEntry& entry : m_buffers) {
+		entry.firstWave = s_unused;
+		entry.lastWave = 0;
+		if (entry.transient) entry.buffer = nullptr;
+	}
+
+	TRY(scheduleNodes());
+	TRY(allocateTransientBuffers());
+	TRY(createBindGroups());
+
+	m_stats.nodes = (uint32_t)m_nodes.size();
+	m_compiled = true;
+	return {};
+}
+
+Result<Void, Error> ComputeGraph::scheduleNodes() {
+	// Wave of the last node that wrote/read each buffer, +1 (0 means none)
+	std::vector<uint32_t> writtenBefore(m_buffers.size(), 0);
+	std::vector<uint32_t> readBefore(m_buffers.size(), 0);
+
+	for (uint32_t nodeIndex = 0; nodeIndex < m_nodes.size(); ++nodeIndex) {
+		const Node& node = m_nodes[nodeIndex];
+
+		// A node comes after the last writer of all the buffers it accesses,
+		// and after the last readers of the buffers it writes.
+		uint32_t wave = 0;
+		for (size_t i = 0; i < node.buffers.size(); ++i) {
+			BufferHandle handle = node.buffers[i];
+			wave = std::max(wave, writtenBefore[handle]);
+			if (isWritable(node.bindings[i])) {
+				wave = std::max(wave, readBefore[handle]);
+			}
+		}
+
+		for (size_t i = 0; i < node.buffers.size(); ++i) {
+			BufferHandle handle = node.buffers[i];
+			BufferEntry& entry = m_buffers[handle];
+			TRY_ASSERT(
+				!entry.transient || isWritable(node.bindings[i]) || writtenBefore[handle] > 0,
+				"Transient buffer '" << entry.label << "' is read by node '" << node.label << "' before being written"
+			);
+			if (isWritable(node.bindings[i])) {
+				writtenBefore[handle] = wave + 1;
+			}
+			else {
+				readBefore[handle] = std::max(readBefore[handle], wave + 1);
+			}
+			entry.firstWave = std::min(entry.firstWave, wave);
+			entry.lastWave = std::max(entry.lastWave, wave);
+		}
+
+		CompiledNode compiled;
+		compiled.node = nodeIndex;
+		compiled.wave = wave;
+		compiled.workgroupCount = std::visit(overloaded{
+			[](WorkgroupCount count) { return count; },
+			[&](ThreadCount threadCount) { return WorkgroupCount{
+				divideAndCeil(threadCount.x, node.workgroupSize.x),
+				divideAndCeil(threadCount.y, node.workgroupSize.y),
+				divideAndCeil(threadCount.z, node.workgroupSize.z)
+			}; }
+		}, node.dispatchSize);
+		for (const KernelBindingInfo& binding : node.bindings) {
+			if (binding.hasDynamicOffset) compiled.dynamicOffsets.push_back(0);
+		}
+		m_schedule.push_back(std::move(compiled));
+		m_stats.waves = std::max(m_stats.waves, wave + 1);
+	}
+
+	// Within a wave, nodes that use the same pipeline are recorded next to
+	// each other so that the recorder does not set it again.
+	std::unordered_map<WGPUComputePipeline, uint32_t> pipelineRank;
+	for (const CompiledNode& compiled : m_schedule) {
+		pipelineRank.emplace(m_nodes[compiled.node].pipeline, (uint32_t)pipelineRank.size());
+	}
+	std::stable_sort(m_schedule.begin(), m_schedule.end(), [&](const CompiledNode& a, const CompiledNode& b) {
+		if (a.wave != b.wave) return a.wave < b.wave;
+		return pipelineRank.at(m_nodes[a.node].pipeline) < pipelineRank.at(m_nodes[b.node].pipeline);
+	});
+	return {};
+}
+
+Result<Void, Error> ComputeGraph::allocateTransientBuffers() {
+	struct Allocation {
+		uint64_t size;
+		BufferUsage usage;
+		uint32_t lastWave;
+		std::vector<BufferHandle> handles;
+	};
+	std::vector<Allocation> allocations;
+
+	std::vector<BufferHandle> transients;
+	for (BufferHandle handle = 0; handle < m_buffers.size(); ++handle) {
+		const BufferEntry& entry = m_buffers[handle];
+		if (entry.transient && entry.firstWave != s_unused) {
+			transients.push_back(handle);
+			m_stats.transientBytes += entry.size;
+		}
+	}
+	m_stats.transientBuffers = (uint32_t)transients.size();
+
+	// Greedy interval allocation: buffers are assigned in order of first use
+	// to an allocation that is no longer used by then, preferably the
+	// smallest one that is large enough, otherwise the largest one, which is
+	// then grown.
+	std::stable_sort(transients.begin(), transients.end(), [&](BufferHandle a, BufferHandle b) {
+		return m_buffers[a].firstWave < m_buffers[b].firstWave;
+	});
+	for (BufferHandle handle : transients) {
+		const BufferEntry& entry = m_buffers[handle];
+		Allocation* best = nullptr;
+		for (Allocation& allocation : allocations) {
+			if (allocation.lastWave >= entry.firstWave) continue;
+			if (best == nullptr) {
+				best = &allocation;
+				continue;
+			}
+			bool fits = allocation.size >= entry.size;
+			bool bestFits = best->size >= entry.size;
+			if (fits && !bestFits) {
+				best = &allocation;
+			}
+			else if (fits && bestFits && allocation.size < best->size) {
+				best = &allocation;
+			}
+			else if (!fits && !bestFits && allocation.size > best->size) {
+				best = &allocation;
+			}
+		}
+		if (best == nullptr) {
+			allocations.push_back(Allocation{ 0, BufferUsage::None, 0, {} });
+			best = &allocations.back();
+		}
+		best->size = std::max(best->size, entry.size);
+		best->usage = best->usage | entry.usage;
+		best->lastWave = entry.lastWave;
+		best->handles.push_back(handle);
+	}
+
+	for (const Allocation& allocation : allocations) {
+		std::string label = m_label + "::transient" + std::to_string(m_allocations.size());
+		BufferDescriptor bufferDesc = Default;
+		bufferDesc.label = StringView(label);
+		bufferDesc.size = allocation.size;
+		bufferDesc.usage = allocation.usage | BufferUsage::CopySrc | BufferUsage::CopyDst;
+		raii::Buffer buffer = m_device.createBuffer(bufferDesc);
+		TRY_ASSERT(*buffer, "Could not allocate transient buffer '" << label << "' (" << allocation.size << " bytes)");
+		for (BufferHandle handle : allocation.handles) {
+			m_buffers[handle].buffer = *buffer;
+		}
+		m_stats.allocatedBytes += allocation.size;
+		m_allocations.push_back(std::move(buffer));
+	}
+	m_stats.allocatedBuffers = (uint32_t)m_allocations.size();
+	return {};
+}
+
+Result<Void, Error> ComputeGraph::createBindGroups() {
+	for (CompiledNode& compiled : m_schedule) {
+		const Node& node = m_nodes[compiled.node];
+		std::vector<BindGroupEntry> entries(node.bindings.size(), Default);
+		for (size_t i = 0; i < node.bindings.size(); ++i) {
+			const BufferEntry& entry = m_buffers[node.buffers[i]];
+			// A transient buffer only covers the beginning of its allocation
+			BufferView view = entry.transient
+				? BufferView(entry.buffer, 0, entry.size)
+				: BufferView(entry.buffer);
+			TRY_ASSIGN(entries[i], makeBufferBindGroupEntry(m_device, node.bindings[i], view));
+		}
+
+		BindGroupDescriptor bindGroupDesc = Default;
+		bindGroupDesc.label = StringView(node.label);
+		bindGroupDesc.layout = node.bindGroupLayout;
+		bindGroupDesc.entryCount = entries.size();
+		bindGroupDesc.entries = entries.data();
+		compiled.bindGroup = m_device.createBindGroup(bindGroupDesc);
+		TRY_ASSERT(*compiled.bindGroup, "Could not create bind group of node '" << node.label << "'");
+	}
+	return {};
+}
+
+Result<Void, Error> ComputeGraph::record(DispatchRecorder& recorder) {
+	if (!m_compiled) {
+		TRY(compile());
+	}
+	for (const CompiledNode& compiled : m_schedule) {
+		const WorkgroupCount& count = compiled.workgroupCount;
+		recorder.setPipeline(m_nodes[compiled.node].pipeline);
+		recorder.setBindGroup(0, *compiled.bindGroup, (uint32_t)compiled.dynamicOffsets.size(), compiled.dynamicOffsets.data());
+		recorder.dispatchWorkgroups(count.x, count.y, count.z);
+	}
+	return {};
+}
+
+Result<Void, Error> ComputeGraph::execute() {
+	DispatchRecorder recorder(m_device, m_label);
+	TRY(record(recorder));
+	recorder.submit();
+	return {};
+}
+
+Buffer ComputeGraph::getBuffer(BufferHandle handle) const {
+	if (handle >= m_buffers.size()) return nullptr;
+	return m_buffers[handle].buffer;
+}
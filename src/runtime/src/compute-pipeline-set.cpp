@@ -0,0 +1,334 @@
+#include <slang-webgpu/runtime/compute-pipeline-set.h>
+
+#include <algorithm>
+#include <cstring>
+#include <mutex>
+#include <thread>
+
+using namespace wgpu;
+
+struct ComputePipelineSet::State {
+	std::mutex mutex;
+	std::string label;
+	std::vector<std::string> entryPoints;
+	std::vector<std::string> labels;
+	// Only kept until all pipelines have been requested
+	raii::ShaderModule shaderModule;
+	raii::PipelineLayout layout;
+	std::vector<raii::ComputePipeline> pipelines;
+	// Whether the creation of each pipeline has started
+	std::vector<bool> requested;
+	size_t requestedCount = 0;
+	// Whether the creation of each pipeline is over, successfully or not
+	std::vector<bool> created;
+	// Number of pipelines that were requested but are not created yet
+	size_t pendingCount = 0;
+	// First error encountered, if any
+	std::string error;
+	std::vector<ReadyCallback> readyCallbacks;
+#ifndef __EMSCRIPTEN__
+	raii::Instance instance;
+	// Futures of the pipelines created asynchronously, for waitFor()
+	std::vector<WGPUFuture> futures;
+#endif // __EMSCRIPTEN__
+};
+
+/**
+ * Userdata of the WebGPU callback of createComputePipelineAsync()
+ */
+struct ComputePipelineSet::PendingPipeline {
+	std::shared_ptr<State> state;
+	uint32_t entryPointIndex;
+};
+
+ComputePipelineSet::ComputePipelineSet(
+	Device device,
+	ShaderModule shaderModule,
+	PipelineLayout layout,
+	const std::vector<std::string>& entryPoints,
+	std::string_view label,
+	PipelineCreation creation
+)
+	: m_device(device)
+	, m_creation(creation)
+	, m_state(std::make_shared<State>())
+{
+	size_t count = entryPoints.size();
+	m_state->label = label;
+	m_state->entryPoints = entryPoints;
+	m_state->pipelines.resize(count);
+	m_state->requested.resize(count, false);
+	m_state->created.resize(count, false);
+#ifndef __EMSCRIPTEN__
+	m_state->futures.resize(count, WGPUFuture{});
+	raii::Adapter adapter = m_device.getAdapter();
+	m_state->instance = adapter->getInstance();
+#endif // __EMSCRIPTEN__
+	for (const std::string& entryPoint : entryPoints) {
+		m_state->labels.push_back(std::string(label) + "::" + entryPoint);
+	}
+
+	// The state holds its own reference to the module and layout
+	shaderModule.addRef();
+	m_state->shaderModule = std::move(shaderModule);
+	layout.addRef();
+	m_state->layout = std::move(layout);
+
+	if (creation == PipelineCreation::Lazy) return;
+	for (uint32_t i = 0; i < count; ++i) {
+		request(i, creation);
+	}
+}
+
+void ComputePipelineSet::request(uint32_t entryPointIndex, PipelineCreation creation) const {
+	raii::ShaderModule shaderModule;
+	raii::PipelineLayout layout;
+	{
+		std::lock_guard lock(m_state->mutex);
+		if (m_state->requested[entryPointIndex]) return;
+		m_state->requested[entryPointIndex] = true;
+		++m_state->pendingCount;
+		shaderModule = m_state->shaderModule;
+		layout = m_state->layout;
+		// The module and layout are no longer needed by the set once all
+		// pipelines have been requested
+		if (++m_state->requestedCount == m_state->pipelines.size()) {
+			m_state->shaderModule = {};
+			m_state->layout = {};
+		}
+	}
+
+	ComputePipelineDescriptor pipelineDesc = Default;
+	pipelineDesc.label = StringView(m_state->labels[entryPointIndex]);
+	pipelineDesc.compute.module = *shaderModule;
+	pipelineDesc.compute.entryPoint = StringView(m_state->entryPoints[entryPointIndex]);
+	pipelineDesc.layout = *layout;
+
+	if (creation != PipelineCreation::Async) {
+		ComputePipeline pipeline = m_device.createComputePipeline(pipelineDesc);
+		onPipelineCreated(m_state, entryPointIndex, pipeline, std::string_view());
+		return;
+	}
+
+	// The callback owns the userdata, and the reference to the pipeline
+	auto pending = new PendingPipeline{ m_state, entryPointIndex };
+#ifdef __EMSCRIPTEN__
+	wgpuDeviceCreateComputePipelineAsync(
+		m_device,
+		&pipelineDesc,
+		[](
+			WGPUCreatePipelineAsyncStatus status,
+			WGPUComputePipeline pipeline,
+			const char* message,
+			void* userdata
+		) {
+			std::unique_ptr<PendingPipeline> pending((PendingPipeline*)userdata);
+			bool success = status == WGPUCreatePipelineAsyncStatus_Success;
+			onPipelineCreated(
+				pending->state,
+				pending->entryPointIndex,
+				success ? pipeline : nullptr,
+				success ? std::string_view() : std::string_view(message ? message : "unknown error")
+			);
+		},
+		pending
+	);
+#else // __EMSCRIPTEN__
+	WGPUCreateComputePipelineAsyncCallbackInfo2 callbackInfo = {};
+	// Callbacks fire from Dawn's worker threads as soon as pipelines are
+	// ready, so that isReady() does not depend on device events.
+	callbackInfo.mode = WGPUCallbackMode_AllowSpontaneous;
+	callbackInfo.callback = [](
+		WGPUCreatePipelineAsyncStatus status,
+		WGPUComputePipeline pipeline,
+		WGPUStringView message,
+		void* userdata1,
+		[[maybe_unused]] void* userdata2
+	) {
+		std::unique_ptr<PendingPipeline> pending((PendingPipeline*)userdata1);
+		bool success = status == WGPUCreatePipelineAsyncStatus_Success;
+		onPipelineCreated(
+			pending->state,
+			pending->entryPointIndex,
+			success ? pipeline : nullptr,
+			success || message.data == nullptr ? std::string_view() : std::string_view(message.data, message.length == WGPU_STRLEN ? std::strlen(message.data) : message.length)
+		);
+	};
+	callbackInfo.userdata1 = pending;
+	WGPUFuture future = wgpuDeviceCreateComputePipelineAsync2(m_device, &pipelineDesc, callbackInfo);
+	{
+		std::lock_guard lock(m_state->mutex);
+		m_state->futures[entryPointIndex] = future;
+	}
+#endif // __EMSCRIPTEN__
+}
+
+void ComputePipelineSet::onPipelineCreated(
+	const std::shared_ptr<State>& state,
+	uint32_t entryPointIndex,
+	ComputePipeline pipeline,
+	std::string_view errorMessage
+) {
+	std::vector<ReadyCallback> callbacks;
+	Result<Void, Error> result;
+	{
+		std::lock_guard lock(state->mutex);
+		// The set takes ownership of the pipeline
+		state->pipelines[entryPointIndex] = raii::ComputePipeline(std::move(pipeline));
+		state->created[entryPointIndex] = true;
+		--state->pendingCount;
+		if (!state->pipelines[entryPointIndex] && state->error.empty()) {
+			state->error = "Could not create pipeline '" + state->labels[entryPointIndex] + "'";
+			if (!errorMessage.empty()) state->error += ": " + std::string(errorMessage);
+		}
+		if (state->pendingCount > 0) return;
+		callbacks = std::move(state->readyCallbacks);
+		if (!state->error.empty()) result = Error{ state->error };
+	}
+	for (const ReadyCallback& callback : callbacks) {
+		callback(result);
+	}
+}
+
+bool ComputePipelineSet::isReady() const {
+	if (!m_state) return false;
+	std::lock_guard lock(m_state->mutex);
+	return m_state->pendingCount == 0;
+}
+
+Result<Void, Error> ComputePipelineSet::waitUntilReady() const {
+	if (!m_state) return Error{ "Pipeline set was not initialized" };
+	TRY(waitFor([this]() { return m_state->pendingCount == 0; }));
+	std::lock_guard lock(m_state->mutex);
+	if (!m_state->error.empty()) return Error{ m_state->error };
+	return {};
+}
+
+void ComputePipelineSet::onReady(ReadyCallback callback) const {
+	Result<Void, Error> result;
+	{
+		std::lock_guard lock(m_state->mutex);
+		if (m_state->pendingCount > 0) {
+			m_state->readyCallbacks.push_back(std::move(callback));
+			return;
+		}
+		if (!m_state->error.empty()) result = Error{ m_state->error };
+	}
+	callback(result);
+}
+
+Result<ComputePipeline, Error> ComputePipelineSet::get(uint32_t entryPointIndex) const {
+	TRY_ASSERT(m_state && entryPointIndex < m_state->pipelines.size(), "Invalid entry point index " << entryPointIndex);
+
+	// Immediate pipelines never change after construction
+	if (m_creation == PipelineCreation::Immediate) {
+		return *m_state->pipelines[entryPointIndex];
+	}
+
+	// Lazy pipelines are created on first use (this does nothing otherwise)
+	request(entryPointIndex, PipelineCreation::Immediate);
+
+	TRY(waitFor([&]() { return (bool)m_state->created[entryPointIndex]; }));
+	std::lock_guard lock(m_state->mutex);
+	TRY_ASSERT(*m_state->pipelines[entryPointIndex], "Could not create pipeline '" << m_state->labels[entryPointIndex] << "'");
+	return *m_state->pipelines[entryPointIndex];
+}
+
+Result<Void, Error> ComputePipelineSet::prewarm(
+	const std::vector<uint32_t>& entryPointIndices,
+	PipelineCreation creation
+) const {
+	TRY_ASSERT(m_state, "Pipeline set was not initialized");
+	TRY_ASSERT(creation != PipelineCreation::Lazy, "Pipelines cannot be prewarmed lazily");
+	for (uint32_t entryPointIndex : entryPointIndices) {
+		TRY_ASSERT(entryPointIndex < m_state->pipelines.size(), "Invalid entry point index " << entryPointIndex);
+	}
+	for (uint32_t entryPointIndex : entryPointIndices) {
+		request(entryPointIndex, creation);
+	}
+	return {};
+}
+
+Result<Void, Error> ComputePipelineSet::prewarm(
+	const std::vector<std::string>& entryPointNames,
+	PipelineCreation creation
+) const {
+	TRY_ASSERT(m_state, "Pipeline set was not initialized");
+	const std::vector<std::string>& entryPoints = m_state->entryPoints;
+	std::vector<uint32_t> entryPointIndices;
+	for (const std::string& name : entryPointNames) {
+		auto it = std::find(entryPoints.begin(), entryPoints.end(), name);
+		if (it == entryPoints.end()) {
+			return Error{ "No entry point '" + name + "' in kernel '" + m_state->label + "'" };
+		}
+		entryPointIndices.push_back(static_cast<uint32_t>(it - entryPoints.begin()));
+	}
+	return prewarm(entryPointIndices, creation);
+}
+
+bool ComputePipelineSet::isRequested(uint32_t entryPointIndex) const {
+	if (!m_state || entryPointIndex >= m_state->pipelines.size()) return false;
+	std::lock_guard lock(m_state->mutex);
+	return m_state->requested[entryPointIndex];
+}
+
+size_t ComputePipelineSet::size() const {
+	return m_state ? m_state->pipelines.size() : 0;
+}
+
+ComputePipelineSet ComputePipelineSet::share(PipelineCreation creation) const {
+	ComputePipelineSet pipelines = *this;
+	pipelines.m_creation = creation;
+	if (!m_state || creation == PipelineCreation::Lazy) return pipelines;
+
+	for (uint32_t i = 0; i < m_state->pipelines.size(); ++i) {
+		request(i, creation);
+	}
+	if (creation == PipelineCreation::Immediate) {
+		// Errors are reported when getting the pipelines
+		[[maybe_unused]] auto maybeError = pipelines.waitUntilReady();
+		// With Emscripten, pipelines created asynchronously by another kernel
+		// cannot be waited for, so get() must check them.
+		if (!pipelines.isReady()) pipelines.m_creation = PipelineCreation::Async;
+	}
+	return pipelines;
+}
+
+Result<Void, Error> ComputePipelineSet::waitFor(std::function<bool()> isDone) const {
+	while (true) {
+#ifndef __EMSCRIPTEN__
+		std::vector<FutureWaitInfo> waitInfos;
+#endif // __EMSCRIPTEN__
+		{
+			std::lock_guard lock(m_state->mutex);
+			if (isDone()) return {};
+#ifndef __EMSCRIPTEN__
+			for (size_t i = 0; i < m_state->pipelines.size(); ++i) {
+				// The future of a pipeline whose creation just started may
+				// not be recorded yet, in which case it is polled below.
+				if (!m_state->requested[i] || m_state->created[i] || m_state->futures[i].id == 0) continue;
+				FutureWaitInfo waitInfo = Default;
+				waitInfo.future = m_state->futures[i];
+				waitInfos.push_back(waitInfo);
+			}
+#endif // __EMSCRIPTEN__
+		}
+#ifdef __EMSCRIPTEN__
+		return Error{ "Pipelines are still being created, which cannot be waited for with Emscripten" };
+#else // __EMSCRIPTEN__
+		if (!waitInfos.empty()) {
+			// Returns as soon as any of the pipelines is created, after having
+			// called its callback.
+			WaitStatus status = m_state->instance->waitAny(waitInfos.size(), waitInfos.data(), UINT64_MAX);
+			if (status == WaitStatus::Success) continue;
+			if (status != WaitStatus::UnsupportedTimeout && status != WaitStatus::UnsupportedCount) {
+				return Error{ "Could not wait for the pipelines of '" + m_state->label + "'" };
+			}
+		}
+		// Without timed waits (see InstanceFeatures::timedWaitAnyEnable),
+		// fall back to processing events.
+		m_device.tick();
+		std::this_thread::yield();
+#endif // __EMSCRIPTEN__
+	}
+}
@@ -0,0 +1,205 @@
+#include <slang-webgpu/runtime/device-registry.h>
+#include <slang-webgpu/runtime/workgroup-count-kernel.h>
+
+#include <algorithm>
+#include <functional>
+#include <map>
+#include <memory>
+
+using namespace wgpu;
+
+namespace {
+
+struct Registries {
+	std::mutex mutex;
+	std::map<WGPUDevice, std::weak_ptr<DeviceRegistry>> registries;
+};
+
+Registries& registries() {
+	static Registries s_registries;
+	return s_registries;
+}
+
+} // anonymous namespace
+
+std::shared_ptr<DeviceRegistry> DeviceRegistry::get(Device device) {
+	Registries& r = registries();
+	std::lock_guard lock(r.mutex);
+	std::weak_ptr<DeviceRegistry>& entry = r.registries[device];
+	std::shared_ptr<DeviceRegistry> registry = entry.lock();
+	if (!registry) {
+		registry.reset(new DeviceRegistry(device));
+		entry = registry;
+	}
+	return registry;
+}
+
+void DeviceRegistry::release(Device device) {
+	Registries& r = registries();
+	std::lock_guard lock(r.mutex);
+	r.registries.erase(device);
+}
+
+DeviceRegistry::DeviceRegistry(Device device)
+	: m_device(device)
+{
+	SupportedLimits supportedLimits = Default;
+	m_device.getLimits(&supportedLimits);
+	m_limits = supportedLimits.limits;
+}
+
+DeviceRegistry::~DeviceRegistry() {
+	// Remove the entry of the device, unless release() already did and a new
+	// registry (still in use) replaced it.
+	Registries& r = registries();
+	std::lock_guard lock(r.mutex);
+	auto it = r.registries.find(m_device);
+	if (it != r.registries.end() && it->second.expired()) {
+		r.registries.erase(it);
+	}
+}
+
+raii::BindGroupLayout DeviceRegistry::getOrCreateBindGroupLayout(
+	const std::string& signature,
+	const std::vector<BindGroupLayoutEntry>& entries
+) {
+	std::lock_guard lock(m_mutex);
+	auto it = m_bindGroupLayouts.find(signature);
+	if (it != m_bindGroupLayouts.end()) {
+		return it->second;
+	}
+
+	BindGroupLayoutDescriptor bindGroupLayoutDesc = Default;
+	bindGroupLayoutDesc.label = StringView(signature);
+	bindGroupLayoutDesc.entryCount = entries.size();
+	bindGroupLayoutDesc.entries = entries.data();
+	raii::BindGroupLayout layout = m_device.createBindGroupLayout(bindGroupLayoutDesc);
+	if (layout) {
+		m_bindGroupLayouts.emplace(signature, layout);
+	}
+	return layout;
+}
+
+size_t DeviceRegistry::bindGroupLayoutCount() const {
+	std::lock_guard lock(m_mutex);
+	return m_bindGroupLayouts.size();
+}
+
+raii::ShaderModule DeviceRegistry::getOrCreateShaderModule(
+	std::string_view label,
+	std::string_view wgslSource
+) {
+	// Hashed before taking the lock, and only copied if not found
+	size_t hash = std::hash<std::string_view>{}(wgslSource);
+
+	std::shared_ptr<ShaderModuleEntry> entry;
+	{
+		std::lock_guard lock(m_mutex);
+		auto [begin, end] = m_shaderModules.equal_range(hash);
+		auto it = std::find_if(begin, end, [&](const auto& item) {
+			return item.second->wgslSource == wgslSource;
+		});
+		if (it == end) {
+			it = m_shaderModules.emplace(hash, std::make_shared<ShaderModuleEntry>());
+			it->second->wgslSource = wgslSource;
+		}
+		entry = it->second;
+	}
+
+	// Compiled outside of the lock, so that requests of other sources do not
+	// wait for it
+	std::call_once(entry->created, [&]() {
+		ShaderSourceWGSL wgslDesc = Default;
+		wgslDesc.code = StringView(entry->wgslSource);
+		ShaderModuleDescriptor shaderDesc = Default;
+		shaderDesc.nextInChain = &wgslDesc.chain;
+		shaderDesc.label = StringView(label);
+		entry->object = m_device.createShaderModule(shaderDesc);
+	});
+
+	if (!entry->object) {
+		// Do not keep failures, so that the next request tries again
+		std::lock_guard lock(m_mutex);
+		auto [begin, end] = m_shaderModules.equal_range(hash);
+		auto it = std::find_if(begin, end, [&](const auto& item) {
+			return item.second == entry;
+		});
+		if (it != end) {
+			m_shaderModules.erase(it);
+		}
+	}
+	return entry->object;
+}
+
+size_t DeviceRegistry::shaderModuleCount() const {
+	std::lock_guard lock(m_mutex);
+	return m_shaderModules.size();
+}
+
+raii::PipelineLayout DeviceRegistry::getOrCreatePipelineLayout(
+	const std::vector<BindGroupLayout>& bindGroupLayouts
+) {
+	std::vector<WGPUBindGroupLayout> key(bindGroupLayouts.begin(), bindGroupLayouts.end());
+
+	std::lock_guard lock(m_mutex);
+	auto it = m_pipelineLayouts.find(key);
+	if (it != m_pipelineLayouts.end()) {
+		return it->second;
+	}
+
+	PipelineLayoutDescriptor layoutDesc = Default;
+	layoutDesc.bindGroupLayoutCount = key.size();
+	layoutDesc.bindGroupLayouts = key.data();
+	raii::PipelineLayout layout = m_device.createPipelineLayout(layoutDesc);
+	if (layout) {
+		m_pipelineLayouts.emplace(std::move(key), layout);
+	}
+	return layout;
+}
+
+ComputePipelineSet DeviceRegistry::getOrCreatePipelineSet(
+	std::string_view kernelName,
+	ShaderModule shaderModule,
+	PipelineLayout layout,
+	const std::vector<std::string>& entryPoints,
+	PipelineCreation creation
+) {
+	auto key = std::make_tuple(std::string(kernelName), (WGPUShaderModule)shaderModule, (WGPUPipelineLayout)layout);
+
+	std::shared_ptr<PendingEntry<ComputePipelineSet>> entry;
+	{
+		std::lock_guard lock(m_mutex);
+		auto& item = m_pipelineSets[std::move(key)];
+		if (!item) {
+			item = std::make_shared<PendingEntry<ComputePipelineSet>>();
+		}
+		entry = item;
+	}
+
+	// Created outside of the lock, since PipelineCreation::Immediate compiles
+	// the pipelines right away
+	bool created = false;
+	std::call_once(entry->created, [&]() {
+		entry->object = ComputePipelineSet(m_device, shaderModule, layout, entryPoints, kernelName, creation);
+		created = true;
+	});
+	if (created) {
+		return entry->object;
+	}
+
+	// The set was created by another instance, possibly with another mode,
+	// and may have to be waited for.
+	return entry->object.share(creation);
+}
+
+size_t DeviceRegistry::pipelineSetCount() const {
+	std::lock_guard lock(m_mutex);
+	return m_pipelineSets.size();
+}
+
+WorkgroupCountKernel& DeviceRegistry::getWorkgroupCountKernel() {
+	std::call_once(m_workgroupCountKernelFlag, [this]() {
+		m_workgroupCountKernel = std::make_unique<WorkgroupCountKernel>(*this);
+	});
+	return *m_workgroupCountKernel;
+}
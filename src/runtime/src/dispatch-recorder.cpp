@@ -0,0 +1,102 @@
+#include <slang-webgpu/runtime/dispatch-recorder.h>
+
+#include <slang-webgpu/common/logger.h>
+
+#include <algorithm>
+#include <utility>
+
+using namespace wgpu;
+
+DispatchRecorder::DispatchRecorder(Device device, std::string_view label)
+	: m_device(device)
+{
+	CommandEncoderDescriptor encoderDesc = Default;
+	encoderDesc.label = StringView(label);
+	m_encoder = m_device.createCommandEncoder(encoderDesc);
+
+	ComputePassDescriptor computePassDesc = Default;
+	computePassDesc.label = StringView(label);
+	m_computePass = m_encoder->beginComputePass(computePassDesc);
+}
+
+bool DispatchRecorder::checkRecording() const {
+	if (m_finished) {
+		LOG(ERROR) << "Cannot record into a DispatchRecorder that has already been finished";
+		return false;
+	}
+	return true;
+}
+
+void DispatchRecorder::setPipeline(ComputePipeline pipeline) {
+	if (!checkRecording()) return;
+	if ((WGPUComputePipeline)*m_pipeline == (WGPUComputePipeline)pipeline) {
+		++m_stats.skippedPipelineChanges;
+		return;
+	}
+	m_computePass->setPipeline(pipeline);
+	pipeline.addRef();
+	m_pipeline = std::move(pipeline);
+	++m_stats.pipelineChanges;
+}
+
+void DispatchRecorder::setBindGroup(
+	uint32_t groupIndex,
+	BindGroup bindGroup,
+	uint32_t dynamicOffsetCount,
+	const uint32_t* dynamicOffsets
+) {
+	if (!checkRecording()) return;
+	if (groupIndex < s_maxBindGroups) {
+		BindGroupState& state = m_bindGroups[groupIndex];
+		bool unchanged =
+			(WGPUBindGroup)*state.bindGroup == (WGPUBindGroup)bindGroup
+			&& state.dynamicOffsets.size() == dynamicOffsetCount
+			&& std::equal(state.dynamicOffsets.begin(), state.dynamicOffsets.end(), dynamicOffsets);
+		if (unchanged) {
+			++m_stats.skippedBindGroupChanges;
+			return;
+		}
+		BindGroup trackedBindGroup = bindGroup;
+		trackedBindGroup.addRef();
+		state.bindGroup = std::move(trackedBindGroup);
+		state.dynamicOffsets.assign(dynamicOffsets, dynamicOffsets + dynamicOffsetCount);
+	}
+	m_computePass->setBindGroup(groupIndex, bindGroup, dynamicOffsetCount, dynamicOffsets);
+	++m_stats.bindGroupChanges;
+}
+
+void DispatchRecorder::dispatchWorkgroups(uint32_t x, uint32_t y, uint32_t z) {
+	if (!checkRecording()) return;
+	m_computePass->dispatchWorkgroups(x, y, z);
+	++m_stats.dispatches;
+}
+
+void DispatchRecorder::dispatchWorkgroupsIndirect(Buffer indirectBuffer, uint64_t indirectOffset) {
+	if (!checkRecording()) return;
+	m_computePass->dispatchWorkgroupsIndirect(indirectBuffer, indirectOffset);
+	++m_stats.dispatches;
+}
+
+void DispatchRecorder::invalidateState() {
+	m_pipeline = {};
+	for (BindGroupState& state : m_bindGroups) {
+		state = {};
+	}
+}
+
+raii::CommandBuffer DispatchRecorder::finish() {
+	if (!checkRecording()) return {};
+	m_computePass->end();
+	m_finished = true;
+	invalidateState();
+
+	CommandBufferDescriptor commandBufferDesc = Default;
+	return m_encoder->finish(commandBufferDesc);
+}
+
+void DispatchRecorder::submit() {
+	raii::CommandBuffer commands = finish();
+	if (!*commands) return;
+	raii::Queue queue = m_device.getQueue();
+	queue->submit(*commands);
+}
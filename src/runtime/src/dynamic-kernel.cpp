@@ -0,0 +1,277 @@
+#include <slang-webgpu/runtime/dynamic-kernel.h>
+#include <slang-webgpu/runtime/device-registry.h>
+
+#include <slang-webgpu/common/variant-utils.h>
+
+#include <string>
+
+using namespace wgpu;
+
+namespace {
+
+BufferBindingType toBufferBindingType(KernelBindingType type) {
+	switch (type) {
+	case KernelBindingType::Uniform:
+		return BufferBindingType::Uniform;
+	case KernelBindingType::ReadOnlyStorage:
+		return BufferBindingType::ReadOnlyStorage;
+	case KernelBindingType::Storage:
+	default:
+		return BufferBindingType::Storage;
+	}
+}
+
+bool sameBindings(const std::vector<KernelBindingInfo>& a, const std::vector<KernelBindingInfo>& b) {
+	if (a.size() != b.size()) return false;
+	for (size_t i = 0; i < a.size(); ++i) {
+		if (
+			a[i].binding != b[i].binding ||
+			a[i].type != b[i].type ||
+			a[i].minBindingSize != b[i].minBindingSize
+		) {
+			return false;
+		}
+	}
+	return true;
+}
+
+} // anonymous namespace
+
+////////////////////////////////////////////
+// Initialization
+
+Result<DynamicKernel, Error> DynamicKernel::create(
+	Device device,
+	const KernelArchive& archive,
+	std::string_view name
+) {
+	auto index = archive.findKernel(name);
+	TRY_ASSERT(index.has_value(), "Kernel '" << name << "' not found in archive");
+
+	DynamicKernel kernel;
+	kernel.m_device = device;
+	TRY(kernel.load(archive.kernel(*index)));
+	return kernel;
+}
+
+Result<Void, Error> DynamicKernel::reload(const KernelArchive& archive) {
+	auto index = archive.findKernel(m_name);
+	TRY_ASSERT(index.has_value(), "Kernel '" << m_name << "' not found in archive");
+	KernelView kernel = archive.kernel(*index);
+	TRY_ASSERT(
+		sameBindings(kernel.bindings, m_bindings),
+		"Bindings of kernel '" << m_name << "' changed, existing bind groups would become invalid"
+	);
+
+	DynamicKernel reloaded;
+	reloaded.m_device = m_device;
+	TRY(reloaded.load(kernel));
+	*this = std::move(reloaded);
+	return {};
+}
+
+Result<Void, Error> DynamicKernel::load(const KernelView& kernel) {
+	m_name = kernel.name;
+	m_entryPoints = kernel.entryPoints;
+	m_bindings = kernel.bindings;
+
+	// 1. Create shader module
+	std::string label(kernel.name);
+	ShaderModuleDescriptor shaderDesc = Default;
+	shaderDesc.label = StringView(label);
+	ShaderSourceWGSL wgslDesc = Default;
+	std::string wgslSource;
+	switch (kernel.sourceFormat) {
+	case KernelSourceFormat::Wgsl:
+		wgslSource = kernel.source;
+		wgslDesc.code = StringView(wgslSource);
+		shaderDesc.nextInChain = &wgslDesc.chain;
+		m_shaderModule = m_device.createShaderModule(shaderDesc);
+		break;
+	case KernelSourceFormat::SpirV: {
+#ifdef __EMSCRIPTEN__
+		return Error{ "Kernel '" + label + "' is in SPIR-V, which is not supported by the web backend" };
+#else
+		TRY_ASSERT(kernel.source.size() % 4 == 0, "SPIR-V source of kernel '" << label << "' is not a whole number of words");
+		ShaderSourceSPIRV spirvDesc = Default;
+		spirvDesc.codeSize = (uint32_t)(kernel.source.size() / 4);
+		spirvDesc.code = reinterpret_cast<const uint32_t*>(kernel.source.data());
+		shaderDesc.nextInChain = &spirvDesc.chain;
+		m_shaderModule = m_device.createShaderModule(shaderDesc);
+		break;
+#endif
+	}
+	}
+	m_valid = m_shaderModule;
+	TRY_ASSERT(m_valid, "Could not create shader module for kernel '" << label << "'");
+
+	// 2. Create pipeline layout
+	std::vector<BindGroupLayoutEntry> layoutEntries(m_bindings.size(), Default);
+	for (size_t i = 0; i < m_bindings.size(); ++i) {
+		layoutEntries[i].binding = m_bindings[i].binding;
+		layoutEntries[i].visibility = ShaderStage::Compute;
+		layoutEntries[i].buffer.type = toBufferBindingType(m_bindings[i].type);
+		layoutEntries[i].buffer.minBindingSize = m_bindings[i].minBindingSize;
+	}
+	// The layout is shared with all kernels that have the same bindings
+	m_registry = DeviceRegistry::get(m_device);
+	m_bindGroupLayout = m_registry->getOrCreateBindGroupLayout(
+		bindingSignature(m_bindings),
+		layoutEntries
+	);
+	TRY_ASSERT(m_bindGroupLayout, "Could not create bind group layout for kernel '" << label << "'");
+
+	m_pipelineLayout = m_registry->getOrCreatePipelineLayout({ *m_bindGroupLayout });
+
+	// 3. Compute pipelines are created lazily
+	m_pipelines.clear();
+	m_pipelines.resize(m_entryPoints.size());
+	return {};
+}
+
+////////////////////////////////////////////
+// Bind Group
+
+Result<BindGroup, Error> DynamicKernel::createBindGroup(
+	const std::vector<BufferView>& buffers
+) const {
+	std::vector<BindGroupEntry> entries;
+	TRY_ASSIGN(entries, makeBindGroupEntries(buffers));
+
+	BindGroupDescriptor bindGroupDesc = Default;
+	bindGroupDesc.label = StringView(m_name);
+	bindGroupDesc.layout = *m_bindGroupLayout;
+	bindGroupDesc.entryCount = entries.size();
+	bindGroupDesc.entries = entries.data();
+
+	return m_device.createBindGroup(bindGroupDesc);
+}
+
+Result<BindGroup, Error> DynamicKernel::getOrCreateBindGroup(
+	BindGroupCache& cache,
+	const std::vector<BufferView>& buffers
+) const {
+	std::vector<BindGroupEntry> entries;
+	TRY_ASSIGN(entries, makeBindGroupEntries(buffers));
+	return cache.getOrCreate(m_device, *m_bindGroupLayout, entries, m_name);
+}
+
+Result<std::vector<BindGroupEntry>, Error> DynamicKernel::makeBindGroupEntries(
+	const std::vector<BufferView>& buffers
+) const {
+	TRY_ASSERT(
+		buffers.size() == m_bindings.size(),
+		"Kernel '" << m_name << "' expects " << m_bindings.size() << " buffer(s), but got " << buffers.size()
+	);
+
+	std::vector<BindGroupEntry> entries(m_bindings.size(), Default);
+	for (size_t i = 0; i < m_bindings.size(); ++i) {
+		TRY_ASSIGN(entries[i], makeBufferBindGroupEntry(m_device, m_bindings[i], buffers[i]));
+	}
+	return entries;
+}
+
+////////////////////////////////////////////
+// Dispatch
+
+Result<Void, Error> DynamicKernel::dispatch(
+	std::string_view entryPoint,
+	DispatchSize dispatchSize,
+	BindGroup bindGroup
+) {
+	CommandEncoderDescriptor encoderDesc = Default;
+	encoderDesc.label = StringView(m_name);
+
+	raii::CommandEncoder encoder = m_device.createCommandEncoder(encoderDesc);
+	TRY(dispatch(*encoder, entryPoint, dispatchSize, bindGroup));
+	raii::CommandBuffer commands = encoder->finish();
+	raii::Queue queue = m_device.getQueue();
+	queue->submit(*commands);
+	return {};
+}
+
+Result<Void, Error> DynamicKernel::dispatch(
+	CommandEncoder encoder,
+	std::string_view entryPoint,
+	DispatchSize dispatchSize,
+	BindGroup bindGroup
+) {
+	// Create the pipeline before beginning the pass, so that nothing is
+	// recorded in case of error.
+	TRY(getPipeline(entryPoint));
+
+	ComputePassDescriptor computePassDesc = Default;
+	computePassDesc.label = StringView(m_name);
+
+	raii::ComputePassEncoder computePass = encoder.beginComputePass(computePassDesc);
+	auto maybeError = dispatch(*computePass, entryPoint, dispatchSize, bindGroup);
+	computePass->end();
+	return maybeError;
+}
+
+Result<Void, Error> DynamicKernel::dispatch(
+	ComputePassEncoder computePass,
+	std::string_view entryPoint,
+	DispatchSize dispatchSize,
+	BindGroup bindGroup
+) {
+	ComputePipeline pipeline = nullptr;
+	TRY_ASSIGN(pipeline, getPipeline(entryPoint));
+	ThreadCount workgroupSize;
+	TRY_ASSIGN(workgroupSize, getWorkgroupSize(entryPoint));
+
+	WorkgroupCount workgroupCount = std::visit(overloaded{
+		[](WorkgroupCount count) { return count; },
+		[&](ThreadCount threadCount) { return WorkgroupCount{
+			divideAndCeil(threadCount.x, workgroupSize.x),
+			divideAndCeil(threadCount.y, workgroupSize.y),
+			divideAndCeil(threadCount.z, workgroupSize.z)
+		}; }
+	}, dispatchSize);
+
+	computePass.setPipeline(pipeline);
+	computePass.setBindGroup(0, bindGroup, 0, nullptr);
+	computePass.dispatchWorkgroups(workgroupCount.x, workgroupCount.y, workgroupCount.z);
+	return {};
+}
+
+////////////////////////////////////////////
+// Direct accessors
+
+bool DynamicKernel::hasEntryPoint(std::string_view entryPoint) const {
+	return !isError(findEntryPoint(entryPoint));
+}
+
+BindGroupLayout DynamicKernel::getBindGroupLayout() const {
+	return *m_bindGroupLayout;
+}
+
+Result<ComputePipeline, Error> DynamicKernel::getPipeline(std::string_view entryPoint) {
+	size_t index;
+	TRY_ASSIGN(index, findEntryPoint(entryPoint));
+	if (!m_pipelines[index]) {
+		std::string label = m_name + "::" + m_entryPoints[index].name;
+		ComputePipelineDescriptor pipelineDesc = Default;
+		pipelineDesc.label = StringView(label);
+		pipelineDesc.compute.module = *m_shaderModule;
+		pipelineDesc.compute.entryPoint = StringView(m_entryPoints[index].name);
+		pipelineDesc.layout = *m_pipelineLayout;
+		m_pipelines[index] = m_device.createComputePipeline(pipelineDesc);
+		TRY_ASSERT(m_pipelines[index], "Could not create pipeline '" << label << "'");
+	}
+	return *m_pipelines[index];
+}
+
+Result<ThreadCount, Error> DynamicKernel::getWorkgroupSize(std::string_view entryPoint) const {
+	size_t index;
+	TRY_ASSIGN(index, findEntryPoint(entryPoint));
+	const auto& size = m_entryPoints[index].workgroupSize;
+	return ThreadCount{ size[0], size[1], size[2] };
+}
+
+Result<size_t, Error> DynamicKernel::findEntryPoint(std::string_view entryPoint) const {
+	for (size_t i = 0; i < m_entryPoints.size(); ++i) {
+		if (m_entryPoints[i].name == entryPoint) return i;
+	}
+	return Error{ "Kernel '" + m_name + "' has no entry point '" + std::string(entryPoint) + "'" };
+}
@@ -0,0 +1,69 @@
+#include <slang-webgpu/runtime/kernel-library.h>
+
+#include <slang-webgpu/common/logger.h>
+
+#include <sstream>
+
+Result<KernelLibrary, Error> KernelLibrary::open(
+	wgpu::Device device,
+	const std::filesystem::path& path
+) {
+	KernelLibrary library;
+	library.m_device = device;
+	library.m_path = path;
+	std::error_code err;
+	library.m_modificationTime = std::filesystem::last_write_time(path, err);
+	TRY_ASSIGN(library.m_archive, KernelArchive::open(path));
+	return library;
+}
+
+Result<DynamicKernel*, Error> KernelLibrary::getKernel(std::string_view name) {
+	auto it = m_kernels.find(name);
+	if (it != m_kernels.end()) {
+		return it->second.get();
+	}
+
+	auto kernel = std::make_unique<DynamicKernel>();
+	TRY_ASSIGN(*kernel, DynamicKernel::create(m_device, m_archive, name));
+	DynamicKernel* kernelPtr = kernel.get();
+	m_kernels.emplace(std::string(name), std::move(kernel));
+	return kernelPtr;
+}
+
+Result<Void, Error> KernelLibrary::reload() {
+	std::error_code err;
+	auto modificationTime = std::filesystem::last_write_time(m_path, err);
+
+	// Map the new archive before releasing the previous one
+	KernelArchive archive;
+	TRY_ASSIGN(archive, KernelArchive::open(m_path));
+	m_archive = std::move(archive);
+	m_modificationTime = modificationTime;
+
+	std::ostringstream errors;
+	size_t failureCount = 0;
+	for (auto& [name, kernel] : m_kernels) {
+		auto maybeError = kernel->reload(m_archive);
+		if (isError(maybeError)) {
+			errors << "\n - " << std::get<Error>(maybeError).message;
+			++failureCount;
+		}
+		else {
+			LOG(INFO) << "Reloaded kernel '" << name << "'";
+		}
+	}
+	if (failureCount > 0) {
+		return Error{ std::to_string(failureCount) + " kernel(s) could not be reloaded from '" + m_path.string() + "':" + errors.str() };
+	}
+	return {};
+}
+
+Result<bool, Error> KernelLibrary::reloadIfChanged() {
+	std::error_code err;
+	auto modificationTime = std::filesystem::last_write_time(m_path, err);
+	if (err || modificationTime == m_modificationTime) {
+		return false;
+	}
+	TRY(reload());
+	return true;
+}
@@ -0,0 +1,276 @@
+#include <slang-webgpu/runtime/kernel-profiler.h>
+
+#include <slang-webgpu/common/logger.h>
+
+#include <algorithm>
+#include <map>
+#include <mutex>
+#include <sstream>
+
+using namespace wgpu;
+
+struct KernelProfiler::Core {
+	std::mutex mutex;
+	std::map<std::pair<std::string, std::string>, EntryPointStats> entryPoints;
+	uint64_t droppedPasses = 0;
+
+	EntryPointStats& getEntryPoint(const std::string& kernel, const std::string& entryPoint) {
+		EntryPointStats& stats = entryPoints[{ kernel, entryPoint }];
+		if (stats.kernel.empty()) {
+			stats.kernel = kernel;
+			stats.entryPoint = entryPoint;
+		}
+		return stats;
+	}
+};
+
+////////////////////////////////////////////
+// Histogram
+
+void KernelProfiler::Histogram::add(uint64_t durationNs) {
+	size_t bucket = 0;
+	while (bucket + 1 < BucketCount && (durationNs >> (bucket + 1)) != 0) {
+		++bucket;
+	}
+	++buckets[bucket];
+	++count;
+	totalNs += durationNs;
+	minNs = std::min(minNs, durationNs);
+	maxNs = std::max(maxNs, durationNs);
+}
+
+double KernelProfiler::Histogram::meanNs() const {
+	return count > 0 ? (double)totalNs / (double)count : 0.0;
+}
+
+uint64_t KernelProfiler::Histogram::percentileNs(double p) const {
+	if (count == 0) return 0;
+	uint64_t rank = (uint64_t)(std::clamp(p, 0.0, 1.0) * (double)(count - 1)) + 1;
+	uint64_t cumulated = 0;
+	for (size_t bucket = 0; bucket < BucketCount; ++bucket) {
+		cumulated += buckets[bucket];
+		if (cumulated >= rank) {
+			uint64_t upperBound = bucket + 1 < BucketCount ? (uint64_t(1) << (bucket + 1)) - 1 : UINT64_MAX;
+			return std::min(upperBound, maxNs);
+		}
+	}
+	return maxNs;
+}
+
+////////////////////////////////////////////
+// DispatchTimer
+
+KernelProfiler::DispatchTimer::DispatchTimer(
+	KernelProfiler* profiler,
+	const char* kernel,
+	const char* entryPoint,
+	WorkgroupCount workgroupCount
+)
+	: m_profiler(profiler && profiler->isEnabled() ? profiler : nullptr)
+	, m_kernel(kernel)
+	, m_entryPoint(entryPoint)
+	, m_workgroups((uint64_t)workgroupCount.x * workgroupCount.y * workgroupCount.z)
+	, m_indirect(false)
+{
+	if (m_profiler) m_start = std::chrono::steady_clock::now();
+}
+
+KernelProfiler::DispatchTimer::DispatchTimer(
+	KernelProfiler* profiler,
+	const char* kernel,
+	const char* entryPoint
+)
+	: m_profiler(profiler && profiler->isEnabled() ? profiler : nullptr)
+	, m_kernel(kernel)
+	, m_entryPoint(entryPoint)
+	, m_workgroups(0)
+	, m_indirect(true)
+{
+	if (m_profiler) m_start = std::chrono::steady_clock::now();
+}
+
+KernelProfiler::DispatchTimer::~DispatchTimer() {
+	if (!m_profiler) return;
+	auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - m_start);
+	m_profiler->recordDispatch(m_kernel, m_entryPoint, m_workgroups, m_indirect, (uint64_t)elapsed.count());
+}
+
+////////////////////////////////////////////
+// KernelProfiler
+
+KernelProfiler::KernelProfiler(Device device, uint32_t maxTimedPasses)
+	: m_maxTimedPasses(maxTimedPasses)
+	, m_readbacks(device, "profiler")
+	, m_core(std::make_shared<Core>())
+{
+	device.addRef();
+	m_device = std::move(device);
+	m_queue = m_device->getQueue();
+
+	if (m_maxTimedPasses == 0) {
+		LOG(INFO) << "GPU timing is disabled (maxTimedPasses = 0), kernel profiler only measures CPU time";
+		return;
+	}
+	if (!m_device->hasFeature(FeatureName::TimestampQuery)) {
+		LOG(INFO) << "Device has no TimestampQuery feature, kernel profiler only measures CPU time";
+		return;
+	}
+
+	QuerySetDescriptor querySetDesc = Default;
+	querySetDesc.label = StringView("profiler");
+	querySetDesc.type = QueryType::Timestamp;
+	querySetDesc.count = 2 * m_maxTimedPasses;
+	m_querySet = m_device->createQuerySet(querySetDesc);
+
+	BufferDescriptor bufferDesc = Default;
+	bufferDesc.label = StringView("profiler timestamps");
+	bufferDesc.size = 2 * m_maxTimedPasses * sizeof(uint64_t);
+	bufferDesc.usage = BufferUsage::QueryResolve | BufferUsage::CopySrc;
+	m_resolveBuffer = m_device->createBuffer(bufferDesc);
+}
+
+bool KernelProfiler::writeTimestamps(
+	const char* kernel,
+	const char* entryPoint,
+	ComputePassTimestampWrites& timestampWrites
+) {
+	if (!m_enabled || !m_querySet) return false;
+
+	std::lock_guard lock(m_core->mutex);
+	if (m_timedPasses.size() >= m_maxTimedPasses) {
+		++m_core->droppedPasses;
+		return false;
+	}
+	uint32_t pass = (uint32_t)m_timedPasses.size();
+	m_timedPasses.emplace_back(kernel, entryPoint);
+
+	timestampWrites.querySet = *m_querySet;
+	timestampWrites.beginningOfPassWriteIndex = 2 * pass;
+	timestampWrites.endOfPassWriteIndex = 2 * pass + 1;
+	return true;
+}
+
+void KernelProfiler::recordDispatch(
+	const char* kernel,
+	const char* entryPoint,
+	uint64_t workgroups,
+	bool indirect,
+	uint64_t cpuEncodeTimeNs
+) {
+	std::lock_guard lock(m_core->mutex);
+	EntryPointStats& stats = m_core->getEntryPoint(kernel, entryPoint);
+	++stats.dispatches;
+	if (indirect) ++stats.indirectDispatches;
+	stats.workgroups += workgroups;
+	stats.cpuEncodeTime.add(cpuEncodeTimeNs);
+}
+
+Result<Void, Error> KernelProfiler::resolve() {
+	std::vector<std::pair<std::string, std::string>> passes;
+	{
+		std::lock_guard lock(m_core->mutex);
+		passes = std::move(m_timedPasses);
+		m_timedPasses.clear();
+	}
+	if (passes.empty()) return {};
+
+	// Resolving is submitted before the copy recorded by the readback
+	// service, and the next resolve() is submitted after this copy, so the
+	// resolve buffer can be reused right away.
+	uint32_t queryCount = 2 * (uint32_t)passes.size();
+	CommandEncoderDescriptor encoderDesc = Default;
+	encoderDesc.label = StringView("profiler");
+	raii::CommandEncoder encoder = m_device->createCommandEncoder(encoderDesc);
+	encoder->resolveQuerySet(*m_querySet, 0, queryCount, *m_resolveBuffer, 0);
+	raii::CommandBuffer commands = encoder->finish();
+	m_queue->submit(*commands);
+
+	ReadbackService::Readback readback;
+	TRY_ASSIGN(readback, m_readbacks.read(*m_resolveBuffer, 0, queryCount * sizeof(uint64_t)));
+	m_readbacks.flush();
+
+	std::shared_ptr<Core> core = m_core;
+	readback.onReady([core, passes](const ReadbackService::Readback& readback) {
+		onTimestampsRead(core, passes, readback);
+	});
+	return {};
+}
+
+void KernelProfiler::onTimestampsRead(
+	const std::shared_ptr<Core>& core,
+	const std::vector<std::pair<std::string, std::string>>& passes,
+	const ReadbackService::Readback& readback
+) {
+	if (isError(readback.status())) {
+		LOG(WARNING) << "Could not read kernel timestamps back: " << std::get<Error>(readback.status()).message;
+		return;
+	}
+	std::vector<uint64_t> timestamps = readback.as<uint64_t>();
+
+	std::lock_guard lock(core->mutex);
+	for (size_t pass = 0; pass < passes.size() && 2 * pass + 1 < timestamps.size(); ++pass) {
+		uint64_t begin = timestamps[2 * pass];
+		uint64_t end = timestamps[2 * pass + 1];
+		// Timestamps may go backwards on some devices, such samples are skipped
+		if (end < begin) continue;
+		const auto& [kernel, entryPoint] = passes[pass];
+		core->getEntryPoint(kernel, entryPoint).gpuTime.add(end - begin);
+	}
+}
+
+void KernelProfiler::poll() {
+	m_readbacks.poll();
+}
+
+Result<Void, Error> KernelProfiler::waitForResults(uint64_t timeoutNs) {
+	return m_readbacks.waitAll(timeoutNs);
+}
+
+std::vector<KernelProfiler::EntryPointStats> KernelProfiler::stats() const {
+	std::lock_guard lock(m_core->mutex);
+	std::vector<EntryPointStats> result;
+	result.reserve(m_core->entryPoints.size());
+	for (const auto& [key, stats] : m_core->entryPoints) {
+		result.push_back(stats);
+	}
+	return result;
+}
+
+Result<KernelProfiler::EntryPointStats, Error> KernelProfiler::stats(const std::string& kernel, const std::string& entryPoint) const {
+	std::lock_guard lock(m_core->mutex);
+	auto it = m_core->entryPoints.find({ kernel, entryPoint });
+	if (it == m_core->entryPoints.end()) {
+		return Error{ "Entry point '" + entryPoint + "' of kernel '" + kernel + "' was never dispatched while profiling" };
+	}
+	return it->second;
+}
+
+uint64_t KernelProfiler::droppedPassCount() const {
+	std::lock_guard lock(m_core->mutex);
+	return m_core->droppedPasses;
+}
+
+void KernelProfiler::logReport() const {
+	for (const EntryPointStats& stats : this->stats()) {
+		std::ostringstream line;
+		line
+			<< stats.kernel << "::" << stats.entryPoint << ": "
+			<< stats.dispatches << " dispatch(es) (" << stats.indirectDispatches << " indirect), "
+			<< stats.workgroups << " workgroup(s), CPU encode "
+			<< stats.cpuEncodeTime.meanNs() / 1000.0 << " us (mean)";
+		if (stats.gpuTime.count > 0) {
+			line
+				<< ", GPU " << stats.gpuTime.meanNs() / 1000.0 << " us (mean), "
+				<< stats.gpuTime.percentileNs(0.5) / 1000.0 << " us (p50), "
+				<< stats.gpuTime.percentileNs(0.99) / 1000.0 << " us (p99) over "
+				<< stats.gpuTime.count << " pass(es)";
+		}
+		LOG(INFO) << "[Profiler] " << line.str();
+	}
+}
+
+void KernelProfiler::reset() {
+	std::lock_guard lock(m_core->mutex);
+	m_core->entryPoints.clear();
+	m_core->droppedPasses = 0;
+}
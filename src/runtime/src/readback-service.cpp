@@ -0,0 +1,364 @@
+#include <slang-webgpu/runtime/readback-service.h>
+
+#include <algorithm>
+#include <chrono>
+#include <mutex>
+#include <thread>
+
+using namespace wgpu;
+
+struct ReadbackService::Core {
+	std::mutex mutex;
+	// Staging buffers that are not used by any readback
+	std::vector<raii::Buffer> pool;
+	// Readbacks that are flushed but not ready yet
+	std::vector<Readback> pending;
+	Stats stats;
+};
+
+struct ReadbackService::Readback::State {
+	std::shared_ptr<Core> core;
+	raii::Buffer staging;
+	uint64_t size = 0;
+	bool flushed = false;
+	bool ready = false;
+	std::string error;
+	std::vector<uint8_t> data;
+	std::vector<ReadyCallback> readyCallbacks;
+#ifndef __EMSCRIPTEN__
+	WGPUFuture future = {};
+#endif // __EMSCRIPTEN__
+};
+
+////////////////////////////////////////////
+// Readback
+
+bool ReadbackService::Readback::isReady() const {
+	if (!m_state) return false;
+	std::lock_guard lock(m_state->core->mutex);
+	return m_state->ready;
+}
+
+Result<Void, Error> ReadbackService::Readback::status() const {
+	if (!m_state) return Error{ "Invalid readback" };
+	std::lock_guard lock(m_state->core->mutex);
+	if (!m_state->ready) return Error{ "Readback is not ready yet" };
+	if (!m_state->error.empty()) return Error{ m_state->error };
+	return {};
+}
+
+const std::vector<uint8_t>& ReadbackService::Readback::data() const {
+	static const std::vector<uint8_t> s_empty;
+	if (!isReady()) return s_empty;
+	// The data no longer changes once ready
+	return m_state->data;
+}
+
+void ReadbackService::Readback::onReady(ReadyCallback callback) const {
+	if (!m_state) return;
+	{
+		std::lock_guard lock(m_state->core->mutex);
+		if (!m_state->ready) {
+			m_state->readyCallbacks.push_back(std::move(callback));
+			return;
+		}
+	}
+	callback(*this);
+}
+
+////////////////////////////////////////////
+// ReadbackService
+
+ReadbackService::ReadbackService(Device device, std::string_view label)
+	: m_label(label)
+	, m_core(std::make_shared<Core>())
+{
+	device.addRef();
+	m_device = std::move(device);
+	m_queue = m_device->getQueue();
+#ifndef __EMSCRIPTEN__
+	raii::Adapter adapter = m_device->getAdapter();
+	m_instance = adapter->getInstance();
+#endif // __EMSCRIPTEN__
+}
+
+ReadbackService::~ReadbackService() {
+	// Readbacks that are still referenced complete once the service is gone
+	flush();
+}
+
+Result<ReadbackService::Readback, Error> ReadbackService::read(
+	Buffer buffer,
+	uint64_t offset,
+	uint64_t size
+) {
+	TRY_ASSERT(buffer, "Cannot read back a null buffer");
+	uint64_t bufferSize = buffer.getSize();
+	TRY_ASSERT(offset <= bufferSize, "Readback offset " << offset << " exceeds the size of the buffer (" << bufferSize << ")");
+	if (size == WGPU_WHOLE_SIZE) {
+		size = bufferSize - offset;
+	}
+	TRY_ASSERT(size > 0, "Cannot read back an empty range");
+	TRY_ASSERT(offset % 4 == 0 && size % 4 == 0, "Offset (" << offset << ") and size (" << size << ") of a readback must be multiples of 4");
+	TRY_ASSERT(offset + size <= bufferSize, "Readback range [" << offset << ", " << offset + size << "[ exceeds the size of the buffer (" << bufferSize << ")");
+
+	raii::Buffer staging = acquireStagingBuffer(size);
+	TRY_ASSERT(*staging, "Could not create a staging buffer of " << size << " bytes");
+
+	if (!m_encoder) {
+		CommandEncoderDescriptor encoderDesc = Default;
+		encoderDesc.label = StringView(m_label);
+		m_encoder = m_device->createCommandEncoder(encoderDesc);
+	}
+	m_encoder->copyBufferToBuffer(buffer, offset, *staging, 0, size);
+
+	Readback readback;
+	readback.m_state = std::make_shared<Readback::State>();
+	readback.m_state->core = m_core;
+	readback.m_state->staging = std::move(staging);
+	readback.m_state->size = size;
+	m_unflushed.push_back(readback);
+	{
+		std::lock_guard lock(m_core->mutex);
+		++m_core->stats.readbacks;
+	}
+	return readback;
+}
+
+void ReadbackService::flush() {
+	if (m_unflushed.empty()) return;
+
+	// A single submit for all reads recorded since the last flush
+	raii::CommandBuffer commands = m_encoder->finish();
+	m_encoder = {};
+	m_queue->submit(*commands);
+	{
+		std::lock_guard lock(m_core->mutex);
+		++m_core->stats.submits;
+	}
+
+	std::vector<Readback> readbacks = std::move(m_unflushed);
+	m_unflushed.clear();
+	for (const Readback& readback : readbacks) {
+		startMapping(readback);
+	}
+}
+
+Result<Void, Error> ReadbackService::wait(const Readback& readback, uint64_t timeoutNs) {
+	TRY_ASSERT(readback, "Invalid readback");
+	return waitFor({ readback }, timeoutNs);
+}
+
+Result<Void, Error> ReadbackService::waitAll(uint64_t timeoutNs) {
+	flush();
+	std::vector<Readback> pending;
+	{
+		std::lock_guard lock(m_core->mutex);
+		for (const Readback& readback : m_core->pending) {
+			pending.push_back(readback);
+		}
+	}
+	return waitFor(pending, timeoutNs);
+}
+
+void ReadbackService::poll() {
+#ifndef __EMSCRIPTEN__
+	m_device->tick();
+	m_instance->processEvents();
+#endif // __EMSCRIPTEN__
+}
+
+size_t ReadbackService::pendingCount() const {
+	std::lock_guard lock(m_core->mutex);
+	return m_core->pending.size() + m_unflushed.size();
+}
+
+ReadbackService::Stats ReadbackService::stats() const {
+	std::lock_guard lock(m_core->mutex);
+	return m_core->stats;
+}
+
+raii::Buffer ReadbackService::acquireStagingBuffer(uint64_t size) {
+	{
+		std::lock_guard lock(m_core->mutex);
+		std::vector<raii::Buffer>& pool = m_core->pool;
+		auto best = pool.end();
+		for (auto it = pool.begin(); it != pool.end(); ++it) {
+			uint64_t bufferSize = (*it)->getSize();
+			if (bufferSize >= size && (best == pool.end() || bufferSize < (*best)->getSize())) {
+				best = it;
+			}
+		}
+		if (best != pool.end()) {
+			raii::Buffer staging = std::move(*best);
+			pool.erase(best);
+			++m_core->stats.stagingBuffersReused;
+			return staging;
+		}
+		++m_core->stats.stagingBuffersCreated;
+	}
+
+	// Sizes are rounded up to a power of two, so that buffers fit more reads
+	uint64_t capacity = 256;
+	while (capacity < size) capacity *= 2;
+
+	BufferDescriptor bufferDesc = Default;
+	bufferDesc.label = StringView(m_label);
+	bufferDesc.size = capacity;
+	bufferDesc.usage = BufferUsage::MapRead | BufferUsage::CopyDst;
+	return m_device->createBuffer(bufferDesc);
+}
+
+void ReadbackService::startMapping(const Readback& readback) {
+	std::shared_ptr<Readback::State> state = readback.m_state;
+	{
+		std::lock_guard lock(m_core->mutex);
+		state->flushed = true;
+		m_core->pending.push_back(readback);
+	}
+
+	// The callback owns a reference to the readback
+	auto userdata = new Readback(readback);
+#ifdef __EMSCRIPTEN__
+	wgpuBufferMapAsync(
+		*state->staging,
+		WGPUMapMode_Read,
+		0,
+		state->size,
+		[](WGPUBufferMapAsyncStatus status, void* userdata) {
+			std::unique_ptr<Readback> readback((Readback*)userdata);
+			bool success = status == WGPUBufferMapAsyncStatus_Success;
+			onMapped(*readback, success, success ? std::string_view() : std::string_view("mapping failed"));
+		},
+		userdata
+	);
+#else // __EMSCRIPTEN__
+	WGPUBufferMapCallbackInfo2 callbackInfo = {};
+	// Callbacks fire within waitAny() or processEvents(), i.e., within wait()
+	// and poll(), or when the application processes device events.
+	callbackInfo.mode = WGPUCallbackMode_AllowProcessEvents;
+	callbackInfo.callback = [](
+		WGPUMapAsyncStatus status,
+		WGPUStringView message,
+		void* userdata1,
+		[[maybe_unused]] void* userdata2
+	) {
+		std::unique_ptr<Readback> readback((Readback*)userdata1);
+		bool success = status == WGPUMapAsyncStatus_Success;
+		onMapped(
+			*readback,
+			success,
+			success || message.data == nullptr ? std::string_view() : std::string_view(message.data, message.length == WGPU_STRLEN ? std::strlen(message.data) : message.length)
+		);
+	};
+	callbackInfo.userdata1 = userdata;
+	WGPUFuture future = wgpuBufferMapAsync2(*state->staging, WGPUMapMode_Read, 0, state->size, callbackInfo);
+	{
+		std::lock_guard lock(m_core->mutex);
+		state->future = future;
+	}
+#endif // __EMSCRIPTEN__
+}
+
+void ReadbackService::onMapped(const Readback& readback, bool success, std::string_view errorMessage) {
+	const std::shared_ptr<Readback::State>& state = readback.m_state;
+	std::shared_ptr<Core> core = state->core;
+	std::vector<Readback::ReadyCallback> callbacks;
+	{
+		std::lock_guard lock(core->mutex);
+		if (success) {
+			const uint8_t* mapped = static_cast<const uint8_t*>(state->staging->getConstMappedRange(0, state->size));
+			state->data.assign(mapped, mapped + state->size);
+			state->staging->unmap();
+			core->pool.push_back(std::move(state->staging));
+		}
+		else {
+			state->error = "Could not map staging buffer for readback";
+			if (!errorMessage.empty()) state->error += ": " + std::string(errorMessage);
+			// The staging buffer is dropped, in case it is what failed
+			state->staging = {};
+		}
+		state->ready = true;
+		callbacks = std::move(state->readyCallbacks);
+
+		auto it = std::find_if(core->pending.begin(), core->pending.end(), [&](const Readback& other) {
+			return other.m_state == state;
+		});
+		if (it != core->pending.end()) {
+			core->pending.erase(it);
+		}
+	}
+	for (const Readback::ReadyCallback& callback : callbacks) {
+		callback(readback);
+	}
+}
+
+Result<Void, Error> ReadbackService::waitFor(const std::vector<Readback>& readbacks, uint64_t timeoutNs) {
+	// Make sure the copies were submitted
+	bool needsFlush = false;
+	{
+		std::lock_guard lock(m_core->mutex);
+		for (const Readback& readback : readbacks) {
+			needsFlush = needsFlush || !readback.m_state->flushed;
+		}
+	}
+	if (needsFlush) {
+		flush();
+	}
+
+	using Clock = std::chrono::steady_clock;
+	Clock::time_point start = Clock::now();
+	auto remainingNs = [&]() -> uint64_t {
+		if (timeoutNs == Infinite) return Infinite;
+		uint64_t elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start).count();
+		return elapsed >= timeoutNs ? 0 : timeoutNs - elapsed;
+	};
+
+	while (true) {
+#ifndef __EMSCRIPTEN__
+		std::vector<FutureWaitInfo> waitInfos;
+#endif // __EMSCRIPTEN__
+		{
+			std::lock_guard lock(m_core->mutex);
+			for (const Readback& readback : readbacks) {
+				if (readback.m_state->ready) continue;
+#ifndef __EMSCRIPTEN__
+				FutureWaitInfo waitInfo = Default;
+				waitInfo.future = readback.m_state->future;
+				waitInfos.push_back(waitInfo);
+#else // __EMSCRIPTEN__
+				return Error{ "Readbacks are still pending, which cannot be waited for with Emscripten" };
+#endif // __EMSCRIPTEN__
+			}
+		}
+#ifndef __EMSCRIPTEN__
+		if (waitInfos.empty()) break;
+
+		// Returns as soon as any of the readbacks is ready, after having
+		// called its callback.
+		WaitStatus status = m_instance->waitAny(waitInfos.size(), waitInfos.data(), remainingNs());
+		if (status == WaitStatus::Success) continue;
+		if (status == WaitStatus::TimedOut) {
+			return Error{ "Timed out while waiting for " + std::to_string(waitInfos.size()) + " readback(s)" };
+		}
+		if (status != WaitStatus::UnsupportedTimeout && status != WaitStatus::UnsupportedCount) {
+			return Error{ "Could not wait for readbacks" };
+		}
+
+		// Without timed waits (see InstanceFeatures::timedWaitAnyEnable),
+		// fall back to processing events until the timeout.
+		if (remainingNs() == 0) {
+			return Error{ "Timed out while waiting for " + std::to_string(waitInfos.size()) + " readback(s)" };
+		}
+		poll();
+		std::this_thread::yield();
+#else // __EMSCRIPTEN__
+		break;
+#endif // __EMSCRIPTEN__
+	}
+
+	for (const Readback& readback : readbacks) {
+		TRY(readback.status());
+	}
+	return {};
+}
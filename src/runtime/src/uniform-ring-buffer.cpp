@@ -0,0 +1,80 @@
+#include <slang-webgpu/runtime/uniform-ring-buffer.h>
+
+#include <slang-webgpu/common/kernel-utils.h>
+
+#include <cstring>
+
+using namespace wgpu;
+
+Result<UniformRingBuffer, Error> UniformRingBuffer::create(
+	Device device,
+	uint64_t capacity,
+	std::string_view label
+) {
+	UniformRingBuffer ring;
+
+	SupportedLimits supportedLimits = Default;
+	device.getLimits(&supportedLimits);
+	const Limits& limits = supportedLimits.limits;
+	uint32_t alignment = limits.minUniformBufferOffsetAlignment;
+	if (alignment != 0 && alignment != WGPU_LIMIT_U32_UNDEFINED) {
+		ring.m_alignment = alignment;
+	}
+
+	// Uniform bindings are read by blocks of 16 bytes
+	capacity = alignUp(capacity, 16);
+	TRY_ASSERT(capacity > 0, "The capacity of a uniform ring buffer must not be zero");
+	TRY_ASSERT(
+		capacity <= limits.maxBufferSize || limits.maxBufferSize == 0,
+		"Capacity " << capacity << " exceeds the device's maxBufferSize (" << limits.maxBufferSize << ")"
+	);
+
+	BufferDescriptor bufferDesc = Default;
+	bufferDesc.label = StringView(label);
+	bufferDesc.size = capacity;
+	bufferDesc.usage = BufferUsage::Uniform | BufferUsage::CopyDst;
+	ring.m_buffer = device.createBuffer(bufferDesc);
+	TRY_ASSERT(*ring.m_buffer, "Could not create uniform ring buffer '" << label << "'");
+
+	ring.m_queue = device.getQueue();
+	ring.m_staging.reserve(capacity);
+	return ring;
+}
+
+Result<uint32_t, Error> UniformRingBuffer::push(const void* data, uint64_t size) {
+	uint64_t offset = alignUp(m_head, m_alignment);
+	uint64_t end = offset + alignUp(size, 16);
+	TRY_ASSERT(
+		end <= getCapacity(),
+		"Uniform ring buffer is full (" << m_head << " bytes pushed, capacity is " << getCapacity() << "), call flush() more often or increase its capacity"
+	);
+
+	// Padding between pushes is left to zero
+	m_staging.resize(end, 0);
+	std::memcpy(m_staging.data() + offset, data, size);
+	m_head = end;
+	return (uint32_t)offset;
+}
+
+void UniformRingBuffer::flush() {
+	if (m_head == 0) return;
+	m_queue->writeBuffer(*m_buffer, 0, m_staging.data(), m_head);
+	m_staging.clear();
+	m_head = 0;
+}
+
+Buffer UniformRingBuffer::getBuffer() const {
+	return *m_buffer;
+}
+
+uint64_t UniformRingBuffer::getCapacity() const {
+	return m_buffer ? m_buffer->getSize() : 0;
+}
+
+uint32_t UniformRingBuffer::getAlignment() const {
+	return m_alignment;
+}
+
+uint64_t UniformRingBuffer::getPendingSize() const {
+	return m_head;
+}
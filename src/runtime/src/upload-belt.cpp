@@ -0,0 +1,373 @@
+#include <slang-webgpu/runtime/upload-belt.h>
+
+#include <slang-webgpu/common/io.h>
+#include <slang-webgpu/common/kernel-utils.h>
+
+#include <algorithm>
+#include <cstring>
+#include <mutex>
+#include <thread>
+
+using namespace wgpu;
+
+enum class StagingState {
+	// Mapped, and not used by any upload
+	Free,
+	// Mapped, and being filled by uploads
+	Current,
+	// Unmapped, with copies waiting for the next flush
+	Closed,
+	// Submitted, and being mapped again
+	InFlight,
+};
+
+struct UploadBelt::Staging {
+	raii::Buffer buffer;
+	uint64_t size = 0;
+	uint8_t* mapped = nullptr;
+	StagingState state = StagingState::Free;
+	// Number of bytes used so far in the current buffer
+	uint64_t cursor = 0;
+#ifndef __EMSCRIPTEN__
+	WGPUFuture future = {};
+#endif // __EMSCRIPTEN__
+};
+
+struct UploadBelt::Core {
+	std::mutex mutex;
+	std::vector<std::shared_ptr<Staging>> buffers;
+	Stats stats;
+};
+
+UploadBelt::UploadBelt(
+	Device device,
+	uint64_t chunkSize,
+	uint32_t maxChunks,
+	std::string_view label
+)
+	: m_label(label)
+	// Copies between buffers require multiples of 4 bytes
+	, m_chunkSize(alignUp(std::max<uint64_t>(chunkSize, 4), 4))
+	, m_maxChunks(std::max<uint32_t>(maxChunks, 1))
+	, m_core(std::make_shared<Core>())
+{
+	device.addRef();
+	m_device = std::move(device);
+	m_queue = m_device->getQueue();
+#ifndef __EMSCRIPTEN__
+	raii::Adapter adapter = m_device->getAdapter();
+	m_instance = adapter->getInstance();
+#endif // __EMSCRIPTEN__
+}
+
+UploadBelt::~UploadBelt() {
+	// Recorded copies must not be lost
+	flush();
+}
+
+////////////////////////////////////////////
+// Mapped at creation
+
+Result<raii::Buffer, Error> UploadBelt::createBuffer(
+	const BufferDescriptor& descriptor,
+	uint64_t size,
+	const FillFunction& fill
+) {
+	BufferDescriptor bufferDesc = descriptor;
+	bufferDesc.size = alignUp(size, 4);
+	bufferDesc.mappedAtCreation = true;
+	raii::Buffer buffer = m_device->createBuffer(bufferDesc);
+	TRY_ASSERT(*buffer, "Could not create buffer of " << bufferDesc.size << " bytes");
+
+	uint8_t* mapped = static_cast<uint8_t*>(buffer->getMappedRange(0, bufferDesc.size));
+	TRY_ASSERT(mapped, "Could not map buffer at creation");
+	if (size > 0) {
+		fill(mapped, 0, size);
+	}
+	std::memset(mapped + size, 0, bufferDesc.size - size);
+	buffer->unmap();
+
+	std::lock_guard lock(m_core->mutex);
+	++m_core->stats.uploads;
+	++m_core->stats.buffersMappedAtCreation;
+	m_core->stats.bytes += size;
+	return buffer;
+}
+
+Result<raii::Buffer, Error> UploadBelt::createBuffer(
+	const BufferDescriptor& descriptor,
+	const void* data,
+	uint64_t size
+) {
+	const uint8_t* source = static_cast<const uint8_t*>(data);
+	return createBuffer(descriptor, size, [source](uint8_t* destination, uint64_t sourceOffset, uint64_t size) {
+		std::memcpy(destination, source + sourceOffset, size);
+	});
+}
+
+Result<raii::Buffer, Error> UploadBelt::createBufferFromFile(
+	const BufferDescriptor& descriptor,
+	const std::filesystem::path& path
+) {
+	MappedFile file;
+	TRY_ASSIGN(file, MappedFile::open(path));
+	return createBuffer(descriptor, file.data(), file.size());
+}
+
+////////////////////////////////////////////
+// Staged uploads
+
+Result<Void, Error> UploadBelt::upload(
+	Buffer destination,
+	uint64_t destinationOffset,
+	uint64_t size,
+	const FillFunction& fill
+) {
+	TRY_ASSERT(destination, "Cannot upload to a null buffer");
+	TRY_ASSERT(destinationOffset % 4 == 0 && size % 4 == 0, "Offset (" << destinationOffset << ") and size (" << size << ") of an upload must be multiples of 4");
+	TRY_ASSERT(destinationOffset + size <= destination.getSize(), "Upload range [" << destinationOffset << ", " << destinationOffset + size << "[ exceeds the size of the buffer (" << destination.getSize() << ")");
+
+	uint64_t chunks = 0;
+	uint64_t fallbackWrites = 0;
+	for (uint64_t offset = 0; offset < size;) {
+		uint64_t chunkSize = std::min(size - offset, m_chunkSize);
+		TRY(reserve(chunkSize));
+
+		if (m_current) {
+			fill(m_current->mapped + m_current->cursor, offset, chunkSize);
+			if (!m_encoder) {
+				CommandEncoderDescriptor encoderDesc = Default;
+				encoderDesc.label = StringView(m_label);
+				m_encoder = m_device->createCommandEncoder(encoderDesc);
+			}
+			m_encoder->copyBufferToBuffer(*m_current->buffer, m_current->cursor, destination, destinationOffset + offset, chunkSize);
+			m_current->cursor += chunkSize;
+			++chunks;
+		}
+		else {
+			// The ring is full and we cannot wait (Emscripten)
+			std::vector<uint8_t> data(chunkSize);
+			fill(data.data(), offset, chunkSize);
+			m_queue->writeBuffer(destination, destinationOffset + offset, data.data(), chunkSize);
+			++fallbackWrites;
+		}
+		offset += chunkSize;
+	}
+
+	std::lock_guard lock(m_core->mutex);
+	++m_core->stats.uploads;
+	m_core->stats.bytes += size;
+	m_core->stats.chunks += chunks;
+	m_core->stats.fallbackWrites += fallbackWrites;
+	return {};
+}
+
+Result<Void, Error> UploadBelt::upload(
+	Buffer destination,
+	uint64_t destinationOffset,
+	const void* data,
+	uint64_t size
+) {
+	const uint8_t* source = static_cast<const uint8_t*>(data);
+	return upload(destination, destinationOffset, size, [source](uint8_t* destination, uint64_t sourceOffset, uint64_t size) {
+		std::memcpy(destination, source + sourceOffset, size);
+	});
+}
+
+Result<Void, Error> UploadBelt::uploadFile(
+	Buffer destination,
+	uint64_t destinationOffset,
+	const std::filesystem::path& path
+) {
+	MappedFile file;
+	TRY_ASSIGN(file, MappedFile::open(path));
+	// Pages of the file are only read when copied into a staging buffer
+	return upload(destination, destinationOffset, file.data(), file.size());
+}
+
+void UploadBelt::flush() {
+	if (m_current && m_current->cursor > 0) {
+		closeCurrent();
+	}
+	if (!m_encoder) return;
+
+	raii::CommandBuffer commands = m_encoder->finish();
+	m_encoder = {};
+	m_queue->submit(*commands);
+
+	std::vector<std::shared_ptr<Staging>> closed = std::move(m_closed);
+	m_closed.clear();
+	{
+		std::lock_guard lock(m_core->mutex);
+		++m_core->stats.submits;
+		for (const std::shared_ptr<Staging>& staging : closed) {
+			staging->state = StagingState::InFlight;
+		}
+	}
+
+	// Map staging buffers again once the GPU is done copying from them
+	for (const std::shared_ptr<Staging>& staging : closed) {
+		startMapping(staging);
+	}
+}
+
+/**
+ * Userdata of the WebGPU callback of mapAsync()
+ */
+struct UploadBelt::PendingStaging {
+	std::shared_ptr<Core> core;
+	std::shared_ptr<Staging> staging;
+};
+
+void UploadBelt::startMapping(const std::shared_ptr<Staging>& staging) {
+	// The callback owns a reference to the staging buffer and to the core
+	auto userdata = new PendingStaging{ m_core, staging };
+#ifdef __EMSCRIPTEN__
+	wgpuBufferMapAsync(
+		*staging->buffer,
+		WGPUMapMode_Write,
+		0,
+		staging->size,
+		[](WGPUBufferMapAsyncStatus status, void* userdata) {
+			std::unique_ptr<PendingStaging> pending((PendingStaging*)userdata);
+			onMapped(*pending, status == WGPUBufferMapAsyncStatus_Success);
+		},
+		userdata
+	);
+#else // __EMSCRIPTEN__
+	WGPUBufferMapCallbackInfo2 callbackInfo = {};
+	// Callbacks fire within waitAny() or processEvents(), i.e., when the ring
+	// is full, within poll(), or when the application processes device events.
+	callbackInfo.mode = WGPUCallbackMode_AllowProcessEvents;
+	callbackInfo.callback = [](
+		WGPUMapAsyncStatus status,
+		[[maybe_unused]] WGPUStringView message,
+		void* userdata1,
+		[[maybe_unused]] void* userdata2
+	) {
+		std::unique_ptr<PendingStaging> pending((PendingStaging*)userdata1);
+		onMapped(*pending, status == WGPUMapAsyncStatus_Success);
+	};
+	callbackInfo.userdata1 = userdata;
+	WGPUFuture future = wgpuBufferMapAsync2(*staging->buffer, WGPUMapMode_Write, 0, staging->size, callbackInfo);
+	{
+		std::lock_guard lock(m_core->mutex);
+		staging->future = future;
+	}
+#endif // __EMSCRIPTEN__
+}
+
+void UploadBelt::onMapped(const PendingStaging& pending, bool success) {
+	const std::shared_ptr<Staging>& staging = pending.staging;
+	std::lock_guard lock(pending.core->mutex);
+	if (!success) {
+		// The staging buffer is dropped, and another one gets created instead
+		std::vector<std::shared_ptr<Staging>>& buffers = pending.core->buffers;
+		auto it = std::find(buffers.begin(), buffers.end(), staging);
+		if (it != buffers.end()) buffers.erase(it);
+		return;
+	}
+	staging->mapped = static_cast<uint8_t*>(staging->buffer->getMappedRange(0, staging->size));
+	staging->state = StagingState::Free;
+}
+
+void UploadBelt::poll() {
+#ifndef __EMSCRIPTEN__
+	m_device->tick();
+	m_instance->processEvents();
+#endif // __EMSCRIPTEN__
+}
+
+UploadBelt::Stats UploadBelt::stats() const {
+	std::lock_guard lock(m_core->mutex);
+	return m_core->stats;
+}
+
+Result<Void, Error> UploadBelt::reserve(uint64_t size) {
+	if (m_current && m_current->cursor + size <= m_current->size) {
+		return {};
+	}
+	if (m_current) {
+		closeCurrent();
+	}
+	TRY_ASSIGN(m_current, acquireStagingBuffer());
+	return {};
+}
+
+void UploadBelt::closeCurrent() {
+	m_current->buffer->unmap();
+	m_current->mapped = nullptr;
+	{
+		std::lock_guard lock(m_core->mutex);
+		m_current->state = StagingState::Closed;
+	}
+	m_closed.push_back(std::move(m_current));
+	m_current = nullptr;
+}
+
+Result<std::shared_ptr<UploadBelt::Staging>, Error> UploadBelt::acquireStagingBuffer() {
+	bool flushed = false;
+	while (true) {
+		{
+			std::lock_guard lock(m_core->mutex);
+			for (const std::shared_ptr<Staging>& staging : m_core->buffers) {
+				if (staging->state == StagingState::Free) {
+					staging->state = StagingState::Current;
+					staging->cursor = 0;
+					return staging;
+				}
+			}
+
+			if (m_core->buffers.size() < m_maxChunks) {
+				BufferDescriptor bufferDesc = Default;
+				bufferDesc.label = StringView(m_label);
+				bufferDesc.size = m_chunkSize;
+				bufferDesc.usage = BufferUsage::MapWrite | BufferUsage::CopySrc;
+				bufferDesc.mappedAtCreation = true;
+				auto staging = std::make_shared<Staging>();
+				staging->buffer = m_device->createBuffer(bufferDesc);
+				TRY_ASSERT(*staging->buffer, "Could not create a staging buffer of " << m_chunkSize << " bytes");
+				staging->size = m_chunkSize;
+				staging->mapped = static_cast<uint8_t*>(staging->buffer->getMappedRange(0, m_chunkSize));
+				staging->state = StagingState::Current;
+				m_core->buffers.push_back(staging);
+				++m_core->stats.stagingBuffersCreated;
+				return staging;
+			}
+		}
+
+		// The ring is full: submit pending copies, so that closed staging
+		// buffers get mapped again, then wait for one of them.
+		if (!flushed) {
+			flush();
+			flushed = true;
+			continue;
+		}
+
+#ifdef __EMSCRIPTEN__
+		return std::shared_ptr<Staging>();
+#else // __EMSCRIPTEN__
+		std::vector<FutureWaitInfo> waitInfos;
+		{
+			std::lock_guard lock(m_core->mutex);
+			++m_core->stats.waits;
+			for (const std::shared_ptr<Staging>& staging : m_core->buffers) {
+				if (staging->state != StagingState::InFlight) continue;
+				FutureWaitInfo waitInfo = Default;
+				waitInfo.future = staging->future;
+				waitInfos.push_back(waitInfo);
+			}
+		}
+		TRY_ASSERT(!waitInfos.empty(), "No staging buffer can be reused");
+		WaitStatus status = m_instance->waitAny(waitInfos.size(), waitInfos.data(), UINT64_MAX);
+		if (status == WaitStatus::Success) continue;
+		if (status != WaitStatus::UnsupportedTimeout && status != WaitStatus::UnsupportedCount) {
+			return Error{ "Could not wait for a staging buffer" };
+		}
+		// Without timed waits (see InstanceFeatures::timedWaitAnyEnable),
+		// fall back to processing events.
+		poll();
+		std::this_thread::yield();
+#endif // __EMSCRIPTEN__
+	}
+}
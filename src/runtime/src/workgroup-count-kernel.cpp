@@ -0,0 +1,148 @@
+#include <slang-webgpu/runtime/workgroup-count-kernel.h>
+#include <slang-webgpu/runtime/device-registry.h>
+
+#include <slang-webgpu/common/kernel-archive.h>
+
+#include <string>
+#include <vector>
+
+using namespace wgpu;
+
+namespace {
+
+const std::vector<KernelBindingInfo> s_bindings = {
+	KernelBindingInfo{ "elementCount", 0, KernelBindingType::ReadOnlyStorage, 4 },
+	KernelBindingInfo{ "dispatchArgs", 1, KernelBindingType::Storage, 12 },
+};
+
+} // anonymous namespace
+
+WorkgroupCountKernel::WorkgroupCountKernel(DeviceRegistry& registry)
+	: m_device(registry.getDevice())
+{
+	m_maxWorkgroupCount = registry.getLimits().maxComputeWorkgroupsPerDimension;
+	if (m_maxWorkgroupCount == 0 || m_maxWorkgroupCount == WGPU_LIMIT_U32_UNDEFINED) {
+		// WebGPU default limit
+		m_maxWorkgroupCount = 65535;
+	}
+
+	// 1. Create shader module
+	ShaderSourceWGSL wgslDesc = Default;
+	wgslDesc.code = StringView(s_wgslSource);
+	ShaderModuleDescriptor shaderDesc = Default;
+	shaderDesc.nextInChain = &wgslDesc.chain;
+	shaderDesc.label = StringView("WorkgroupCount");
+	m_shaderModule = m_device.createShaderModule(shaderDesc);
+	m_valid = m_shaderModule;
+
+	// 2. Create pipeline layout
+	std::vector<BindGroupLayoutEntry> layoutEntries(s_bindings.size(), Default);
+	for (size_t i = 0; i < s_bindings.size(); ++i) {
+		layoutEntries[i].binding = s_bindings[i].binding;
+		layoutEntries[i].visibility = ShaderStage::Compute;
+		layoutEntries[i].buffer.minBindingSize = s_bindings[i].minBindingSize;
+		layoutEntries[i].buffer.type = s_bindings[i].type == KernelBindingType::ReadOnlyStorage
+			? BufferBindingType::ReadOnlyStorage
+			: BufferBindingType::Storage;
+	}
+	m_bindGroupLayout = registry.getOrCreateBindGroupLayout(bindingSignature(s_bindings), layoutEntries);
+
+	PipelineLayoutDescriptor layoutDesc = Default;
+	layoutDesc.bindGroupLayoutCount = 1;
+	layoutDesc.bindGroupLayouts = (WGPUBindGroupLayout*)&*m_bindGroupLayout;
+	m_pipelineLayout = m_device.createPipelineLayout(layoutDesc);
+
+	// NB: Pipelines are created upon first use, for each workgroup size
+}
+
+ComputePipeline WorkgroupCountKernel::getPipeline(uint32_t workgroupSize) {
+	std::lock_guard lock(m_mutex);
+	auto it = m_pipelines.find(workgroupSize);
+	if (it != m_pipelines.end()) {
+		return *it->second;
+	}
+
+	std::vector<ConstantEntry> constants(2, Default);
+	constants[0].key = StringView("workgroupSize");
+	constants[0].value = (double)workgroupSize;
+	constants[1].key = StringView("maxWorkgroupCount");
+	constants[1].value = (double)m_maxWorkgroupCount;
+
+	std::string label = "WorkgroupCount::" + std::to_string(workgroupSize);
+	ComputePipelineDescriptor pipelineDesc = Default;
+	pipelineDesc.label = StringView(label);
+	pipelineDesc.compute.module = *m_shaderModule;
+	pipelineDesc.compute.entryPoint = StringView("main");
+	pipelineDesc.compute.constantCount = constants.size();
+	pipelineDesc.compute.constants = constants.data();
+	pipelineDesc.layout = *m_pipelineLayout;
+	raii::ComputePipeline& pipeline = m_pipelines[workgroupSize];
+	pipeline = m_device.createComputePipeline(pipelineDesc);
+	return *pipeline;
+}
+
+Result<Void, Error> WorkgroupCountKernel::dispatch(
+	ComputePassEncoder computePass,
+	const BufferView& elementCount,
+	const BufferView& dispatchArgs,
+	uint32_t workgroupSize
+) {
+	TRY_ASSERT(m_valid, "WorkgroupCount kernel could not load");
+	TRY_ASSERT(workgroupSize > 0, "Workgroup size must not be zero");
+	TRY_ASSERT(
+		(WGPUBuffer)elementCount.buffer != (WGPUBuffer)dispatchArgs.buffer,
+		"Element count and dispatch arguments must be in different buffers"
+	);
+
+	std::vector<BindGroupEntry> entries(s_bindings.size(), Default);
+	TRY_ASSIGN(entries[0], makeBufferBindGroupEntry(m_device, s_bindings[0], elementCount));
+	TRY_ASSIGN(entries[1], makeBufferBindGroupEntry(m_device, s_bindings[1], dispatchArgs));
+
+	BindGroupDescriptor bindGroupDesc = Default;
+	bindGroupDesc.label = StringView("WorkgroupCount");
+	bindGroupDesc.layout = *m_bindGroupLayout;
+	bindGroupDesc.entryCount = entries.size();
+	bindGroupDesc.entries = entries.data();
+	raii::BindGroup bindGroup = m_device.createBindGroup(bindGroupDesc);
+
+	computePass.setPipeline(getPipeline(workgroupSize));
+	computePass.setBindGroup(0, *bindGroup, 0, nullptr);
+	computePass.dispatchWorkgroups(1, 1, 1);
+	return {};
+}
+
+Result<Void, Error> WorkgroupCountKernel::dispatch(
+	CommandEncoder encoder,
+	const BufferView& elementCount,
+	const BufferView& dispatchArgs,
+	uint32_t workgroupSize
+) {
+	ComputePassDescriptor computePassDesc = Default;
+	computePassDesc.label = StringView("WorkgroupCount");
+
+	raii::ComputePassEncoder computePass = encoder.beginComputePass(computePassDesc);
+	auto maybeError = dispatch(*computePass, elementCount, dispatchArgs, workgroupSize);
+	computePass->end();
+	return maybeError;
+}
+
+////////////////////////////////////////////
+// Shader source
+
+const char* WorkgroupCountKernel::s_wgslSource = R"(
+override workgroupSize: u32 = 64;
+override maxWorkgroupCount: u32 = 65535;
+
+@group(0) @binding(0) var<storage, read> elementCount: array<u32>;
+@group(0) @binding(1) var<storage, read_write> dispatchArgs: array<u32, 3>;
+
+@compute @workgroup_size(1)
+fn main() {
+	let count = elementCount[0];
+	// NB: This does not overflow, contrary to (count + workgroupSize - 1)
+	let workgroupCount = count / workgroupSize + select(0u, 1u, count % workgroupSize != 0u);
+	dispatchArgs[0] = min(workgroupCount, maxWorkgroupCount);
+	dispatchArgs[1] = 1u;
+	dispatchArgs[2] = 1u;
+}
+)";
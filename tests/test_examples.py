@@ -43,6 +43,9 @@ all_examples = [
 	"03_module_import",
 	"04_uniforms",
 	"05_autodiff",
+	"06_kernel_fusion",
+	"07_kernel_archive",
+	"08_indirect_dispatch",
 ]
 
 def main(args):